@@ -16,8 +16,10 @@
 // Includes
 //-----------------------------------------------------------------------
 #include "sensor_comm.h"
+#include "sensor_common.h"
 #include "../hal_stm_lvgl/stm32f429i_discovery.h"
 #include "../mma865x_regdef.h"
+#include "i2c_async.h"
 
 //-----------------------------------------------------------------------
 // Global Variables
@@ -33,12 +35,38 @@ uint8_t sensor_comm_init(sensor_comm_handle_t *pComHandle)
 
 uint8_t sensor_comm_write(sensor_comm_handle_t *pComHandle, uint16_t offset, uint16_t size, uint8_t *pWritebuffer)
 {
-	HAL_I2C_Mem_Write(pComHandle, MMA865x_I2C_ADDRESS_WRITE, offset, I2C_MEMADD_SIZE_8BIT, pWritebuffer, size, 1000);
-	return 0;
+	/* waits behind the queued transactions, the bus belongs to i2c_async */
+	if (i2c_async_transfer(MMA865x_I2C_ADDRESS_WRITE, (uint8_t)offset, 1, pWritebuffer, size) != 0)
+	{
+		return SENSOR_WRITE_ERR;
+	}
+	return SENSOR_SUCCESS;
 }
 
 uint8_t sensor_comm_read(sensor_comm_handle_t *pComHandle, uint16_t offset, uint16_t size, uint8_t *pReadbuffer)
 {
-	HAL_I2C_Mem_Read(pComHandle, MMA865x_I2C_ADDRESS_READ, offset, I2C_MEMADD_SIZE_8BIT, pReadbuffer, size, 1000);
-	return 0;
+	/* waits behind the queued transactions, the bus belongs to i2c_async */
+	if (i2c_async_transfer(MMA865x_I2C_ADDRESS_READ, (uint8_t)offset, 0, pReadbuffer, size) != 0)
+	{
+		return SENSOR_READ_ERR;
+	}
+	return SENSOR_SUCCESS;
+}
+
+uint8_t sensor_comm_read_async(sensor_comm_handle_t *pComHandle, uint16_t offset, uint16_t size, uint8_t *pReadbuffer,
+		i2c_async_xfer_t *pXfer, i2c_async_cb_t callback, void *pArg)
+{
+	pXfer->addr = MMA865x_I2C_ADDRESS_READ;
+	pXfer->reg = (uint8_t)offset;
+	pXfer->write = 0;
+	pXfer->buf = pReadbuffer;
+	pXfer->len = size;
+	pXfer->chunk = 0;
+	pXfer->done = callback;
+	pXfer->arg = pArg;
+	if (i2c_async_submit(pXfer) != 0)
+	{
+		return SENSOR_READ_ERR;
+	}
+	return SENSOR_SUCCESS;
 }
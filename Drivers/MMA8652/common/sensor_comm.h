@@ -18,6 +18,7 @@
  * Includes
  ******************************************************************************/
 #include <stdint.h>
+#include "i2c_async.h"
 
 /*******************************************************************************
  * Definitions
@@ -49,4 +50,11 @@ typedef struct sensor_comm_handle
 uint8_t sensor_comm_init(sensor_comm_handle_t *pComHandle);
 uint8_t sensor_comm_write(sensor_comm_handle_t *pComHandle, uint16_t offset, uint16_t size, uint8_t *pWritebuffer);
 uint8_t sensor_comm_read(sensor_comm_handle_t *pComHandle, uint16_t offset, uint16_t size, uint8_t *pReadbuffer);
+/*! @brief       Start a register read without waiting for the bus.
+ *  @details     The transaction pXfer is owned by the caller, callback is called from i2c_async_poll()
+ *               once pReadbuffer holds the data or the read failed (pXfer->status).
+ *  @return      SENSOR_SUCCESS if the read was queued, SENSOR_READ_ERR if the queue is full or pXfer is pending.
+ */
+uint8_t sensor_comm_read_async(sensor_comm_handle_t *pComHandle, uint16_t offset, uint16_t size, uint8_t *pReadbuffer,
+		i2c_async_xfer_t *pXfer, i2c_async_cb_t callback, void *pArg);
 #endif /* SENSOR_COMM_H_ */
@@ -33,6 +33,8 @@
 #define MT_FF_MT_THS  0x15  /* Motion Threshold Value. */
 #define FF_MT_COUNT   0x08  /* Freefall/motion debounce count value. */
 #define PL_COUNT      0x15  /* Debounce count value. */
+#define TR_THS        0x02  /* Transient Threshold Value (0.063g/LSB). */
+#define TR_COUNT      0x01  /* Transient debounce count value. */
 #define ASLP_COUNTER  0x07  /* Auto Sleep after ~5s. */
 
 #define PULSE_THX     0x28  /* X-axis pulse threshold value. */
@@ -132,6 +134,21 @@ const registerwritelist_t gMma865xMotiontDetectConfig[] = {
      MMA865x_CTRL_REG1_DR_MASK | MMA865x_CTRL_REG1_ACTIVE_MASK},
     __END_WRITE_DATA__};
 
+/*! @brief Register Configuration to configure MMA865x for Transient-detect Mode.
+ *  Adds to the current configuration, the event is latched and routed to INT2. */
+const registerwritelist_t gMma865xTransientDetectConfig[] = {
+    {MMA865x_HP_FILTER_CUTOFF, MMA865x_HP_FILTER_CUTOFF_SEL_VAL_0, MMA865x_HP_FILTER_CUTOFF_SEL_MASK},
+    {MMA865x_TRANSIENT_THS, TR_THS | MMA865x_TRANSIENT_THS_DBCNTM_INC_CLR,
+     MMA865x_TRANSIENT_THS_THS_MASK | MMA865x_TRANSIENT_THS_DBCNTM_MASK}, /* Threshold */
+    {MMA865x_TRANSIENT_COUNT, TR_COUNT, 0}, /* Debounce Counter */
+    {MMA865x_TRANSIENT_CFG, MMA865x_TRANSIENT_CFG_ELE_EN | MMA865x_TRANSIENT_CFG_ZTEFE_EN |
+        MMA865x_TRANSIENT_CFG_YTEFE_EN | MMA865x_TRANSIENT_CFG_XTEFE_EN | MMA865x_TRANSIENT_CFG_HPF_BYP_THROUGH_HPF,
+     MMA865x_TRANSIENT_CFG_ELE_MASK | MMA865x_TRANSIENT_CFG_ZTEFE_MASK | MMA865x_TRANSIENT_CFG_YTEFE_MASK |
+        MMA865x_TRANSIENT_CFG_XTEFE_MASK | MMA865x_TRANSIENT_CFG_HPF_BYP_MASK},
+    {MMA865x_CTRL_REG5, MMA865x_CTRL_REG5_INT_CFG_TRANS_INT2, MMA865x_CTRL_REG5_INT_CFG_TRANS_MASK},
+    {MMA865x_CTRL_REG4, MMA865x_CTRL_REG4_INT_EN_TRANS_EN, MMA865x_CTRL_REG4_INT_EN_TRANS_MASK},
+    __END_WRITE_DATA__};
+
 /*! @brief Register Configuration to configure MMA865x for Free-fall Mode. */
 const registerwritelist_t gMma865xFreefallDetectConfig[] = {
     {MMA865x_FF_MT_COUNT, FF_MT_COUNT, 0}, /* Debounce Counter */
@@ -204,6 +221,11 @@ const registerreadlist_t gMma865xReadFFMTSrc[] = {
 	{.readFrom = MMA865x_FF_MT_SRC, .numBytes = 1},
 	__END_READ_DATA__};
 
+/*! @brief Read register list for MMA865x to read Transient Status Register. */
+const registerreadlist_t gMma865xReadTransientSrc[] = {
+	{.readFrom = MMA865x_TRANSIENT_SRC, .numBytes = 1},
+	__END_READ_DATA__};
+
 /*! @brief Read register list for MMA865x to read Interrupt Source Register. */
 const registerreadlist_t gMma865xReadINTSrc[] = {
 	{.readFrom = MMA865x_INT_SOURCE, .numBytes = 1},
@@ -41,6 +41,7 @@ extern const registerwritelist_t gMma865xAccelPollConfig[];
 extern const registerwritelist_t gMma865xAccelFifoConfig[];
 extern const registerwritelist_t gMma865xOrientDetectConfig[];
 extern const registerwritelist_t gMma865xMotiontDetectConfig[];
+extern const registerwritelist_t gMma865xTransientDetectConfig[];
 extern const registerwritelist_t gMma865xFreefallDetectConfig[];
 extern const registerwritelist_t gMma865xDoubleTapDetectConfig[];
 
@@ -50,6 +51,7 @@ extern const registerreadlist_t gMma865xReadAccelFifo[];
 extern const registerreadlist_t gMma865xFifoStatus[];
 extern const registerreadlist_t gMma865xReadAccel8bit[];
 extern const registerreadlist_t gMma865xReadFFMTSrc[];
+extern const registerreadlist_t gMma865xReadTransientSrc[];
 extern const registerreadlist_t gMma865xReadINTSrc[];
 extern const registerreadlist_t gMma865xReadPLStatus[];
 extern const registerreadlist_t gMma865xReadPulseSrc[];
@@ -32,6 +32,20 @@
  */
 static uint8_t mma865x_set_mode(mma865x_driver_t *pDriver, mma865x_mode_type_t sensorMode);
 
+/*******************************************************************************
+ * Local Variables
+ ******************************************************************************/
+/*! @brief State of the asynchronous event reads, one per event type. */
+typedef struct
+{
+    i2c_async_xfer_t xfer;
+    mma865x_event_type_t eventType;
+    uint8_t eventStatus;
+    mma865x_event_cb_t callback;
+} mma865x_async_event_t;
+
+static mma865x_async_event_t gMma865xAsyncEvent[MMA865x_VECTOR_MAGNITUDE + 1];
+
 /*******************************************************************************
  * Code
  ******************************************************************************/
@@ -237,12 +251,11 @@ uint8_t mma865x_read_data(mma865x_driver_t *pDriver, mma865x_data_type_t dataTyp
 	return status;
 }
 
-/*! @brief  The interface function to read MMA865x sensor events.
+/*! @brief  The local function to decode the source register of a MMA865x sensor event.
  */
-uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t eventType, uint8_t* eventVal)
+static uint8_t mma865x_decode_event(mma865x_event_type_t eventType, uint8_t eventStatus, uint8_t* eventVal)
 {
-	uint8_t status;
-    uint8_t eventStatus;
+	uint8_t status = SENSOR_SUCCESS;
 
 	(* eventVal) = MMA865x_NO_EVENT_DETECTED;
 
@@ -250,12 +263,6 @@ uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t event
 	{
 		case MMA865x_FREEFALL:
 
-			status = sensor_burst_read(pDriver->pComHandle, gMma865xReadFFMTSrc, &eventStatus);
-			if (SENSOR_SUCCESS != status)
-			{
-				return status;
-			}
-
             if (0 == (eventStatus & MMA865x_FF_MT_SRC_EA_MASK))
             { /* Return, if new event is not detected. */
               return SENSOR_INVALIDPARAM_ERR;
@@ -266,25 +273,21 @@ uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t event
 			break;
 		case MMA865x_MOTION:
 
-			status = sensor_burst_read(pDriver->pComHandle, gMma865xReadFFMTSrc, &eventStatus);
-			if (SENSOR_SUCCESS != status)
-			{
-				return status;
-			}
-
             if (0x80 == (eventStatus & MMA865x_FF_MT_SRC_EA_MASK))
             { /*! Motion event has been detected. */
             	(* eventVal) = MMA865x_MOTION_DETECTED;
             }
 
 			break;
-		case MMA865x_DOUBLETAP:
+		case MMA865x_TRANSIENT:
 
-			status = sensor_burst_read(pDriver->pComHandle, gMma865xReadPulseSrc, &eventStatus);
-			if (SENSOR_SUCCESS != status)
-			{
-				return status;
-			}
+            if (MMA865x_TRANSIENT_SRC_EA_DETECTED == (eventStatus & MMA865x_TRANSIENT_SRC_EA_MASK))
+            { /*! Transient event has been detected. */
+            	(* eventVal) = MMA865x_TRANSIENT_DETECTED;
+            }
+
+			break;
+		case MMA865x_DOUBLETAP:
 
             if (0x01 == (eventStatus & MMA865x_PULSE_SRC_DPE_MASK))
             { /*! Double-Tap event has been detected. */
@@ -294,12 +297,6 @@ uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t event
 			break;
 		case MMA865x_ORIENTATION:
 
-			status = sensor_burst_read(pDriver->pComHandle, gMma865xReadPLStatus, &eventStatus);
-			if (SENSOR_SUCCESS != status)
-			{
-				return status;
-			}
-
 			if (((eventStatus & MMA865x_PL_STATUS_NEWLP_MASK) == 0x80) &&
 				((eventStatus & MMA865x_PL_STATUS_LO_MASK) == 0x00))
 			{
@@ -348,6 +345,94 @@ uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t event
 	return status;
 }
 
+/*! @brief  The local function to get the source register of a MMA865x sensor event.
+ */
+static const registerreadlist_t *mma865x_event_source(mma865x_event_type_t eventType)
+{
+	switch (eventType)
+	{
+		case MMA865x_FREEFALL:
+		case MMA865x_MOTION:
+			return gMma865xReadFFMTSrc;
+		case MMA865x_TRANSIENT:
+			/*! Reading the source register clears the latched event and releases the interrupt. */
+			return gMma865xReadTransientSrc;
+		case MMA865x_DOUBLETAP:
+			return gMma865xReadPulseSrc;
+		case MMA865x_ORIENTATION:
+			return gMma865xReadPLStatus;
+		default:
+			return NULL;
+	}
+}
+
+/*! @brief  The local function called by the transaction queue once an event source register is read.
+ */
+static void mma865x_event_read_done(i2c_async_xfer_t *pXfer)
+{
+	mma865x_async_event_t *pEvent = pXfer->arg;
+	uint8_t eventVal = MMA865x_NO_EVENT_DETECTED;
+	uint8_t status = SENSOR_READ_ERR;
+
+	if (I2C_ASYNC_DONE == pXfer->status)
+	{
+		status = mma865x_decode_event(pEvent->eventType, pEvent->eventStatus, &eventVal);
+	}
+	pEvent->callback(pEvent->eventType, status, eventVal);
+}
+
+/*! @brief  The interface function to read MMA865x sensor events.
+ */
+uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t eventType, uint8_t* eventVal)
+{
+	uint8_t status;
+	uint8_t eventStatus;
+	const registerreadlist_t *pSource = mma865x_event_source(eventType);
+
+	(* eventVal) = MMA865x_NO_EVENT_DETECTED;
+
+	if (NULL == pSource)
+	{
+		return SENSOR_INVALIDPARAM_ERR;
+	}
+	status = sensor_burst_read(pDriver->pComHandle, pSource, &eventStatus);
+	if (SENSOR_SUCCESS != status)
+	{
+		return status;
+	}
+
+	return mma865x_decode_event(eventType, eventStatus, eventVal);
+}
+
+/*! @brief  The interface function to read MMA865x sensor events without waiting for the bus.
+ */
+uint8_t mma865x_read_event_async(mma865x_driver_t *pDriver, mma865x_event_type_t eventType, mma865x_event_cb_t callback)
+{
+	const registerreadlist_t *pSource = mma865x_event_source(eventType);
+	mma865x_async_event_t *pEvent;
+
+	if ((NULL == pDriver) || (NULL == callback))
+	{
+		return SENSOR_BAD_ADDRESS;
+	}
+	if (NULL == pSource)
+	{
+		return SENSOR_INVALIDPARAM_ERR;
+	}
+
+	/*! One read per event type can be in flight, the source registers are a single byte. */
+	pEvent = &gMma865xAsyncEvent[eventType];
+	if (I2C_ASYNC_PENDING == pEvent->xfer.status)
+	{
+		return SENSOR_READ_ERR;
+	}
+	pEvent->eventType = eventType;
+	pEvent->callback = callback;
+
+	return sensor_comm_read_async(pDriver->pComHandle, pSource->readFrom, pSource->numBytes, &pEvent->eventStatus,
+			&pEvent->xfer, mma865x_event_read_done, pEvent);
+}
+
 /*! @brief  The interface function to apply MMA865x Accel configuration.
  */
 uint8_t mma865x_configure(mma865x_driver_t *pDriver, mma865x_odr_t odr, mma865x_power_mode_t powerMode, mma865x_config_type_t pConfig)
@@ -566,6 +651,32 @@ uint8_t mma865x_set_embedded_function(mma865x_driver_t *pDriver, mma865x_embedde
 				return status;
 			}
 
+		    /*! Set MMA865x into Active mode.*/
+			status = mma865x_set_mode(pDriver, MMA865x_ACTIVE_MODE);
+			if (SENSOR_SUCCESS != status)
+			{
+				return status;
+			}
+
+			/*! Successfully applied sensor configuration. */
+
+			break;
+		case MMA865x_TRANSIENT_DETECTION_MODE:
+
+		    /*! Set MMA865x into standby mode so that configuration can be applied.*/
+			status = mma865x_set_mode(pDriver, MMA865x_STANDBY_MODE);
+			if (SENSOR_SUCCESS != status)
+			{
+				return status;
+			}
+
+            /*! Apply Register Configuration to configure MMA865x for Transient detection mode */
+			status = sensor_burst_write(pDriver->pComHandle, gMma865xTransientDetectConfig);
+			if (SENSOR_SUCCESS != status)
+			{
+				return status;
+			}
+
 		    /*! Set MMA865x into Active mode.*/
 			status = mma865x_set_mode(pDriver, MMA865x_ACTIVE_MODE);
 			if (SENSOR_SUCCESS != status)
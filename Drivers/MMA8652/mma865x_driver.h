@@ -118,6 +118,11 @@ typedef enum mma865x_event_status_type
     MMA865x_FIFO_WTRMRK_DETECTED       = 12U, /*!< FIFO watermark event detected. */
 } mma865x_event_status_type_t;
 
+/*!
+ * @brief Callback of mma865x_read_event_async, status is SENSOR_SUCCESS or the read/decode error.
+ */
+typedef void (*mma865x_event_cb_t)(mma865x_event_type_t eventType, uint8_t status, uint8_t eventVal);
+
 /*!
  * @brief MMA865x Sensor Mode Type
  */
@@ -305,6 +310,16 @@ uint8_t mma865x_read_data(mma865x_driver_t *pDriver, mma865x_data_type_t dataTyp
  */
 uint8_t mma865x_read_event(mma865x_driver_t *pDriver, mma865x_event_type_t eventType, uint8_t* eventVal);
 
+/*! @brief       The interface function to read MMA865x sensor events without waiting for the bus.
+ *  @details     This function queues the read of the event source register, the callback is called
+ *               from i2c_async_poll() with the decoded event. One read per event type can be pending.
+ *  @param[in]   mma865x_driver_t *pDriver, the pointer to the MMA865x driver handle.
+ *  @param[in]   eventType - The MMA865x sensor event type to be read.
+ *  @param[in]   callback - Called with the event value/status.
+ *  @return      returns the status of the operation, SENSOR_READ_ERR if a read of the event type is pending.
+ */
+uint8_t mma865x_read_event_async(mma865x_driver_t *pDriver, mma865x_event_type_t eventType, mma865x_event_cb_t callback);
+
 /*! @brief       The interface function to de-initialize the MMA865x sensor.
  *  @details     This function de-initialize the MMA865x sensor.
  *  @param[in]   mma865x_driver_t *pDriver, the pointer to the MMA865x driver handle.
@@ -7,6 +7,7 @@
 
 #include "../hal_stm_lvgl/stm32f429i_discovery.h"
 #include "accelerometer.h"
+#include "i2c_async.h"
 
 stmdevacc_ctx_t acc_ctx;
 
@@ -25,6 +26,7 @@ stmdevacc_ctx_t mma8452q_init(void){
 
 /*
  * @brief  Write generic device register (platform dependent)
+ *         waits behind the queued transactions, the bus belongs to i2c_async
  *
  * @param  handle    customizable argument. In this examples is used in
  *                   order to select the correct sensor bus handler.
@@ -35,12 +37,12 @@ stmdevacc_ctx_t mma8452q_init(void){
  */
 static int32_t platform_write(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len)
 {
-  HAL_I2C_Mem_Write(handle, MMA8452Q_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
-  return 0;
+  return i2c_async_transfer(MMA8452Q_I2C_ADD_L, reg, 1, bufp, len);
 }
 
 /*
  * @brief  Read generic device register (platform dependent)
+ *         waits behind the queued transactions, the bus belongs to i2c_async
  *
  * @param  handle    customizable argument. In this examples is used in
  *                   order to select the correct sensor bus handler.
@@ -51,6 +53,5 @@ static int32_t platform_write(void *handle, uint8_t reg, uint8_t *bufp, uint16_t
  */
 static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len)
 {
-  HAL_I2C_Mem_Read(handle, MMA8452Q_I2C_ADD_L, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
-  return 0;
+  return i2c_async_transfer(MMA8452Q_I2C_ADD_L, reg, 0, bufp, len);
 }
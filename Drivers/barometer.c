@@ -7,13 +7,46 @@
 
 #include "../hal_stm_lvgl/stm32f429i_discovery.h"
 #include "barometer.h"
+#include "i2c_async.h"
+#include "baro_units.h"
 
 stmdev_ctx_t baro_ctx;
 lps28dfw_md_t md;
+// failed reads of the pressure output registers
+static uint32_t read_errors;
+// register access of the FIFO readout and of the one-shot acquisition
+static baro_fifo_ctx_t fifo_ctx;
+static baro_oneshot_ctx_t oneshot_ctx;
+static baro_wake_ctx_t wake_ctx;
+static baro_bench_ctx_t bench_ctx;
+// acquisition in use and its settings, kept for barometer_resume()
+static baro_mode_t mode = BAROMETER_FIFO;
+static uint8_t fifo_wtm;
+static uint8_t oneshot_avg;
+// wake threshold in Pa, 0 if off, applied whenever the FIFO acquisition starts
+static uint16_t wake_pa;
+// cleared by the reset in barometer_init(), until barometer_resume()
+static uint8_t acquiring;
+// last one-shot sample, the output registers belong to the pending conversion
+static bdata_t last;
+// a full FIFO is 384 bytes, about 35 ms on the bus: it goes in parts of 10
+// samples so a touch read waits 3 ms at most, whole samples as every part
+// restarts at the first output register
+#define FIFO_READ_CHUNK (10 * 3)
+// asynchronous read on the bus and its completion, FIFO or one-shot
+static i2c_async_xfer_t read_xfer;
+static baro_fifo_read_done_ptr read_done;
+// completion of barometer_batch_async
+static bdata_cb_t batch_done;
+// end of the settings sweep
+static bench_done_cb_t bench_done;
 
 
 static int32_t platform_write(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len);
 static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len);
+static int32_t platform_read_async(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len, baro_fifo_read_done_ptr done);
+static uint32_t platform_us(void);
+static uint8_t platform_int(void *handle);
 
 stmdev_ctx_t lps28dfw_init(void){
 	  /* Initialize mems driver interface */
@@ -26,6 +59,7 @@ stmdev_ctx_t lps28dfw_init(void){
 
 /*
  * @brief  Write generic device register (platform dependent)
+ *         waits behind the queued transactions, the bus belongs to i2c_async
  *
  * @param  handle    customizable argument. In this examples is used in
  *                   order to select the correct sensor bus handler.
@@ -36,12 +70,12 @@ stmdev_ctx_t lps28dfw_init(void){
  */
 static int32_t platform_write(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len)
 {
-  HAL_I2C_Mem_Write(handle, LPS28DFW_I2C_ADD_H, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
-  return 0;
+  return i2c_async_transfer(LPS28DFW_I2C_ADD_H, reg, 1, bufp, len);
 }
 
 /*
  * @brief  Read generic device register (platform dependent)
+ *         waits behind the queued transactions, the bus belongs to i2c_async
  *
  * @param  handle    customizable argument. In this examples is used in
  *                   order to select the correct sensor bus handler.
@@ -52,8 +86,86 @@ static int32_t platform_write(void *handle, uint8_t reg, uint8_t *bufp, uint16_t
  */
 static int32_t platform_read(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len)
 {
-  HAL_I2C_Mem_Read(handle, LPS28DFW_I2C_ADD_H, reg, I2C_MEMADD_SIZE_8BIT, bufp, len, 1000);
-  return 0;
+  return i2c_async_transfer(LPS28DFW_I2C_ADD_H, reg, 0, bufp, len);
+}
+
+static void read_xfer_complete(i2c_async_xfer_t *xfer)
+{
+  read_done((xfer->status == I2C_ASYNC_DONE) ? 0 : -1);
+}
+
+/*
+ * @brief  Start reading generic device registers without waiting for the bus
+ *         only one read runs at a time, the FIFO readout chains its two reads
+ *         and only one acquisition mode is active
+ *
+ * @param  handle    unused, the bus belongs to i2c_async
+ * @param  reg       register to read
+ * @param  bufp      pointer to buffer that store the data read, valid until done
+ * @param  len       number of consecutive register to read
+ * @param  done      called from i2c_async_poll() once the data is in bufp
+ *
+ */
+static int32_t platform_read_async(void *handle, uint8_t reg, uint8_t *bufp, uint16_t len, baro_fifo_read_done_ptr done)
+{
+  read_xfer.addr = LPS28DFW_I2C_ADD_H;
+  read_xfer.reg = reg;
+  read_xfer.write = 0;
+  read_xfer.buf = bufp;
+  read_xfer.len = len;
+  read_xfer.chunk = (reg == LPS28DFW_FIFO_DATA_OUT_PRESS_XL) ? FIFO_READ_CHUNK : 0;
+  read_xfer.done = read_xfer_complete;
+  read_done = done;
+  return i2c_async_submit(&read_xfer);
+}
+
+/*
+ * @brief  Microseconds from the HAL tick and the SysTick counter
+ *         wraps at 2^32 like the product of the ms tick, called from the EXTI
+ *         interrupt the ms tick may lag by one when the SysTick is pending
+ *
+ */
+static uint32_t platform_us(void)
+{
+  uint32_t ms;
+  uint32_t val;
+  uint32_t load = SysTick->LOAD + 1;
+
+  do {
+    ms = HAL_GetTick();
+    val = SysTick->VAL;
+  } while (ms != HAL_GetTick());
+
+  return (ms * 1000) + (((load - val) * 1000) / load);
+}
+
+/*
+ * @brief  Level of the INT pin, for polling data ready with the EXTI line enabled
+ */
+static uint8_t platform_int(void *handle)
+{
+  return (HAL_GPIO_ReadPin(BARO_INT_GPIO_Port, BARO_INT_Pin) == GPIO_PIN_SET) ? 1 : 0;
+}
+
+/*
+ * @brief  INT pin on EXTI, raised by the FIFO threshold, by one-shot data ready
+ *         or by the pressure threshold
+ */
+static void int_pin_init(void)
+{
+	GPIO_InitTypeDef GPIO_InitStruct;
+
+	/* INT is push-pull active high, the data sources stay set until the data is read,
+	 * the pressure threshold until the reference is retaken */
+	__HAL_RCC_GPIOG_CLK_ENABLE();
+	GPIO_InitStruct.Pin = BARO_INT_Pin;
+	GPIO_InitStruct.Pull = GPIO_PULLDOWN;
+	GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING;
+	GPIO_InitStruct.Speed = GPIO_SPEED_FREQ_LOW;
+	HAL_GPIO_Init(BARO_INT_GPIO_Port, &GPIO_InitStruct);
+
+	HAL_NVIC_SetPriority(BARO_INT_EXTI_IRQn, 0x0F, 0x00);
+	HAL_NVIC_EnableIRQ(BARO_INT_EXTI_IRQn);
 }
 
 void barometer_init(void){
@@ -61,10 +173,10 @@ void barometer_init(void){
 	lps28dfw_bus_mode_t bus_mode;
 	lps28dfw_stat_t status;
 	lps28dfw_pin_int_route_t int_route;
-	lps28dfw_md_t md;
 
 
 	baro_ctx = lps28dfw_init();
+	acquiring = 0;
 
 	/* Restore default configuration */
 	lps28dfw_init_set(&baro_ctx, LPS28DFW_BOOT);
@@ -74,18 +186,17 @@ void barometer_init(void){
 	} while (status.sw_reset);
 
 
-	/* Set bdu and if_inc recommended for driver usage */
+	/* Set bdu and if_inc recommended for driver usage, the FIFO is set up by barometer_fifo_start() */
 	lps28dfw_init_set(&baro_ctx, LPS28DFW_DRV_RDY);
 
-	lps28dfw_fifo_mode_set(&baro_ctx, (lps28dfw_fifo_md_t *) LPS28DFW_STREAM);
-
 	/* Select bus interface */
 	bus_mode.filter = LPS28DFW_AUTO;
 	bus_mode.interface = LPS28DFW_SEL_BY_HW;
 	lps28dfw_bus_mode_set(&baro_ctx, &bus_mode);
 
-	/* Set Output Data Rate */
-	md.odr = LPS28DFW_4Hz;
+	/* Set Output Data Rate, md is kept for the raw data conversion
+	 * one conversion per second, the FIFO collects them between the batches */
+	md.odr = LPS28DFW_1Hz;
 	md.avg = LPS28DFW_4_AVG;
 	md.lpf = LPS28DFW_LPF_ODR_DIV_4;
 	md.fs = LPS28DFW_1260hPa;
@@ -97,15 +208,328 @@ void barometer_init(void){
 	lps28dfw_pin_int_route_set(&baro_ctx, &int_route);
 }
 
+/*
+ * @brief  Convert raw pressure counts to Pa at the configured full scale (baro_units.h)
+ */
+static inline int32_t counts_to_pa(int32_t counts, lps28dfw_fs_t fs)
+{
+	return baro_counts_to_pa(counts, fs == LPS28DFW_4060hPa);
+}
+
 bdata_t barometer_data(void){
-	lps28dfw_data_t data;
-	bdata_t ret;
-	lps28dfw_data_get(&baro_ctx, &md, &data);
-	ret.deg_c = data.heat.deg_c;
-	ret.hpa = data.pressure.hpa;
+	uint8_t buf[5];
+	int32_t counts;
+	bdata_t ret = {0, 0, 0};
+
+	/* reading the output would take the data ready of the next conversion */
+	if ((mode == BAROMETER_ONESHOT) && acquiring){
+		return last;
+	}
+	/* pressure (24 bit) and temperature (16 bit) are consecutive registers, read them in one burst */
+	if (lps28dfw_read_reg(&baro_ctx, LPS28DFW_PRESS_OUT_XL, buf, sizeof(buf)) != 0){
+		read_errors++;
+		return ret;
+	}
+	/* sign extend the 24 bit two's complement value */
+	counts = (int32_t)(((uint32_t)buf[2] << 24) | ((uint32_t)buf[1] << 16) | ((uint32_t)buf[0] << 8)) >> 8;
+	ret.pa = counts_to_pa(counts, md.fs);
+	/* temperature is already in 0.01 degC */
+	ret.centi_c = (int16_t)((uint16_t)buf[3] | ((uint16_t)buf[4] << 8));
+	ret.valid = 1;
+
 	return ret;
 }
 
+uint32_t barometer_errors(void){
+	return read_errors;
+}
+
+/*
+ * @brief  Start the FIFO in stream mode, the INT pin is raised once watermark samples are collected
+ *
+ * @param  watermark    samples per batch, 1..BARO_FIFO_WTM_MAX
+ *
+ */
+int barometer_fifo_start(uint8_t watermark){
+	/* back from one-shot: continuous conversions at the ODR of barometer_init() */
+	if (mode == BAROMETER_ONESHOT){
+		if ((baro_oneshot_stop() != 0) || (lps28dfw_mode_set(&baro_ctx, &md) != 0)){
+			return -1;
+		}
+	}
+	mode = BAROMETER_FIFO;
+
+	fifo_ctx.write = platform_write;
+	fifo_ctx.read = platform_read;
+	fifo_ctx.read_async = platform_read_async;
+	fifo_ctx.handle = &I2cHandle;
+	if (baro_fifo_start(&fifo_ctx, watermark) != 0){
+		return -1;
+	}
+	fifo_wtm = watermark;
+	acquiring = 1;
+	int_pin_init();
+
+	/* the reset of barometer_init() or the one-shot acquisition cleared the threshold */
+	if (wake_pa != 0){
+		return barometer_wake_start(wake_pa);
+	}
+	return 0;
+}
+
+/*
+ * @brief  Power the sensor down between one-shot conversions started with barometer_trigger()
+ *         the end of the conversion raises the INT pin as data ready
+ *
+ * @param  avg    internal averaging, AVG code 0..BARO_ONESHOT_AVG_MAX for 4..512 samples:
+ *                more averages give less noise for a longer conversion and more current
+ *
+ */
+int barometer_oneshot_start(uint8_t avg){
+	if (avg > BARO_ONESHOT_AVG_MAX){
+		return -1;
+	}
+	/* the FIFO and the threshold must not hold on to the INT pin, the threshold is kept for the FIFO */
+	if ((mode == BAROMETER_FIFO) && (fifo_wtm != 0)){
+		if (baro_fifo_stop() != 0){
+			return -1;
+		}
+	}
+	if (baro_wake_threshold() != 0){
+		if (baro_wake_stop() != 0){
+			return -1;
+		}
+	}
+	mode = BAROMETER_ONESHOT;
+	last.valid = 0;
+
+	oneshot_ctx.write = platform_write;
+	oneshot_ctx.read = platform_read;
+	oneshot_ctx.read_async = platform_read_async;
+	oneshot_ctx.tick = platform_us;
+	oneshot_ctx.handle = &I2cHandle;
+	if (baro_oneshot_start(&oneshot_ctx, avg) != 0){
+		return -1;
+	}
+	oneshot_avg = avg;
+	acquiring = 1;
+	int_pin_init();
+
+	return 0;
+}
+
+/*
+ * @brief  Set up the acquisition in use again, e.g. after barometer_init()
+ */
+int barometer_resume(void){
+	if (mode == BAROMETER_ONESHOT){
+		return barometer_oneshot_start(oneshot_avg);
+	}
+	if (fifo_wtm == 0){
+		return -1;
+	}
+	return barometer_fifo_start(fifo_wtm);
+}
+
+baro_mode_t barometer_mode(void){
+	return mode;
+}
+
+/*
+ * @brief  Raise the INT pin as soon as a conversion is more than pa away from the reference
+ *         the reference is the conversion after the start and after every barometer_wake_rearm()
+ *         the comparison needs continuous conversions: in one-shot mode the threshold is only
+ *         kept and programmed by the next barometer_fifo_start()
+ *
+ * @param  pa    threshold in Pa, BARO_WAKE_MIN_PA..BARO_WAKE_MAX_PA
+ *
+ * @retval 0 on success, -1 before the acquisition is started, on bus error or invalid threshold
+ */
+int barometer_wake_start(uint16_t pa){
+	if ((pa < BARO_WAKE_MIN_PA) || (pa > BARO_WAKE_MAX_PA) || !acquiring){
+		return -1;
+	}
+	if (mode == BAROMETER_ONESHOT){
+		wake_pa = pa;
+		return 0;
+	}
+	wake_ctx.write = platform_write;
+	wake_ctx.read = platform_read;
+	wake_ctx.handle = &I2cHandle;
+	if (baro_wake_start(&wake_ctx, pa) != 0){
+		return -1;
+	}
+	wake_pa = pa;
 
+	return 0;
+}
 
+/*
+ * @brief  Disable the threshold interrupt, also for later FIFO starts
+ */
+int barometer_wake_stop(void){
+	wake_pa = 0;
+	if (baro_wake_threshold() == 0){
+		return 0;
+	}
+	return baro_wake_stop();
+}
 
+/*
+ * @brief  Take the next conversion as the reference, called after every handled sample
+ *         blocking, not from an i2c_async callback
+ *
+ * @param  event    gets the BARO_WAKE_x flags of the comparison, can be NULL
+ *
+ * @retval 0 on success or if the threshold is off, -1 on bus error
+ */
+int barometer_wake_rearm(uint8_t *event){
+	if (barometer_wake_threshold() == 0){
+		if (event != NULL){
+			*event = 0;
+		}
+		return 0;
+	}
+	return baro_wake_rearm(event);
+}
+
+/*
+ * @brief  Threshold in Pa as programmed, 0 if off, in one-shot mode or after barometer_init()
+ *         barometer_wake_pending() gives the one kept for the FIFO
+ */
+uint16_t barometer_wake_threshold(void){
+	/* the reset of barometer_init() cleared it, barometer_resume() programs it again */
+	if (!acquiring){
+		return 0;
+	}
+	return baro_wake_threshold();
+}
+
+/*
+ * @brief  Threshold in Pa kept for the FIFO acquisition, 0 if off
+ */
+uint16_t barometer_wake_pending(void){
+	return wake_pa;
+}
+
+/*
+ * @brief  Start a one-shot conversion
+ *
+ * @retval 0 on success, -1 in FIFO mode, on bus error or if the last conversion was not read
+ */
+int barometer_trigger(void){
+	if (mode != BAROMETER_ONESHOT){
+		return -1;
+	}
+	return baro_oneshot_trigger();
+}
+
+static void batch_complete(const baro_fifo_batch_t *batch, int32_t status)
+{
+	bdata_t ret = {0, 0, 0};
+
+	if (status != 0){
+		read_errors++;
+	} else if (batch->samples != 0){
+		ret.pa = counts_to_pa(batch->counts, md.fs);
+		ret.centi_c = batch->centi_c;
+		ret.valid = 1;
+	}
+	batch_done(ret);
+}
+
+static void oneshot_complete(const baro_oneshot_sample_t *sample, int32_t status)
+{
+	bdata_t ret = {0, 0, 0};
+
+	if (status != 0){
+		read_errors++;
+	} else if (sample->ready){
+		ret.pa = counts_to_pa(sample->counts, md.fs);
+		ret.centi_c = sample->centi_c;
+		ret.valid = 1;
+		last = ret;
+	}
+	batch_done(ret);
+}
+
+/*
+ * @brief  Start draining the FIFO or reading the one-shot conversion without waiting for the bus
+ *         done is called from i2c_async_poll() with the averaged batch or the sample,
+ *         valid is 0 if there was no new data or the bus failed
+ *
+ * @param  done      completion callback
+ *
+ * @retval 0 if the read was started, -1 if a read is still running
+ */
+int barometer_batch_async(bdata_cb_t done){
+	batch_done = done;
+	if (mode == BAROMETER_ONESHOT){
+		return baro_oneshot_read_async(oneshot_complete);
+	}
+	return baro_fifo_drain_async(batch_complete);
+}
+
+/*
+ * @brief  Start running every ODR/AVG/LPF combination for samples conversions, see baro_bench.h
+ *         the sweep takes the sensor until barometer_bench_step() is done with it,
+ *         no read of the acquisition may be started meanwhile
+ *
+ * @param  odr        ODR code to run, 0 for all of them
+ * @param  samples    conversions per combination, BARO_BENCH_SAMPLES_MIN..BARO_BENCH_SAMPLES_MAX
+ * @param  out        called with every result
+ * @param  done       called by barometer_bench_step() at the end, the acquisition is running again
+ *
+ * @retval 0 on success, -1 on bus error, invalid arguments or if a sweep is running
+ */
+int barometer_bench_start(uint8_t odr, uint16_t samples, baro_bench_result_ptr out, bench_done_cb_t done){
+	/* the INT pin is set up by the acquisition */
+	if (!acquiring || baro_bench_running()){
+		return -1;
+	}
+	bench_ctx.write = platform_write;
+	bench_ctx.read = platform_read;
+	bench_ctx.tick = platform_us;
+	bench_ctx.int_pin = platform_int;
+	bench_ctx.handle = &I2cHandle;
+	bench_done = done;
+
+	barometer_init();
+	if (baro_bench_start(&bench_ctx, odr, samples, out) != 0){
+		barometer_init();
+		barometer_resume();
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * @brief  Advance the sweep, called from the superloop, see baro_bench_step()
+ *         the acquisition in use is set up again once the sweep is done
+ *
+ * @retval 1 while the sweep runs, 0 once it is done, -1 on bus error
+ */
+int barometer_bench_step(void){
+	int ret;
+
+	if (!baro_bench_running()){
+		return 0;
+	}
+	ret = baro_bench_step();
+	if (ret > 0){
+		return ret;
+	}
+	barometer_init();
+	if (barometer_resume() != 0){
+		ret = -1;
+	}
+	bench_done(ret);
+	return ret;
+}
+
+/*
+ * @brief  True while a sweep has the sensor
+ */
+bool barometer_bench_running(void){
+	return baro_bench_running();
+}
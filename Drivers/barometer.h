@@ -14,17 +14,55 @@
  extern "C" {
 #endif
 
+ /* Barometer sample in fixed point, no floats from the driver to the UI */
  typedef struct {
-	 float hpa;
-	 float deg_c;
+	 int32_t pa;       /* pressure in Pa */
+	 int16_t centi_c;  /* temperature in 0.01 degC */
+	 uint8_t valid;    /* 0 if the I2C read failed */
  } bdata_t;
 
+ /* Completion of an asynchronous barometer read */
+ typedef void (*bdata_cb_t)(bdata_t data);
+
+ /* End of the settings sweep, result 0 on success, -1 on bus error */
+ typedef void (*bench_done_cb_t)(int result);
+
+ /* Acquisition of the log samples, selected at runtime */
+ typedef enum {
+	 BAROMETER_FIFO = 0,   /* 1 Hz conversions with 4 averages batched in the FIFO */
+	 BAROMETER_ONESHOT,    /* one conversion per log interval, powered down in between */
+ } baro_mode_t;
+
 /* Includes ------------------------------------------------------------------*/
 #include "LPS28DFW/lps28dfw_reg.h"
+#include "baro_fifo.h"
+#include "baro_oneshot.h"
+#include "baro_wake.h"
+#include "baro_bench.h"
+
+/* LPS28DFW INT pin, raised by the FIFO threshold, one-shot data ready or the pressure threshold */
+#define BARO_INT_Pin GPIO_PIN_3
+#define BARO_INT_GPIO_Port GPIOG
+#define BARO_INT_EXTI_IRQn EXTI3_IRQn
 
 stmdev_ctx_t lps28dfw_init(void);
 void barometer_init(void);
 bdata_t barometer_data(void);
+uint32_t barometer_errors(void);
+int barometer_fifo_start(uint8_t watermark);
+int barometer_oneshot_start(uint8_t avg);
+int barometer_resume(void);
+baro_mode_t barometer_mode(void);
+int barometer_trigger(void);
+int barometer_wake_start(uint16_t pa);
+int barometer_wake_stop(void);
+int barometer_wake_rearm(uint8_t *event);
+uint16_t barometer_wake_threshold(void);
+uint16_t barometer_wake_pending(void);
+int barometer_bench_start(uint8_t odr, uint16_t samples, baro_bench_result_ptr out, bench_done_cb_t done);
+int barometer_bench_step(void);
+bool barometer_bench_running(void);
+int barometer_batch_async(bdata_cb_t done);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,126 @@
+/*
+ * i2c_dma.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ */
+
+#include "../hal_stm_lvgl/stm32f429i_discovery.h"
+#include "i2c_dma.h"
+
+i2c_async_ctx_t i2c_dma_ctx;
+#ifdef I2C_PROF
+i2c_prof_ctx_t i2c_dma_prof_ctx;
+#endif
+
+static int32_t platform_start(void *handle, const i2c_async_xfer_t *xfer);
+static void platform_abort(void *handle);
+static uint32_t platform_tick(void);
+#ifdef I2C_PROF
+static uint32_t platform_cycles(void);
+#endif
+
+i2c_async_ctx_t i2c_dma_init(void){
+	/* Initialize bus interface of the transaction queue, the bus is set up by the BSP */
+	i2c_dma_ctx.start = platform_start;
+	i2c_dma_ctx.abort = platform_abort;
+	i2c_dma_ctx.tick = platform_tick;
+	i2c_dma_ctx.handle = &I2cHandle;
+
+	return i2c_dma_ctx;
+}
+
+/*
+ * @brief  Start a register transfer on DMA
+ *         The HAL sends the address phase by polling, the data phase runs on DMA
+ *         and ends in HAL_I2C_MemRxCpltCallback / HAL_I2C_MemTxCpltCallback
+ *
+ * @param  handle    I2C handle
+ * @param  xfer      transaction to start
+ *
+ */
+static int32_t platform_start(void *handle, const i2c_async_xfer_t *xfer)
+{
+	HAL_StatusTypeDef status;
+
+	if (xfer->write){
+		status = HAL_I2C_Mem_Write_DMA(handle, xfer->addr, xfer->reg, I2C_MEMADD_SIZE_8BIT, xfer->buf, xfer->len);
+	} else {
+		status = HAL_I2C_Mem_Read_DMA(handle, xfer->addr, xfer->reg, I2C_MEMADD_SIZE_8BIT, xfer->buf, xfer->len);
+	}
+	return (status == HAL_OK) ? 0 : -1;
+}
+
+/*
+ * @brief  Stop a transfer that did not complete and reset the peripheral
+ *         The DMA handles stay linked, a pending completion is discarded
+ *
+ * @param  handle    I2C handle
+ *
+ */
+static void platform_abort(void *handle)
+{
+	I2C_HandleTypeDef *hi2c = handle;
+
+	HAL_NVIC_DisableIRQ(DISCOVERY_I2Cx_EV_IRQn);
+	HAL_NVIC_DisableIRQ(DISCOVERY_I2Cx_ER_IRQn);
+	HAL_DMA_Abort(hi2c->hdmarx);
+	HAL_DMA_Abort(hi2c->hdmatx);
+	HAL_I2C_DeInit(hi2c);
+	HAL_I2C_Init(hi2c);
+	HAL_NVIC_ClearPendingIRQ(DISCOVERY_I2Cx_DMA_RX_IRQn);
+	HAL_NVIC_ClearPendingIRQ(DISCOVERY_I2Cx_DMA_TX_IRQn);
+	HAL_NVIC_ClearPendingIRQ(DISCOVERY_I2Cx_EV_IRQn);
+	HAL_NVIC_ClearPendingIRQ(DISCOVERY_I2Cx_ER_IRQn);
+	HAL_NVIC_EnableIRQ(DISCOVERY_I2Cx_EV_IRQn);
+	HAL_NVIC_EnableIRQ(DISCOVERY_I2Cx_ER_IRQn);
+}
+
+static uint32_t platform_tick(void)
+{
+	return HAL_GetTick();
+}
+
+#ifdef I2C_PROF
+i2c_prof_ctx_t i2c_dma_prof_init(void){
+	/* Start the DWT cycle counter for the bus profiler, it wraps after 23 s at 180 MHz */
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	i2c_dma_prof_ctx.cycles = platform_cycles;
+	i2c_dma_prof_ctx.cycles_per_us = SystemCoreClock / 1000000;
+
+	return i2c_dma_prof_ctx;
+}
+
+static uint32_t platform_cycles(void)
+{
+	return DWT->CYCCNT;
+}
+#endif
+
+/*
+ * @brief  HAL completion callbacks, called from the I2C and DMA interrupts
+ *         only the result is handed over, the driver callbacks run in i2c_async_poll()
+ */
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c == &I2cHandle){
+		i2c_async_complete(0);
+	}
+}
+
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c == &I2cHandle){
+		i2c_async_complete(0);
+	}
+}
+
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef *hi2c)
+{
+	if (hi2c == &I2cHandle){
+		i2c_async_complete(-1);
+	}
+}
@@ -0,0 +1,33 @@
+/**
+  ******************************************************************************
+  * @file    i2c_dma.h
+  * @author  Tomislav Darlić
+  * @version V1
+  * @date    16-Oct-2026
+  * @brief   This header file contains the functions prototypes for the DMA
+  *          transfers of the asynchronous sensor transactions on I2C3.
+  ******************************************************************************/
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __I2C_DMA_H
+#define __I2C_DMA_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "i2c_async.h"
+#ifdef I2C_PROF
+#include "i2c_prof.h"
+#endif
+
+i2c_async_ctx_t i2c_dma_init(void);
+#ifdef I2C_PROF
+i2c_prof_ctx_t i2c_dma_prof_init(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2C_DMA_H */
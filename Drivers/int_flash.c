@@ -0,0 +1,97 @@
+/*
+ * int_flash.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ */
+
+#include <string.h>
+#include "stm32f4xx_hal.h"
+#include "int_flash.h"
+
+/* Start of the FLASH_LOG region, defined in LinkerScript.ld */
+extern uint8_t _sflash_log[];
+
+press_store_ctx_t flash_ctx;
+
+static int32_t platform_erase(void *handle, uint8_t sector);
+static int32_t platform_program(void *handle, uint32_t offset, const uint8_t *bufp, uint16_t len);
+static int32_t platform_read(void *handle, uint32_t offset, uint8_t *bufp, uint16_t len);
+
+press_store_ctx_t int_flash_init(void){
+	/* Initialize flash interface of the pressure store */
+	flash_ctx.erase = platform_erase;
+	flash_ctx.program = platform_program;
+	flash_ctx.read = platform_read;
+	flash_ctx.sector_size = INT_FLASH_LOG_SECTOR_SIZE;
+	flash_ctx.handle = _sflash_log;
+
+	return flash_ctx;
+}
+
+/*
+ * @brief  Erase one of the two log sectors
+ *
+ * @param  handle    start of the log region
+ * @param  sector    0 or 1
+ *
+ */
+static int32_t platform_erase(void *handle, uint8_t sector)
+{
+	FLASH_EraseInitTypeDef erase;
+	uint32_t error = 0;
+	HAL_StatusTypeDef status;
+
+	erase.TypeErase = FLASH_TYPEERASE_SECTORS;
+	erase.Banks = FLASH_BANK_2;
+	erase.Sector = (sector == 0) ? INT_FLASH_LOG_SECTOR_0 : INT_FLASH_LOG_SECTOR_1;
+	erase.NbSectors = 1;
+	erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+
+	HAL_FLASH_Unlock();
+	status = HAL_FLASHEx_Erase(&erase, &error);
+	HAL_FLASH_Lock();
+
+	return (status == HAL_OK) ? 0 : -1;
+}
+
+/*
+ * @brief  Program words into the log region
+ *
+ * @param  handle    start of the log region
+ * @param  offset    offset from the start of the region, word aligned
+ * @param  bufp      pointer to data to write
+ * @param  len       number of bytes to write, multiple of 4
+ *
+ */
+static int32_t platform_program(void *handle, uint32_t offset, const uint8_t *bufp, uint16_t len)
+{
+	uint32_t addr = (uint32_t) handle + offset;
+	uint32_t word;
+	uint16_t i;
+	HAL_StatusTypeDef status = HAL_OK;
+
+	HAL_FLASH_Unlock();
+	for (i = 0; (i < len) && (status == HAL_OK); i += 4){
+		memcpy(&word, &bufp[i], 4);
+		status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + i, word);
+	}
+	HAL_FLASH_Lock();
+
+	return (status == HAL_OK) ? 0 : -1;
+}
+
+/*
+ * @brief  Read from the log region, flash is memory mapped
+ *
+ * @param  handle    start of the log region
+ * @param  offset    offset from the start of the region
+ * @param  bufp      pointer to buffer that store the data read
+ * @param  len       number of bytes to read
+ *
+ */
+static int32_t platform_read(void *handle, uint32_t offset, uint8_t *bufp, uint16_t len)
+{
+	memcpy(bufp, (const uint8_t *) handle + offset, len);
+	return 0;
+}
@@ -0,0 +1,33 @@
+/**
+  ******************************************************************************
+  * @file    int_flash.h
+  * @author  Tomislav Darlić
+  * @version V1
+  * @date    16-Oct-2026
+  * @brief   This header file contains the functions prototypes for the internal
+  *          flash sectors reserved for the persistent pressure log.
+  ******************************************************************************/
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __INT_FLASH_H
+#define __INT_FLASH_H
+
+#ifdef __cplusplus
+ extern "C" {
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "press_store.h"
+
+/* Sectors reserved in LinkerScript.ld (FLASH_LOG region), bank 2 so that the
+ * code in bank 1 keeps running while a sector is erased or programmed */
+#define INT_FLASH_LOG_SECTOR_0    FLASH_SECTOR_22
+#define INT_FLASH_LOG_SECTOR_1    FLASH_SECTOR_23
+#define INT_FLASH_LOG_SECTOR_SIZE (128 * 1024)
+
+press_store_ctx_t int_flash_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INT_FLASH_H */
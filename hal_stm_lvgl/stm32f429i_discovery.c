@@ -38,6 +38,7 @@
   
 /* Includes ------------------------------------------------------------------*/
 #include "stm32f429i_discovery.h"
+#include "i2c_async.h"
 
 /** @defgroup BSP BSP
   * @{
@@ -120,9 +121,9 @@ static void               I2Cx_WriteData(uint8_t Addr, uint8_t Reg, uint8_t Valu
 static void               I2Cx_WriteBuffer(uint8_t Addr, uint8_t Reg,  uint8_t *pBuffer, uint16_t Length);
 static uint8_t            I2Cx_ReadData(uint8_t Addr, uint8_t Reg);
 static uint8_t            I2Cx_ReadBuffer(uint8_t Addr, uint8_t Reg, uint8_t *pBuffer, uint16_t Length);
-static void               I2Cx_Error(void);
 static void               I2Cx_MspInit(I2C_HandleTypeDef *hi2c);  
 #ifdef EE_M24LR64
+static void               I2Cx_Error(void);
 static HAL_StatusTypeDef  I2Cx_WriteBufferDMA(uint8_t Addr, uint16_t Reg,  uint8_t *pBuffer, uint16_t Length);
 static HAL_StatusTypeDef  I2Cx_ReadBufferDMA(uint8_t Addr, uint16_t Reg, uint8_t *pBuffer, uint16_t Length);
 static HAL_StatusTypeDef  I2Cx_IsDeviceReady(uint16_t DevAddress, uint32_t Trials);
@@ -321,13 +322,11 @@ uint32_t BSP_PB_GetState(Button_TypeDef Button)
 static void I2Cx_MspInit(I2C_HandleTypeDef *hi2c)
 {
   GPIO_InitTypeDef  GPIO_InitStruct;  
-#ifdef EE_M24LR64
   static DMA_HandleTypeDef hdma_tx;
   static DMA_HandleTypeDef hdma_rx;
   
   I2C_HandleTypeDef* pI2cHandle;
   pI2cHandle = &I2cHandle;
-#endif /* EE_M24LR64 */
 
   if (hi2c->Instance == DISCOVERY_I2Cx)
   {
@@ -367,16 +366,15 @@ static void I2Cx_MspInit(I2C_HandleTypeDef *hi2c)
     HAL_NVIC_SetPriority(DISCOVERY_I2Cx_ER_IRQn, 0x0F, 0);
     HAL_NVIC_EnableIRQ(DISCOVERY_I2Cx_ER_IRQn);  
 
-#ifdef EE_M24LR64
-    /* I2C DMA TX and RX channels configuration */
+    /* I2C DMA TX and RX channels configuration, the sensor transactions run on DMA */
     /* Enable the DMA clock */
-    EEPROM_I2C_DMA_CLK_ENABLE();
+    DISCOVERY_I2Cx_DMA_CLK_ENABLE();
     
-    /* Configure the DMA stream for the EE I2C peripheral TX direction */
+    /* Configure the DMA stream for the I2C peripheral TX direction */
     /* Configure the DMA Stream */
-    hdma_tx.Instance                  = EEPROM_I2C_DMA_STREAM_TX;
+    hdma_tx.Instance                  = DISCOVERY_I2Cx_DMA_STREAM_TX;
     /* Set the parameters to be configured */
-    hdma_tx.Init.Channel              = EEPROM_I2C_DMA_CHANNEL;  
+    hdma_tx.Init.Channel              = DISCOVERY_I2Cx_DMA_CHANNEL;  
     hdma_tx.Init.Direction            = DMA_MEMORY_TO_PERIPH;
     hdma_tx.Init.PeriphInc            = DMA_PINC_DISABLE;
     hdma_tx.Init.MemInc               = DMA_MINC_ENABLE;
@@ -396,14 +394,14 @@ static void I2Cx_MspInit(I2C_HandleTypeDef *hi2c)
     HAL_DMA_Init(&hdma_tx);
     
     /* Configure and enable I2C DMA TX Channel interrupt */
-    HAL_NVIC_SetPriority((IRQn_Type)(EEPROM_I2C_DMA_TX_IRQn), EEPROM_I2C_DMA_PREPRIO, 0);
-    HAL_NVIC_EnableIRQ((IRQn_Type)(EEPROM_I2C_DMA_TX_IRQn));
+    HAL_NVIC_SetPriority((IRQn_Type)(DISCOVERY_I2Cx_DMA_TX_IRQn), DISCOVERY_I2Cx_DMA_PREPRIO, 0);
+    HAL_NVIC_EnableIRQ((IRQn_Type)(DISCOVERY_I2Cx_DMA_TX_IRQn));
     
-    /* Configure the DMA stream for the EE I2C peripheral TX direction */
+    /* Configure the DMA stream for the I2C peripheral RX direction */
     /* Configure the DMA Stream */
-    hdma_rx.Instance                  = EEPROM_I2C_DMA_STREAM_RX;
+    hdma_rx.Instance                  = DISCOVERY_I2Cx_DMA_STREAM_RX;
     /* Set the parameters to be configured */
-    hdma_rx.Init.Channel              = EEPROM_I2C_DMA_CHANNEL;  
+    hdma_rx.Init.Channel              = DISCOVERY_I2Cx_DMA_CHANNEL;  
     hdma_rx.Init.Direction            = DMA_PERIPH_TO_MEMORY;
     hdma_rx.Init.PeriphInc            = DMA_PINC_DISABLE;
     hdma_rx.Init.MemInc               = DMA_MINC_ENABLE;
@@ -423,9 +421,8 @@ static void I2Cx_MspInit(I2C_HandleTypeDef *hi2c)
     HAL_DMA_Init(&hdma_rx);
     
     /* Configure and enable I2C DMA RX Channel interrupt */
-    HAL_NVIC_SetPriority((IRQn_Type)(EEPROM_I2C_DMA_RX_IRQn), EEPROM_I2C_DMA_PREPRIO, 0);
-    HAL_NVIC_EnableIRQ((IRQn_Type)(EEPROM_I2C_DMA_RX_IRQn));
-#endif /* EE_M24LR64 */
+    HAL_NVIC_SetPriority((IRQn_Type)(DISCOVERY_I2Cx_DMA_RX_IRQn), DISCOVERY_I2Cx_DMA_PREPRIO, 0);
+    HAL_NVIC_EnableIRQ((IRQn_Type)(DISCOVERY_I2Cx_DMA_RX_IRQn));
   }
 }
 
@@ -478,19 +475,13 @@ static void I2Cx_ITConfig(void)
   * @param  Addr: Device address on BUS Bus.  
   * @param  Reg: The target register address to write
   * @param  Value: The target register value to be written 
+  * @note   The BUS transactions go through the sensor transaction queue in
+  *         the class of the device address, the queue recovers the BUS
+  *         after a failure.
   */
 static void I2Cx_WriteData(uint8_t Addr, uint8_t Reg, uint8_t Value)
   {
-  HAL_StatusTypeDef status = HAL_OK;
-  
-  status = HAL_I2C_Mem_Write(&I2cHandle, Addr, (uint16_t)Reg, I2C_MEMADD_SIZE_8BIT, &Value, 1, I2cxTimeout); 
-  
-  /* Check the communication status */
-  if(status != HAL_OK)
-  {
-    /* Re-Initialize the BUS */
-    I2Cx_Error();
-  }        
+  i2c_async_transfer(Addr, Reg, 1, &Value, 1);
 }
 
 /**
@@ -502,16 +493,7 @@ static void I2Cx_WriteData(uint8_t Addr, uint8_t Reg, uint8_t Value)
   */
 static void I2Cx_WriteBuffer(uint8_t Addr, uint8_t Reg,  uint8_t *pBuffer, uint16_t Length)
   {
-  HAL_StatusTypeDef status = HAL_OK;
-  
-  status = HAL_I2C_Mem_Write(&I2cHandle, Addr, (uint16_t)Reg, I2C_MEMADD_SIZE_8BIT, pBuffer, Length, I2cxTimeout); 
-
-  /* Check the communication status */
-  if(status != HAL_OK)
-  {
-    /* Re-Initialize the BUS */
-    I2Cx_Error();
-  }        
+  i2c_async_transfer(Addr, Reg, 1, pBuffer, Length);
 }
 
 /**
@@ -522,18 +504,10 @@ static void I2Cx_WriteBuffer(uint8_t Addr, uint8_t Reg,  uint8_t *pBuffer, uint1
   */
 static uint8_t I2Cx_ReadData(uint8_t Addr, uint8_t Reg)
 {
-  HAL_StatusTypeDef status = HAL_OK;
   uint8_t value = 0;
   
-  status = HAL_I2C_Mem_Read(&I2cHandle, Addr, Reg, I2C_MEMADD_SIZE_8BIT, &value, 1, I2cxTimeout);
- 
-  /* Check the communication status */
-  if(status != HAL_OK)
-  {
-    /* Re-Initialize the BUS */
-    I2Cx_Error();
-  
-  }
+  i2c_async_transfer(Addr, Reg, 0, &value, 1);
+
   return value;
 }
 
@@ -547,22 +521,7 @@ static uint8_t I2Cx_ReadData(uint8_t Addr, uint8_t Reg)
   */
 static uint8_t I2Cx_ReadBuffer(uint8_t Addr, uint8_t Reg, uint8_t *pBuffer, uint16_t Length)
 {
-  HAL_StatusTypeDef status = HAL_OK;
-
-  status = HAL_I2C_Mem_Read(&I2cHandle, Addr, (uint16_t)Reg, I2C_MEMADD_SIZE_8BIT, pBuffer, Length, I2cxTimeout);
-  
-  /* Check the communication status */
-  if(status == HAL_OK)
-  {
-    return 0;
-  }
-  else
-  {
-    /* Re-Initialize the BUS */
-    I2Cx_Error();
-
-    return 1;
-  }
+  return (i2c_async_transfer(Addr, Reg, 0, pBuffer, Length) == 0) ? 0 : 1;
 }
 
 #ifdef EE_M24LR64
@@ -625,7 +584,6 @@ static HAL_StatusTypeDef I2Cx_IsDeviceReady(uint16_t DevAddress, uint32_t Trials
 { 
   return (HAL_I2C_IsDeviceReady(&I2cHandle, DevAddress, Trials, I2cxTimeout));
 }
-#endif /* EE_M24LR64 */
 
 /**
   * @brief  I2Cx error treatment function
@@ -638,6 +596,7 @@ static void I2Cx_Error(void)
   /* Re-Initialize the SPI communication BUS */
   I2Cx_Init();
 }
+#endif /* EE_M24LR64 */
 
 /******************************* SPI Routines *********************************/
 
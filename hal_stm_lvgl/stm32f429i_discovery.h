@@ -183,6 +183,15 @@ typedef enum
 #define DISCOVERY_I2Cx_EV_IRQn                  I2C3_EV_IRQn
 #define DISCOVERY_I2Cx_ER_IRQn                  I2C3_ER_IRQn
 
+/* Definition for DISCO I2Cx's DMA, used by the asynchronous sensor transactions */
+#define DISCOVERY_I2Cx_DMA_CLK_ENABLE()         __HAL_RCC_DMA1_CLK_ENABLE()
+#define DISCOVERY_I2Cx_DMA_CHANNEL              DMA_CHANNEL_3
+#define DISCOVERY_I2Cx_DMA_STREAM_TX            DMA1_Stream4
+#define DISCOVERY_I2Cx_DMA_STREAM_RX            DMA1_Stream2
+#define DISCOVERY_I2Cx_DMA_TX_IRQn              DMA1_Stream4_IRQn
+#define DISCOVERY_I2Cx_DMA_RX_IRQn              DMA1_Stream2_IRQn
+#define DISCOVERY_I2Cx_DMA_PREPRIO              0x0F
+
 /* I2C clock speed configuration (in Hz) 
   WARNING: 
    Make sure that this define is not already declared in other files.
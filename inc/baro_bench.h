@@ -0,0 +1,126 @@
+/*
+ * baro_bench.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Characterisation of the LPS28DFW settings. Every combination of output
+ *  data rate, internal averaging and low-pass filter is run for a number
+ *  of samples, the result gives the noise, the conversion time and the bus
+ *  time per sample of the combination so the acquisition can be chosen per
+ *  deployment instead of by guess.
+ *
+ *  The conversion time of every averaging is measured first with one-shot
+ *  conversions, from the trigger to data ready on the INT pin. A data rate
+ *  is only run with the averagings that convert within its period. The
+ *  samples are taken on data ready, the first ones after a change are
+ *  dropped while the low-pass filter settles. The noise is the standard
+ *  deviation of the samples around their mean, the station must be kept
+ *  still and out of draughts during the run.
+ *
+ *  Every result is also available as a compact binary frame with a
+ *  checksum, for logging the sweep over the console UART.
+ *
+ *  Register access goes through baro_bench_ctx_t so the same code runs on
+ *  the register-level mock on the host (tools/mock). The sweep is a state
+ *  machine: baro_bench_start() sets the sensor up, every baro_bench_step()
+ *  does at most one conversion or sample, so the superloop keeps running
+ *  over the 20 minutes of a full sweep. It leaves the sensor powered down,
+ *  the caller sets up its acquisition again.
+ */
+
+#ifndef BARO_BENCH_H_
+#define BARO_BENCH_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "baro_fifo.h"
+
+/// ODR codes of CTRL_REG1, 0 is one-shot, 1..8 are 1, 4, 10, 25, 50, 75, 100 and 200 Hz
+#define BARO_BENCH_ODR_MAX 8
+
+/// AVG codes of CTRL_REG1, code n averages 4 << n samples (4..512)
+#define BARO_BENCH_AVG_MAX 7
+
+/// Low-pass filter settings, values of lps28dfw_lpf_t (EN_LPFP and LFPF_CFG of CTRL_REG2)
+#define BARO_BENCH_LPF_OFF   0
+#define BARO_BENCH_LPF_ODR_4 1
+#define BARO_BENCH_LPF_ODR_9 3
+
+/// Samples per combination
+#define BARO_BENCH_SAMPLES_MIN 4
+#define BARO_BENCH_SAMPLES_MAX 1000
+
+/// Result status
+#define BARO_BENCH_OK      0
+#define BARO_BENCH_SKIPPED 1    // the averaging does not convert within the ODR period
+#define BARO_BENCH_TIMEOUT 2    // data ready did not come
+
+/// Binary frame: sync, type, the result little endian and a Fletcher-16 checksum
+#define BARO_BENCH_FRAME_SYNC 0xA5
+#define BARO_BENCH_FRAME_TYPE 0x01
+#define BARO_BENCH_FRAME_LEN  24
+
+/// Free running microsecond tick, wraps at 2^32
+typedef uint32_t (*baro_bench_tick_ptr)(void);
+
+/// Level of the INT pin, data ready
+typedef uint8_t (*baro_bench_pin_ptr)(void* handle);
+
+/// Register access, same functions as baro_fifo_ctx_t
+typedef struct {
+	baro_fifo_write_ptr write;
+	baro_fifo_read_ptr read;
+	baro_bench_tick_ptr tick;
+	baro_bench_pin_ptr int_pin;
+	void* handle;
+} baro_bench_ctx_t;
+
+/// Result of one combination
+typedef struct {
+	uint8_t odr;            // ODR code
+	uint8_t avg;            // AVG code
+	uint8_t lpf;            // BARO_BENCH_LPF_x
+	uint8_t status;         // BARO_BENCH_x
+	uint16_t samples;       // samples taken
+	uint16_t noise_mpa;     // standard deviation in mPa, saturated
+	uint32_t conv_us;       // one-shot conversion time of the averaging
+	uint32_t period_us;     // mean time between data ready
+	uint16_t bus_us;        // mean time of the sample read
+	uint16_t errors;        // failed bus transactions
+} baro_bench_result_t;
+
+/// Called for every combination as soon as it is done
+typedef void (*baro_bench_result_ptr)(const baro_bench_result_t* result);
+
+/// Start the sweep, the combinations go to out in order of ODR, AVG and LPF
+/// odr selects one ODR code, 0 runs all of them
+/// Requires: ctx stays valid until the sweep is done
+/// Returns 0 on success, -1 on bus error, invalid arguments or if a sweep is running
+int baro_bench_start(const baro_bench_ctx_t* ctx, uint8_t odr, uint16_t samples, baro_bench_result_ptr out);
+
+/// Advance the sweep without waiting: a conversion or a sample is taken if data ready is up,
+/// a finished combination goes to out, a skipped one is passed on
+/// Returns 1 while the sweep runs, 0 once it is done, -1 on bus error (the sweep is stopped)
+int baro_bench_step(void);
+
+/// Returns true between baro_bench_start() and the end of the sweep
+bool baro_bench_running(void);
+
+/// Run the whole sweep, baro_bench_start() and baro_bench_step() until it is done
+/// Returns 0 on success, -1 on bus error or invalid arguments
+int baro_bench_sweep(const baro_bench_ctx_t* ctx, uint8_t odr, uint16_t samples, baro_bench_result_ptr out);
+
+/// Output data rate of an ODR code in Hz, 0 for one-shot
+uint16_t baro_bench_odr_hz(uint8_t odr);
+
+/// Write the binary frame of a result into frame, BARO_BENCH_FRAME_LEN bytes
+/// Returns the frame length
+uint16_t baro_bench_encode(const baro_bench_result_t* result, uint8_t* frame);
+
+/// Check and decode a binary frame
+/// Returns 0 on success, -1 if the sync, the type or the checksum is wrong
+int baro_bench_decode(const uint8_t* frame, baro_bench_result_t* result);
+
+#endif // BARO_BENCH_H_
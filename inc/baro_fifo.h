@@ -0,0 +1,97 @@
+/*
+ * baro_fifo.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Batched readout of the LPS28DFW hardware FIFO. The sensor runs in stream
+ *  mode and fills its 128-slot FIFO on its own, the FIFO threshold raises
+ *  the INT pin once the watermark is reached. The FIFO is then drained with
+ *  two bus transactions: one burst over FIFO_STATUS1..TEMP_OUT_H for the
+ *  level, the flags and the temperature, and one burst over the FIFO data
+ *  output (the address rolls back to FIFO_DATA_OUT_PRESS_XL while
+ *  IF_ADD_INC is set). The batch is averaged into one sample.
+ *
+ *  The drain can also run without waiting for the bus: the two reads are
+ *  chained through completion callbacks and the batch is handed to the
+ *  caller from the last one.
+ *
+ *  Register access goes through baro_fifo_ctx_t so the same code runs on
+ *  the register-level mock on the host (tools/mock).
+ */
+
+#ifndef BARO_FIFO_H_
+#define BARO_FIFO_H_
+
+#include <stdint.h>
+
+/// Number of pressure samples the FIFO holds
+#define BARO_FIFO_DEPTH 128
+
+/// Register access, same signature as the ST driver stmdev_ctx_t functions
+/// Returns 0 on success
+typedef int32_t (*baro_fifo_write_ptr)(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+typedef int32_t (*baro_fifo_read_ptr)(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+
+/// Completion of an asynchronous register read, status is 0 on success
+typedef void (*baro_fifo_read_done_ptr)(int32_t status);
+/// Start a register read, done is called once the data is in bufp
+/// Returns 0 if the read was started
+typedef int32_t (*baro_fifo_read_async_ptr)(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len, baro_fifo_read_done_ptr done);
+
+typedef struct {
+	baro_fifo_write_ptr write;
+	baro_fifo_read_ptr read;
+	baro_fifo_read_async_ptr read_async;  // may be NULL if only baro_fifo_drain is used
+	void* handle;
+} baro_fifo_ctx_t;
+
+/// Averaged batch in raw sensor units
+typedef struct {
+	int32_t counts;      // mean of the pressure counts, rounded
+	int32_t min;         // smallest and largest counts of the batch
+	int32_t max;
+	int16_t centi_c;     // temperature in 0.01 degC at the time of the drain
+	uint8_t samples;     // samples in the batch, 0 if the FIFO was empty
+	uint8_t overrun;     // 1 if samples were lost because the FIFO was full
+} baro_fifo_batch_t;
+
+/// Bus transactions and drains since baro_fifo_start
+typedef struct {
+	uint32_t drains;
+	uint32_t samples;
+	uint32_t transactions;
+	uint32_t overruns;
+	uint32_t errors;
+} baro_fifo_stats_t;
+
+/// Completion of baro_fifo_drain_async, status is 0 on success (batch->samples may be 0)
+typedef void (*baro_fifo_done_ptr)(const baro_fifo_batch_t* batch, int32_t status);
+
+/// Largest watermark, FIFO_WTM is a 7-bit register
+#define BARO_FIFO_WTM_MAX 127
+
+/// Put the FIFO in stream mode with the watermark and route the threshold to INT
+/// Requires: 1 <= watermark <= BARO_FIFO_WTM_MAX, ctx stays valid
+/// Returns 0 on success, -1 on bus error or invalid watermark
+int baro_fifo_start(const baro_fifo_ctx_t* ctx, uint8_t watermark);
+
+/// Put the FIFO in bypass mode (empties it) and disable the threshold interrupt
+/// Returns 0 on success, -1 on bus error
+int baro_fifo_stop(void);
+
+/// Read all samples in the FIFO and average them
+/// Returns 0 on success (batch->samples may be 0), -1 on bus error or if an
+/// asynchronous drain is running
+int baro_fifo_drain(baro_fifo_batch_t* batch);
+
+/// Start reading all samples in the FIFO, done is called with the average
+/// Requires: ctx->read_async is set
+/// Returns 0 if the drain was started, -1 if a drain is running or the read
+/// could not be started
+int baro_fifo_drain_async(baro_fifo_done_ptr done);
+
+/// Get the counters
+void baro_fifo_get_stats(baro_fifo_stats_t* stats);
+
+#endif // BARO_FIFO_H_
@@ -0,0 +1,103 @@
+/*
+ * baro_oneshot.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  One-shot acquisition of the LPS28DFW. The sensor stays in power-down
+ *  (ODR 0) and converts only when triggered through the ONESHOT bit, once
+ *  per log interval instead of continuously. Every conversion uses the
+ *  internal averaging set with baro_oneshot_start(): more averages give
+ *  less noise for a longer conversion, the sensor draws its active current
+ *  only while it converts. The end of the conversion is routed to the INT
+ *  pin as data ready (latched, cleared by reading the output), the output
+ *  is then read in one burst over STATUS..TEMP_OUT_H.
+ *
+ *  The conversion time is measured: the trigger and the data ready
+ *  interrupt are timestamped with the microsecond tick of the context, the
+ *  read with the time the sample reached the caller.
+ *
+ *  Register access goes through baro_oneshot_ctx_t so the same code runs on
+ *  the register-level mock on the host (tools/mock).
+ */
+
+#ifndef BARO_ONESHOT_H_
+#define BARO_ONESHOT_H_
+
+#include <stdint.h>
+
+#include "baro_fifo.h"
+
+/// Largest AVG code of CTRL_REG1, code n averages 4 << n samples (4..512)
+#define BARO_ONESHOT_AVG_MAX 7
+
+/// Free running microsecond tick, wraps at 2^32
+typedef uint32_t (*baro_oneshot_tick_ptr)(void);
+
+/// Register access, same functions as baro_fifo_ctx_t
+typedef struct {
+	baro_fifo_write_ptr write;
+	baro_fifo_read_ptr read;
+	baro_fifo_read_async_ptr read_async;  // may be NULL if only baro_oneshot_read is used
+	baro_oneshot_tick_ptr tick;
+	void* handle;
+} baro_oneshot_ctx_t;
+
+/// Output of one conversion in raw sensor units
+typedef struct {
+	int32_t counts;
+	int16_t centi_c;
+	uint8_t ready;       // 0 if no new conversion was in the output registers
+} baro_oneshot_sample_t;
+
+/// Conversions and measured latencies since baro_oneshot_start
+typedef struct {
+	uint32_t conversions;   // triggered
+	uint32_t samples;       // read with new data
+	uint32_t missed;        // read before the conversion had ended
+	uint32_t transactions;
+	uint32_t errors;
+	uint32_t conv_us;       // trigger to data ready interrupt, last conversion
+	uint32_t conv_min_us;
+	uint32_t conv_max_us;
+	uint32_t read_us;       // trigger to the sample at the caller, last conversion
+	uint32_t read_max_us;
+} baro_oneshot_stats_t;
+
+/// Completion of baro_oneshot_read_async, status is 0 on success (sample->ready may be 0)
+typedef void (*baro_oneshot_done_ptr)(const baro_oneshot_sample_t* sample, int32_t status);
+
+/// Power the sensor down, set the averaging and route data ready to INT
+/// The FIFO must be in bypass mode (baro_fifo_stop)
+/// Requires: avg <= BARO_ONESHOT_AVG_MAX, ctx stays valid
+/// Returns 0 on success, -1 on bus error or invalid avg
+int baro_oneshot_start(const baro_oneshot_ctx_t* ctx, uint8_t avg);
+
+/// Remove data ready from INT, the sensor stays powered down
+/// Returns 0 on success, -1 on bus error
+int baro_oneshot_stop(void);
+
+/// Start a conversion
+/// Returns 0 on success, -1 on bus error or if the last conversion was not read yet
+int baro_oneshot_trigger(void);
+
+/// Interrupt side: data ready was raised, timestamps the end of the conversion
+void baro_oneshot_drdy(void);
+
+/// Read the output of the last conversion
+/// Returns 0 on success (sample->ready may be 0), -1 on bus error or if an
+/// asynchronous read is running
+int baro_oneshot_read(baro_oneshot_sample_t* sample);
+
+/// Start reading the output of the last conversion, done is called with it
+/// Requires: ctx->read_async is set
+/// Returns 0 if the read was started, -1 if a read is running or could not be started
+int baro_oneshot_read_async(baro_oneshot_done_ptr done);
+
+/// Averaging in use, the AVG code
+uint8_t baro_oneshot_avg(void);
+
+/// Get the counters
+void baro_oneshot_get_stats(baro_oneshot_stats_t* stats);
+
+#endif // BARO_ONESHOT_H_
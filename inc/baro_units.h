@@ -0,0 +1,36 @@
+/*
+ * baro_units.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Conversion of the LPS28DFW pressure output to Pa. The 24 bit output counts
+ *  4096 LSB/hPa at the 1260 hPa full scale and 2048 LSB/hPa at 4060 hPa, so
+ *  one Pa is 40.96 or 20.48 counts and the conversion is a multiply by 25 and
+ *  a shift (100 / 4096 = 25 / 1024). The result is rounded, halves up. Kept in
+ *  a header so the driver glue (Drivers/barometer.c) and the host tools use
+ *  the same code.
+ */
+
+#ifndef BARO_UNITS_H_
+#define BARO_UNITS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Pressure counts per hPa at the 1260 hPa full scale, half of it at 4060 hPa
+#define BARO_COUNTS_PER_HPA 4096
+
+/// Convert sign extended 24 bit pressure counts to Pa, rounded
+/// fs_4060 selects the 4060 hPa full scale
+/// Any 24 bit value fits: |counts| * 25 stays below 2^31
+static inline int32_t baro_counts_to_pa(int32_t counts, bool fs_4060)
+{
+	if(fs_4060)
+	{
+		return ((counts * 25) + 256) >> 9;
+	}
+	return ((counts * 25) + 512) >> 10;
+}
+
+#endif // BARO_UNITS_H_
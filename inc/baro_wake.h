@@ -0,0 +1,77 @@
+/*
+ * baro_wake.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Wake on pressure change with the LPS28DFW threshold interrupt. The
+ *  sensor compares every conversion with a reference pressure and raises
+ *  the INT pin once the pressure is more than the threshold above or below
+ *  it, so a fast change is seen within one ODR period without polling.
+ *
+ *  REF_P cannot be written, the reference is taken by the sensor itself:
+ *  with AUTOREFP the next conversion becomes the reference. Rearming after
+ *  every logged sample keeps the reference at the last logged value. The
+ *  interrupt is not latched, INT follows the comparison and drops once the
+ *  reference is retaken, so it can share the pin with the FIFO threshold.
+ *
+ *  The threshold interrupt needs continuous conversions (ODR > 0), it does
+ *  not work with the one-shot acquisition.
+ *
+ *  Register access goes through baro_wake_ctx_t so the same code runs on
+ *  the register-level mock on the host (tools/mock).
+ */
+
+#ifndef BARO_WAKE_H_
+#define BARO_WAKE_H_
+
+#include <stdint.h>
+
+#include "baro_fifo.h"
+
+/// Event flags, as in INT_SOURCE
+#define BARO_WAKE_HIGH 0x01    // pressure above the reference + threshold
+#define BARO_WAKE_LOW  0x02    // pressure below the reference - threshold
+
+/// Smallest and largest threshold in Pa, THS_P is 15 bits of 1/16 hPa at 1260 hPa full scale
+#define BARO_WAKE_MIN_PA 7
+#define BARO_WAKE_MAX_PA 20000
+
+/// Register access, same functions as baro_fifo_ctx_t
+typedef struct {
+	baro_fifo_write_ptr write;
+	baro_fifo_read_ptr read;
+	void* handle;
+} baro_wake_ctx_t;
+
+/// Rearms and the events they found since baro_wake_start
+typedef struct {
+	uint32_t rearms;
+	uint32_t high;
+	uint32_t low;
+	uint32_t transactions;
+	uint32_t errors;
+} baro_wake_stats_t;
+
+/// Program the threshold, take the next conversion as the reference and
+/// route the threshold interrupt to INT
+/// Requires: BARO_WAKE_MIN_PA <= threshold_pa <= BARO_WAKE_MAX_PA, ctx stays valid
+/// Returns 0 on success, -1 on bus error or invalid threshold
+int baro_wake_start(const baro_wake_ctx_t* ctx, uint16_t threshold_pa);
+
+/// Disable the threshold interrupt
+/// Returns 0 on success, -1 on bus error
+int baro_wake_stop(void);
+
+/// Read the interrupt source and take the next conversion as the new reference
+/// event gets the BARO_WAKE_x flags of the comparison, can be NULL
+/// Returns 0 on success, -1 on bus error
+int baro_wake_rearm(uint8_t* event);
+
+/// Threshold in Pa as programmed, rounded to the register resolution, 0 if stopped
+uint16_t baro_wake_threshold(void);
+
+/// Get the counters
+void baro_wake_get_stats(baro_wake_stats_t* stats);
+
+#endif // BARO_WAKE_H_
@@ -3,6 +3,9 @@
  *
  *  Created on: Jun 23, 2022
  *      Author: tdarlic
+ *
+ *  The firmware keeps its samples in RING_DECLARE rings (ring_template.h),
+ *  this buffer is only used by the host tools.
  */
 
 #ifndef CIRCULAR_BUFFER_H_
@@ -21,11 +24,15 @@ typedef circular_buf_t* cbuf_handle_t;
 /// Requires: buffer is not NULL, size > 0 (size > 1 for the threadsafe
 //  version, because it holds size - 1 elements)
 /// Ensures: me has been created and is returned in an empty state
+/// The control block is taken from MEM_POOL_SAMPLES (mem_pool.h), NULL is returned
+/// if the pool is exhausted or sealed. The firmware sizes that pool for the barometer
+/// ring only, the host tools start it empty for every buffer
 cbuf_handle_t circular_buf_init(uint16_t* buffer, size_t size);
 
 /// Free a circular buffer structure
 /// Requires: me is valid and created by circular_buf_init
 /// Does not free data buffer; owner is responsible for that
+/// The control block stays in the pool, it is only detached from the buffer
 void circular_buf_free(cbuf_handle_t me);
 
 /// Reset the circular buffer to empty, head == tail. Data not cleared
@@ -77,7 +84,35 @@ size_t circular_buf_size(cbuf_handle_t me);
 /// Returns 0 if successful, -1 if data is not available
 int circular_buf_peek(cbuf_handle_t me, uint16_t* data, unsigned int look_ahead_counter);
 
-// TODO: int circular_buf_get_range(circular_buf_t me, uint8_t *data, size_t len);
-// TODO: int circular_buf_put_range(circular_buf_t me, uint8_t * data, size_t len);
+/// Random access to a value stored in the circular buffer without removing the data
+/// Index 0 is the oldest element, circular_buf_size() - 1 the newest
+/// Requires: me is valid and created by circular_buf_init
+/// Returns 0 if successful, -1 if index is out of range
+int circular_buf_at(cbuf_handle_t me, size_t index, uint16_t* data);
+
+/// Two-segment view of the stored data in oldest to newest order
+/// The first segment starts at the tail, the second one (possibly empty) continues
+/// from the start of the storage buffer. Pointers are only valid until the next put/get.
+/// Requires: me is valid and created by circular_buf_init, all pointers are not NULL
+/// Returns the total number of elements in both segments
+size_t circular_buf_spans(cbuf_handle_t me, const uint16_t** first, size_t* first_len,
+		const uint16_t** second, size_t* second_len);
+
+/// Bulk put that continues to add data if the buffer is full
+/// Old data is overwritten, if len exceeds the capacity only the last values are kept
+/// Data is copied in at most two memcpy segments
+/// Requires: me is valid and created by circular_buf_init, data is not NULL
+void circular_buf_put_range(cbuf_handle_t me, const uint16_t* data, size_t len);
+
+/// Bulk retrieve, drains up to len of the oldest values into the caller buffer
+/// Data is copied out in at most two memcpy segments
+/// Requires: me is valid and created by circular_buf_init, data is not NULL
+/// Returns the number of values retrieved
+size_t circular_buf_get_range(cbuf_handle_t me, uint16_t* data, size_t len);
+
+/// Bulk copy of stored values without removing the data, starting at index (0 is the oldest)
+/// Requires: me is valid and created by circular_buf_init, data is not NULL
+/// Returns the number of values copied
+size_t circular_buf_peek_range(cbuf_handle_t me, size_t index, uint16_t* data, size_t len);
 
 #endif // CIRCULAR_BUFFER_H_
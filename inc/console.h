@@ -35,6 +35,7 @@ typedef enum {
 // but they can be memory hogs in their flexibility. 
 // The HexUint16 functions implement the parsing themselves, eschewing atoi and itoa.
 eCommandResult_T ConsoleReceiveParamInt16(const char * buffer, const uint8_t parameterNumber, int16_t* parameterInt16);
+eCommandResult_T ConsoleReceiveParamInt32(const char * buffer, const uint8_t parameterNumber, int32_t* parameterInt32);
 eCommandResult_T ConsoleSendParamInt16(int16_t parameterInt);
 eCommandResult_T ConsoleSendParamInt32(int32_t parameterInt);
 eCommandResult_T ConsoleReceiveParamHexUint16(const char * buffer, const uint8_t parameterNumber, uint16_t* parameterUint16);
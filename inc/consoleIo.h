@@ -12,5 +12,6 @@ eConsoleError ConsoleIoInit(UART_HandleTypeDef *huart);
 
 eConsoleError ConsoleIoReceive(uint8_t *buffer, const uint32_t bufferLength, uint32_t *readLength);
 eConsoleError ConsoleIoSendString(const char *buffer); // must be null terminated
+eConsoleError ConsoleIoSendBytes(const uint8_t *buffer, const uint32_t length);
 
 #endif // CONSOLE_IO_H
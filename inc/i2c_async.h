@@ -0,0 +1,174 @@
+/*
+ * i2c_async.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Non-blocking register transactions on the shared sensor I2C bus.
+ *  Drivers submit a transaction and get a completion callback, the bus
+ *  transfer itself runs on DMA. The interrupt side only pushes the result
+ *  into a spsc_ring, the callbacks run from i2c_async_poll() in the
+ *  superloop, so no driver code runs in interrupt context and nothing
+ *  waits on the bus between two UI frames. A transaction that does not
+ *  complete within I2C_ASYNC_TIMEOUT is aborted and the bus is recovered.
+ *
+ *  Every device address has a priority class, the touch controller comes
+ *  before the sensor events and those before the sample readout. The bus
+ *  serves the highest class with a transaction waiting, each class in
+ *  submission order, one transaction at a time. A transfer on the bus is
+ *  not interrupted, long readouts are split with xfer->chunk so a touch
+ *  read waits for one part at most. Each class has its own queue: a full
+ *  class refuses further submissions (the caller retries on its next pass)
+ *  without taking slots from the others. The time from submission to
+ *  completion is checked against the deadline of the class.
+ *
+ *  i2c_async_transfer() is a blocking wrapper for the register-level ST
+ *  and NXP drivers and the touch controller, it queues behind the
+ *  transactions already submitted instead of colliding with them. While it
+ *  waits the bus is serviced but the callbacks of the other transactions
+ *  are held back to the next i2c_async_poll() of the superloop, so no
+ *  callback runs inside LVGL's input read or a driver register sequence.
+ *
+ *  The bus goes through i2c_async_ctx_t so the queue runs on top of the
+ *  latency mock on the host (tools/mock).
+ */
+
+#ifndef I2C_ASYNC_H_
+#define I2C_ASYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Transactions waiting for the bus per priority class, a power of two
+#define I2C_ASYNC_QUEUE_LEN 8
+
+/// Devices with a priority of their own, the others are I2C_ASYNC_PRIO_BACKGROUND
+#define I2C_ASYNC_DEVICES 4
+
+/// Deadlines in ms from submission to completion, a later completion is counted as late
+#define I2C_ASYNC_DEADLINE_TOUCH 5
+#define I2C_ASYNC_DEADLINE_SENSOR 20
+#define I2C_ASYNC_DEADLINE_BACKGROUND 200
+
+/// Time in ms after which a transaction on the bus is aborted
+/// (a full LPS28DFW FIFO is 384 bytes, about 35 ms at 100 kHz)
+#define I2C_ASYNC_TIMEOUT 100
+
+/// Transaction status
+typedef enum {
+	I2C_ASYNC_DONE = 0,
+	I2C_ASYNC_PENDING,     // queued or on the bus
+	I2C_ASYNC_ERROR,       // NACK or bus error
+	I2C_ASYNC_TIMEOUT_ERR, // aborted after I2C_ASYNC_TIMEOUT
+} i2c_async_status_t;
+
+/// Priority classes, highest first
+typedef enum {
+	I2C_ASYNC_PRIO_TOUCH = 0,  // touch controller, the UI waits for it
+	I2C_ASYNC_PRIO_SENSOR,     // sensor events
+	I2C_ASYNC_PRIO_BACKGROUND, // sample readout, configuration
+	I2C_ASYNC_PRIO_LEVELS,
+} i2c_async_prio_t;
+
+typedef struct i2c_async_xfer i2c_async_xfer_t;
+
+/// Completion callback, called from i2c_async_poll() with xfer->status set
+typedef void (*i2c_async_cb_t)(i2c_async_xfer_t* xfer);
+
+/// One register transaction, owned by the caller and untouched by the queue
+/// until the callback
+struct i2c_async_xfer {
+	uint8_t addr;           // 8-bit device address, as the HAL uses it
+	uint8_t reg;            // first register, auto-increment is up to the device
+	uint8_t write;          // 1 to write buf to the device, 0 to read into buf
+	uint16_t len;
+	uint8_t* buf;           // must stay valid until the callback
+	uint16_t chunk;         // most bytes per bus transfer, 0 for all at once,
+	                        // every part starts at reg (FIFO output registers)
+	i2c_async_cb_t done;    // may be NULL
+	void* arg;              // free for the owner
+	volatile uint8_t status; // i2c_async_status_t
+	uint8_t prio;           // i2c_async_prio_t of the address, set by the queue
+	uint16_t offset;        // bytes transferred so far
+	uint32_t queued;        // tick of the submission
+	uint32_t start;         // tick the current part was put on the bus
+#ifdef I2C_PROF
+	uint32_t stamp;         // cycle counter at the submission, i2c_prof
+#endif
+};
+
+/// Put a transaction on the bus, completion is reported with i2c_async_complete()
+/// Returns 0 if the transfer was started
+typedef int32_t (*i2c_async_start_ptr)(void* handle, const i2c_async_xfer_t* xfer);
+/// Cancel the transfer on the bus and recover the bus, no completion may follow
+typedef void (*i2c_async_abort_ptr)(void* handle);
+/// Millisecond tick
+typedef uint32_t (*i2c_async_tick_ptr)(void);
+
+/// Bus interface
+typedef struct {
+	i2c_async_start_ptr start;
+	i2c_async_abort_ptr abort;
+	i2c_async_tick_ptr tick;
+	void* handle;
+} i2c_async_ctx_t;
+
+/// Counters of a priority class
+typedef struct {
+	uint32_t submitted;
+	uint32_t completed;
+	uint32_t rejected;   // submissions refused because the class queue was full
+	uint32_t late;       // completed after the deadline of the class
+	uint32_t latency_max; // longest submission to completion in ms
+	uint8_t max_depth;   // deepest the class queue has been
+} i2c_async_class_stats_t;
+
+/// Queue counters
+typedef struct {
+	uint32_t submitted;
+	uint32_t completed;
+	uint32_t errors;
+	uint32_t timeouts;
+	uint32_t rejected;   // submissions refused because the queue was full
+	uint32_t stale;      // completions of aborted transactions, ignored
+	uint32_t parts;      // bus transfers, more than completed with chunked transactions
+	uint8_t max_depth;   // most transactions waiting at once
+	i2c_async_class_stats_t cls[I2C_ASYNC_PRIO_LEVELS];
+} i2c_async_stats_t;
+
+/// Attach the queue to the bus, any queued transaction and the device priorities are dropped
+/// Requires: ctx stays valid
+void i2c_async_init(const i2c_async_ctx_t* ctx);
+
+/// Set the priority class of a device, both 8-bit addresses (read and write) use it
+/// Returns 0 on success, -1 if all I2C_ASYNC_DEVICES are used or prio is invalid
+int i2c_async_set_priority(uint8_t addr, i2c_async_prio_t prio);
+
+/// Queue a transaction in the class of its address, it is started at once if the bus is idle
+/// Requires: addr, reg, write, len, buf, chunk, done and arg are set
+/// Returns 0 on success, -1 if the class queue is full or xfer is still pending
+int i2c_async_submit(i2c_async_xfer_t* xfer);
+
+/// Interrupt side: report the end of the transfer started last
+/// status is 0 on success
+void i2c_async_complete(int32_t status);
+
+/// Run the callbacks of the completed transactions, abort a transaction
+/// that timed out and start the next one or the next part
+/// Returns the number of transactions handed back
+uint32_t i2c_async_poll(void);
+
+/// Blocking transaction, waits for the transaction on the bus and the ones
+/// queued before it in the same or a higher class, the callbacks of the
+/// transactions completing meanwhile run from the next i2c_async_poll()
+/// Requires: not called from a completion callback
+/// Returns 0 on success, -1 on bus error or timeout
+int32_t i2c_async_transfer(uint8_t addr, uint8_t reg, uint8_t write, uint8_t* buf, uint16_t len);
+
+/// Check if nothing is queued, on the bus or waiting for its callback
+bool i2c_async_idle(void);
+
+/// Get the queue counters
+void i2c_async_get_stats(i2c_async_stats_t* stats);
+
+#endif // I2C_ASYNC_H_
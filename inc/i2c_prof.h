@@ -0,0 +1,80 @@
+/*
+ * i2c_prof.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Profiler of the sensor I2C bus. Every transaction of the drivers ends in
+ *  i2c_async: the blocking accessors of the touch controller (IOE_*), of the
+ *  accelerometer (sensor_comm_read/write) and of the barometer
+ *  (platform_read/write) as well as the asynchronous reads. The queue stamps
+ *  a transaction with the cycle counter when it is submitted and records it
+ *  when it completes, so the latency is the time the caller waits for it,
+ *  in the queue and on the bus.
+ *
+ *  Per device address the transactions, the bytes transferred, the errors
+ *  and the timeouts are counted and the latencies go into a histogram with
+ *  log2 buckets in us.
+ *
+ *  The profiler is built with I2C_PROF defined (the Debug configuration),
+ *  without it the queue has no hooks and no stamp in the transactions.
+ */
+
+#ifndef I2C_PROF_H_
+#define I2C_PROF_H_
+
+#include <stdint.h>
+
+/// Devices with counters of their own, further addresses are only counted in others
+#define I2C_PROF_DEVICES 4
+
+/// Latency buckets, bucket 0 is below 1 us, bucket n from 2^(n-1) to below 2^n us,
+/// the last one everything longer
+#define I2C_PROF_BUCKETS 18
+
+/// Free running cycle counter, wraps at 2^32
+typedef uint32_t (*i2c_prof_cycles_ptr)(void);
+
+/// Cycle counter of the profiler
+typedef struct {
+	i2c_prof_cycles_ptr cycles;
+	uint32_t cycles_per_us;
+} i2c_prof_ctx_t;
+
+/// Counters of a device
+typedef struct {
+	uint8_t addr;           // 8-bit write address
+	uint32_t transactions;
+	uint32_t bytes;         // of the transactions that completed
+	uint32_t errors;
+	uint32_t timeouts;
+	uint64_t latency_sum;   // us
+	uint32_t latency_max;   // us
+	uint32_t hist[I2C_PROF_BUCKETS];
+} i2c_prof_device_t;
+
+/// Start profiling with empty counters
+/// Requires: ctx stays valid, cycles_per_us > 0
+void i2c_prof_init(const i2c_prof_ctx_t* ctx);
+
+/// Cycle counter for the submission stamp of a transaction
+uint32_t i2c_prof_stamp(void);
+
+/// Record a completed transaction
+/// status is the i2c_async_status_t it completed with, stamp the one taken at the submission
+void i2c_prof_record(uint8_t addr, uint16_t len, uint8_t status, uint32_t stamp);
+
+/// Copy the counters of the devices seen into out
+/// Returns the number of devices, at most max
+uint8_t i2c_prof_get(i2c_prof_device_t* out, uint8_t max);
+
+/// Transactions of the addresses beyond I2C_PROF_DEVICES
+uint32_t i2c_prof_others(void);
+
+/// Clear all counters
+void i2c_prof_reset(void);
+
+/// Lower bound of a latency bucket in us
+uint32_t i2c_prof_bucket_us(uint8_t bucket);
+
+#endif // I2C_PROF_H_
@@ -26,7 +26,8 @@ extern "C" {
  * GLOBAL PROTOTYPES
  **********************/
 void lv_widgets(void);
-void set_barometer_value(float bvalue);
+void set_barometer_value(int32_t pa);
+void set_forecast(char letter, const char * text);
 void lv_rotate_screen(lv_disp_rot_t rot);
 void lv_ex_msgbox(void);
 void lv_ex_msgbox_close(void);
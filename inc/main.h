@@ -31,7 +31,7 @@ extern "C" {
 #include "lvgl/lvgl.h"
 #include "Drivers/MMA8652/mma865x_driver.h"
 #include "Drivers/MMA8652/mma865x_regdef.h"
-#include "circular_buffer.h"
+#include "press_pipeline.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 
@@ -54,24 +54,56 @@ extern "C" {
 
 /* Exported functions prototypes ---------------------------------------------*/
 void Error_Handler(void);
+void import_sample(uint32_t pa);
 
 /* USER CODE BEGIN EFP */
 extern volatile uint16_t delayTime;
 
 extern volatile lv_disp_rot_t rotation;
 extern volatile bool screen_rotated;
+extern volatile bool acc_motion;
+extern volatile bool baro_data_ready;
 extern mma865x_driver_t I2C;
 extern uint8_t orientation;
 extern bool warnShown;
-extern uint16_t * buffer;
-extern cbuf_handle_t me;
-
-// size of the buffer holding the barometer values
-// 240 holds last 4 hours
-#define BAROMETER_BUFFER_SIZE 240
+extern uint8_t forecastMonth;
+extern uint16_t benchHeld;
 
 // barometer log interval in seconds
-#define BAROMETER_LOG_INTERVAL 5
+#define BAROMETER_LOG_INTERVAL 60
+
+// barometer FIFO watermark, at one conversion per second one batch per log interval
+#define BAROMETER_FIFO_WATERMARK BAROMETER_LOG_INTERVAL
+#if BAROMETER_FIFO_WATERMARK > 127
+#error "BAROMETER_FIFO_WATERMARK does not fit the LPS28DFW FIFO_WTM register"
+#endif
+
+// time in ms past the expected batch before the FIFO is drained without the interrupt
+#define BAROMETER_FIFO_GRACE 5000
+
+// acquisition of the log samples (barometer.h), can be changed with the "bm" command:
+// BAROMETER_ONESHOT powers the sensor down between one conversion per log interval
+// with BAROMETER_ONESHOT_AVG internal averages (AVG code, 5: 128 samples),
+// BAROMETER_FIFO converts continuously at 1 Hz and averages the FIFO batch
+// one-shot is the default for its current, the wake below is armed only in FIFO mode
+#define BAROMETER_ACQ_MODE BAROMETER_ONESHOT
+#define BAROMETER_ONESHOT_AVG 5
+
+// wake on pressure change in FIFO mode, in Pa (0: off), can be changed with the "bw" command:
+// a conversion more than this away from the last sample raises INT and the FIFO is drained at once:
+// in the log slot of the next sample (half an interval around its nominal time) it is that sample,
+// before the slot it is only shown, the history keeps one sample per interval;
+// the threshold needs continuous conversions, with the one-shot acquisition it is kept for a
+// switch to the FIFO ("bm 0")
+#define BAROMETER_WAKE_THRESHOLD 20
+
+// default station altitude in metres for the sea-level reduction, can be changed with the "alt" command
+#define BAROMETER_ALTITUDE 0
+
+// outlier rejection of the barometer samples (outlier.h): window in samples and
+// the lower limit of the deviation scale in Pa
+#define BAROMETER_OUTLIER_LEN 5
+#define BAROMETER_OUTLIER_SCALE 3
 
 /* USER CODE END EFP */
 
@@ -0,0 +1,58 @@
+/*
+ * mem_pool.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Static memory pools replacing malloc on the application path. Every pool
+ *  is a fixed array placed by the linker into the .pools section (see
+ *  LinkerScript.ld), memory is handed out with a bump allocator during boot
+ *  and never freed. After mem_pool_seal() all allocations fail, so no memory
+ *  can be taken or fragmented while the device runs for months.
+ */
+
+#ifndef MEM_POOL_H_
+#define MEM_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Pool identifiers
+typedef enum {
+	MEM_POOL_SAMPLES = 0, // sample storage of the buffers
+	MEM_POOL_COUNT
+} mem_pool_id_t;
+
+/// Pool sizes in bytes, multiples of MEM_POOL_ALIGN
+/// The samples pool holds the barometer ring of press_pipeline.h, 256 samples and its indices
+#define MEM_POOL_SAMPLES_SIZE 520
+
+/// Alignment of every allocation
+#define MEM_POOL_ALIGN 8
+
+/// RAM budget of all pools together, checked at compile time
+#define MEM_POOL_BUDGET 1024
+
+/// Usage of one pool
+typedef struct {
+	const char* name;
+	uint32_t size;   // bytes in the pool
+	uint32_t used;   // bytes handed out
+	uint32_t failed; // allocations that did not fit or came after the seal
+} mem_pool_info_t;
+
+/// Clear all pools, call before any allocation
+void mem_pool_init(void);
+
+/// Take size bytes from a pool, aligned to MEM_POOL_ALIGN
+/// Returns NULL if the pool does not have enough room or the pools are sealed
+void* mem_pool_alloc(mem_pool_id_t pool, size_t size);
+
+/// End of the boot phase, any further allocation fails
+void mem_pool_seal(void);
+
+/// Get the usage of a pool
+/// Returns 0 on success, -1 if the pool does not exist
+int mem_pool_info(mem_pool_id_t pool, mem_pool_info_t* info);
+
+#endif // MEM_POOL_H_
@@ -0,0 +1,79 @@
+/*
+ * outlier.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Hampel outlier rejection for sensor streams. Every stage keeps the last
+ *  len samples in time order and in sorted order, so the median is a
+ *  lookup and the median absolute deviation (MAD) is a merge outwards from
+ *  the median. A new sample is tested against the window of the previous
+ *  samples:
+ *
+ *      |x - median| > nsigma * max(1.4826 * MAD, min_scale)
+ *
+ *  A rejected sample is replaced by the median but still enters the window,
+ *  so a real step is accepted once it holds for more than half the window.
+ *  Cost per sample is O(len), len is at most OUTLIER_WINDOW_MAX.
+ */
+
+#ifndef OUTLIER_H_
+#define OUTLIER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Window length limits in samples, the length must be odd
+#define OUTLIER_WINDOW_MIN 3
+#define OUTLIER_WINDOW_MAX 15
+
+/// Default threshold in multiples of the robust standard deviation
+#define OUTLIER_NSIGMA 3
+
+/// Single stream stage
+typedef struct {
+	int32_t window[OUTLIER_WINDOW_MAX];   // time order, oldest at pos once full
+	int32_t sorted[OUTLIER_WINDOW_MAX];
+	uint8_t len;
+	uint8_t count;
+	uint8_t pos;
+	uint8_t nsigma;
+	int32_t min_scale;   // lower limit of the deviation scale, e.g. the sensor noise
+	uint32_t samples;
+	uint32_t rejected;
+} outlier_t;
+
+/// Stage for x, y, z triples, a triple is rejected as a whole
+typedef struct {
+	outlier_t axis[3];
+	uint32_t samples;
+	uint32_t rejected;
+} outlier3_t;
+
+/// Set up a stage and clear the counters
+/// Requires: len odd in OUTLIER_WINDOW_MIN..OUTLIER_WINDOW_MAX, nsigma > 0, min_scale >= 0
+/// Returns 0 on success, -1 on invalid parameters
+int outlier_init(outlier_t* o, uint8_t len, uint8_t nsigma, int32_t min_scale);
+
+/// Pass a sample through the stage, a rejected sample is replaced by the median
+/// Samples are accepted until the window is full
+/// Returns true if the sample was rejected
+bool outlier_put(outlier_t* o, int32_t* value);
+
+/// Median of the samples in the window, 0 if empty
+int32_t outlier_median(const outlier_t* o);
+
+/// Empty the window, e.g. after a level change of the stream, the counters are kept
+/// The next len samples refill the window and are accepted
+void outlier_clear(outlier_t* o);
+
+/// Set up a triple stage, same parameters for every axis
+/// Returns 0 on success, -1 on invalid parameters
+int outlier3_init(outlier3_t* o, uint8_t len, uint8_t nsigma, int32_t min_scale);
+
+/// Pass a triple through the stage, if any axis is an outlier all three are
+/// replaced by the medians
+/// Returns true if the triple was rejected
+bool outlier3_put(outlier3_t* o, int32_t xyz[3]);
+
+#endif // OUTLIER_H_
@@ -0,0 +1,71 @@
+/*
+ * press_filter.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Two-state Kalman filter (pressure and pressure rate) run once per
+ *  barometer sample, so a single noisy reading no longer moves the history,
+ *  the min/max of the windows and the meter. The state model is a constant
+ *  rate with a random walk on the rate:
+ *
+ *      p[k+1] = p[k] + r[k]        r[k+1] = r[k] + w
+ *
+ *  Everything is in fixed point: pressure in Q8 Pa, rate in Q16 Pa per
+ *  sample and the covariance in Q16 Pa^2. The gains need one 32-bit
+ *  division per update, the rest are 32x32->64 multiplies, a few dozen
+ *  cycles on the Cortex-M4.
+ */
+
+#ifndef PRESS_FILTER_H_
+#define PRESS_FILTER_H_
+
+#include <stdint.h>
+
+/// Variance in Pa^2 (num / den) as Q16
+#define PRESS_FILTER_Q16(num, den) ((uint32_t) (((uint64_t) (num) << 16) / (den)))
+
+/// Default variance of a reading, 1 Pa RMS
+#define PRESS_FILTER_MEAS_VAR PRESS_FILTER_Q16(1, 1)
+/// Default process noise of the pressure per sample, 0.05 Pa RMS
+#define PRESS_FILTER_PRESS_VAR PRESS_FILTER_Q16(1, 400)
+/// Default process noise of the rate per sample, 0.01 Pa per sample RMS
+#define PRESS_FILTER_RATE_VAR PRESS_FILTER_Q16(1, 10000)
+/// Default variance of the rate at start, 1 Pa per sample RMS
+#define PRESS_FILTER_RATE_VAR0 PRESS_FILTER_Q16(1, 1)
+
+/// Filter configuration, all variances in Q16 Pa^2 (see PRESS_FILTER_Q16)
+typedef struct {
+	uint32_t meas_var;   // variance of a reading
+	uint32_t press_var;  // process noise of the pressure per sample
+	uint32_t rate_var;   // process noise of the rate per sample
+	uint32_t rate_var0;  // variance of the rate at the first sample
+} press_filter_cfg_t;
+
+/// Filter output
+typedef struct {
+	int32_t pa;          // filtered pressure in Pa
+	int32_t rate;        // Pa per hour
+	uint32_t var;        // variance of the pressure in 0.01 Pa^2
+	uint32_t rate_var;   // variance of the rate in 0.01 (Pa/h)^2, saturated
+	uint32_t updates;    // readings since the last reset
+} press_filter_t;
+
+/// Configure the filter and reset it
+/// cfg can be NULL for the PRESS_FILTER_* defaults, period_s is the sample period in seconds
+void press_filter_init(const press_filter_cfg_t* cfg, uint16_t period_s);
+
+/// Forget the state, the next reading starts the filter again
+void press_filter_reset(void);
+
+/// Advance one sample without a reading, e.g. while the samples are held
+void press_filter_predict(void);
+
+/// Advance one sample and correct with a reading in Pa
+/// Returns the filtered pressure in Pa
+int32_t press_filter_update(int32_t pa);
+
+/// Get the filter output
+void press_filter_get(press_filter_t* out);
+
+#endif // PRESS_FILTER_H_
@@ -0,0 +1,61 @@
+/*
+ * press_history.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Multi-resolution pressure history. Raw samples are kept in the circular
+ *  buffer, this module rolls them up into 15 minute and hourly tiers that keep
+ *  min/max/mean so days of history fit in a few KB of SRAM.
+ */
+
+#ifndef PRESS_HISTORY_H_
+#define PRESS_HISTORY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Number of 15 minute rollups kept (2 days)
+#define PRESS_HISTORY_15MIN_LEN 192
+
+/// Number of hourly rollups kept (14 days)
+#define PRESS_HISTORY_HOUR_LEN 336
+
+/// Rollup tiers, ordered from the finest to the coarsest
+typedef enum {
+	PRESS_TIER_15MIN = 0,
+	PRESS_TIER_HOUR,
+	PRESS_TIER_COUNT
+} press_tier_t;
+
+/// One rollup entry, values are in the units of the samples
+typedef struct {
+	uint16_t min;
+	uint16_t max;
+	uint16_t mean;
+} press_rollup_t;
+
+/// Reset the history and set the period of the raw samples
+/// Requires: period_s divides 900 (15 minutes)
+void press_history_init(uint16_t period_s);
+
+/// Add a raw sample and cascade it into the rollup tiers
+/// Returns bit mask of the tiers (1 << press_tier_t) that got a new entry
+uint8_t press_history_put(uint16_t value);
+
+/// Number of rollups stored in the tier
+size_t press_history_size(press_tier_t tier);
+
+/// Maximum number of rollups the tier can hold
+size_t press_history_capacity(press_tier_t tier);
+
+/// Get a rollup, index 0 is the oldest entry of the tier
+/// Returns 0 if successful, -1 if index is out of range
+int press_history_at(press_tier_t tier, size_t index, press_rollup_t* rollup);
+
+/// Get the most recent rollup of the tier
+/// Returns 0 if successful, -1 if the tier is empty
+int press_history_last(press_tier_t tier, press_rollup_t* rollup);
+
+#endif // PRESS_HISTORY_H_
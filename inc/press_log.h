@@ -0,0 +1,54 @@
+/*
+ * press_log.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Delta-encoded pressure log. Samples are stored in fixed size blocks, each
+ *  starting with an absolute keyframe followed by nibble-packed zig-zag
+ *  deltas. One-minute readings differ by a few Pa so most samples take a
+ *  single nibble, which gives roughly 4x the samples of a uint16_t ring in
+ *  the same RAM. When the log is full the oldest block is dropped.
+ */
+
+#ifndef PRESS_LOG_H_
+#define PRESS_LOG_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Size of one block in bytes
+#define PRESS_LOG_BLOCK_SIZE 64
+
+/// Number of blocks in the log (2 KB, about 3800 samples)
+#define PRESS_LOG_BLOCKS 32
+
+/// Sequential decoder state
+typedef struct {
+	uint16_t block;     // blocks decoded so far
+	uint16_t nibble;    // next nibble inside the block
+	uint8_t left;       // samples left in the block
+	uint32_t value;     // last decoded value
+} press_log_iter_t;
+
+/// Empty the log
+void press_log_init(void);
+
+/// Append a pressure sample in Pa
+void press_log_put(uint32_t pa);
+
+/// Number of samples stored in the log
+size_t press_log_size(void);
+
+/// Number of bytes used by the stored samples
+size_t press_log_bytes(void);
+
+/// Start decoding from the oldest sample
+void press_log_iter_begin(press_log_iter_t* it);
+
+/// Decode the next sample in Pa
+/// Returns true if a sample was decoded, false when all samples have been read
+bool press_log_iter_next(press_log_iter_t* it, uint32_t* pa);
+
+#endif // PRESS_LOG_H_
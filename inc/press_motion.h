@@ -0,0 +1,78 @@
+/*
+ * press_motion.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Motion gate in front of the pressure history. While the station is
+ *  carried a change of height of one metre moves the reading by about
+ *  12 Pa, which the trend rules would take for weather. The accelerometer
+ *  transient function raises an interrupt on handling, so there is no
+ *  extra I2C traffic while the station is still.
+ *
+ *  Samples taken during motion and for PRESS_MOTION_SETTLE samples after the
+ *  last event are held at the last accepted value so the history keeps its
+ *  time base. At rest the samples are held until PRESS_MOTION_CONFIRM more
+ *  samples stay within PRESS_MOTION_CONFIRM_TOL Pa of the one before, so a
+ *  glitch or a gust on the first sample at rest does not stay in the
+ *  history. The run is taken back along its slope to the last accepted
+ *  sample, so the weather of the held samples is not counted, and a step of
+ *  at least PRESS_MOTION_REBASE_MIN Pa to the held value is taken as a
+ *  change of altitude and added to the offset removed from all following
+ *  samples.
+ *  Without a steady run within PRESS_MOTION_CONFIRM_MAX samples nothing is
+ *  removed, the offset stays within PRESS_MOTION_OFFSET_MAX.
+ */
+
+#ifndef PRESS_MOTION_H_
+#define PRESS_MOTION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Samples held after the last motion event
+#define PRESS_MOTION_SETTLE 2
+
+/// Smallest step in Pa after motion treated as a change of altitude (about 1 m)
+#define PRESS_MOTION_REBASE_MIN 12
+
+/// Samples after the first one at rest that must stay at its level
+#define PRESS_MOTION_CONFIRM 2
+
+/// Largest difference in Pa between two samples of a steady run
+#define PRESS_MOTION_CONFIRM_TOL 10
+
+/// Samples at rest after which the gate gives up without a steady run
+#define PRESS_MOTION_CONFIRM_MAX 8
+
+/// Largest offset in Pa (about 500 m), beyond it the altitude is set with the "alt" command
+#define PRESS_MOTION_OFFSET_MAX 6000
+
+/// Gate state and counters
+typedef struct {
+	bool moving;        // samples are being held
+	uint32_t events;    // motion events reported
+	uint32_t held;      // samples replaced by the held value
+	uint32_t rebases;   // altitude changes removed
+	uint32_t rejected;  // times at rest without a steady run, nothing removed
+	int32_t offset;     // Pa removed from every sample
+} press_motion_t;
+
+/// Reset the gate, the offset and the counters
+void press_motion_init(void);
+
+/// Report a motion event, safe to call from an interrupt
+void press_motion_event(void);
+
+/// Pass a sample in Pa through the gate
+/// held is set if the sample was taken during motion and replaced
+/// Returns the sample with the offset removed, or the held value
+int32_t press_motion_filter(int32_t pa, bool* held);
+
+/// Drop the offset, e.g. after the station altitude was set again
+void press_motion_clear(void);
+
+/// Get the gate state and counters
+void press_motion_get(press_motion_t* state);
+
+#endif // PRESS_MOTION_H_
@@ -0,0 +1,95 @@
+/*
+ * press_pipeline.h
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Sample pipeline of the barometer, one call per log interval. A reading
+ *  goes through the same chain on the station and in the host tools:
+ *
+ *      sea-level reduction (press_slp) -> motion gate (press_motion)
+ *      -> outlier rejection (outlier) -> Kalman filter (press_filter)
+ *      -> compressed log, ring, statistics and history tiers
+ *      -> tendency and storm level (press_tendency)
+ *
+ *  The display, the flash store and the forecast are left to the caller,
+ *  the result of every sample says what changed. The samples are kept in Pa
+ *  above PRESS_PIPELINE_OFFSET in a uint16_t.
+ */
+
+#ifndef PRESS_PIPELINE_H_
+#define PRESS_PIPELINE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#include "ring_template.h"
+#include "outlier.h"
+#include "press_filter.h"
+#include "press_tendency.h"
+
+/// Capacity of the sample ring, a power of two
+/// 256 samples hold the last 4 hours and 16 minutes at one sample per minute
+#define PRESS_PIPELINE_RING_LEN 256
+
+/// Pressure in Pa of a stored value of 0 (900 hPa)
+#define PRESS_PIPELINE_OFFSET 90000
+
+/// Sliding windows of the pressure statistics (press_stats.h)
+#define PRESS_WINDOW_1H  0
+#define PRESS_WINDOW_3H  1
+#define PRESS_WINDOW_6H  2
+#define PRESS_WINDOW_12H 3
+#define PRESS_WINDOW_COUNT 4
+
+RING_DECLARE(baro_ring, uint16_t, PRESS_PIPELINE_RING_LEN)
+
+/// Pipeline configuration
+typedef struct {
+	uint16_t period_s;                      // log interval in seconds
+	uint8_t outlier_len;                    // outlier window in samples
+	int32_t outlier_scale;                  // lower limit of the outlier deviation scale in Pa
+	uint8_t slope_window;                   // PRESS_WINDOW_x of the tendency slope
+	bool filter_rate;                       // the tendency slope is the press_filter rate instead
+	const press_tendency_cfg_t* tendency;   // NULL for the PRESS_TENDENCY_* defaults
+	const press_filter_cfg_t* filter;       // NULL for the PRESS_FILTER_* defaults
+} press_pipeline_cfg_t;
+
+/// What a sample changed
+typedef struct {
+	bool held;              // failed read or taken during motion, the filter coasted
+	bool rejected;          // replaced by the median of the outlier window
+	bool logged;            // stored in the history, not before the first good reading
+	uint32_t pa;            // filtered sea-level pressure in Pa
+	uint16_t value;         // sample as stored, Pa above PRESS_PIPELINE_OFFSET
+	uint8_t tiers;          // history tiers closed by the sample (press_history_put())
+	bool trend;             // the tendency was updated
+	press_storm_t storm;    // storm level after the sample
+	bool warning;           // the storm warning was raised by this sample
+} press_pipeline_result_t;
+
+/// Configure and reset all modules of the pipeline, the ring is taken from MEM_POOL_SAMPLES
+/// The station altitude of press_slp is kept
+/// Returns 0 on success, -1 if the ring or the windows do not fit
+int press_pipeline_init(const press_pipeline_cfg_t* cfg);
+
+/// Take a reading of the station pressure in Pa at centi_c 0.01 degC
+/// valid is false for a failed read, the sample is held
+void press_pipeline_put(int32_t pa, int16_t centi_c, bool valid, press_pipeline_result_t* res);
+
+/// Take a sea-level pressure in Pa past the gate and the outlier window,
+/// e.g. a generated trace sent over the console
+void press_pipeline_import(uint32_t pa, press_pipeline_result_t* res);
+
+/// Replay a stored value recovered from flash into the history, no trend is taken
+/// Returns the history tiers closed by the value (press_history_put())
+uint8_t press_pipeline_restore(uint16_t value);
+
+/// Ring of the stored values, oldest first
+const baro_ring_t* press_pipeline_ring(void);
+
+/// Outlier window of the readings
+outlier_t* press_pipeline_outlier(void);
+
+#endif // PRESS_PIPELINE_H_
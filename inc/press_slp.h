@@ -0,0 +1,39 @@
+/*
+ * press_slp.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Reduction of the station pressure to sea-level pressure so the trend
+ *  rules, the forecast and the meter ranges work at any elevation. Uses the
+ *  hypsometric equation with the mean temperature of the air column
+ *  (station temperature plus half of the standard lapse rate over the
+ *  altitude):
+ *
+ *      p0 = p * exp(g * M * h / (R * Tm))
+ *
+ *  The exponent is computed in Q16 and exp() comes from a Q24 lookup table
+ *  with linear interpolation, so there is no floating point per sample.
+ */
+
+#ifndef PRESS_SLP_H_
+#define PRESS_SLP_H_
+
+#include <stdint.h>
+
+/// Altitude range supported by the reduction in metres
+#define PRESS_SLP_ALT_MIN (-500)
+#define PRESS_SLP_ALT_MAX 4000
+
+/// Set the station altitude in metres, clamped to PRESS_SLP_ALT_MIN..PRESS_SLP_ALT_MAX
+void press_slp_set_altitude(int16_t altitude_m);
+
+/// Get the station altitude in metres
+int16_t press_slp_get_altitude(void);
+
+/// Reduce the station pressure in Pa to sea level
+/// centi_c is the station temperature in 0.01 degC
+/// Returns the sea-level pressure in Pa
+int32_t press_slp_reduce(int32_t pa, int16_t centi_c);
+
+#endif // PRESS_SLP_H_
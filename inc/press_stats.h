@@ -0,0 +1,60 @@
+/*
+ * press_stats.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Streaming sliding-window statistics over the barometer samples.
+ *  Every window keeps min/max in monotonic deques and running sums for the
+ *  mean and the least-squares slope, so both the update and the query are
+ *  (amortized) O(1) no matter how long the window is.
+ */
+
+#ifndef PRESS_STATS_H_
+#define PRESS_STATS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Maximum number of simultaneous windows
+#define PRESS_STATS_MAX_WINDOWS 4
+
+/// Length of the longest window in samples (12 hours at one sample per minute)
+#define PRESS_STATS_MAX_WINDOW 720
+
+/// Sum of all window lengths in samples, sizes the static deque storage
+/// (1h + 3h + 6h + 12h at one sample per minute)
+#define PRESS_STATS_DEQUE_POOL (60 + 180 + 360 + 720)
+
+/// Statistics of a single window, values are in the units of the samples
+/// (Pa above 900 hPa for the barometer ring)
+typedef struct {
+	uint16_t count; // samples currently inside the window
+	uint16_t min;
+	uint16_t max;
+	uint16_t mean;  // rounded
+	int32_t slope;  // least-squares slope in sample units per hour
+} press_stats_t;
+
+/// Configure the windows and reset all statistics
+/// Requires: windows holds count lengths in samples, each in 1..PRESS_STATS_MAX_WINDOW,
+/// count <= PRESS_STATS_MAX_WINDOWS, sum of lengths <= PRESS_STATS_DEQUE_POOL,
+/// period_s is the sample period in seconds
+/// Returns 0 on success, -1 if the configuration does not fit the static storage
+int press_stats_init(const uint16_t* windows, uint8_t count, uint16_t period_s);
+
+/// Reset all windows to empty, configuration is kept
+void press_stats_reset(void);
+
+/// Add a new sample to all windows, evicting the ones that fell out of each window
+/// Amortized O(1) per window
+void press_stats_put(uint16_t value);
+
+/// Get the statistics of a window
+/// Returns 0 on success, -1 if the window does not exist or is empty
+int press_stats_get(uint8_t window, press_stats_t* stats);
+
+/// Check if the window has been completely filled with samples
+bool press_stats_window_full(uint8_t window);
+
+#endif // PRESS_STATS_H_
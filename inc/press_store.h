@@ -0,0 +1,75 @@
+/*
+ * press_store.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Log-structured persistent pressure log in a pair of flash sectors.
+ *  Samples are batched in RAM and written as whole CRC protected records,
+ *  appended sequentially. When the active sector is full the other one is
+ *  erased and becomes active, so both sectors wear evenly. At boot the end
+ *  of the log is found with a binary search and the newest samples are
+ *  replayed into the RAM history.
+ *
+ *  Flash access goes through press_store_ctx_t so the store can run on top
+ *  of a RAM mock on the host.
+ */
+
+#ifndef PRESS_STORE_H_
+#define PRESS_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/// Size of one record in flash, a multiple of the flash program word
+#define PRESS_STORE_RECORD_SIZE 64
+
+/// Number of samples batched into one record
+#define PRESS_STORE_RECORD_SAMPLES 26
+
+/// Erase one of the two sectors (0 or 1)
+typedef int32_t (*press_store_erase_ptr)(void* handle, uint8_t sector);
+/// Program len bytes at offset from the start of the region, len is a multiple of 4
+typedef int32_t (*press_store_program_ptr)(void* handle, uint32_t offset, const uint8_t* bufp, uint16_t len);
+/// Read len bytes at offset from the start of the region
+typedef int32_t (*press_store_read_ptr)(void* handle, uint32_t offset, uint8_t* bufp, uint16_t len);
+
+/// Flash interface, all functions return 0 on success
+typedef struct {
+	press_store_erase_ptr erase;
+	press_store_program_ptr program;
+	press_store_read_ptr read;
+	uint32_t sector_size;  // bytes in one sector, sector 1 follows sector 0
+	void* handle;
+} press_store_ctx_t;
+
+/// Counters for the write amplification and recovery cost
+typedef struct {
+	uint32_t records_written;
+	uint32_t samples_written;
+	uint32_t erases;
+	uint32_t recovery_reads;  // record reads done during the last recovery
+	uint32_t crc_errors;
+} press_store_stats_t;
+
+/// Attach to the flash and locate the end of the log
+/// Requires: ctx stays valid for the lifetime of the store
+/// Returns 0 on success, -1 on flash error
+int press_store_init(const press_store_ctx_t* ctx);
+
+/// Replay up to max_samples of the newest samples, oldest first
+/// Returns the number of samples passed to the sink
+size_t press_store_recover(void (*sink)(uint16_t value), size_t max_samples);
+
+/// Add a sample, a record is written once PRESS_STORE_RECORD_SAMPLES are batched
+/// Returns 0 on success, -1 on flash error
+int press_store_put(uint16_t value);
+
+/// Write the partially filled batch, if any
+/// Returns 0 on success, -1 on flash error
+int press_store_flush(void);
+
+/// Get the store counters
+void press_store_get_stats(press_store_stats_t* stats);
+
+#endif // PRESS_STORE_H_
@@ -0,0 +1,93 @@
+/*
+ * press_tendency.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Pressure tendency engine. The rate comes from the least-squares slope of a
+ *  press_stats window (running sums, O(1) per sample), the shape of the last
+ *  three hours is classified into the nine WMO pressure tendency
+ *  characteristics (code table 0200) from the change over the first and the
+ *  second half of the window. Storm levels are raised by falling-rate
+ *  thresholds and only dropped again once the rate has recovered past a
+ *  hysteresis band, so a rate hovering at a threshold does not toggle the
+ *  warning every sample.
+ *
+ *  All values are integers in Pa and Pa per hour.
+ */
+
+#ifndef PRESS_TENDENCY_H_
+#define PRESS_TENDENCY_H_
+
+#include <stdint.h>
+
+/// Change in Pa over half of the window that still counts as steady
+#define PRESS_TENDENCY_STEADY 10
+
+/// Falling rate in Pa per hour raising the storm watch (3.6 hPa in 3 h, "falling quickly")
+#define PRESS_TENDENCY_WATCH_RATE (-120)
+
+/// Falling rate in Pa per hour raising the storm warning (6 hPa in 3 h, "falling very rapidly")
+#define PRESS_TENDENCY_WARN_RATE (-200)
+
+/// Rate in Pa per hour the pressure has to recover above a threshold before the level is dropped
+#define PRESS_TENDENCY_HYSTERESIS 30
+
+/// WMO pressure tendency characteristic, code table 0200
+typedef enum {
+	PRESS_TEND_RISE_FALL = 0,     // increasing, then decreasing; same or higher than 3 h ago
+	PRESS_TEND_RISE_STEADY,       // increasing, then steady or increasing more slowly; higher
+	PRESS_TEND_RISE,              // increasing steadily or unsteadily; higher
+	PRESS_TEND_FALL_RISE_HIGHER,  // decreasing or steady, then increasing or increasing more rapidly; higher
+	PRESS_TEND_STEADY,            // steady; same as 3 h ago
+	PRESS_TEND_FALL_RISE,         // decreasing, then increasing; same or lower than 3 h ago
+	PRESS_TEND_FALL_STEADY,       // decreasing, then steady or decreasing more slowly; lower
+	PRESS_TEND_FALL,              // decreasing steadily or unsteadily; lower
+	PRESS_TEND_RISE_FALL_LOWER,   // steady or increasing, then decreasing or decreasing more rapidly; lower
+	PRESS_TEND_COUNT
+} press_tend_code_t;
+
+/// Storm level
+typedef enum {
+	PRESS_STORM_NONE = 0,
+	PRESS_STORM_WATCH,
+	PRESS_STORM_WARNING
+} press_storm_t;
+
+/// Engine configuration, rates are negative for a falling pressure
+typedef struct {
+	int32_t steady;      // Pa
+	int32_t watch_rate;  // Pa per hour
+	int32_t warn_rate;   // Pa per hour, <= watch_rate
+	int32_t hysteresis;  // Pa per hour, >= 0
+} press_tendency_cfg_t;
+
+/// Result of the last update
+typedef struct {
+	int32_t slope;          // least-squares slope in Pa per hour
+	int32_t change;         // Pa, end - start of the window
+	press_tend_code_t code;
+	press_storm_t storm;
+	uint32_t updates;       // number of updates since init
+} press_tendency_t;
+
+/// Configure the engine and clear the state
+/// cfg can be NULL for the PRESS_TENDENCY_* defaults
+void press_tendency_init(const press_tendency_cfg_t* cfg);
+
+/// Update with the slope of the rate window and the values at the start, the middle
+/// and the end of the tendency window
+/// Returns the storm level after the update
+press_storm_t press_tendency_update(int32_t slope, int32_t start, int32_t mid, int32_t end);
+
+/// Get the result of the last update
+void press_tendency_get(press_tendency_t* out);
+
+/// Classify the change over the first and the second half of a window
+/// first = mid - start, second = end - mid, changes within +-steady count as steady
+press_tend_code_t press_tendency_classify(int32_t first, int32_t second, int32_t steady);
+
+/// Short description of a tendency code
+const char* press_tendency_name(press_tend_code_t code);
+
+#endif // PRESS_TENDENCY_H_
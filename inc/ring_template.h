@@ -0,0 +1,112 @@
+/*
+ * ring_template.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Compile-time typed ring buffers. RING_DECLARE(name, type, capacity)
+ *  generates a ring type name_t holding capacity elements of type together
+ *  with static inline accessors name_put(), name_get(), ... The storage lives
+ *  inside the struct so a ring is declared as a plain static variable, no
+ *  heap is involved. Capacity must be a power of two, the head and tail run
+ *  freely and are masked, so no operation needs a division.
+ *
+ *  Example:
+ *      RING_DECLARE(acc_ring, acc_sample_t, 16)
+ *      static acc_ring_t ring;
+ *      acc_ring_put(&ring, sample);
+ */
+
+#ifndef RING_TEMPLATE_H_
+#define RING_TEMPLATE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// Declare the ring type name_t and its accessors:
+///   void name_reset(name_t*)                   empty the ring
+///   bool name_empty(const name_t*)
+///   bool name_full(const name_t*)
+///   size_t name_size(const name_t*)            number of elements in the ring
+///   size_t name_capacity(void)
+///   void name_put(name_t*, type)               add, overwrites the oldest element when full
+///   bool name_try_put(name_t*, type)           add, returns false when full
+///   bool name_get(name_t*, type*)              remove the oldest, returns false when empty
+///   bool name_at(const name_t*, size_t, type*) read without removing, 0 is the oldest
+#define RING_DECLARE(name, type, capacity)                                         \
+	_Static_assert(((capacity) > 0) && (((capacity) & ((capacity) - 1)) == 0),     \
+			#name " capacity must be a power of two");                             \
+                                                                                   \
+	typedef struct {                                                               \
+		type buffer[capacity];                                                     \
+		uint32_t head;                                                             \
+		uint32_t tail;                                                             \
+	} name##_t;                                                                    \
+                                                                                   \
+	static inline void name##_reset(name##_t* r)                                   \
+	{                                                                              \
+		r->head = 0;                                                               \
+		r->tail = 0;                                                               \
+	}                                                                              \
+                                                                                   \
+	static inline size_t name##_size(const name##_t* r)                            \
+	{                                                                              \
+		return (size_t)(r->head - r->tail);                                        \
+	}                                                                              \
+                                                                                   \
+	static inline size_t name##_capacity(void)                                     \
+	{                                                                              \
+		return (capacity);                                                         \
+	}                                                                              \
+                                                                                   \
+	static inline bool name##_empty(const name##_t* r)                             \
+	{                                                                              \
+		return r->head == r->tail;                                                 \
+	}                                                                              \
+                                                                                   \
+	static inline bool name##_full(const name##_t* r)                              \
+	{                                                                              \
+		return (r->head - r->tail) == (capacity);                                  \
+	}                                                                              \
+                                                                                   \
+	static inline void name##_put(name##_t* r, type data)                          \
+	{                                                                              \
+		if(name##_full(r))                                                         \
+		{                                                                          \
+			r->tail++;                                                             \
+		}                                                                          \
+		r->buffer[r->head++ & ((capacity) - 1)] = data;                            \
+	}                                                                              \
+                                                                                   \
+	static inline bool name##_try_put(name##_t* r, type data)                      \
+	{                                                                              \
+		if(name##_full(r))                                                         \
+		{                                                                          \
+			return false;                                                          \
+		}                                                                          \
+		r->buffer[r->head++ & ((capacity) - 1)] = data;                            \
+		return true;                                                               \
+	}                                                                              \
+                                                                                   \
+	static inline bool name##_get(name##_t* r, type* data)                         \
+	{                                                                              \
+		if(name##_empty(r))                                                        \
+		{                                                                          \
+			return false;                                                          \
+		}                                                                          \
+		*data = r->buffer[r->tail++ & ((capacity) - 1)];                           \
+		return true;                                                               \
+	}                                                                              \
+                                                                                   \
+	static inline bool name##_at(const name##_t* r, size_t index, type* data)      \
+	{                                                                              \
+		if(index >= name##_size(r))                                                \
+		{                                                                          \
+			return false;                                                          \
+		}                                                                          \
+		*data = r->buffer[(r->tail + (uint32_t)index) & ((capacity) - 1)];         \
+		return true;                                                               \
+	}
+
+#endif // RING_TEMPLATE_H_
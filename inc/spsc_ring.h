@@ -0,0 +1,47 @@
+/*
+ * spsc_ring.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Lock-free single-producer/single-consumer ring for handing samples from an
+ *  interrupt (sensor data-ready, DMA completion) to the superloop without
+ *  disabling IRQs. The producer only writes head, the consumer only writes
+ *  tail, both indices run freely and are masked with the power-of-two
+ *  capacity. Index publication uses acquire/release ordering, which GCC turns
+ *  into a DMB on the Cortex-M4.
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Ring control block, the storage is provided by the owner so both can be static
+typedef struct {
+	uint8_t* buffer;
+	uint32_t mask;          // capacity - 1
+	uint16_t elem_size;     // bytes per element
+	volatile uint32_t head; // next slot to write, owned by the producer
+	volatile uint32_t tail; // next slot to read, owned by the consumer
+	uint32_t dropped;       // pushes rejected because the ring was full
+} spsc_ring_t;
+
+/// Set up a ring on top of buffer, which holds capacity elements of elem_size bytes
+/// Requires: r and buffer are not NULL, capacity is a power of two
+/// Returns 0 on success, -1 if capacity is not a power of two
+int spsc_ring_init(spsc_ring_t* r, void* buffer, uint16_t elem_size, uint32_t capacity);
+
+/// Producer side: copy one element into the ring
+/// Returns true on success, false if the ring is full (the element is dropped)
+bool spsc_ring_push(spsc_ring_t* r, const void* elem);
+
+/// Consumer side: copy the oldest element out of the ring
+/// Returns true on success, false if the ring is empty
+bool spsc_ring_pop(spsc_ring_t* r, void* elem);
+
+/// Number of elements in the ring, exact only when called from the producer or the consumer
+uint32_t spsc_ring_size(spsc_ring_t* r);
+
+#endif // SPSC_RING_H_
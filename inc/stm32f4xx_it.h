@@ -61,6 +61,11 @@ void SysTick_Handler(void);
 void USART1_IRQHandler(void);
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
 void EXTI0_IRQHandler(void);
+void EXTI3_IRQHandler(void);
+void I2C3_EV_IRQHandler(void);
+void I2C3_ER_IRQHandler(void);
+void DMA1_Stream2_IRQHandler(void);
+void DMA1_Stream4_IRQHandler(void);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,39 @@
+/*
+ * zambretti.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Zambretti forecaster. The sea-level pressure between 950 and 1050 hPa is
+ *  split into 22 bands, the band and the 3 hour trend (rising, steady,
+ *  falling) select one of 26 forecasts A..Z from lookup tables. Between April
+ *  and September (northern hemisphere) a rising or falling pressure is
+ *  shifted by 7 % of the range as in the original Negretti & Zambra
+ *  instrument. Everything is integer, one evaluation is a constant-time
+ *  table lookup.
+ */
+
+#ifndef ZAMBRETTI_H_
+#define ZAMBRETTI_H_
+
+#include <stdint.h>
+
+/// Number of forecasts, letters A..Z
+#define ZAMBRETTI_COUNT 26
+
+/// 3 hour change in Pa that counts as rising or falling (1.6 hPa)
+#define ZAMBRETTI_TREND 160
+
+/// Get the forecast for a sea-level pressure
+/// pa is the sea-level pressure in Pa, change_3h the change over the last 3 hours in Pa,
+/// month is 1..12 or 0 if unknown (no seasonal correction)
+/// Returns the forecast code 0..ZAMBRETTI_COUNT-1, 0 is A
+uint8_t zambretti_forecast(int32_t pa, int32_t change_3h, uint8_t month);
+
+/// Letter of a forecast code, 'A'..'Z'
+char zambretti_letter(uint8_t code);
+
+/// Text of a forecast code
+const char* zambretti_text(uint8_t code);
+
+#endif // ZAMBRETTI_H_
@@ -0,0 +1,518 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "baro_bench.h"
+
+// LPS28DFW registers and bits used by the sweep
+#define REG_INTERRUPT_CFG      0x0B
+#define REG_CTRL_REG1          0x10
+#define REG_CTRL_REG2          0x11
+#define REG_CTRL_REG4          0x13
+#define REG_FIFO_CTRL          0x14
+#define REG_STATUS             0x27
+
+#define CTRL_REG1_ODR_SHIFT    3
+#define CTRL_REG2_BOOT         0x80
+#define CTRL_REG2_LFPF_CFG     0x20
+#define CTRL_REG2_EN_LPFP      0x10
+#define CTRL_REG2_SWRESET      0x04
+#define CTRL_REG2_ONESHOT      0x01
+#define CTRL_REG4_DRDY_PLS     0x40
+#define CTRL_REG4_DRDY         0x20
+#define CTRL_REG4_INT_EN       0x10
+#define CTRL_REG4_INT_F        0x07
+#define STATUS_P_DA            0x01
+#define FIFO_CTRL_BYPASS       0x00
+
+// STATUS, PRESS_OUT_XL/L/H, TEMP_OUT_L/H
+#define OUT_BURST              6
+#define OUT_OFF_STATUS         0
+#define OUT_OFF_PRESS          1
+
+// one-shot conversions per averaging for its conversion time
+#define CONV_RUNS              4
+// longest wait for a one-shot conversion, 512 averages take about 100 ms
+#define CONV_TIMEOUT_US        500000
+// wait for data ready on top of the ODR period and the conversion
+#define READY_MARGIN_US        20000
+
+// (1e5 mPa / 4096 counts)^2 * 1000, counts^2 to mPa^2
+#define MPA2_PER_COUNT2_X1000  596046
+
+static const uint16_t odr_hz[BARO_BENCH_ODR_MAX + 1] = {0, 1, 4, 10, 25, 50, 75, 100, 200};
+
+// filter settings in the order of the sweep, with the samples dropped while the filter settles
+static const uint8_t lpf_cfg[] = {BARO_BENCH_LPF_OFF, BARO_BENCH_LPF_ODR_4, BARO_BENCH_LPF_ODR_9};
+static const uint8_t lpf_settle[] = {1, 4, 8};
+
+// steps of the sweep
+typedef enum {
+	STATE_IDLE,
+	STATE_CONV,          // one-shot conversions of the averaging avg
+	STATE_SETUP,         // the next combination is set up or skipped
+	STATE_RUN,           // continuous conversions of the combination
+} state_t;
+
+static const baro_bench_ctx_t* bus;
+static uint8_t ctrl2;                 // CTRL_REG2 without the filter and the self-clearing bits
+static uint16_t errors;
+
+// sweep in progress, kept between the steps
+static state_t state = STATE_IDLE;
+static baro_bench_result_ptr out;
+static uint16_t samples;
+static uint8_t odr_end;
+static uint8_t odr;
+static uint8_t avg;
+static uint8_t f;
+static uint32_t conv[BARO_BENCH_AVG_MAX + 1];
+static baro_bench_result_t r;
+// the conversion or the sample waited for: started at, time out after, count
+static uint32_t since;
+static uint32_t timeout;
+static uint16_t i;
+static bool triggered;
+// sums of the combination, deviations from the first sample keep them small
+static uint32_t conv_sum;
+static uint32_t first;
+static uint32_t last;
+static uint32_t bus_sum;
+static int64_t sum;
+static int64_t sumsq;
+static int32_t ref;
+
+//#pragma mark - Private Functions -
+
+static int reg_read(uint8_t reg, uint8_t* buf, uint16_t len)
+{
+	if(bus->read(bus->handle, reg, buf, len) != 0)
+	{
+		errors++;
+		return -1;
+	}
+	return 0;
+}
+
+static int reg_write(uint8_t reg, uint8_t value)
+{
+	if(bus->write(bus->handle, reg, &value, 1) != 0)
+	{
+		errors++;
+		return -1;
+	}
+	return 0;
+}
+
+// 24-bit two's complement, little endian
+static inline int32_t sample_counts(const uint8_t* p)
+{
+	return (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8)) >> 8;
+}
+
+static uint32_t isqrt(uint64_t x)
+{
+	uint64_t root = 0;
+	uint64_t bit = (uint64_t)1 << 62;
+
+	while(bit > x)
+	{
+		bit >>= 2;
+	}
+	while(bit != 0)
+	{
+		if(x >= (root + bit))
+		{
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+		{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return (uint32_t)root;
+}
+
+static void put16(uint8_t* p, uint16_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+}
+
+static void put32(uint8_t* p, uint32_t v)
+{
+	put16(p, (uint16_t)v);
+	put16(p + 2, (uint16_t)(v >> 16));
+}
+
+static uint16_t get16(const uint8_t* p)
+{
+	return (uint16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+static uint32_t get32(const uint8_t* p)
+{
+	return (uint32_t)get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+// Fletcher-16 over type and payload, the two sums in the last two bytes
+static uint16_t checksum(const uint8_t* frame)
+{
+	uint8_t a = 0;
+	uint8_t b = 0;
+	uint16_t i;
+
+	for(i = 1; i < (BARO_BENCH_FRAME_LEN - 2); i++)
+	{
+		a += frame[i];
+		b += a;
+	}
+	return (uint16_t)(a | ((uint16_t)b << 8));
+}
+
+// One-shot conversions of one averaging for its conversion time, mean of CONV_RUNS
+// Returns 0 while running or done, -1 on bus error
+static int conv_step(void)
+{
+	uint8_t buf[OUT_BURST];
+
+	if(!triggered)
+	{
+		if((i == 0) && (reg_write(REG_CTRL_REG1, avg) != 0))
+		{
+			return -1;
+		}
+		since = bus->tick();
+		if(reg_write(REG_CTRL_REG2, ctrl2 | CTRL_REG2_ONESHOT) != 0)
+		{
+			return -1;
+		}
+		triggered = true;
+		return 0;
+	}
+	if(!bus->int_pin(bus->handle))
+	{
+		if((bus->tick() - since) > CONV_TIMEOUT_US)
+		{
+			// no conversion time, the averaging is skipped
+			conv[avg] = 0;
+			conv_sum = 0;
+			i = 0;
+			triggered = false;
+			state = (++avg > BARO_BENCH_AVG_MAX) ? STATE_SETUP : STATE_CONV;
+		}
+		return 0;
+	}
+	conv_sum += bus->tick() - since;
+	triggered = false;
+	// reading the output releases data ready
+	if(reg_read(REG_STATUS, buf, sizeof(buf)) != 0)
+	{
+		return -1;
+	}
+	if(++i < CONV_RUNS)
+	{
+		return 0;
+	}
+	conv[avg] = conv_sum / CONV_RUNS;
+	conv_sum = 0;
+	i = 0;
+	state = (++avg > BARO_BENCH_AVG_MAX) ? STATE_SETUP : STATE_CONV;
+
+	return 0;
+}
+
+// Next combination in the order of ODR, AVG and LPF
+static void next(void)
+{
+	state = STATE_SETUP;
+	if(++f < sizeof(lpf_cfg))
+	{
+		return;
+	}
+	f = 0;
+	if(++avg <= BARO_BENCH_AVG_MAX)
+	{
+		return;
+	}
+	avg = 0;
+	if(++odr > odr_end)
+	{
+		state = STATE_IDLE;
+	}
+}
+
+// Start the combination odr, avg, f or pass it on as skipped
+// Returns 0 on success, -1 on bus error
+static int setup_step(void)
+{
+	uint8_t buf[OUT_BURST];
+
+	memset(&r, 0, sizeof(r));
+	r.odr = odr;
+	r.avg = avg;
+	r.lpf = lpf_cfg[f];
+	r.conv_us = conv[avg];
+	errors = 0;
+	if((conv[avg] == 0) || (conv[avg] >= (1000000u / odr_hz[odr])))
+	{
+		r.status = BARO_BENCH_SKIPPED;
+		out(&r);
+		next();
+		return 0;
+	}
+
+	// through power-down, ODR changes are made from there
+	if((reg_write(REG_CTRL_REG1, 0) != 0) ||
+			(reg_write(REG_CTRL_REG2, ctrl2 | (uint8_t)(r.lpf << 4)) != 0) ||
+			(reg_read(REG_STATUS, buf, sizeof(buf)) != 0) ||
+			(reg_write(REG_CTRL_REG1, (uint8_t)((r.odr << CTRL_REG1_ODR_SHIFT) | r.avg)) != 0))
+	{
+		return -1;
+	}
+	timeout = (1000000u / odr_hz[odr]) + r.conv_us + READY_MARGIN_US;
+	first = 0;
+	last = 0;
+	bus_sum = 0;
+	sum = 0;
+	sumsq = 0;
+	ref = 0;
+	i = 0;
+	since = bus->tick();
+	state = STATE_RUN;
+
+	return 0;
+}
+
+// Noise of the samples taken, fills the measured part of the result
+static void finish(void)
+{
+	int64_t num;
+
+	if(r.samples < 2)
+	{
+		return;
+	}
+	r.period_us = (last - first) / (r.samples - 1);
+	r.bus_us = (uint16_t)(bus_sum / r.samples);
+	// n^2 times the variance in counts^2
+	num = (r.samples * sumsq) - (sum * sum);
+	if(num > (INT64_MAX / MPA2_PER_COUNT2_X1000))
+	{
+		r.noise_mpa = UINT16_MAX;
+		return;
+	}
+	num = (num * MPA2_PER_COUNT2_X1000) / ((int64_t)1000 * r.samples * (r.samples - 1));
+	r.noise_mpa = (num > ((int64_t)UINT16_MAX * UINT16_MAX)) ? UINT16_MAX : (uint16_t)isqrt((uint64_t)num);
+}
+
+// One sample of the combination on data ready, the first ones are dropped while the filter settles
+// Returns 0 while running or done, -1 on bus error
+static int run_step(void)
+{
+	uint8_t buf[OUT_BURST];
+	uint32_t start;
+	int32_t d;
+
+	if(!bus->int_pin(bus->handle))
+	{
+		if((bus->tick() - since) <= timeout)
+		{
+			return 0;
+		}
+		r.status = BARO_BENCH_TIMEOUT;
+	}
+	else
+	{
+		last = bus->tick();
+		start = last;
+		if((reg_read(REG_STATUS, buf, sizeof(buf)) == 0) && (buf[OUT_OFF_STATUS] & STATUS_P_DA) &&
+				(i >= lpf_settle[f]))
+		{
+			bus_sum += bus->tick() - start;
+			d = sample_counts(&buf[OUT_OFF_PRESS]);
+			if(r.samples == 0)
+			{
+				ref = d;
+				first = last;
+			}
+			d -= ref;
+			sum += d;
+			sumsq += (int64_t)d * d;
+			r.samples++;
+		}
+		since = bus->tick();
+		if(++i < (lpf_settle[f] + samples))
+		{
+			return 0;
+		}
+	}
+
+	if((reg_write(REG_CTRL_REG1, 0) != 0) ||
+			(reg_read(REG_STATUS, buf, sizeof(buf)) != 0))
+	{
+		return -1;
+	}
+	finish();
+	r.errors = errors;
+	out(&r);
+	next();
+
+	return 0;
+}
+
+//#pragma mark - APIs -
+
+int baro_bench_start(const baro_bench_ctx_t* ctx, uint8_t odr_code, uint16_t count, baro_bench_result_ptr result)
+{
+	uint8_t buf[OUT_BURST];
+	uint8_t reg;
+
+	assert(ctx && ctx->read && ctx->write && ctx->tick && ctx->int_pin && result);
+
+	if((state != STATE_IDLE) || (odr_code > BARO_BENCH_ODR_MAX) ||
+			(count < BARO_BENCH_SAMPLES_MIN) || (count > BARO_BENCH_SAMPLES_MAX))
+	{
+		return -1;
+	}
+	bus = ctx;
+	out = result;
+	samples = count;
+	odr = (odr_code == 0) ? 1 : odr_code;
+	odr_end = (odr_code == 0) ? BARO_BENCH_ODR_MAX : odr_code;
+	avg = 0;
+	f = 0;
+	i = 0;
+	conv_sum = 0;
+	triggered = false;
+
+	// powered down, no FIFO and no threshold, data ready latched on INT
+	if((reg_write(REG_CTRL_REG1, 0) != 0) ||
+			(reg_write(REG_FIFO_CTRL, FIFO_CTRL_BYPASS) != 0) ||
+			(reg_write(REG_INTERRUPT_CFG, 0) != 0) ||
+			(reg_read(REG_CTRL_REG2, &reg, 1) != 0))
+	{
+		return -1;
+	}
+	ctrl2 = reg & (uint8_t)~(CTRL_REG2_BOOT | CTRL_REG2_SWRESET | CTRL_REG2_ONESHOT | CTRL_REG2_EN_LPFP | CTRL_REG2_LFPF_CFG);
+	if((reg_write(REG_CTRL_REG2, ctrl2) != 0) ||
+			(reg_read(REG_CTRL_REG4, &reg, 1) != 0))
+	{
+		return -1;
+	}
+	reg = (reg & (uint8_t)~(CTRL_REG4_DRDY_PLS | CTRL_REG4_INT_F)) | CTRL_REG4_DRDY | CTRL_REG4_INT_EN;
+	if((reg_write(REG_CTRL_REG4, reg) != 0) ||
+			(reg_read(REG_STATUS, buf, sizeof(buf)) != 0))
+	{
+		return -1;
+	}
+	state = STATE_CONV;
+
+	return 0;
+}
+
+int baro_bench_step(void)
+{
+	int ret = 0;
+
+	switch(state)
+	{
+	case STATE_CONV:
+		ret = conv_step();
+		// the combinations start again from the first averaging
+		if(state == STATE_SETUP)
+		{
+			avg = 0;
+		}
+		break;
+	case STATE_SETUP:
+		ret = setup_step();
+		break;
+	case STATE_RUN:
+		ret = run_step();
+		break;
+	default:
+		return 0;
+	}
+	if(ret != 0)
+	{
+		state = STATE_IDLE;
+		return -1;
+	}
+
+	return (state == STATE_IDLE) ? 0 : 1;
+}
+
+bool baro_bench_running(void)
+{
+	return state != STATE_IDLE;
+}
+
+int baro_bench_sweep(const baro_bench_ctx_t* ctx, uint8_t odr_code, uint16_t count, baro_bench_result_ptr result)
+{
+	int ret;
+
+	if(baro_bench_start(ctx, odr_code, count, result) != 0)
+	{
+		return -1;
+	}
+	do
+	{
+		ret = baro_bench_step();
+	} while(ret > 0);
+
+	return ret;
+}
+
+uint16_t baro_bench_odr_hz(uint8_t odr)
+{
+	return (odr <= BARO_BENCH_ODR_MAX) ? odr_hz[odr] : 0;
+}
+
+uint16_t baro_bench_encode(const baro_bench_result_t* result, uint8_t* frame)
+{
+	assert(result && frame);
+
+	frame[0] = BARO_BENCH_FRAME_SYNC;
+	frame[1] = BARO_BENCH_FRAME_TYPE;
+	frame[2] = result->odr;
+	frame[3] = result->avg;
+	frame[4] = result->lpf;
+	frame[5] = result->status;
+	put16(&frame[6], result->samples);
+	put16(&frame[8], result->noise_mpa);
+	put32(&frame[10], result->conv_us);
+	put32(&frame[14], result->period_us);
+	put16(&frame[18], result->bus_us);
+	put16(&frame[20], result->errors);
+	put16(&frame[22], checksum(frame));
+
+	return BARO_BENCH_FRAME_LEN;
+}
+
+int baro_bench_decode(const uint8_t* frame, baro_bench_result_t* result)
+{
+	assert(frame && result);
+
+	if((frame[0] != BARO_BENCH_FRAME_SYNC) || (frame[1] != BARO_BENCH_FRAME_TYPE) ||
+			(get16(&frame[22]) != checksum(frame)))
+	{
+		return -1;
+	}
+	result->odr = frame[2];
+	result->avg = frame[3];
+	result->lpf = frame[4];
+	result->status = frame[5];
+	result->samples = get16(&frame[6]);
+	result->noise_mpa = get16(&frame[8]);
+	result->conv_us = get32(&frame[10]);
+	result->period_us = get32(&frame[14]);
+	result->bus_us = get16(&frame[18]);
+	result->errors = get16(&frame[20]);
+
+	return 0;
+}
@@ -0,0 +1,257 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "baro_fifo.h"
+
+// LPS28DFW registers and bits used by the FIFO readout
+#define REG_CTRL_REG4          0x13
+#define REG_FIFO_CTRL          0x14
+#define REG_FIFO_WTM           0x15
+#define REG_FIFO_STATUS1       0x25
+#define REG_FIFO_DATA_OUT      0x78
+
+#define CTRL_REG4_INT_F_WTM    0x02
+#define CTRL_REG4_INT_EN       0x10
+#define FIFO_CTRL_BYPASS       0x00
+#define FIFO_CTRL_STREAM       0x02
+#define FIFO_STATUS2_OVR       0x40
+
+// FIFO_STATUS1, FIFO_STATUS2, STATUS, PRESS_OUT_XL/L/H, TEMP_OUT_L/H
+#define STATUS_BURST           8
+#define STATUS_OFF_LEVEL       0
+#define STATUS_OFF_FLAGS       1
+#define STATUS_OFF_TEMP        6
+
+// bytes per sample in the FIFO
+#define FIFO_SAMPLE_SIZE       3
+
+static const baro_fifo_ctx_t* bus;
+static uint8_t data[BARO_FIFO_DEPTH * FIFO_SAMPLE_SIZE];
+static baro_fifo_stats_t stats;
+
+// state of the asynchronous drain
+static volatile bool draining;
+static baro_fifo_done_ptr drain_done;
+static uint8_t async_status[STATUS_BURST];
+static uint8_t async_level;
+static baro_fifo_batch_t async_batch;
+
+//#pragma mark - Private Functions -
+
+static int reg_read(uint8_t reg, uint8_t* buf, uint16_t len)
+{
+	stats.transactions++;
+	if(bus->read(bus->handle, reg, buf, len) != 0)
+	{
+		stats.errors++;
+		return -1;
+	}
+	return 0;
+}
+
+static int reg_write(uint8_t reg, uint8_t value)
+{
+	stats.transactions++;
+	if(bus->write(bus->handle, reg, &value, 1) != 0)
+	{
+		stats.errors++;
+		return -1;
+	}
+	return 0;
+}
+
+// 24-bit two's complement, little endian
+static inline int32_t sample_counts(const uint8_t* p)
+{
+	return (int32_t)(((uint32_t)p[2] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[0] << 8)) >> 8;
+}
+
+// Decode the FIFO_STATUS1..TEMP_OUT_H burst into the batch
+// Returns the number of samples in the FIFO
+static uint8_t parse_status(const uint8_t* status, baro_fifo_batch_t* batch)
+{
+	uint8_t level = status[STATUS_OFF_LEVEL];
+
+	if(level > BARO_FIFO_DEPTH)
+	{
+		level = BARO_FIFO_DEPTH;
+	}
+	batch->centi_c = (int16_t)((uint16_t)status[STATUS_OFF_TEMP] | ((uint16_t)status[STATUS_OFF_TEMP + 1] << 8));
+	batch->overrun = (status[STATUS_OFF_FLAGS] & FIFO_STATUS2_OVR) ? 1 : 0;
+	stats.overruns += batch->overrun;
+
+	return level;
+}
+
+// Average the level samples read into data
+static void average(baro_fifo_batch_t* batch, uint8_t level)
+{
+	int64_t sum = 0;
+	int32_t counts;
+	uint8_t i;
+
+	batch->min = INT32_MAX;
+	batch->max = INT32_MIN;
+	for(i = 0; i < level; i++)
+	{
+		counts = sample_counts(&data[i * FIFO_SAMPLE_SIZE]);
+		sum += counts;
+		batch->min = (counts < batch->min) ? counts : batch->min;
+		batch->max = (counts > batch->max) ? counts : batch->max;
+	}
+	// rounded mean, symmetric for negative sums
+	batch->counts = (int32_t)((sum >= 0) ? ((sum + (level / 2)) / level) : ((sum - (level / 2)) / level));
+	batch->samples = level;
+
+	stats.drains++;
+	stats.samples += level;
+}
+
+static void drain_finish(int32_t status)
+{
+	draining = false;
+	drain_done(&async_batch, status);
+}
+
+static void data_read(int32_t status)
+{
+	if(status != 0)
+	{
+		stats.errors++;
+		drain_finish(-1);
+		return;
+	}
+	average(&async_batch, async_level);
+	drain_finish(0);
+}
+
+static void status_read(int32_t status)
+{
+	if(status != 0)
+	{
+		stats.errors++;
+		drain_finish(-1);
+		return;
+	}
+	async_level = parse_status(async_status, &async_batch);
+	if(async_level == 0)
+	{
+		drain_finish(0);
+		return;
+	}
+
+	stats.transactions++;
+	if(bus->read_async(bus->handle, REG_FIFO_DATA_OUT, data, (uint16_t)(async_level * FIFO_SAMPLE_SIZE), data_read) != 0)
+	{
+		stats.errors++;
+		drain_finish(-1);
+	}
+}
+
+//#pragma mark - APIs -
+
+int baro_fifo_start(const baro_fifo_ctx_t* ctx, uint8_t watermark)
+{
+	uint8_t reg;
+
+	assert(ctx && ctx->read && ctx->write);
+
+	if((watermark == 0) || (watermark > BARO_FIFO_WTM_MAX))
+	{
+		return -1;
+	}
+	bus = ctx;
+	draining = false;
+	memset(&stats, 0, sizeof(stats));
+
+	// bypass first so the FIFO starts empty
+	if((reg_write(REG_FIFO_CTRL, FIFO_CTRL_BYPASS) != 0) ||
+			(reg_write(REG_FIFO_WTM, watermark) != 0) ||
+			(reg_write(REG_FIFO_CTRL, FIFO_CTRL_STREAM) != 0) ||
+			(reg_read(REG_CTRL_REG4, &reg, 1) != 0))
+	{
+		return -1;
+	}
+
+	return reg_write(REG_CTRL_REG4, reg | CTRL_REG4_INT_F_WTM | CTRL_REG4_INT_EN);
+}
+
+int baro_fifo_stop(void)
+{
+	uint8_t reg;
+
+	assert(bus);
+
+	if((reg_read(REG_CTRL_REG4, &reg, 1) != 0) ||
+			(reg_write(REG_CTRL_REG4, reg & (uint8_t)~CTRL_REG4_INT_F_WTM) != 0))
+	{
+		return -1;
+	}
+
+	return reg_write(REG_FIFO_CTRL, FIFO_CTRL_BYPASS);
+}
+
+int baro_fifo_drain(baro_fifo_batch_t* batch)
+{
+	uint8_t status[STATUS_BURST];
+	uint8_t level;
+
+	assert(bus && batch);
+
+	memset(batch, 0, sizeof(*batch));
+	// the sample buffer belongs to the running drain
+	if(draining)
+	{
+		return -1;
+	}
+	if(reg_read(REG_FIFO_STATUS1, status, sizeof(status)) != 0)
+	{
+		return -1;
+	}
+	level = parse_status(status, batch);
+	if(level == 0)
+	{
+		return 0;
+	}
+
+	if(reg_read(REG_FIFO_DATA_OUT, data, (uint16_t)(level * FIFO_SAMPLE_SIZE)) != 0)
+	{
+		return -1;
+	}
+	average(batch, level);
+
+	return 0;
+}
+
+int baro_fifo_drain_async(baro_fifo_done_ptr done)
+{
+	assert(bus && bus->read_async && done);
+
+	if(draining)
+	{
+		return -1;
+	}
+
+	memset(&async_batch, 0, sizeof(async_batch));
+	drain_done = done;
+	draining = true;
+	stats.transactions++;
+	if(bus->read_async(bus->handle, REG_FIFO_STATUS1, async_status, sizeof(async_status), status_read) != 0)
+	{
+		stats.errors++;
+		draining = false;
+		return -1;
+	}
+
+	return 0;
+}
+
+void baro_fifo_get_stats(baro_fifo_stats_t* out)
+{
+	assert(out);
+
+	*out = stats;
+}
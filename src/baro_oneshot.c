@@ -0,0 +1,270 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "baro_oneshot.h"
+
+// LPS28DFW registers and bits used by the one-shot acquisition
+#define REG_CTRL_REG1          0x10
+#define REG_CTRL_REG2          0x11
+#define REG_CTRL_REG4          0x13
+#define REG_STATUS             0x27
+
+#define CTRL_REG1_AVG          0x07   // ODR bits 0: power-down
+#define CTRL_REG2_BOOT         0x80
+#define CTRL_REG2_EN_LPFP      0x10
+#define CTRL_REG2_SWRESET      0x04
+#define CTRL_REG2_ONESHOT      0x01
+#define CTRL_REG4_DRDY_PLS     0x40
+#define CTRL_REG4_DRDY         0x20
+#define CTRL_REG4_INT_EN       0x10
+#define STATUS_P_DA            0x01
+
+// STATUS, PRESS_OUT_XL/L/H, TEMP_OUT_L/H
+#define OUT_BURST              6
+#define OUT_OFF_STATUS         0
+#define OUT_OFF_PRESS          1
+#define OUT_OFF_TEMP           4
+
+static const baro_oneshot_ctx_t* bus;
+static uint8_t avg_code;
+static uint8_t ctrl2;                 // CTRL_REG2 without the self-clearing bits
+static baro_oneshot_stats_t stats;
+
+// conversion in progress, set by the trigger and cleared by the read
+static volatile bool converting;
+static uint32_t trigger_at;
+static volatile bool drdy_seen;
+static volatile uint32_t drdy_at;
+
+// state of the asynchronous read
+static volatile bool reading;
+static baro_oneshot_done_ptr read_done;
+static uint8_t async_out[OUT_BURST];
+static baro_oneshot_sample_t async_sample;
+
+//#pragma mark - Private Functions -
+
+static int reg_read(uint8_t reg, uint8_t* buf, uint16_t len)
+{
+	stats.transactions++;
+	if(bus->read(bus->handle, reg, buf, len) != 0)
+	{
+		stats.errors++;
+		return -1;
+	}
+	return 0;
+}
+
+static int reg_write(uint8_t reg, uint8_t value)
+{
+	stats.transactions++;
+	if(bus->write(bus->handle, reg, &value, 1) != 0)
+	{
+		stats.errors++;
+		return -1;
+	}
+	return 0;
+}
+
+// Decode the STATUS..TEMP_OUT_H burst and close the conversion
+static void parse_output(const uint8_t* out, baro_oneshot_sample_t* sample)
+{
+	uint32_t now = bus->tick();
+	uint32_t conv;
+
+	sample->ready = (out[OUT_OFF_STATUS] & STATUS_P_DA) ? 1 : 0;
+	if(sample->ready)
+	{
+		// 24-bit two's complement, little endian
+		sample->counts = (int32_t)(((uint32_t)out[OUT_OFF_PRESS + 2] << 24) |
+				((uint32_t)out[OUT_OFF_PRESS + 1] << 16) | ((uint32_t)out[OUT_OFF_PRESS] << 8)) >> 8;
+		sample->centi_c = (int16_t)((uint16_t)out[OUT_OFF_TEMP] | ((uint16_t)out[OUT_OFF_TEMP + 1] << 8));
+		stats.samples++;
+	}
+	if(!converting)
+	{
+		return;
+	}
+	converting = false;
+	if(!sample->ready)
+	{
+		// given up, the next trigger starts a new conversion
+		stats.missed++;
+		return;
+	}
+
+	stats.read_us = now - trigger_at;
+	stats.read_max_us = (stats.read_us > stats.read_max_us) ? stats.read_us : stats.read_max_us;
+	// without the interrupt only the read gives an upper bound, it is not counted
+	if(drdy_seen)
+	{
+		conv = drdy_at - trigger_at;
+		stats.conv_us = conv;
+		stats.conv_min_us = (conv < stats.conv_min_us) ? conv : stats.conv_min_us;
+		stats.conv_max_us = (conv > stats.conv_max_us) ? conv : stats.conv_max_us;
+	}
+}
+
+static void output_read(int32_t status)
+{
+	reading = false;
+	if(status != 0)
+	{
+		stats.errors++;
+		read_done(&async_sample, -1);
+		return;
+	}
+	parse_output(async_out, &async_sample);
+	read_done(&async_sample, 0);
+}
+
+//#pragma mark - APIs -
+
+int baro_oneshot_start(const baro_oneshot_ctx_t* ctx, uint8_t avg)
+{
+	uint8_t reg;
+	uint8_t out[OUT_BURST];
+
+	assert(ctx && ctx->read && ctx->write && ctx->tick);
+
+	if(avg > BARO_ONESHOT_AVG_MAX)
+	{
+		return -1;
+	}
+	bus = ctx;
+	avg_code = avg;
+	converting = false;
+	drdy_seen = false;
+	reading = false;
+	memset(&stats, 0, sizeof(stats));
+	stats.conv_min_us = UINT32_MAX;
+
+	// ODR 0 is power-down, the low-pass filter works across conversions and is of no use here
+	if((reg_write(REG_CTRL_REG1, avg & CTRL_REG1_AVG) != 0) ||
+			(reg_read(REG_CTRL_REG2, &reg, 1) != 0))
+	{
+		return -1;
+	}
+	ctrl2 = reg & (uint8_t)~(CTRL_REG2_BOOT | CTRL_REG2_SWRESET | CTRL_REG2_ONESHOT | CTRL_REG2_EN_LPFP);
+	if((reg_write(REG_CTRL_REG2, ctrl2) != 0) ||
+			(reg_read(REG_CTRL_REG4, &reg, 1) != 0))
+	{
+		return -1;
+	}
+	// latched data ready, a stale output is read away so the next conversion raises INT
+	reg = (reg & (uint8_t)~CTRL_REG4_DRDY_PLS) | CTRL_REG4_DRDY | CTRL_REG4_INT_EN;
+	if(reg_write(REG_CTRL_REG4, reg) != 0)
+	{
+		return -1;
+	}
+
+	return reg_read(REG_STATUS, out, sizeof(out));
+}
+
+int baro_oneshot_stop(void)
+{
+	uint8_t reg;
+
+	assert(bus);
+
+	if(reg_read(REG_CTRL_REG4, &reg, 1) != 0)
+	{
+		return -1;
+	}
+	converting = false;
+
+	return reg_write(REG_CTRL_REG4, reg & (uint8_t)~CTRL_REG4_DRDY);
+}
+
+int baro_oneshot_trigger(void)
+{
+	assert(bus);
+
+	if(converting || reading)
+	{
+		return -1;
+	}
+	// armed before the write, a short conversion may end before the write returns
+	drdy_seen = false;
+	trigger_at = bus->tick();
+	converting = true;
+	if(reg_write(REG_CTRL_REG2, ctrl2 | CTRL_REG2_ONESHOT) != 0)
+	{
+		converting = false;
+		return -1;
+	}
+	stats.conversions++;
+
+	return 0;
+}
+
+void baro_oneshot_drdy(void)
+{
+	if(converting && !drdy_seen)
+	{
+		drdy_at = bus->tick();
+		drdy_seen = true;
+	}
+}
+
+int baro_oneshot_read(baro_oneshot_sample_t* sample)
+{
+	uint8_t out[OUT_BURST];
+
+	assert(bus && sample);
+
+	memset(sample, 0, sizeof(*sample));
+	if(reading)
+	{
+		return -1;
+	}
+	if(reg_read(REG_STATUS, out, sizeof(out)) != 0)
+	{
+		return -1;
+	}
+	parse_output(out, sample);
+
+	return 0;
+}
+
+int baro_oneshot_read_async(baro_oneshot_done_ptr done)
+{
+	assert(bus && bus->read_async && done);
+
+	if(reading)
+	{
+		return -1;
+	}
+
+	memset(&async_sample, 0, sizeof(async_sample));
+	read_done = done;
+	reading = true;
+	stats.transactions++;
+	if(bus->read_async(bus->handle, REG_STATUS, async_out, sizeof(async_out), output_read) != 0)
+	{
+		stats.errors++;
+		reading = false;
+		return -1;
+	}
+
+	return 0;
+}
+
+uint8_t baro_oneshot_avg(void)
+{
+	return avg_code;
+}
+
+void baro_oneshot_get_stats(baro_oneshot_stats_t* out)
+{
+	assert(out);
+
+	*out = stats;
+	if(out->conv_min_us == UINT32_MAX)
+	{
+		out->conv_min_us = 0;
+	}
+}
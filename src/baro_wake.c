@@ -0,0 +1,166 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "baro_wake.h"
+
+// LPS28DFW registers and bits used by the threshold interrupt
+#define REG_INTERRUPT_CFG      0x0B
+#define REG_THS_P_L            0x0C
+#define REG_CTRL_REG4          0x13
+#define REG_INT_SOURCE         0x24
+
+#define INTERRUPT_CFG_AUTOREFP 0x80
+#define INTERRUPT_CFG_RESET_ARP 0x40
+#define INTERRUPT_CFG_PLE      0x02
+#define INTERRUPT_CFG_PHE      0x01
+#define CTRL_REG4_INT_EN       0x10
+#define INT_SOURCE_IA          0x04
+
+// THS_P and REF_P count 1/16 hPa at 1260 hPa full scale
+#define LSB_PER_HPA            16
+
+// reference from the next conversion, interrupt above and below it, not latched
+#define CFG_ARMED (INTERRUPT_CFG_AUTOREFP | INTERRUPT_CFG_PLE | INTERRUPT_CFG_PHE)
+
+static const baro_wake_ctx_t* bus;
+static uint16_t threshold;
+static baro_wake_stats_t stats;
+
+//#pragma mark - Private Functions -
+
+static int reg_read(uint8_t reg, uint8_t* buf, uint16_t len)
+{
+	stats.transactions++;
+	if(bus->read(bus->handle, reg, buf, len) != 0)
+	{
+		stats.errors++;
+		return -1;
+	}
+	return 0;
+}
+
+static int reg_write(uint8_t reg, uint8_t* buf, uint16_t len)
+{
+	stats.transactions++;
+	if(bus->write(bus->handle, reg, buf, len) != 0)
+	{
+		stats.errors++;
+		return -1;
+	}
+	return 0;
+}
+
+// Drop the reference and take the next conversion
+static int retake_reference(void)
+{
+	uint8_t cfg = INTERRUPT_CFG_RESET_ARP;
+
+	if(reg_write(REG_INTERRUPT_CFG, &cfg, 1) != 0)
+	{
+		return -1;
+	}
+	cfg = CFG_ARMED;
+	return reg_write(REG_INTERRUPT_CFG, &cfg, 1);
+}
+
+//#pragma mark - APIs -
+
+int baro_wake_start(const baro_wake_ctx_t* ctx, uint16_t threshold_pa)
+{
+	uint8_t ths[2];
+	uint8_t reg;
+	uint16_t lsb;
+
+	assert(ctx && ctx->read && ctx->write);
+
+	if((threshold_pa < BARO_WAKE_MIN_PA) || (threshold_pa > BARO_WAKE_MAX_PA))
+	{
+		return -1;
+	}
+	bus = ctx;
+	threshold = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	// rounded to 6.25 Pa
+	lsb = (uint16_t)((((uint32_t)threshold_pa * LSB_PER_HPA) + 50) / 100);
+	ths[0] = (uint8_t)lsb;
+	ths[1] = (uint8_t)(lsb >> 8);
+	if((reg_write(REG_THS_P_L, ths, sizeof(ths)) != 0) ||
+			(retake_reference() != 0) ||
+			(reg_read(REG_CTRL_REG4, &reg, 1) != 0))
+	{
+		return -1;
+	}
+	reg |= CTRL_REG4_INT_EN;
+	if(reg_write(REG_CTRL_REG4, &reg, 1) != 0)
+	{
+		return -1;
+	}
+	threshold = (uint16_t)((((uint32_t)lsb * 100) + (LSB_PER_HPA / 2)) / LSB_PER_HPA);
+
+	return 0;
+}
+
+int baro_wake_stop(void)
+{
+	uint8_t cfg = INTERRUPT_CFG_RESET_ARP;
+
+	assert(bus);
+
+	// INT_EN stays, the FIFO threshold uses it as well
+	threshold = 0;
+	if(reg_write(REG_INTERRUPT_CFG, &cfg, 1) != 0)
+	{
+		return -1;
+	}
+	cfg = 0;
+	return reg_write(REG_INTERRUPT_CFG, &cfg, 1);
+}
+
+int baro_wake_rearm(uint8_t* event)
+{
+	uint8_t src;
+
+	assert(bus);
+
+	if(event != NULL)
+	{
+		*event = 0;
+	}
+	if(threshold == 0)
+	{
+		return 0;
+	}
+	if(reg_read(REG_INT_SOURCE, &src, 1) != 0)
+	{
+		return -1;
+	}
+	stats.rearms++;
+	if(src & INT_SOURCE_IA)
+	{
+		src &= BARO_WAKE_HIGH | BARO_WAKE_LOW;
+		stats.high += (src & BARO_WAKE_HIGH) ? 1 : 0;
+		stats.low += (src & BARO_WAKE_LOW) ? 1 : 0;
+		if(event != NULL)
+		{
+			*event = src;
+		}
+	}
+
+	return retake_reference();
+}
+
+uint16_t baro_wake_threshold(void)
+{
+	return threshold;
+}
+
+void baro_wake_get_stats(baro_wake_stats_t* out)
+{
+	assert(out);
+
+	*out = stats;
+}
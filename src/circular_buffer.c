@@ -1,9 +1,10 @@
-#include <stdlib.h>
 #include <stdint.h>
 #include <stddef.h>
+#include <string.h>
 #include <assert.h>
 
 #include "circular_buffer.h"
+#include "mem_pool.h"
 
 // The definition of our circular buffer structure is hidden from the user
 struct circular_buf_t
@@ -41,8 +42,13 @@ cbuf_handle_t circular_buf_init(uint16_t* buffer, size_t size)
 {
 	assert(buffer && size);
 
-	cbuf_handle_t cbuf = malloc(sizeof(circular_buf_t));
+	// control blocks come from a static pool, there is no heap on the application path
+	cbuf_handle_t cbuf = mem_pool_alloc(MEM_POOL_SAMPLES, sizeof(circular_buf_t));
 	assert(cbuf);
+	if(cbuf == NULL)
+	{
+		return NULL;
+	}
 
 	cbuf->buffer = buffer;
 	cbuf->max = size;
@@ -56,7 +62,8 @@ cbuf_handle_t circular_buf_init(uint16_t* buffer, size_t size)
 void circular_buf_free(cbuf_handle_t me)
 {
 	assert(me);
-	free(me);
+	// pool memory is never returned, only detach the storage
+	me->buffer = NULL;
 }
 
 void circular_buf_reset(cbuf_handle_t me)
@@ -174,3 +181,152 @@ int circular_buf_peek(cbuf_handle_t me, uint16_t* data, unsigned int look_ahead_
 
 	return 0;
 }
+
+int circular_buf_at(cbuf_handle_t me, size_t index, uint16_t* data)
+{
+	size_t pos;
+
+	assert(me && data && me->buffer);
+
+	if(index >= circular_buf_size(me))
+	{
+		return -1;
+	}
+
+	pos = me->tail + index;
+	if(pos >= me->max)
+	{
+		pos -= me->max;
+	}
+	*data = me->buffer[pos];
+
+	return 0;
+}
+
+size_t circular_buf_spans(cbuf_handle_t me, const uint16_t** first, size_t* first_len,
+		const uint16_t** second, size_t* second_len)
+{
+	size_t size;
+	size_t run;
+
+	assert(me && me->buffer && first && first_len && second && second_len);
+
+	size = circular_buf_size(me);
+	run = me->max - me->tail;
+	if(run > size)
+	{
+		run = size;
+	}
+
+	*first = &me->buffer[me->tail];
+	*first_len = run;
+	*second = me->buffer;
+	*second_len = size - run;
+
+	return size;
+}
+
+// Copy count values starting at storage position pos, wrapping once at the end of the storage
+static void copy_out(cbuf_handle_t me, size_t pos, uint16_t* data, size_t count)
+{
+	size_t run = me->max - pos;
+
+	if(run > count)
+	{
+		run = count;
+	}
+	memcpy(data, &me->buffer[pos], run * sizeof(uint16_t));
+	memcpy(&data[run], me->buffer, (count - run) * sizeof(uint16_t));
+}
+
+void circular_buf_put_range(cbuf_handle_t me, const uint16_t* data, size_t len)
+{
+	size_t run;
+	size_t free_slots;
+
+	assert(me && me->buffer && data);
+
+	// only the last max values can survive
+	if(len > me->max)
+	{
+		data += len - me->max;
+		len = me->max;
+	}
+
+	free_slots = me->max - circular_buf_size(me);
+
+	run = me->max - me->head;
+	if(run > len)
+	{
+		run = len;
+	}
+	memcpy(&me->buffer[me->head], data, run * sizeof(uint16_t));
+	memcpy(me->buffer, &data[run], (len - run) * sizeof(uint16_t));
+
+	me->head += len;
+	if(me->head >= me->max)
+	{
+		me->head -= me->max;
+	}
+
+	if(len >= free_slots)
+	{
+		// old data was overwritten, the oldest value is right after the newest
+		me->tail = me->head;
+		me->full = true;
+	}
+}
+
+size_t circular_buf_get_range(cbuf_handle_t me, uint16_t* data, size_t len)
+{
+	size_t size;
+
+	assert(me && me->buffer && data);
+
+	size = circular_buf_size(me);
+	if(len > size)
+	{
+		len = size;
+	}
+
+	copy_out(me, me->tail, data, len);
+
+	me->tail += len;
+	if(me->tail >= me->max)
+	{
+		me->tail -= me->max;
+	}
+	if(len)
+	{
+		me->full = false;
+	}
+
+	return len;
+}
+
+size_t circular_buf_peek_range(cbuf_handle_t me, size_t index, uint16_t* data, size_t len)
+{
+	size_t size;
+	size_t pos;
+
+	assert(me && me->buffer && data);
+
+	size = circular_buf_size(me);
+	if(index >= size)
+	{
+		return 0;
+	}
+	if(len > (size - index))
+	{
+		len = size - index;
+	}
+
+	pos = me->tail + index;
+	if(pos >= me->max)
+	{
+		pos -= me->max;
+	}
+	copy_out(me, pos, data, len);
+
+	return len;
+}
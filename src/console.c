@@ -255,6 +255,40 @@ eCommandResult_T ConsoleReceiveParamInt16(const char * buffer, const uint8_t par
 	return result;
 }
 
+// ConsoleReceiveParamInt32
+// Identify and obtain a parameter of type int32_t, sent in in decimal, possibly with a negative sign.
+eCommandResult_T ConsoleReceiveParamInt32(const char * buffer, const uint8_t parameterNumber, int32_t* parameterInt)
+{
+	uint32_t startIndex = 0;
+	uint32_t i;
+	eCommandResult_T result;
+	char charVal;
+	char str[INT32_MAX_STR_LENGTH];
+
+	result = ConsoleParamFindN(buffer, parameterNumber, &startIndex);
+
+	i = 0;
+	charVal = buffer[startIndex + i];
+	while ( ( LF_CHAR != charVal ) && ( CR_CHAR != charVal )
+			&& ( PARAMETER_SEPARATER != charVal )
+		&& ( i < INT32_MAX_STR_LENGTH ) )
+	{
+		str[i] = charVal;					// copy the relevant part
+		i++;
+		charVal = buffer[startIndex + i];
+	}
+	if ( i == INT32_MAX_STR_LENGTH)
+	{
+		result = COMMAND_PARAMETER_ERROR;
+	}
+	if ( COMMAND_SUCCESS == result )
+	{
+		str[i] = NULL_CHAR;
+		*parameterInt = atol(str);
+	}
+	return result;
+}
+
 // ConsoleReceiveParamHexUint16
 // Identify and obtain a parameter of type uint16, sent in as hex. This parses the number and does not use
 // a library function to do it.
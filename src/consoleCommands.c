@@ -7,6 +7,7 @@
 //		3. Implement the function, using ConsoleReceiveParam<Type> to get the parameters from the buffer.
 #include <stdio.h>
 #include <string.h>
+#include <malloc.h>
 #include "consoleCommands.h"
 #include "console.h"
 #include "consoleIo.h"
@@ -20,7 +21,23 @@
 #include "../Drivers/MMA8652/mma865x_driver.h"
 #include "../Drivers/MMA8652/mma865x_regdef.h"
 #include "main.h"
-#include "circular_buffer.h"
+#include "press_history.h"
+#include "press_log.h"
+#include "press_store.h"
+#include "mem_pool.h"
+#include "press_tendency.h"
+#include "zambretti.h"
+#include "press_slp.h"
+#include "press_motion.h"
+#include "press_filter.h"
+#include "outlier.h"
+#include "ring_template.h"
+#include "press_pipeline.h"
+#include "i2c_async.h"
+#include "baro_units.h"
+#ifdef I2C_PROF
+#	include "i2c_prof.h"
+#endif
 
 #define IGNORE_UNUSED_VARIABLE(x)  if ( &x == &x ) {}
 #define ABS(x)  (x < 0) ? (-x) : x
@@ -34,6 +51,30 @@ typedef struct _ACC_DATA {
 	float x, y, z;
 } ACC_DATA;
 
+typedef struct {
+	int16_t x, y, z;
+} acc_sample_t;
+
+// Number of accelerometer samples averaged by the "ad" command
+#define ACC_AVG_LEN 8
+RING_DECLARE(acc_ring, acc_sample_t, ACC_AVG_LEN)
+
+typedef struct {
+	float x, y, z;
+} gyro_sample_t;
+
+// Number of gyro readings averaged by the "gt" bars, 40 ms at one reading per 10 ms
+#define GYRO_AVG_LEN 4
+RING_DECLARE(gyro_ring, gyro_sample_t, GYRO_AVG_LEN)
+
+// Conversions counted by the "pc" command
+#define BARO_CONV_RUNS 256
+
+// Outlier rejection of the "ad" samples: window and lower limit of the deviation scale in counts
+#define ACC_OUTLIER_LEN 5
+#define ACC_OUTLIER_SCALE 20
+static outlier3_t accOutlier;
+
 static eCommandResult_T ConsoleCommandVer(const char buffer[]);
 static eCommandResult_T ConsoleCommandHelp(const char buffer[]);
 static eCommandResult_T ConsoleCommandGyroPresent(const char buffer[]);
@@ -47,6 +88,27 @@ static eCommandResult_T ConsoleCommandAccData(const char buffer[]);
 static eCommandResult_T ConsoleCommandAccOrient(const char buffer[]);
 static eCommandResult_T ConsoleCommandSimWarn(const char buffer[]);
 static eCommandResult_T ConsoleCommandCircBuf(const char buffer[]);
+static eCommandResult_T ConsoleCommandHistTier(const char buffer[]);
+static eCommandResult_T ConsoleCommandPressLog(const char buffer[]);
+static eCommandResult_T ConsoleCommandPressStore(const char buffer[]);
+static eCommandResult_T ConsoleCommandMemPool(const char buffer[]);
+static eCommandResult_T ConsoleCommandTendency(const char buffer[]);
+static eCommandResult_T ConsoleCommandForecast(const char buffer[]);
+static eCommandResult_T ConsoleCommandPressImport(const char buffer[]);
+static eCommandResult_T ConsoleCommandAltitude(const char buffer[]);
+static eCommandResult_T ConsoleCommandMotion(const char buffer[]);
+static eCommandResult_T ConsoleCommandFilter(const char buffer[]);
+static eCommandResult_T ConsoleCommandOutlier(const char buffer[]);
+static eCommandResult_T ConsoleCommandBaroFifo(const char buffer[]);
+static eCommandResult_T ConsoleCommandI2cQueue(const char buffer[]);
+static eCommandResult_T ConsoleCommandBaroMode(const char buffer[]);
+static eCommandResult_T ConsoleCommandBaroWake(const char buffer[]);
+static eCommandResult_T ConsoleCommandBaroBench(const char buffer[]);
+static eCommandResult_T ConsoleCommandBaroConv(const char buffer[]);
+#ifdef I2C_PROF
+static eCommandResult_T ConsoleCommandI2cProfile(const char buffer[]);
+#endif
+static bool baro_bench_busy(void);
 
 static const sConsoleCommandTable_T mConsoleCommandTable[] =
 {
@@ -62,7 +124,27 @@ static const sConsoleCommandTable_T mConsoleCommandTable[] =
 	{"ad", &ConsoleCommandAccData, HELP("Get accelerometer data: params 10 - number of seconds to test")},
 	{"ao", &ConsoleCommandAccOrient, HELP("Get accelerometer orientation: params 10 - number of seconds to test")},
 	{"sw", &ConsoleCommandSimWarn, HELP("Simulate barometer warning")},
-	{"cb", &ConsoleCommandCircBuf, HELP("Output circular buffer")},
+	{"cb", &ConsoleCommandCircBuf, HELP("Output barometer ring")},
+	{"ht", &ConsoleCommandHistTier, HELP("Output history tier: params 0 - 15 min, 1 - hourly")},
+	{"cl", &ConsoleCommandPressLog, HELP("Output compressed pressure log")},
+	{"fl", &ConsoleCommandPressStore, HELP("Flash pressure log status: params 1 - write pending samples")},
+	{"mem", &ConsoleCommandMemPool, HELP("Memory budget: RAM sections, static pools and heap use")},
+	{"pt", &ConsoleCommandTendency, HELP("Pressure tendency: slope, 3 hour change, WMO code and storm level")},
+	{"fc", &ConsoleCommandForecast, HELP("Zambretti forecast: params 1..12 - set current month, 0 - no seasonal correction")},
+	{"pi", &ConsoleCommandPressImport, HELP("Import pressure sample: params 101325 - pressure in Pa")},
+	{"alt", &ConsoleCommandAltitude, HELP("Station altitude for the sea-level pressure: params 250 - altitude in m")},
+	{"mo", &ConsoleCommandMotion, HELP("Motion gate of the pressure samples: state, held samples and altitude offset")},
+	{"kf", &ConsoleCommandFilter, HELP("Pressure filter: filtered pressure, rate and their variances")},
+	{"ol", &ConsoleCommandOutlier, HELP("Outlier rejection: rejected pressure and accelerometer samples, barometer read errors")},
+	{"bf", &ConsoleCommandBaroFifo, HELP("Barometer FIFO: batches, samples, bus transactions and overruns")},
+	{"i2", &ConsoleCommandI2cQueue, HELP("I2C transaction queue: transactions, errors, timeouts, queue depth and latency per class")},
+	{"bm", &ConsoleCommandBaroMode, HELP("Barometer acquisition: params 0 - FIFO at 1 Hz, 4..512 - one-shot with this many averages")},
+	{"bw", &ConsoleCommandBaroWake, HELP("Wake on pressure change, armed in FIFO mode: params 0 - off, 7..20000 - threshold in Pa")},
+	{"bb", &ConsoleCommandBaroBench, HELP("Barometer ODR/AVG/LPF sweep: params 32 - samples per setting, 0 - ODR code (0 all), 0 - text, 1 - binary frames")},
+	{"pc", &ConsoleCommandBaroConv, HELP("Pressure conversion cycles: integer Pa against the float hPa path, DWT counted")},
+#ifdef I2C_PROF
+	{"ip", &ConsoleCommandI2cProfile, HELP("I2C bus profile per device since the last call: transactions, bytes, errors, latency histogram")},
+#endif
 
 	CONSOLE_COMMAND_TABLE_END // must be LAST
 };
@@ -119,6 +201,9 @@ static void getAxisBar(char * buffer, float val, uint16_t blen){
 static eCommandResult_T ConsoleCommandGyroTest(const char buffer[]){
 	float Buffer[3];
 	float Xval, Yval, Zval = 0x00;
+	static gyro_ring_t gyroRing;
+	gyro_sample_t sample;
+	size_t i, n;
 	int16_t tsec;
     char strbuf[100];
     eCommandResult_T result;
@@ -136,6 +221,7 @@ static eCommandResult_T ConsoleCommandGyroTest(const char buffer[]){
 			}
             //function will exit after tsec
 			endTick = HAL_GetTick() + (tsec * 1000);
+			gyro_ring_reset(&gyroRing);
 
 			while(HAL_GetTick() < endTick){
 
@@ -144,9 +230,22 @@ static eCommandResult_T ConsoleCommandGyroTest(const char buffer[]){
 
 				// device is outputting mdps (millidegrees per second)
 				// to get DPS we need to divide by 1000
-				Xval = (Buffer[0]/1000);
-				Yval = (Buffer[1]/1000);
-				Zval = (Buffer[2]/1000);
+				sample.x = (Buffer[0]/1000);
+				sample.y = (Buffer[1]/1000);
+				sample.z = (Buffer[2]/1000);
+				// bars show the moving average over the last GYRO_AVG_LEN readings
+				gyro_ring_put(&gyroRing, sample);
+				Xval = Yval = Zval = 0;
+				n = gyro_ring_size(&gyroRing);
+				for (i = 0; i < n; i++){
+					gyro_ring_at(&gyroRing, i, &sample);
+					Xval += sample.x;
+					Yval += sample.y;
+					Zval += sample.z;
+				}
+				Xval /= n;
+				Yval /= n;
+				Zval /= n;
 				//Reset the string buffer
 				memset(strbuf, 0x00, 100);
 
@@ -174,34 +273,643 @@ static eCommandResult_T ConsoleCommandGyroTest(const char buffer[]){
 
 
 static eCommandResult_T ConsoleCommandCircBuf(const char buffer[]){
-	uint16_t i;
-	uint16_t bdata;
+	const baro_ring_t * ring = press_pipeline_ring();
+	size_t i;
+	size_t size;
+	uint16_t bval;
 	char strbuf[100];
-	int rs;
 
-	ConsoleIoSendString("\r\n************\r\nCircular Buffer:\r\n");
-	sprintf(strbuf, "Circular buffer size/capacity %i / %i\n", circular_buf_size(me), circular_buf_capacity(me));
+	ConsoleIoSendString("\r\n************\r\nBarometer ring:\r\n");
+	size = baro_ring_size(ring);
+	sprintf(strbuf, "Barometer ring size/capacity %i / %i\n", size, baro_ring_capacity());
 	ConsoleIoSendString(strbuf);
 
 	memset(strbuf, 0x00, 100);
 
+	// the accessors are inlined, reading one value at a time costs no call
+	for (i = 0; baro_ring_at(ring, i, &bval); ++i) {
+		//Reset the string buffer
+		memset(strbuf, 0x00, 100);
+		sprintf(strbuf, "%i - %u.%02u\n", i + 1, (bval / 100) + 900, bval % 100);
+		ConsoleIoSendString(strbuf);
+	}
+	ConsoleIoSendString("\r\nDone\r\n");
 
-	for (i = 1; i < BAROMETER_BUFFER_SIZE; ++i) {
-		rs = circular_buf_peek(me, &bdata, i);
-		if (rs == -1){
-			break;
-		} else {
-			//Reset the string buffer
-			memset(strbuf, 0x00, 100);
-			sprintf(strbuf, "%i - %f\n", i, ((float)bdata/100 + 900));
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Outputs min/max/mean of every rollup stored in the selected history tier
+ */
+static eCommandResult_T ConsoleCommandHistTier(const char buffer[]){
+	size_t i;
+	size_t size;
+	int16_t tier;
+	press_rollup_t rollup;
+	char strbuf[100];
+	eCommandResult_T result;
+
+	result = ConsoleReceiveParamInt16(buffer, 1, &tier);
+	if ((COMMAND_SUCCESS != result) || (tier < 0) || (tier >= PRESS_TIER_COUNT)){
+		ConsoleIoSendString("Error in history tier: 0 - 15 min, 1 - hourly\r\n");
+		return COMMAND_PARAMETER_ERROR;
+	}
+
+	size = press_history_size((press_tier_t) tier);
+	sprintf(strbuf, "\r\n************\r\nHistory tier %i size/capacity %i / %i\r\n",
+			tier, size, press_history_capacity((press_tier_t) tier));
+	ConsoleIoSendString(strbuf);
+
+	for (i = 0; i < size; ++i) {
+		press_history_at((press_tier_t) tier, i, &rollup);
+		memset(strbuf, 0x00, 100);
+		sprintf(strbuf, "%i - min %u.%02u max %u.%02u mean %u.%02u\n", i + 1,
+				(rollup.min / 100) + 900, rollup.min % 100, (rollup.max / 100) + 900, rollup.max % 100,
+				(rollup.mean / 100) + 900, rollup.mean % 100);
+		ConsoleIoSendString(strbuf);
+	}
+	ConsoleIoSendString("\r\nDone\r\n");
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Decodes the compressed pressure log and outputs it from the oldest sample
+ */
+static eCommandResult_T ConsoleCommandPressLog(const char buffer[]){
+	size_t i = 0;
+	uint32_t pa;
+	press_log_iter_t it;
+	char strbuf[100];
+
+	sprintf(strbuf, "\r\n************\r\nPressure log: %i samples in %i bytes\r\n",
+			press_log_size(), press_log_bytes());
+	ConsoleIoSendString(strbuf);
+
+	press_log_iter_begin(&it);
+	while (press_log_iter_next(&it, &pa)) {
+		memset(strbuf, 0x00, 100);
+		sprintf(strbuf, "%i - %lu.%02lu\n", ++i, pa / 100, pa % 100);
+		ConsoleIoSendString(strbuf);
+	}
+	ConsoleIoSendString("\r\nDone\r\n");
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Outputs the counters of the persistent pressure log in flash
+ */
+static eCommandResult_T ConsoleCommandPressStore(const char buffer[]){
+	int16_t flush;
+	press_store_stats_t stats;
+	char strbuf[100];
+
+	if ((COMMAND_SUCCESS == ConsoleReceiveParamInt16(buffer, 1, &flush)) && (flush == 1)){
+		if (press_store_flush() != 0){
+			ConsoleIoSendString("Flash write failed\r\n");
+		}
+	}
+
+	press_store_get_stats(&stats);
+	ConsoleIoSendString("\r\n************\r\nFlash pressure log:\r\n");
+	sprintf(strbuf, "Samples written: %lu\r\n", stats.samples_written);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Records written: %lu\r\n", stats.records_written);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Sector erases: %lu\r\n", stats.erases);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Record reads: %lu\r\n", stats.recovery_reads);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "CRC errors: %lu\r\n", stats.crc_errors);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandMemPool(const char buffer[]){
+	// section boundaries and reservations from LinkerScript.ld
+	extern uint8_t _sdata[], _edata[], _sbss[], _ebss[], _spools[], _epools[];
+	extern uint8_t _Min_Heap_Size[], _Min_Stack_Size[];
+	mem_pool_info_t info;
+	struct mallinfo heap;
+	char strbuf[100];
+	uint8_t i;
+
+	ConsoleIoSendString("\r\n************\r\nRAM budget:\r\n");
+	sprintf(strbuf, ".data: %lu\r\n", (uint32_t)(_edata - _sdata));
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, ".bss: %lu\r\n", (uint32_t)(_ebss - _sbss));
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, ".pools: %lu (budget %u)\r\n", (uint32_t)(_epools - _spools), MEM_POOL_BUDGET);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Heap reserved: %lu, stack reserved: %lu\r\n", (uint32_t)_Min_Heap_Size, (uint32_t)_Min_Stack_Size);
+	ConsoleIoSendString(strbuf);
+
+	ConsoleIoSendString("Pools:\r\n");
+	for (i = 0; i < MEM_POOL_COUNT; i++){
+		if (mem_pool_info(i, &info) == 0){
+			sprintf(strbuf, "%s: %lu/%lu failed %lu\r\n", info.name, info.used, info.size, info.failed);
 			ConsoleIoSendString(strbuf);
 		}
 	}
-	ConsoleIoSendString("\r\nDone\r\n");
+
+	// anything taken from the heap comes from the C library, not the application
+	heap = mallinfo();
+	sprintf(strbuf, "Heap: arena %u, in use %u\r\n", (unsigned)heap.arena, (unsigned)heap.uordblks);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandTendency(const char buffer[]){
+	static const char* const storm[] = {"none", "watch", "warning"};
+	press_tendency_t tend;
+	char strbuf[100];
+
+	press_tendency_get(&tend);
+	ConsoleIoSendString("\r\n************\r\nPressure tendency:\r\n");
+	if (tend.updates == 0){
+		ConsoleIoSendString("Waiting for 3 hours of samples\r\n");
+		return COMMAND_SUCCESS;
+	}
+	sprintf(strbuf, "Slope: %ld Pa/h\r\n", tend.slope);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "3 hour change: %ld Pa\r\n", tend.change);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "WMO code: %u - %s\r\n", tend.code, press_tendency_name(tend.code));
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Storm: %s\r\n", storm[tend.storm]);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandForecast(const char buffer[]){
+	int16_t month;
+	press_tendency_t tend;
+	uint16_t bval;
+	uint8_t code;
+	char strbuf[100];
+
+	if (COMMAND_SUCCESS == ConsoleReceiveParamInt16(buffer, 1, &month)){
+		if ((month < 0) || (month > 12)){
+			return COMMAND_PARAMETER_ERROR;
+		}
+		forecastMonth = (uint8_t) month;
+	}
+	sprintf(strbuf, "\r\nMonth: %u\r\n", forecastMonth);
+	ConsoleIoSendString(strbuf);
+
+	press_tendency_get(&tend);
+	if ((tend.updates == 0) || !baro_ring_at(press_pipeline_ring(), baro_ring_size(press_pipeline_ring()) - 1, &bval)){
+		ConsoleIoSendString("Waiting for 3 hours of samples\r\n");
+		return COMMAND_SUCCESS;
+	}
+	code = zambretti_forecast((int32_t) bval + PRESS_PIPELINE_OFFSET, tend.change, forecastMonth);
+	sprintf(strbuf, "Forecast: %c - %s\r\n", zambretti_letter(code), zambretti_text(code));
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Imports one pressure sample, used to replay generated traces (tools/tracegen -f console)
+ */
+static eCommandResult_T ConsoleCommandPressImport(const char buffer[]){
+	int32_t pa;
+
+	if ((COMMAND_SUCCESS != ConsoleReceiveParamInt32(buffer, 1, &pa)) || (pa <= 0)){
+		ConsoleIoSendString("Error in pressure: Pa > 0\r\n");
+		return COMMAND_PARAMETER_ERROR;
+	}
+	import_sample((uint32_t) pa);
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Sets the station altitude, outputs the station and the sea-level pressure
+ */
+static eCommandResult_T ConsoleCommandAltitude(const char buffer[]){
+	int16_t altitude;
+	bdata_t data;
+	char strbuf[100];
+
+	if (baro_bench_busy()){
+		return COMMAND_ERROR;
+	}
+	if (COMMAND_SUCCESS == ConsoleReceiveParamInt16(buffer, 1, &altitude)){
+		if ((altitude < PRESS_SLP_ALT_MIN) || (altitude > PRESS_SLP_ALT_MAX)){
+			ConsoleIoSendString("Error in altitude: -500..4000 m\r\n");
+			return COMMAND_PARAMETER_ERROR;
+		}
+		press_slp_set_altitude(altitude);
+		// the new altitude replaces the offset found after moving the station
+		press_motion_clear();
+		outlier_clear(press_pipeline_outlier());
+		press_filter_reset();
+	}
+
+	data = barometer_data();
+	sprintf(strbuf, "\r\nAltitude: %d m\r\n", press_slp_get_altitude());
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Station pressure: %ld Pa, temperature: %d (0.01 degC)\r\n", data.pa, data.centi_c);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Sea-level pressure: %ld Pa\r\n", press_slp_reduce(data.pa, data.centi_c));
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandMotion(const char buffer[]){
+	press_motion_t gate;
+	char strbuf[100];
+
+	press_motion_get(&gate);
+	sprintf(strbuf, "\r\nState: %s\r\n", gate.moving ? "moving" : "still");
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Motion events: %lu, held samples: %lu\r\n", gate.events, gate.held);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Altitude steps: %lu, not confirmed: %lu, offset: %ld Pa\r\n", gate.rebases, gate.rejected, gate.offset);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandFilter(const char buffer[]){
+	press_filter_t filter;
+	char strbuf[100];
+
+	press_filter_get(&filter);
+	if (filter.updates == 0){
+		ConsoleIoSendString("\r\nNo samples yet\r\n");
+		return COMMAND_SUCCESS;
+	}
+	sprintf(strbuf, "\r\nPressure: %ld Pa, variance: %lu (0.01 Pa^2)\r\n", filter.pa, filter.var);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Rate: %ld Pa/h, variance: %lu (0.01 (Pa/h)^2)\r\n", filter.rate, filter.rate_var);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Samples: %lu\r\n", filter.updates);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandOutlier(const char buffer[]){
+	const outlier_t * outl = press_pipeline_outlier();
+	char strbuf[100];
+
+	sprintf(strbuf, "\r\nPressure: samples %lu, rejected %lu, median %ld Pa\r\n",
+			outl->samples, outl->rejected, outlier_median(outl));
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Barometer read errors: %lu\r\n", barometer_errors());
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Accelerometer (last ad run): samples %lu, rejected %lu\r\n", accOutlier.samples, accOutlier.rejected);
+	ConsoleIoSendString(strbuf);
 
 	return COMMAND_SUCCESS;
 }
 
+static eCommandResult_T ConsoleCommandBaroFifo(const char buffer[]){
+	baro_fifo_stats_t stats;
+	char strbuf[100];
+
+	baro_fifo_get_stats(&stats);
+	sprintf(strbuf, "\r\nBatches: %lu, samples: %lu\r\n", stats.drains, stats.samples);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Bus transactions: %lu, errors: %lu\r\n", stats.transactions, stats.errors);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Overruns: %lu\r\n", stats.overruns);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+static eCommandResult_T ConsoleCommandI2cQueue(const char buffer[]){
+	static const char *names[I2C_ASYNC_PRIO_LEVELS] = {"touch", "sensor", "background"};
+	static const uint16_t deadlines[I2C_ASYNC_PRIO_LEVELS] = {
+			I2C_ASYNC_DEADLINE_TOUCH, I2C_ASYNC_DEADLINE_SENSOR, I2C_ASYNC_DEADLINE_BACKGROUND};
+	i2c_async_stats_t stats;
+	i2c_async_class_stats_t *cls;
+	uint8_t i;
+	char strbuf[100];
+
+	i2c_async_get_stats(&stats);
+	sprintf(strbuf, "\r\nTransactions: %lu, completed: %lu\r\n", stats.submitted, stats.completed);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Errors: %lu, timeouts: %lu, stale completions: %lu\r\n", stats.errors, stats.timeouts, stats.stale);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Queue full: %lu, max depth: %u, bus transfers: %lu\r\n", stats.rejected, stats.max_depth, stats.parts);
+	ConsoleIoSendString(strbuf);
+	for (i = 0; i < I2C_ASYNC_PRIO_LEVELS; i++){
+		cls = &stats.cls[i];
+		sprintf(strbuf, "%s: %lu done, %lu full, depth %u, late %lu (> %u ms), max %lu ms\r\n", names[i],
+				cls->completed, cls->rejected, cls->max_depth, cls->late, deadlines[i], cls->latency_max);
+		ConsoleIoSendString(strbuf);
+	}
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Selects the barometer acquisition and shows the measured one-shot latency
+ * More averages lower the noise of the one-shot sample, the sensor converts longer and draws more current
+ */
+static eCommandResult_T ConsoleCommandBaroMode(const char buffer[]){
+	baro_oneshot_stats_t stats;
+	int16_t avg;
+	uint8_t code = 0;
+	int result;
+	char strbuf[100];
+
+	if (baro_bench_busy()){
+		return COMMAND_ERROR;
+	}
+	if (COMMAND_SUCCESS == ConsoleReceiveParamInt16(buffer, 1, &avg)){
+		while ((code < BARO_ONESHOT_AVG_MAX) && ((4 << code) < avg)){
+			code++;
+		}
+		if ((avg != 0) && ((avg < 4) || ((4 << code) != avg))){
+			ConsoleIoSendString("Error in averages: 0 or 4, 8, 16, 32, 64, 128, 256, 512\r\n");
+			return COMMAND_PARAMETER_ERROR;
+		}
+		// no barometer read may be on the bus while the sensor is reconfigured
+		while (!i2c_async_idle()){
+			i2c_async_poll();
+		}
+		if (avg == 0){
+			result = barometer_fifo_start(BAROMETER_FIFO_WATERMARK);
+		} else {
+			result = barometer_oneshot_start(code);
+		}
+		baro_data_ready = false;
+		if (result != 0){
+			ConsoleIoSendString("Barometer Error\r\n");
+			return COMMAND_ERROR;
+		}
+	}
+
+	if (barometer_mode() == BAROMETER_FIFO){
+		ConsoleIoSendString("\r\nMode: FIFO, 1 Hz with 4 averages\r\n");
+		return COMMAND_SUCCESS;
+	}
+	baro_oneshot_get_stats(&stats);
+	sprintf(strbuf, "\r\nMode: one-shot, %u averages\r\n", 4 << baro_oneshot_avg());
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Conversions: %lu, samples: %lu, missed: %lu\r\n", stats.conversions, stats.samples, stats.missed);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Conversion us: %lu (min %lu, max %lu)\r\n", stats.conv_us, stats.conv_min_us, stats.conv_max_us);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Read latency us: %lu (max %lu)\r\n", stats.read_us, stats.read_max_us);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Sets the wake on pressure change and shows the threshold events
+ * The threshold interrupt compares every conversion, it needs the FIFO acquisition ("bm 0")
+ */
+static eCommandResult_T ConsoleCommandBaroWake(const char buffer[]){
+	baro_wake_stats_t stats;
+	int16_t pa;
+	int result = 0;
+	char strbuf[100];
+
+	if (COMMAND_SUCCESS == ConsoleReceiveParamInt16(buffer, 1, &pa)){
+		if ((pa != 0) && ((pa < BARO_WAKE_MIN_PA) || (pa > BARO_WAKE_MAX_PA))){
+			ConsoleIoSendString("Error in threshold: 0 or 7..20000 Pa\r\n");
+			return COMMAND_PARAMETER_ERROR;
+		}
+		if (baro_bench_busy()){
+			return COMMAND_ERROR;
+		}
+		// no barometer read may be on the bus while the sensor is reconfigured
+		while (!i2c_async_idle()){
+			i2c_async_poll();
+		}
+		if (pa == 0){
+			result = barometer_wake_stop();
+		} else {
+			result = barometer_wake_start((uint16_t) pa);
+		}
+		if (result != 0){
+			ConsoleIoSendString("Barometer Error\r\n");
+			return COMMAND_ERROR;
+		}
+	}
+
+	if (barometer_wake_pending() == 0){
+		ConsoleIoSendString("\r\nWake: off\r\n");
+		return COMMAND_SUCCESS;
+	}
+	// the threshold needs continuous conversions
+	if (barometer_mode() != BAROMETER_FIFO){
+		sprintf(strbuf, "\r\nWake: %u Pa, armed in FIFO mode (bm 0)\r\n", barometer_wake_pending());
+		ConsoleIoSendString(strbuf);
+		return COMMAND_SUCCESS;
+	}
+	baro_wake_get_stats(&stats);
+	sprintf(strbuf, "\r\nWake: %u Pa\r\n", barometer_wake_threshold());
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Rearms: %lu, rises: %lu, falls: %lu\r\n", stats.rearms, stats.high, stats.low);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Transactions: %lu, errors: %lu\r\n", stats.transactions, stats.errors);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Outputs one result of the barometer sweep as a text line
+ */
+static void baro_bench_text(const baro_bench_result_t* r){
+	static const char* lpf[] = {"off", "odr/4", "", "odr/9"};
+	char strbuf[160];
+
+	if (r->status == BARO_BENCH_SKIPPED){
+		sprintf(strbuf, "%u Hz x%u %s skipped, conversion %lu us\r\n",
+				baro_bench_odr_hz(r->odr), 4 << r->avg, lpf[r->lpf & 0x03], r->conv_us);
+	} else {
+		sprintf(strbuf, "%u Hz x%u %s: %u samples, noise %u mPa, conversion %lu us, period %lu us, bus %u us%s\r\n",
+				baro_bench_odr_hz(r->odr), 4 << r->avg, lpf[r->lpf & 0x03], r->samples, r->noise_mpa,
+				r->conv_us, r->period_us, r->bus_us, (r->status == BARO_BENCH_TIMEOUT) ? ", timeout" : "");
+	}
+	ConsoleIoSendString(strbuf);
+}
+
+/**
+ * Outputs one result of the barometer sweep as a binary frame (baro_bench.h)
+ */
+static void baro_bench_frame(const baro_bench_result_t* r){
+	uint8_t frame[BARO_BENCH_FRAME_LEN];
+
+	ConsoleIoSendBytes(frame, baro_bench_encode(r, frame));
+}
+
+/**
+ * End of the barometer sweep, called from the superloop by barometer_bench_step()
+ */
+static void baro_bench_done(int result){
+	char strbuf[60];
+
+	// data ready of the sweep is not a sample
+	baro_data_ready = false;
+	if (result != 0){
+		ConsoleIoSendString("\r\nBarometer Error\r\n");
+	} else {
+		ConsoleIoSendString("\r\nDone\r\n");
+	}
+	sprintf(strbuf, "Log samples held during the sweep: %u\r\n", benchHeld);
+	ConsoleIoSendString(strbuf);
+}
+
+/**
+ * The sweep has the barometer until it is done, the commands that use the sensor are refused meanwhile
+ * Returns true if a sweep is running
+ */
+static bool baro_bench_busy(void){
+	if (!barometer_bench_running()){
+		return false;
+	}
+	ConsoleIoSendString("Barometer sweep running\r\n");
+	return true;
+}
+
+/**
+ * Starts every ODR/AVG/LPF combination of the barometer, outputs noise, conversion time and bus time
+ * The station has to be kept still, the whole sweep takes about 20 minutes with 32 samples
+ * The superloop runs the sweep a step at a time, the log samples meanwhile are held
+ */
+static eCommandResult_T ConsoleCommandBaroBench(const char buffer[]){
+	int16_t samples = 32;
+	int16_t odr = 0;
+	int16_t binary = 0;
+
+	ConsoleReceiveParamInt16(buffer, 1, &samples);
+	ConsoleReceiveParamInt16(buffer, 2, &odr);
+	ConsoleReceiveParamInt16(buffer, 3, &binary);
+	if ((samples < BARO_BENCH_SAMPLES_MIN) || (samples > BARO_BENCH_SAMPLES_MAX) ||
+			(odr < 0) || (odr > BARO_BENCH_ODR_MAX)){
+		ConsoleIoSendString("Error in parameters: 4..1000 samples, ODR code 0..8\r\n");
+		return COMMAND_PARAMETER_ERROR;
+	}
+	if (baro_bench_busy()){
+		return COMMAND_ERROR;
+	}
+
+	// no barometer read may be on the bus while the sensor is reconfigured
+	while (!i2c_async_idle()){
+		i2c_async_poll();
+	}
+	ConsoleIoSendString("\r\n************\r\nBarometer sweep\r\n");
+	benchHeld = 0;
+	if (barometer_bench_start((uint8_t) odr, (uint16_t) samples, binary ? baro_bench_frame : baro_bench_text,
+			baro_bench_done) != 0){
+		baro_data_ready = false;
+		ConsoleIoSendString("\r\nBarometer Error\r\n");
+		return COMMAND_ERROR;
+	}
+
+	return COMMAND_SUCCESS;
+}
+
+/**
+ * Counts the cycles of the pressure conversion with the DWT cycle counter: the integer Pa of
+ * barometer.c against the float hPa of the ST driver that it replaced, scaled to Pa as main.c did
+ * The loop without a conversion is counted too and taken off both
+ */
+static eCommandResult_T ConsoleCommandBaroConv(const char buffer[]){
+	static volatile int32_t counts[BARO_CONV_RUNS];
+	volatile int32_t ipa;
+	volatile uint32_t fpa;
+	float hpa;
+	uint32_t start, loop, intCycles, floatCycles;
+	uint16_t i;
+	char strbuf[100];
+
+	IGNORE_UNUSED_VARIABLE(buffer);
+	// the counter runs for the I2C profiler too, it is started but never cleared here
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	// counts around 1013 hPa, volatile so the compiler cannot fold the conversions
+	for (i = 0; i < BARO_CONV_RUNS; i++){
+		counts[i] = ((101300 + i) * BARO_COUNTS_PER_HPA) / 100;
+	}
+
+	start = DWT->CYCCNT;
+	for (i = 0; i < BARO_CONV_RUNS; i++){
+		ipa = counts[i];
+	}
+	loop = DWT->CYCCNT - start;
+
+	start = DWT->CYCCNT;
+	for (i = 0; i < BARO_CONV_RUNS; i++){
+		ipa = baro_counts_to_pa(counts[i], false);
+	}
+	intCycles = DWT->CYCCNT - start;
+
+	start = DWT->CYCCNT;
+	for (i = 0; i < BARO_CONV_RUNS; i++){
+		// lps28dfw_from_fs1260_to_hPa() of the raw value shifted left by 8, then Pa as main.c did
+		hpa = (float)(counts[i] * 256) / 1048576.0f;
+		fpa = (uint32_t) (hpa * 100 + 0.5f);
+	}
+	floatCycles = DWT->CYCCNT - start;
+
+	intCycles = (intCycles > loop) ? (intCycles - loop) : 0;
+	floatCycles = (floatCycles > loop) ? (floatCycles - loop) : 0;
+	sprintf(strbuf, "\r\n%u conversions, cycles per conversion: integer %lu.%02lu, float %lu.%02lu\r\n", BARO_CONV_RUNS,
+			intCycles / BARO_CONV_RUNS, ((intCycles % BARO_CONV_RUNS) * 100) / BARO_CONV_RUNS,
+			floatCycles / BARO_CONV_RUNS, ((floatCycles % BARO_CONV_RUNS) * 100) / BARO_CONV_RUNS);
+	ConsoleIoSendString(strbuf);
+	sprintf(strbuf, "Last: %ld Pa integer, %lu Pa float\r\n", ipa, fpa);
+	ConsoleIoSendString(strbuf);
+
+	return COMMAND_SUCCESS;
+}
+
+#ifdef I2C_PROF
+/**
+ * Dumps the bus profile of every device and starts a new one
+ * The histogram gives the transactions per latency bucket, from the lower bound of the bucket in us
+ */
+static eCommandResult_T ConsoleCommandI2cProfile(const char buffer[]){
+	static uint32_t since;
+	i2c_prof_device_t devices[I2C_PROF_DEVICES];
+	i2c_prof_device_t *d;
+	uint32_t now = HAL_GetTick();
+	uint8_t n;
+	uint8_t i;
+	uint8_t b;
+	char strbuf[100];
+
+	n = i2c_prof_get(devices, I2C_PROF_DEVICES);
+	sprintf(strbuf, "\r\nI2C profile over %lu ms, other devices: %lu\r\n", now - since, i2c_prof_others());
+	ConsoleIoSendString(strbuf);
+	for (i = 0; i < n; i++){
+		d = &devices[i];
+		sprintf(strbuf, "0x%02X: %lu transactions, %lu bytes, %lu errors, %lu timeouts, mean %lu us, max %lu us\r\n",
+				d->addr, d->transactions, d->bytes, d->errors, d->timeouts,
+				d->transactions ? (uint32_t)(d->latency_sum / d->transactions) : 0, d->latency_max);
+		ConsoleIoSendString(strbuf);
+		ConsoleIoSendString("  us:");
+		for (b = 0; b < I2C_PROF_BUCKETS; b++){
+			if (d->hist[b] != 0){
+				sprintf(strbuf, " %lu:%lu", i2c_prof_bucket_us(b), d->hist[b]);
+				ConsoleIoSendString(strbuf);
+			}
+		}
+		ConsoleIoSendString(STR_ENDLINE);
+	}
+	i2c_prof_reset();
+	since = now;
+
+	return COMMAND_SUCCESS;
+}
+#endif
+
 static eCommandResult_T ConsoleCommandSimWarn(const char buffer[]){
 	warnShown = true;
 	return COMMAND_SUCCESS;
@@ -226,6 +934,9 @@ static eCommandResult_T ConsoleCommandBaroReset(const char buffer[]){
 	lps28dfw_stat_t status;
 	uint32_t endTick = 0;
 
+	if (baro_bench_busy()){
+		return COMMAND_ERROR;
+	}
 	dev_ctx = lps28dfw_init();
 	ConsoleIoSendString("Resetting Barometer\n");
 	lps28dfw_init_set(&dev_ctx, LPS28DFW_BOOT);
@@ -340,6 +1051,11 @@ static eCommandResult_T ConsoleCommandAccData(const char buffer[]){
 	int16_t tsec;
 	uint32_t endTick = 0;
 	float x, y, z = 0.0;
+	static acc_ring_t accRing;
+	acc_sample_t sample;
+	int32_t sum[3];
+	int32_t xyz[3];
+	size_t i, n;
 
 	I2C.pComHandle = (sensor_comm_handle_t*) &I2cHandle;
 
@@ -358,14 +1074,43 @@ static eCommandResult_T ConsoleCommandAccData(const char buffer[]){
 		mma865x_configure(&I2C, MMA865x_ODR_6P25_HZ, MMA865x_ACCEL_NORMAL, MMA865x_ACCEL_14BIT_READ_POLL_MODE);
 		mma865x_write_reg(&I2C, MMA865x_XYZ_DATA_CFG, MMA865x_XYZ_DATA_CFG_FS_2G, (uint8_t *) MMA865x_XYZ_DATA_CFG_FS_MASK);
 		endTick = HAL_GetTick() + (tsec * 1000);
+		acc_ring_reset(&accRing);
+		outlier3_init(&accOutlier, ACC_OUTLIER_LEN, OUTLIER_NSIGMA, ACC_OUTLIER_SCALE);
 		/* Read samples in polling mode (no int) */
 		while(HAL_GetTick() < endTick)
 		{
 			memset(linebuf, 0x00, 120);
-			mma865x_read_data(&I2C, MMA865x_ACCEL_14BIT_DATAREAD, &accBuf);
+			if (mma865x_read_data(&I2C, MMA865x_ACCEL_14BIT_DATAREAD, &accBuf) != SENSOR_SUCCESS){
+				ConsoleIoSendString("Read error\r\n");
+				HAL_Delay(100);
+				continue;
+			}
 			convertAccData(accBuf, &x, &y, &z, 2);
 			sprintf(linebuf, "X:%08X Y:%08X Z:%08X - X:%09.6f Y:%09.6f Z:%09.6f\r\n", accBuf.accel[0], accBuf.accel[1], accBuf.accel[2], x, y, z);
 			ConsoleIoSendString(linebuf);
+			// glitches are replaced by the medians before they reach the average
+			xyz[0] = accBuf.accel[0];
+			xyz[1] = accBuf.accel[1];
+			xyz[2] = accBuf.accel[2];
+			if (outlier3_put(&accOutlier, xyz)){
+				ConsoleIoSendString("  outlier, replaced by the median\r\n");
+			}
+			// moving average over the last ACC_AVG_LEN samples
+			sample.x = (int16_t) xyz[0];
+			sample.y = (int16_t) xyz[1];
+			sample.z = (int16_t) xyz[2];
+			acc_ring_put(&accRing, sample);
+			sum[0] = sum[1] = sum[2] = 0;
+			n = acc_ring_size(&accRing);
+			for (i = 0; i < n; i++){
+				acc_ring_at(&accRing, i, &sample);
+				sum[0] += sample.x;
+				sum[1] += sample.y;
+				sum[2] += sample.z;
+			}
+			sprintf(linebuf, "  avg(%u) X:%09.6f Y:%09.6f Z:%09.6f\r\n", (unsigned)n,
+					(float)sum[0] / n / (1 << 11) * 2, (float)sum[1] / n / (1 << 11) * 2, (float)sum[2] / n / (1 << 11) * 2);
+			ConsoleIoSendString(linebuf);
 			HAL_Delay(100);
 		}
 	}
@@ -452,11 +1197,13 @@ static eCommandResult_T ConsoleCommandBaroPresent(const char buffer[]){
 	lps28dfw_stat_t status;
 	lps28dfw_all_sources_t all_sources;
 	char strbuf[100];
-	static lps28dfw_data_t data;
-	lps28dfw_md_t md;
+	bdata_t data;
 
 	id.whoami = 0;
 
+	if (baro_bench_busy()){
+		return COMMAND_ERROR;
+	}
 	dev_ctx = lps28dfw_init();
 	/* Check device ID */
 	lps28dfw_id_get(&dev_ctx, &id);
@@ -522,8 +1269,8 @@ static eCommandResult_T ConsoleCommandBaroPresent(const char buffer[]){
         ConsoleIoSendString(strbuf);
 
         memset(strbuf, 0, 100);
-        lps28dfw_data_get(&dev_ctx, &md, &data);
-        sprintf(strbuf, "pressure [hPa]:%6.2f temperature [degC]:%6.2f\r\n", data.pressure.hpa, data.heat.deg_c);
+        data = barometer_data();
+        sprintf(strbuf, "pressure [Pa]:%ld temperature [0.01 degC]:%d\r\n", data.pa, data.centi_c);
         ConsoleIoSendString(strbuf);
 
 	} else {
@@ -547,11 +1294,15 @@ static eCommandResult_T ConsoleCommandBaroData(const char buffer[]){
 	lps28dfw_bus_mode_t bus_mode;
 	lps28dfw_stat_t status;
 	lps28dfw_pin_int_route_t int_route;
+	lps28dfw_fifo_md_t fifo_md;
 	lps28dfw_md_t md;
 	char strbuf[100];
 	int16_t tsec;
-	static lps28dfw_data_t data;
+	bdata_t data;
 
+	if (baro_bench_busy()){
+		return COMMAND_ERROR;
+	}
 	dev_ctx = lps28dfw_init();
 
 	result = ConsoleReceiveParamInt16(buffer, 1, &tsec);
@@ -573,7 +1324,10 @@ static eCommandResult_T ConsoleCommandBaroData(const char buffer[]){
 		/* Set bdu and if_inc recommended for driver usage */
 		lps28dfw_init_set(&dev_ctx, LPS28DFW_DRV_RDY);
 
-		lps28dfw_fifo_mode_set(&dev_ctx, (lps28dfw_fifo_md_t *) LPS28DFW_STREAM);
+		/* Single values are polled, no FIFO */
+		fifo_md.operation = LPS28DFW_BYPASS;
+		fifo_md.watermark = 0;
+		lps28dfw_fifo_mode_set(&dev_ctx, &fifo_md);
 
 		/* Select bus interface */
 		bus_mode.filter = LPS28DFW_AUTO;
@@ -599,8 +1353,8 @@ static eCommandResult_T ConsoleCommandBaroData(const char buffer[]){
 		{
 			lps28dfw_all_sources_get(&dev_ctx, &all_sources);
 			    if (all_sources.drdy_pres | all_sources.drdy_temp ) {
-					lps28dfw_data_get(&dev_ctx, &md, &data);
-					sprintf(strbuf, "pressure [hPa]:%6.2f temperature [degC]:%6.2f\r\n", data.pressure.hpa, data.heat.deg_c);
+					data = barometer_data();
+					sprintf(strbuf, "pressure [Pa]:%ld temperature [0.01 degC]:%d\r\n", data.pa, data.centi_c);
 					ConsoleIoSendString(strbuf);
 			    } else {
 			    	sprintf(strbuf, "pressure data:%i | temperature data:%i\r\n", all_sources.drdy_pres, all_sources.drdy_temp);
@@ -610,6 +1364,10 @@ static eCommandResult_T ConsoleCommandBaroData(const char buffer[]){
 			HAL_Delay(500);
 		}
 
+		// back to the acquisition used by the main loop
+		barometer_init();
+		barometer_resume();
+
 		return COMMAND_SUCCESS;
 	}
 
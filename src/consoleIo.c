@@ -68,6 +68,18 @@ eConsoleError ConsoleIoSendString(const char *buffer)
 	return CONSOLE_SUCCESS;
 }
 
+/**
+ * Sends binary data, may contain zero bytes
+ * stdout is not buffered, the bytes go out in order with the strings
+ */
+eConsoleError ConsoleIoSendBytes(const uint8_t *buffer, const uint32_t length)
+{
+	if (fwrite(buffer, 1, length, stdout) != length){
+		return CONSOLE_ERROR;
+	}
+	return CONSOLE_SUCCESS;
+}
+
 /*
  * This function gets called after completion of RX cycle on UART
  */
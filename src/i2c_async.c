@@ -0,0 +1,447 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "i2c_async.h"
+#include "spsc_ring.h"
+#ifdef I2C_PROF
+#include "i2c_prof.h"
+#endif
+
+// Completions in flight from the interrupt, one transfer is on the bus at a
+// time so a few slots are plenty
+#define DONE_RING_LEN 4
+
+#if (I2C_ASYNC_QUEUE_LEN & (I2C_ASYNC_QUEUE_LEN - 1)) != 0
+#error "I2C_ASYNC_QUEUE_LEN must be a power of two"
+#endif
+
+// Bus profiler hooks, nothing without I2C_PROF
+#ifdef I2C_PROF
+#define PROF_SUBMIT(x) ((x)->stamp = i2c_prof_stamp())
+#define PROF_FINISH(x, status) i2c_prof_record((x)->addr, (x)->len, (status), (x)->stamp)
+#else
+#define PROF_SUBMIT(x) ((void)0)
+#define PROF_FINISH(x, status) ((void)0)
+#endif
+
+// Completions held back while i2c_async_transfer() waits, a transaction stays
+// pending until its callback runs so every one is in here at most once
+#define DEFERRED_LEN ((I2C_ASYNC_PRIO_LEVELS * (I2C_ASYNC_QUEUE_LEN + 1)) + 1)
+
+// Result of a transfer, tagged with the sequence number of the transfer it
+// belongs to so a late completion of an aborted transfer is not taken for
+// the one started after it
+typedef struct
+{
+	uint32_t seq;
+	int32_t status;
+} done_t;
+
+// Completed transaction whose callback waits for the superloop
+typedef struct
+{
+	i2c_async_xfer_t* xfer;
+	uint8_t status;
+} deferred_t;
+
+// Transactions of a priority class. A chunked transaction waits in resume
+// between its parts, ahead of the queue, so it keeps its place in the class.
+typedef struct
+{
+	i2c_async_xfer_t* slot[I2C_ASYNC_QUEUE_LEN];
+	uint32_t head;                      // next slot to fill
+	uint32_t tail;                      // oldest queued transaction
+	i2c_async_xfer_t* resume;
+} queue_t;
+
+static const uint32_t deadline[I2C_ASYNC_PRIO_LEVELS] = {
+	I2C_ASYNC_DEADLINE_TOUCH,
+	I2C_ASYNC_DEADLINE_SENSOR,
+	I2C_ASYNC_DEADLINE_BACKGROUND,
+};
+
+static const i2c_async_ctx_t* bus;
+static queue_t queue[I2C_ASYNC_PRIO_LEVELS];
+static uint32_t pending;                // transactions queued or waiting to resume
+static uint8_t dev_addr[I2C_ASYNC_DEVICES];
+static uint8_t dev_prio[I2C_ASYNC_DEVICES];
+static uint8_t devices;
+static i2c_async_xfer_t* active;        // transaction on the bus
+static i2c_async_xfer_t part;           // the part of it the bus driver works on
+static volatile uint32_t active_seq;
+static done_t done_buf[DONE_RING_LEN];
+static spsc_ring_t done_ring;
+static uint8_t in_callback;
+static uint8_t in_wait;                 // i2c_async_transfer() is waiting
+static deferred_t deferred[DEFERRED_LEN];
+static uint32_t deferred_count;
+static i2c_async_stats_t stats;
+
+//#pragma mark - Private Functions -
+
+static uint8_t prio_of(uint8_t addr)
+{
+	uint8_t i;
+
+	for(i = 0; i < devices; i++)
+	{
+		if(dev_addr[i] == (addr & 0xFE))
+		{
+			return dev_prio[i];
+		}
+	}
+	return I2C_ASYNC_PRIO_BACKGROUND;
+}
+
+static bool queue_full(uint8_t prio)
+{
+	return (queue[prio].head - queue[prio].tail) >= I2C_ASYNC_QUEUE_LEN;
+}
+
+// Hand a transaction back to its owner
+static void dispatch(i2c_async_xfer_t* x, uint8_t status)
+{
+	x->status = status;
+	if(x->done != NULL)
+	{
+		in_callback++;
+		x->done(x);
+		in_callback--;
+	}
+}
+
+// Account a completed transaction and dispatch it, while i2c_async_transfer()
+// waits the callbacks are kept for the next i2c_async_poll() of the superloop
+// Returns 1 if the transaction was dispatched
+static uint32_t finish(i2c_async_xfer_t* x, uint8_t status)
+{
+	i2c_async_class_stats_t* cls = &stats.cls[x->prio];
+	uint32_t latency = bus->tick() - x->queued;
+
+	pending--;
+	stats.completed++;
+	cls->completed++;
+	if(status == I2C_ASYNC_ERROR)
+	{
+		stats.errors++;
+	}
+	else if(status == I2C_ASYNC_TIMEOUT_ERR)
+	{
+		stats.timeouts++;
+	}
+	if(latency > deadline[x->prio])
+	{
+		cls->late++;
+	}
+	if(latency > cls->latency_max)
+	{
+		cls->latency_max = latency;
+	}
+	PROF_FINISH(x, status);
+
+	if(in_wait && (x->done != NULL))
+	{
+		assert(deferred_count < DEFERRED_LEN);
+		deferred[deferred_count].xfer = x;
+		deferred[deferred_count].status = status;
+		deferred_count++;
+		return 0;
+	}
+	dispatch(x, status);
+	return 1;
+}
+
+// Run the callbacks held back during a blocking transfer, in completion order
+static uint32_t run_deferred(void)
+{
+	uint32_t i;
+	uint32_t n = deferred_count;
+
+	// a callback cannot defer again, nothing waits while it runs
+	for(i = 0; i < n; i++)
+	{
+		dispatch(deferred[i].xfer, deferred[i].status);
+	}
+	deferred_count = 0;
+
+	return n;
+}
+
+// Oldest transaction of the highest class waiting, NULL if there is none
+static i2c_async_xfer_t* take_next(void)
+{
+	i2c_async_xfer_t* x;
+	queue_t* q;
+	uint8_t p;
+
+	for(p = 0; p < I2C_ASYNC_PRIO_LEVELS; p++)
+	{
+		q = &queue[p];
+		if(q->resume != NULL)
+		{
+			x = q->resume;
+			q->resume = NULL;
+			return x;
+		}
+		if(q->tail != q->head)
+		{
+			x = q->slot[q->tail & (I2C_ASYNC_QUEUE_LEN - 1)];
+			q->tail++;
+			return x;
+		}
+	}
+	return NULL;
+}
+
+// Start transactions until one is on the bus or nothing is waiting
+static void start_next(void)
+{
+	i2c_async_xfer_t* x;
+	uint16_t len;
+
+	while(active == NULL)
+	{
+		x = take_next();
+		if(x == NULL)
+		{
+			return;
+		}
+
+		len = x->len - x->offset;
+		if((x->chunk != 0) && (len > x->chunk))
+		{
+			len = x->chunk;
+		}
+		part = *x;
+		part.buf = x->buf + x->offset;
+		part.len = len;
+
+		x->start = bus->tick();
+		// the interrupt tags its completion with the new sequence number
+		active_seq++;
+		active = x;
+		stats.parts++;
+		if(bus->start(bus->handle, &part) != 0)
+		{
+			active = NULL;
+			finish(x, I2C_ASYNC_ERROR);
+		}
+	}
+}
+
+//#pragma mark - APIs -
+
+void i2c_async_init(const i2c_async_ctx_t* ctx)
+{
+	assert(ctx && ctx->start && ctx->abort && ctx->tick);
+
+	bus = ctx;
+	memset(queue, 0, sizeof(queue));
+	pending = 0;
+	devices = 0;
+	active = NULL;
+	active_seq = 0;
+	in_callback = 0;
+	in_wait = 0;
+	deferred_count = 0;
+	spsc_ring_init(&done_ring, done_buf, sizeof(done_t), DONE_RING_LEN);
+	memset(&stats, 0, sizeof(stats));
+}
+
+int i2c_async_set_priority(uint8_t addr, i2c_async_prio_t prio)
+{
+	uint8_t i;
+
+	if(prio >= I2C_ASYNC_PRIO_LEVELS)
+	{
+		return -1;
+	}
+	addr &= 0xFE;
+	for(i = 0; i < devices; i++)
+	{
+		if(dev_addr[i] == addr)
+		{
+			break;
+		}
+	}
+	if(i == I2C_ASYNC_DEVICES)
+	{
+		return -1;
+	}
+	dev_addr[i] = addr;
+	dev_prio[i] = (uint8_t)prio;
+	if(i == devices)
+	{
+		devices++;
+	}
+
+	return 0;
+}
+
+int i2c_async_submit(i2c_async_xfer_t* xfer)
+{
+	queue_t* q;
+	uint32_t depth;
+	uint8_t prio;
+
+	assert(bus && xfer && xfer->buf && xfer->len);
+
+	if(xfer->status == I2C_ASYNC_PENDING)
+	{
+		return -1;
+	}
+	prio = prio_of(xfer->addr);
+	q = &queue[prio];
+	if(queue_full(prio))
+	{
+		stats.rejected++;
+		stats.cls[prio].rejected++;
+		return -1;
+	}
+
+	xfer->status = I2C_ASYNC_PENDING;
+	xfer->prio = prio;
+	xfer->offset = 0;
+	xfer->queued = bus->tick();
+	PROF_SUBMIT(xfer);
+	q->slot[q->head & (I2C_ASYNC_QUEUE_LEN - 1)] = xfer;
+	q->head++;
+	pending++;
+	stats.submitted++;
+	stats.cls[prio].submitted++;
+	depth = q->head - q->tail;
+	if(depth > stats.cls[prio].max_depth)
+	{
+		stats.cls[prio].max_depth = (uint8_t)depth;
+	}
+	if(pending > stats.max_depth)
+	{
+		stats.max_depth = (uint8_t)pending;
+	}
+
+	start_next();
+
+	return 0;
+}
+
+void i2c_async_complete(int32_t status)
+{
+	done_t d;
+
+	d.seq = active_seq;
+	d.status = status;
+	spsc_ring_push(&done_ring, &d);
+}
+
+uint32_t i2c_async_poll(void)
+{
+	i2c_async_xfer_t* x;
+	done_t d;
+	uint32_t n = 0;
+
+	assert(bus);
+
+	if(!in_wait)
+	{
+		n += run_deferred();
+	}
+
+	while(spsc_ring_pop(&done_ring, &d))
+	{
+		if((active == NULL) || (d.seq != active_seq))
+		{
+			stats.stale++;
+			continue;
+		}
+		x = active;
+		active = NULL;
+		if(d.status != 0)
+		{
+			n += finish(x, I2C_ASYNC_ERROR);
+		}
+		else
+		{
+			x->offset += part.len;
+			if(x->offset < x->len)
+			{
+				// the next part goes after the higher classes waiting
+				queue[x->prio].resume = x;
+			}
+			else
+			{
+				n += finish(x, I2C_ASYNC_DONE);
+			}
+		}
+		start_next();
+	}
+
+	if((active != NULL) && ((bus->tick() - active->start) > I2C_ASYNC_TIMEOUT))
+	{
+		x = active;
+		active = NULL;
+		// a completion that still arrives belongs to no transaction
+		active_seq++;
+		bus->abort(bus->handle);
+		n += finish(x, I2C_ASYNC_TIMEOUT_ERR);
+	}
+
+	start_next();
+
+	return n;
+}
+
+int32_t i2c_async_transfer(uint8_t addr, uint8_t reg, uint8_t write, uint8_t* buf, uint16_t len)
+{
+	i2c_async_xfer_t x;
+	int ret;
+
+	// a callback runs in the middle of its owner's work, it must not wait
+	assert(in_callback == 0);
+
+	memset(&x, 0, sizeof(x));
+	x.addr = addr;
+	x.reg = reg;
+	x.write = write;
+	x.buf = buf;
+	x.len = len;
+
+	// the bus is serviced while waiting, the callbacks of the other
+	// transactions are left to the superloop: the caller may be inside
+	// LVGL or in the middle of a register sequence
+	in_wait++;
+	// a full class drains on its own, the oldest transaction times out at worst
+	while(queue_full(prio_of(addr)))
+	{
+		i2c_async_poll();
+	}
+	ret = i2c_async_submit(&x);
+	// the loop above made room in the class, a refused transfer would leave buf untouched
+	assert(ret == 0);
+	if(ret != 0)
+	{
+		in_wait--;
+		return -1;
+	}
+	while(x.status == I2C_ASYNC_PENDING)
+	{
+		i2c_async_poll();
+	}
+	in_wait--;
+
+	return (x.status == I2C_ASYNC_DONE) ? 0 : -1;
+}
+
+bool i2c_async_idle(void)
+{
+	return (active == NULL) && (pending == 0) && (deferred_count == 0);
+}
+
+void i2c_async_get_stats(i2c_async_stats_t* out)
+{
+	assert(out);
+
+	*out = stats;
+}
@@ -0,0 +1,128 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "i2c_prof.h"
+#include "i2c_async.h"
+
+static const i2c_prof_ctx_t* counter;
+static i2c_prof_device_t devices[I2C_PROF_DEVICES];
+static uint8_t device_count;
+static uint32_t others;
+
+//#pragma mark - Private Functions -
+
+static i2c_prof_device_t* find(uint8_t addr)
+{
+	uint8_t i;
+
+	// the R/W bit is not part of the address
+	addr &= 0xFE;
+	for(i = 0; i < device_count; i++)
+	{
+		if(devices[i].addr == addr)
+		{
+			return &devices[i];
+		}
+	}
+	if(device_count >= I2C_PROF_DEVICES)
+	{
+		return NULL;
+	}
+	devices[device_count].addr = addr;
+	return &devices[device_count++];
+}
+
+// Bucket of a latency, the number of significant bits
+static uint8_t bucket(uint32_t us)
+{
+	uint8_t b = 0;
+
+	while((us != 0) && (b < (I2C_PROF_BUCKETS - 1)))
+	{
+		us >>= 1;
+		b++;
+	}
+	return b;
+}
+
+//#pragma mark - APIs -
+
+void i2c_prof_init(const i2c_prof_ctx_t* ctx)
+{
+	assert(ctx && ctx->cycles && ctx->cycles_per_us);
+
+	counter = ctx;
+	i2c_prof_reset();
+}
+
+uint32_t i2c_prof_stamp(void)
+{
+	return (counter != NULL) ? counter->cycles() : 0;
+}
+
+void i2c_prof_record(uint8_t addr, uint16_t len, uint8_t status, uint32_t stamp)
+{
+	i2c_prof_device_t* d;
+	uint32_t us;
+
+	if(counter == NULL)
+	{
+		return;
+	}
+	d = find(addr);
+	if(d == NULL)
+	{
+		others++;
+		return;
+	}
+
+	us = (counter->cycles() - stamp) / counter->cycles_per_us;
+	d->transactions++;
+	if(status == I2C_ASYNC_DONE)
+	{
+		d->bytes += len;
+	}
+	else if(status == I2C_ASYNC_TIMEOUT_ERR)
+	{
+		d->timeouts++;
+	}
+	else
+	{
+		d->errors++;
+	}
+	d->latency_sum += us;
+	if(us > d->latency_max)
+	{
+		d->latency_max = us;
+	}
+	d->hist[bucket(us)]++;
+}
+
+uint8_t i2c_prof_get(i2c_prof_device_t* out, uint8_t max)
+{
+	uint8_t n = (device_count < max) ? device_count : max;
+
+	assert(out || (max == 0));
+
+	memcpy(out, devices, n * sizeof(i2c_prof_device_t));
+	return n;
+}
+
+uint32_t i2c_prof_others(void)
+{
+	return others;
+}
+
+void i2c_prof_reset(void)
+{
+	memset(devices, 0, sizeof(devices));
+	device_count = 0;
+	others = 0;
+}
+
+uint32_t i2c_prof_bucket_us(uint8_t b)
+{
+	return (b == 0) ? 0 : (1ul << (b - 1));
+}
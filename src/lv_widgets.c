@@ -46,6 +46,7 @@ static lv_style_t style_icon;
 static lv_style_t style_bullet;
 
 static lv_obj_t * meter3;
+static lv_obj_t * forecast_label;
 
 lv_meter_indicator_t *indic;
 
@@ -154,8 +155,13 @@ void lv_rotate_screen(lv_disp_rot_t rot){
 	lv_disp_set_rotation(lv_disp_get_default(), rot);
 }
 
-void set_barometer_value(float bvalue){
-	lv_meter_set_indicator_value(meter3, indic, round(bvalue));
+void set_barometer_value(int32_t pa){
+	// meter is in whole hPa
+	lv_meter_set_indicator_value(meter3, indic, (pa + 50) / 100);
+}
+
+void set_forecast(char letter, const char * text){
+	lv_label_set_text_fmt(forecast_label, "%c - %s", letter, text);
 }
 
 static void event_cb(lv_event_t * e)
@@ -243,6 +249,22 @@ static void pressure_create(lv_obj_t * parent)
 	// Set indicator to minimum pressure for start
 	lv_meter_set_indicator_value(meter3, indic, 930);
 
+	// Zambretti forecast below the meter
+	lv_obj_t * forecast_cont = lv_obj_create(parent);
+	lv_obj_set_height(forecast_cont, LV_SIZE_CONTENT);
+	lv_obj_set_flex_grow(forecast_cont, 1);
+	lv_obj_set_flex_flow(forecast_cont, LV_FLEX_FLOW_COLUMN);
+	lv_obj_add_flag(forecast_cont, LV_OBJ_FLAG_FLEX_IN_NEW_TRACK);
+
+	lv_obj_t * forecast_title = lv_label_create(forecast_cont);
+	lv_label_set_text(forecast_title, "Forecast");
+	lv_obj_add_style(forecast_title, &style_title, 0);
+
+	forecast_label = lv_label_create(forecast_cont);
+	lv_label_set_long_mode(forecast_label, LV_LABEL_LONG_WRAP);
+	lv_obj_set_width(forecast_label, LV_PCT(100));
+	lv_label_set_text(forecast_label, "Collecting data");
+
 	lv_obj_update_layout(parent);
 
 	lv_coord_t meter_w = lv_obj_get_width(meter3);
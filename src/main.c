@@ -21,33 +21,85 @@
 #include "console.h"
 #include "retarget.h"
 #include "Drivers/barometer.h"
+#include "Drivers/int_flash.h"
+#include "Drivers/i2c_dma.h"
 #include "Drivers/MMA8652/mma865x_driver.h"
 #include "Drivers/MMA8652/mma865x_regdef.h"
-#include "circular_buffer.h"
+#include "mem_pool.h"
+#include "press_stats.h"
+#include "press_history.h"
+#include "press_store.h"
+#include "press_tendency.h"
+#include "zambretti.h"
+#include "press_slp.h"
+#include "press_motion.h"
+#include "press_pipeline.h"
+#include "i2c_async.h"
 #include "main.h"
 
 UART_HandleTypeDef huart1;
 bdata_t bdata;
 volatile uint16_t delayTime = 100;
 
-// buffer containing the barometer values
-uint16_t * buffer;
-// handle for circular buffer
-cbuf_handle_t me;
+// flash interface of the persistent pressure log
+press_store_ctx_t store_ctx;
+
+// DMA interface of the sensor transactions
+i2c_async_ctx_t i2c_ctx;
+#ifdef I2C_PROF
+// cycle counter of the bus profiler
+i2c_prof_ctx_t prof_ctx;
+#endif
+
+// sample pipeline of the barometer, the host tools replay traces through the same one
+static const press_pipeline_cfg_t pipeline_cfg = {
+	.period_s = BAROMETER_LOG_INTERVAL,
+	.outlier_len = BAROMETER_OUTLIER_LEN,
+	.outlier_scale = BAROMETER_OUTLIER_SCALE,
+	.slope_window = PRESS_WINDOW_3H,
+	.filter_rate = false,
+	.tendency = NULL,
+	.filter = NULL,
+};
 
 // screen rotation constants
 volatile lv_disp_rot_t rotation;
 volatile bool screen_rotated;
 uint8_t orientation;
 
+// set by the accelerometer transient interrupt while the station is handled
+volatile bool acc_motion;
+
+// set by the barometer INT pin once the FIFO holds a batch, a one-shot conversion is done
+// or the pressure moved beyond the wake threshold
+volatile bool baro_data_ready;
+// a sample was handled, the wake reference is taken again from the main loop
+static bool baro_rearm;
+// nominal time of the next log sample in ms, one sample per BAROMETER_LOG_INTERVAL (log_slot_open())
+static uint32_t logTick;
+// log slots taken without a reading while the settings sweep ("bb") has the sensor
+uint16_t benchHeld;
+
 // Accelerometer I2C driver
 mma865x_driver_t I2C;
 
 bool warnShown = false;
 
+// month used by the forecast for the seasonal correction, 0 if not set
+uint8_t forecastMonth = 0;
+
 static void SystemClock_Config(void);
 static void MX_USART1_UART_Init(void);
-static bool get_press_trend(void);
+static void update_forecast(uint32_t pa);
+static void show_sample(const press_pipeline_result_t * res);
+static void chart_put(uint8_t tiers);
+static void restore_sample(uint16_t bval);
+static bool log_slot_open(void);
+static void log_slot_next(void);
+static void baro_batch_done(bdata_t data);
+static void baro_early_done(bdata_t data);
+static void bench_gap(void);
+static void acc_event_done(mma865x_event_type_t eventType, uint8_t status, uint8_t eventVal);
 void Error_Handler(void);
 
 int main(void)
@@ -55,12 +107,16 @@ int main(void)
 	uint32_t minTick;
 	uint32_t lastMov = 0;
 	uint8_t eventVal;
-	uint16_t bval;
+	bool early;
 
 	HAL_Init();
 
-	buffer  = malloc(BAROMETER_BUFFER_SIZE * sizeof(uint8_t));
-	me = circular_buf_init(buffer, BAROMETER_BUFFER_SIZE);
+	// all buffers come from the static pools, nothing is taken from the heap
+	mem_pool_init();
+	press_slp_set_altitude(BAROMETER_ALTITUDE);
+	if (press_pipeline_init(&pipeline_cfg) != 0){
+		Error_Handler();
+	}
 
 	I2C.pComHandle = (sensor_comm_handle_t*) &I2cHandle;
 
@@ -84,28 +140,70 @@ int main(void)
 	lv_init();
 
 	tft_init();
+
+	// from here on the touch controller and the sensor drivers share the bus
+	// through the transaction queue, touch first as the UI waits for it
+	i2c_ctx = i2c_dma_init();
+#ifdef I2C_PROF
+	prof_ctx = i2c_dma_prof_init();
+	i2c_prof_init(&prof_ctx);
+#endif
+	i2c_async_init(&i2c_ctx);
+	i2c_async_set_priority(TS_I2C_ADDRESS, I2C_ASYNC_PRIO_TOUCH);
+	i2c_async_set_priority(MMA865x_I2C_ADDRESS_WRITE, I2C_ASYNC_PRIO_SENSOR);
+	i2c_async_set_priority(LPS28DFW_I2C_ADD_H, I2C_ASYNC_PRIO_BACKGROUND);
 	touchpad_init();
 
 	lv_widgets();
 
+	// refill the history from the persistent log so the trend survives a reset
+	store_ctx = int_flash_init();
+	if (press_store_init(&store_ctx) == 0){
+		press_store_recover(restore_sample, PRESS_STATS_MAX_WINDOW);
+	}
+
 	RetargetInit(&huart1);
 	ConsoleInit(&huart1);
 	barometer_init();
 
-	// immediately get barometer value
-	minTick = 0;
 	// switch off LED3 (green)
 	BSP_LED_Off(LED3);
 
 	// set the barometer value
 	bdata = barometer_data();
-	set_barometer_value(bdata.hpa);
+	set_barometer_value(press_slp_reduce(bdata.pa, bdata.centi_c));
+	// from now on the samples are collected by the FIFO or by one-shot conversions,
+	// the FIFO is set up in any case for a switch with the "bm" command
+	baro_data_ready = false;
+	if (barometer_fifo_start(BAROMETER_FIFO_WATERMARK) != 0){
+		Error_Handler();
+	}
+	baro_rearm = false;
+	minTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000) + BAROMETER_FIFO_GRACE;
+	if (BAROMETER_ACQ_MODE == BAROMETER_ONESHOT){
+		if (barometer_oneshot_start(BAROMETER_ONESHOT_AVG) != 0){
+			Error_Handler();
+		}
+		minTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000);
+	}
+	logTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000);
+	// in one-shot mode the threshold is kept and armed by a switch to the FIFO ("bm 0")
+	if ((BAROMETER_WAKE_THRESHOLD != 0) && (barometer_wake_start(BAROMETER_WAKE_THRESHOLD) != 0)){
+		Error_Handler();
+	}
 
 	// initialize the accelerometer orientation detection mode
 	mma865x_init(&I2C);
 	mma865x_set_embedded_function(&I2C, MMA865x_ORIENT_DETECTION_MODE);
 	screen_rotated = true;
 	mma865x_read_event(&I2C, MMA865x_ORIENTATION, &eventVal);
+	// handling of the station is reported on INT2 by the transient function
+	mma865x_set_embedded_function(&I2C, MMA865x_TRANSIENT_DETECTION_MODE);
+	acc_motion = false;
+	mma865x_read_event(&I2C, MMA865x_TRANSIENT, &eventVal);
+
+	// boot is done, no more allocations from the pools
+	mem_pool_seal();
 
 	// Superloop
 	while (1)
@@ -113,52 +211,74 @@ int main(void)
 		HAL_Delay(3);
 		lv_task_handler();
 		ConsoleProcess();
-
-		// Sample barometer every minute
-		if (minTick < HAL_GetTick()){
-			bdata = barometer_data();
-			set_barometer_value(bdata.hpa);
-			minTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000);
-			// convert float into uint16_t for storing variable into a buffer
-			// value is stored as a uint16_t integer by subtracting 900 and multiplying
-			bval = (uint16_t) ((bdata.hpa - 900)  * 100);
-			circular_buf_put(me, bval);
-			lv_add_baro_value((uint16_t) bdata.hpa);
-			// calculate pressure trend and if needed send alarm
-			get_press_trend();
+		// completed sensor transactions, runs their callbacks
+		i2c_async_poll();
+
+		// Barometer sample every minute, the data is read on DMA and handled in baro_batch_done()
+		// FIFO: the batch is signalled by the watermark or early by the wake threshold,
+		// the tick is a fallback in case the interrupt is lost
+		// one-shot: the tick starts the conversion, its end is signalled by data ready
+		// a batch before the slot of the next sample is only shown, the history keeps its interval
+		// the FIFO holds less than a batch then, the tick takes the sample at its nominal time
+		// the settings sweep of the "bb" command has the sensor for minutes: it takes a step per pass
+		// and its log slots are held (bench_gap()), the acquisition is running again once it is done
+		if (barometer_bench_running()){
+			barometer_bench_step();
+			if ((int32_t) (HAL_GetTick() - logTick) >= 0){
+				bench_gap();
+			}
+		} else if (baro_data_ready){
+			early = !log_slot_open();
+			if (barometer_batch_async(early ? baro_early_done : baro_batch_done) == 0){
+				baro_data_ready = false;
+				if (early){
+					minTick = logTick;
+				} else if (barometer_mode() == BAROMETER_FIFO){
+					minTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000) + BAROMETER_FIFO_GRACE;
+				}
+			}
+		} else if (minTick < HAL_GetTick()){
+			if (barometer_mode() == BAROMETER_ONESHOT){
+				if (barometer_trigger() == 0){
+					minTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000);
+				} else {
+					// the last conversion was not read, data ready was lost
+					baro_data_ready = true;
+				}
+			} else if (barometer_batch_async(log_slot_open() ? baro_batch_done : baro_early_done) == 0){
+				minTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000) + BAROMETER_FIFO_GRACE;
+			}
+		}
+		// the wake reference follows the last sample, the register writes block and cannot run in the callback
+		if (baro_rearm && !barometer_bench_running()){
+			baro_rearm = false;
+			barometer_wake_rearm(NULL);
 		}
 
 		// if no interrupt was detected but the pin is held low then reset the interrupt in accelerometer
 		if ((HAL_GPIO_ReadPin(ACC_INT1_GPIO_Port, ACC_INT1_Pin) == 0) && (!screen_rotated)){
-			mma865x_read_event(&I2C, MMA865x_ORIENTATION, &eventVal);
+			mma865x_read_event_async(&I2C, MMA865x_ORIENTATION, acc_event_done);
 		}
-		// now process the rotation of the screen if rotated
-		if (screen_rotated){
-			lastMov = HAL_GetTick() + 60 * 1000;
-			// Disable orientation interrupt so that it does not interfere here
-			HAL_NVIC_DisableIRQ(EXTI9_5_IRQn);
-			mma865x_read_event(&I2C, MMA865x_ORIENTATION, &orientation);
-			if (eventVal != 0){
-				switch (eventVal){
-				case MMA865x_PORTRAIT_UP:
-					lv_rotate_screen(LV_DISP_ROT_90);
-					break;
-				case MMA865x_PORTRAIT_DOWN:
-					lv_rotate_screen(LV_DISP_ROT_270);
-					break;
-				case MMA865x_LANDSCAPE_RIGHT:
-					lv_rotate_screen(LV_DISP_ROT_NONE);
-					break;
-				case MMA865x_LANDSCAPE_LEFT:
-					lv_rotate_screen(LV_DISP_ROT_180);
-					break;
-				default:
-					break;
-				}
+		if ((HAL_GPIO_ReadPin(ACC_INT2_GPIO_Port, ACC_INT2_Pin) == 0) && (!acc_motion)){
+			acc_motion = true;
+		}
+		// one register read per event, reading the source releases INT2
+		// a read that cannot be queued yet is retried on the next pass
+		if (acc_motion){
+			acc_motion = false;
+			if (mma865x_read_event_async(&I2C, MMA865x_TRANSIENT, acc_event_done) != SENSOR_SUCCESS){
+				acc_motion = true;
 			}
-			// reset screen rotated variable
+		}
+		// now process the rotation of the screen if rotated, the screen is turned in acc_event_done()
+		if (screen_rotated){
 			screen_rotated = false;
-			HAL_NVIC_EnableIRQ(EXTI9_5_IRQn);
+			if (mma865x_read_event_async(&I2C, MMA865x_ORIENTATION, acc_event_done) == SENSOR_SUCCESS){
+				lastMov = HAL_GetTick() + 60 * 1000;
+				press_motion_event();
+			} else {
+				screen_rotated = true;
+			}
 		}
 
 		if (warnShown){
@@ -169,40 +289,170 @@ int main(void)
 }
 
 /**
- * Calculates the pressure trend for this circular buffer
- * If trend drops more than 4 mb in last 4 hours storm is coming
+ * The history, statistics and filter take one sample per log interval, their windows count samples
+ * The slot of a sample reaches half an interval to both sides of its nominal time: a batch of the
+ * wake threshold in an open slot is the sample of the slot, the watermark follows it one interval
+ * later, before the slot is open it is only shown (baro_early_done())
+ * Returns true if the next sample can be taken
  */
-static bool get_press_trend(void){
-	uint16_t i;
-	float val;
-	float min = 1200.0;
-	float max = 0.0;
-	uint16_t bdata;
-	int rs;
-	// walk the circular buffer and get max and minimum
-	for (i = 1; i < circular_buf_size(me); ++i) {
-		rs = circular_buf_peek(me, &bdata, i);
-		if (rs == -1){
-			break;
-		} else {
-			val = ((float)bdata/100) + 900;
-			if (val < min){
-				min = val;
-			}
-			if (val > max){
-				max = val;
-			}
-		}
+static bool log_slot_open(void){
+	return (int32_t) (HAL_GetTick() - (logTick - ((BAROMETER_LOG_INTERVAL * 1000) / 2))) >= 0;
+}
+
+/**
+ * A sample was taken, the next one is due one interval later
+ */
+static void log_slot_next(void){
+	logTick += BAROMETER_LOG_INTERVAL * 1000;
+	// batches were lost or the mode was switched, the slots start again from this sample
+	if (log_slot_open()){
+		logTick = HAL_GetTick() + (BAROMETER_LOG_INTERVAL * 1000);
+	}
+}
+
+/**
+ * Handles a barometer batch, called from i2c_async_poll() once the FIFO is drained
+ */
+static void baro_batch_done(bdata_t data){
+	press_pipeline_result_t res;
+
+	bdata = data;
+	baro_rearm = true;
+	log_slot_next();
+	// sea-level reduction, motion gate, outlier rejection, filter, history and trend
+	press_pipeline_put(bdata.pa, bdata.centi_c, bdata.valid, &res);
+	show_sample(&res);
+}
+
+/**
+ * Handles a batch of the wake threshold before the slot of the next sample is open
+ * The pressure is shown at once, history, statistics and filter wait for the slot
+ */
+static void baro_early_done(bdata_t data){
+	press_motion_t gate;
+
+	bdata = data;
+	baro_rearm = true;
+	press_motion_get(&gate);
+	// a sample while the station is carried shows the altitude, not the weather
+	if (bdata.valid && !gate.moving){
+		set_barometer_value(press_slp_reduce(bdata.pa, bdata.centi_c) - gate.offset);
 	}
-	// if highest pressure was lower than storm limit
-	if (max >= 1009.144){
-		// if pressure was dropping more than 1 mb per hour storm is coming
-		if ((max - min) >= 4){
-			warnShown = true;
-			return true;
+}
+
+/**
+ * Takes the log slot of a sample while the settings sweep has the sensor
+ * The slot is handled like a failed read: the filter coasts, the history keeps its time base
+ * and the trend is not taken from the coasted samples
+ */
+static void bench_gap(void){
+	press_pipeline_result_t res;
+
+	benchHeld++;
+	log_slot_next();
+	press_pipeline_put(0, 0, false, &res);
+	show_sample(&res);
+}
+
+/**
+ * Handles the accelerometer event registers, called from i2c_async_poll()
+ */
+static void acc_event_done(mma865x_event_type_t eventType, uint8_t status, uint8_t eventVal){
+	if (status != SENSOR_SUCCESS){
+		return;
+	}
+	if (eventType == MMA865x_TRANSIENT){
+		if (eventVal == MMA865x_TRANSIENT_DETECTED){
+			press_motion_event();
 		}
+		return;
+	}
+	if ((eventType != MMA865x_ORIENTATION) || (eventVal == MMA865x_NO_EVENT_DETECTED)){
+		return;
+	}
+	orientation = eventVal;
+	switch (eventVal){
+	case MMA865x_PORTRAIT_UP:
+		lv_rotate_screen(LV_DISP_ROT_90);
+		break;
+	case MMA865x_PORTRAIT_DOWN:
+		lv_rotate_screen(LV_DISP_ROT_270);
+		break;
+	case MMA865x_LANDSCAPE_RIGHT:
+		lv_rotate_screen(LV_DISP_ROT_NONE);
+		break;
+	case MMA865x_LANDSCAPE_LEFT:
+		lv_rotate_screen(LV_DISP_ROT_180);
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+ * Shows a sample of the pipeline and keeps it in the persistent log
+ * The warning is shown once when the falling rate crosses the storm warning threshold
+ */
+static void show_sample(const press_pipeline_result_t * res){
+	// nothing is logged before the first good reading
+	if (res->logged){
+		set_barometer_value(res->pa);
+		press_store_put(res->value);
+		chart_put(res->tiers);
+	}
+	if (res->warning){
+		warnShown = true;
+	}
+	// a held sample carries no new information
+	if (!res->held){
+		update_forecast(res->pa);
+	}
+}
+
+/**
+ * Replays a sample recovered from flash into the RAM history
+ */
+static void restore_sample(uint16_t bval){
+	chart_put(press_pipeline_restore(bval));
+}
+
+/**
+ * The history chart shows the 15 minute tier, a point is added when a tier closes
+ */
+static void chart_put(uint8_t tiers){
+	press_rollup_t rollup;
+
+	if (tiers & (1u << PRESS_TIER_15MIN)){
+		press_history_last(PRESS_TIER_15MIN, &rollup);
+		lv_add_baro_value((uint16_t) ((rollup.mean + 50) / 100 + 900));
+	}
+}
+
+/**
+ * Imports a pressure sample in Pa (e.g. a generated trace sent over the console)
+ * The sample is handled like a measured one: history, flash log, trend and forecast
+ */
+void import_sample(uint32_t pa){
+	press_pipeline_result_t res;
+
+	press_pipeline_import(pa, &res);
+	show_sample(&res);
+}
+
+/**
+ * Shows the Zambretti forecast for the pressure in Pa and the current tendency
+ */
+static void update_forecast(uint32_t pa){
+	press_tendency_t tend;
+	uint8_t code;
+
+	press_tendency_get(&tend);
+	if (tend.updates == 0){
+		// no 3 hour trend yet
+		return;
 	}
-	return false;
+	code = zambretti_forecast((int32_t) pa, tend.change, forecastMonth);
+	set_forecast(zambretti_letter(code), zambretti_text(code));
 }
 
 /**
@@ -321,6 +571,15 @@ void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
+  static volatile bool entered = false;
+
+  /* keep the batched samples, the store ignores this if it is not initialized
+   * the flash driver waits on HAL_GetTick(), so this runs before the interrupts are off
+   * an error raised by the flush itself comes back here and only locks up */
+  if (!entered){
+    entered = true;
+    press_store_flush();
+  }
   __disable_irq();
   while (1)
   {
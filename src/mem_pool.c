@@ -0,0 +1,88 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "mem_pool.h"
+
+_Static_assert(MEM_POOL_SAMPLES_SIZE <= MEM_POOL_BUDGET,
+		"memory pools exceed MEM_POOL_BUDGET");
+_Static_assert((MEM_POOL_SAMPLES_SIZE % MEM_POOL_ALIGN) == 0,
+		"pool sizes must be multiples of MEM_POOL_ALIGN");
+
+// Pool storage, collected by the linker into the .pools section
+static uint8_t pool_samples[MEM_POOL_SAMPLES_SIZE] __attribute__((section(".pool.samples"), aligned(MEM_POOL_ALIGN)));
+
+typedef struct
+{
+	const char* name;
+	uint8_t* base;
+	uint32_t size;
+} pool_def_t;
+
+static const pool_def_t pools[MEM_POOL_COUNT] =
+{
+	[MEM_POOL_SAMPLES] = {"samples", pool_samples, sizeof(pool_samples)},
+};
+
+static uint32_t used[MEM_POOL_COUNT];
+static uint32_t failed[MEM_POOL_COUNT];
+static bool sealed;
+
+//#pragma mark - APIs -
+
+void mem_pool_init(void)
+{
+	uint8_t i;
+
+	// .pools is NOLOAD, the startup code does not clear it
+	for(i = 0; i < MEM_POOL_COUNT; i++)
+	{
+		memset(pools[i].base, 0, pools[i].size);
+		used[i] = 0;
+		failed[i] = 0;
+	}
+	sealed = false;
+}
+
+void* mem_pool_alloc(mem_pool_id_t pool, size_t size)
+{
+	void* p;
+
+	assert(pool < MEM_POOL_COUNT);
+
+	size = (size + (MEM_POOL_ALIGN - 1)) & ~(size_t)(MEM_POOL_ALIGN - 1);
+	if(sealed || (size > (pools[pool].size - used[pool])))
+	{
+		failed[pool]++;
+		return NULL;
+	}
+
+	p = &pools[pool].base[used[pool]];
+	used[pool] += size;
+
+	return p;
+}
+
+void mem_pool_seal(void)
+{
+	sealed = true;
+}
+
+int mem_pool_info(mem_pool_id_t pool, mem_pool_info_t* info)
+{
+	assert(info);
+
+	if(pool >= MEM_POOL_COUNT)
+	{
+		return -1;
+	}
+
+	info->name = pools[pool].name;
+	info->size = pools[pool].size;
+	info->used = used[pool];
+	info->failed = failed[pool];
+
+	return 0;
+}
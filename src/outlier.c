@@ -0,0 +1,211 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "outlier.h"
+
+//#pragma mark - Private Functions -
+
+// Median absolute deviation of a sorted window of odd length, the deviations
+// grow on both sides of the median so the k-th smallest is a two-way merge
+static int32_t mad(const int32_t* s, uint8_t n)
+{
+	uint8_t mid = n / 2;
+	int8_t l = (int8_t)mid - 1;
+	uint8_t r = mid + 1;
+	int32_t d = 0;
+	uint8_t k;
+
+	// the median itself is the smallest deviation
+	for(k = 0; k < mid; k++)
+	{
+		if((r >= n) || ((l >= 0) && ((s[mid] - s[l]) <= (s[r] - s[mid]))))
+		{
+			d = s[mid] - s[l];
+			l--;
+		}
+		else
+		{
+			d = s[r] - s[mid];
+			r++;
+		}
+	}
+
+	return d;
+}
+
+// Replace old by value in the sorted window, count elements
+static void sorted_replace(int32_t* s, uint8_t count, int32_t old, int32_t value)
+{
+	uint8_t i = 0;
+
+	while((i < count) && (s[i] != old))
+	{
+		i++;
+	}
+	assert(i < count);
+
+	// shift towards the hole until value fits
+	while((i > 0) && (s[i - 1] > value))
+	{
+		s[i] = s[i - 1];
+		i--;
+	}
+	while(((i + 1) < count) && (s[i + 1] < value))
+	{
+		s[i] = s[i + 1];
+		i++;
+	}
+	s[i] = value;
+}
+
+static void sorted_insert(int32_t* s, uint8_t count, int32_t value)
+{
+	uint8_t i = count;
+
+	while((i > 0) && (s[i - 1] > value))
+	{
+		s[i] = s[i - 1];
+		i--;
+	}
+	s[i] = value;
+}
+
+//#pragma mark - APIs -
+
+int outlier_init(outlier_t* o, uint8_t len, uint8_t nsigma, int32_t min_scale)
+{
+	assert(o);
+
+	if((len < OUTLIER_WINDOW_MIN) || (len > OUTLIER_WINDOW_MAX) || ((len & 1) == 0) ||
+			(nsigma == 0) || (min_scale < 0))
+	{
+		return -1;
+	}
+
+	o->len = len;
+	o->count = 0;
+	o->pos = 0;
+	o->nsigma = nsigma;
+	o->min_scale = min_scale;
+	o->samples = 0;
+	o->rejected = 0;
+
+	return 0;
+}
+
+bool outlier_put(outlier_t* o, int32_t* value)
+{
+	int32_t median;
+	int32_t scale;
+	int32_t dev;
+	int32_t x;
+	bool reject = false;
+
+	assert(o && value);
+
+	x = *value;
+	o->samples++;
+
+	if(o->count < o->len)
+	{
+		// still filling the window
+		sorted_insert(o->sorted, o->count, x);
+		o->window[o->count++] = x;
+		return false;
+	}
+
+	median = o->sorted[o->len / 2];
+	// 1.4826 * MAD as 95/64
+	scale = ((mad(o->sorted, o->len) * 95) + 32) >> 6;
+	if(scale < o->min_scale)
+	{
+		scale = o->min_scale;
+	}
+	dev = (x > median) ? (x - median) : (median - x);
+	if(dev > (scale * o->nsigma))
+	{
+		reject = true;
+		o->rejected++;
+		*value = median;
+	}
+
+	// the raw sample replaces the oldest one
+	sorted_replace(o->sorted, o->len, o->window[o->pos], x);
+	o->window[o->pos] = x;
+	o->pos = (uint8_t)((o->pos + 1) % o->len);
+
+	return reject;
+}
+
+int32_t outlier_median(const outlier_t* o)
+{
+	assert(o);
+
+	if(o->count == 0)
+	{
+		return 0;
+	}
+
+	return o->sorted[o->count / 2];
+}
+
+void outlier_clear(outlier_t* o)
+{
+	assert(o);
+
+	o->count = 0;
+	o->pos = 0;
+}
+
+int outlier3_init(outlier3_t* o, uint8_t len, uint8_t nsigma, int32_t min_scale)
+{
+	uint8_t i;
+
+	assert(o);
+
+	for(i = 0; i < 3; i++)
+	{
+		if(outlier_init(&o->axis[i], len, nsigma, min_scale) != 0)
+		{
+			return -1;
+		}
+	}
+	o->samples = 0;
+	o->rejected = 0;
+
+	return 0;
+}
+
+bool outlier3_put(outlier3_t* o, int32_t xyz[3])
+{
+	int32_t in[3];
+	int32_t median[3];
+	bool reject = false;
+	uint8_t i;
+
+	assert(o && xyz);
+
+	o->samples++;
+	for(i = 0; i < 3; i++)
+	{
+		in[i] = xyz[i];
+		median[i] = outlier_median(&o->axis[i]);
+		if(outlier_put(&o->axis[i], &in[i]))
+		{
+			reject = true;
+		}
+	}
+
+	if(reject)
+	{
+		o->rejected++;
+		for(i = 0; i < 3; i++)
+		{
+			xyz[i] = median[i];
+		}
+	}
+
+	return reject;
+}
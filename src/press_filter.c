@@ -0,0 +1,145 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "press_filter.h"
+
+// Covariance limit in Q16 Pa^2, keeps the innovation variance in 32 bits
+#define FILTER_VAR_MAX (1L << 28)
+
+static press_filter_cfg_t cfg;
+static uint16_t per_hour;   // samples per hour
+static int32_t x;           // pressure, Q8 Pa
+static int32_t v;           // rate, Q16 Pa per sample
+static int32_t p00;         // covariance, Q16 Pa^2
+static int32_t p01;
+static int32_t p11;
+static uint32_t updates;
+
+//#pragma mark - Private Functions -
+
+static inline int32_t clamp_var(int64_t p)
+{
+	if(p < 1)
+	{
+		return 1;
+	}
+	if(p > FILTER_VAR_MAX)
+	{
+		return FILTER_VAR_MAX;
+	}
+	return (int32_t)p;
+}
+
+static inline int32_t clamp_cov(int64_t p)
+{
+	if(p < -FILTER_VAR_MAX)
+	{
+		return -FILTER_VAR_MAX;
+	}
+	if(p > FILTER_VAR_MAX)
+	{
+		return FILTER_VAR_MAX;
+	}
+	return (int32_t)p;
+}
+
+//#pragma mark - APIs -
+
+void press_filter_init(const press_filter_cfg_t* config, uint16_t period_s)
+{
+	assert((period_s > 0) && (period_s <= 3600));
+
+	if(config == NULL)
+	{
+		cfg.meas_var = PRESS_FILTER_MEAS_VAR;
+		cfg.press_var = PRESS_FILTER_PRESS_VAR;
+		cfg.rate_var = PRESS_FILTER_RATE_VAR;
+		cfg.rate_var0 = PRESS_FILTER_RATE_VAR0;
+	}
+	else
+	{
+		cfg = *config;
+	}
+	assert((cfg.meas_var > 0) && (cfg.meas_var <= FILTER_VAR_MAX));
+	per_hour = 3600 / period_s;
+
+	press_filter_reset();
+}
+
+void press_filter_reset(void)
+{
+	x = 0;
+	v = 0;
+	p00 = 0;
+	p01 = 0;
+	p11 = 0;
+	updates = 0;
+}
+
+void press_filter_predict(void)
+{
+	if(updates == 0)
+	{
+		return;
+	}
+
+	x += (v + 128) >> 8;
+	// P = F P F' + Q with F = [1 1; 0 1]
+	p00 = clamp_var((int64_t)p00 + (2 * (int64_t)p01) + p11 + cfg.press_var);
+	p01 = clamp_cov((int64_t)p01 + p11);
+	p11 = clamp_var((int64_t)p11 + cfg.rate_var);
+}
+
+int32_t press_filter_update(int32_t pa)
+{
+	uint32_t inv;
+	int32_t k0, k1;
+	int32_t y;
+
+	if(updates == 0)
+	{
+		// the first reading is taken as it is
+		x = pa * 256;
+		v = 0;
+		p00 = (int32_t)cfg.meas_var;
+		p01 = 0;
+		p11 = clamp_var(cfg.rate_var0);
+		updates = 1;
+		return pa;
+	}
+
+	press_filter_predict();
+
+	// gains K = P H' / (H P H' + R), 2^32 / S is the only division
+	inv = 0xFFFFFFFFu / ((uint32_t)p00 + cfg.meas_var);
+	k0 = (int32_t)(((int64_t)p00 * inv) >> 16);
+	k1 = (int32_t)(((int64_t)p01 * inv) >> 16);
+
+	y = (pa * 256) - x;
+	x += (int32_t)((((int64_t)k0 * y) + 32768) >> 16);
+	v += (int32_t)((((int64_t)k1 * y) + 128) >> 8);
+
+	// P = (I - K H) P, p11 needs the old p01
+	p11 = clamp_var((int64_t)p11 - (((int64_t)k1 * p01) >> 16));
+	p01 = clamp_cov((int64_t)p01 - (((int64_t)k0 * p01) >> 16));
+	p00 = clamp_var((int64_t)p00 - (((int64_t)k0 * p00) >> 16));
+	updates++;
+
+	return (x + 128) >> 8;
+}
+
+void press_filter_get(press_filter_t* out)
+{
+	uint64_t rate_var;
+
+	assert(out);
+
+	out->pa = (x + 128) >> 8;
+	out->rate = (int32_t)((((int64_t)v * per_hour) + 32768) >> 16);
+	out->var = (uint32_t)(((int64_t)p00 * 100) >> 16);
+	// grows with the square of the samples per hour, at one per second a large p11 needs 43 bits
+	rate_var = ((uint64_t)p11 * per_hour * per_hour * 100) >> 16;
+	out->rate_var = (rate_var > UINT32_MAX) ? UINT32_MAX : (uint32_t)rate_var;
+	out->updates = updates;
+}
@@ -0,0 +1,175 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "press_history.h"
+
+// Number of 15 minute rollups in one hourly rollup
+#define PRESS_HISTORY_15MIN_PER_HOUR 4
+
+// Rollup accumulator of the tier that is being filled
+typedef struct
+{
+	uint16_t count;
+	uint16_t min;
+	uint16_t max;
+	uint32_t sum;
+} press_accum_t;
+
+// Ring of rollups for a single tier
+typedef struct
+{
+	press_rollup_t* buf;
+	uint16_t cap;
+	uint16_t head;
+	uint16_t size;
+	uint16_t fan_in; // number of inputs per rollup
+	press_accum_t acc;
+} press_tier_ring_t;
+
+static press_rollup_t tier_15min[PRESS_HISTORY_15MIN_LEN];
+static press_rollup_t tier_hour[PRESS_HISTORY_HOUR_LEN];
+
+static press_tier_ring_t tiers[PRESS_TIER_COUNT] =
+{
+	{ tier_15min, PRESS_HISTORY_15MIN_LEN, 0, 0, 0, { 0 } },
+	{ tier_hour, PRESS_HISTORY_HOUR_LEN, 0, 0, PRESS_HISTORY_15MIN_PER_HOUR, { 0 } },
+};
+
+//#pragma mark - Private Functions -
+
+static inline void accum_reset(press_accum_t* acc)
+{
+	acc->count = 0;
+	acc->min = UINT16_MAX;
+	acc->max = 0;
+	acc->sum = 0;
+}
+
+static inline void accum_add(press_accum_t* acc, uint16_t min, uint16_t max, uint16_t mean)
+{
+	if(min < acc->min)
+	{
+		acc->min = min;
+	}
+	if(max > acc->max)
+	{
+		acc->max = max;
+	}
+	acc->sum += mean;
+	acc->count++;
+}
+
+// Close the accumulator into a rollup stored in the tier ring
+static void tier_push(press_tier_ring_t* t, press_rollup_t* out)
+{
+	out->min = t->acc.min;
+	out->max = t->acc.max;
+	out->mean = (uint16_t)((t->acc.sum + (t->acc.count / 2)) / t->acc.count);
+
+	t->buf[t->head] = *out;
+	t->head++;
+	if(t->head >= t->cap)
+	{
+		t->head = 0;
+	}
+	if(t->size < t->cap)
+	{
+		t->size++;
+	}
+
+	accum_reset(&t->acc);
+}
+
+//#pragma mark - APIs -
+
+void press_history_init(uint16_t period_s)
+{
+	uint8_t i;
+
+	assert(period_s && ((900 % period_s) == 0));
+
+	tiers[PRESS_TIER_15MIN].fan_in = 900 / period_s;
+
+	for(i = 0; i < PRESS_TIER_COUNT; i++)
+	{
+		tiers[i].head = 0;
+		tiers[i].size = 0;
+		accum_reset(&tiers[i].acc);
+	}
+}
+
+uint8_t press_history_put(uint16_t value)
+{
+	press_rollup_t r;
+	uint8_t mask = 0;
+	uint8_t i;
+
+	r.min = value;
+	r.max = value;
+	r.mean = value;
+
+	// cascade the new entry as long as the tiers close a rollup
+	for(i = 0; i < PRESS_TIER_COUNT; i++)
+	{
+		accum_add(&tiers[i].acc, r.min, r.max, r.mean);
+		if(tiers[i].acc.count < tiers[i].fan_in)
+		{
+			break;
+		}
+		tier_push(&tiers[i], &r);
+		mask |= (uint8_t)(1u << i);
+	}
+
+	return mask;
+}
+
+size_t press_history_size(press_tier_t tier)
+{
+	assert(tier < PRESS_TIER_COUNT);
+
+	return tiers[tier].size;
+}
+
+size_t press_history_capacity(press_tier_t tier)
+{
+	assert(tier < PRESS_TIER_COUNT);
+
+	return tiers[tier].cap;
+}
+
+int press_history_at(press_tier_t tier, size_t index, press_rollup_t* rollup)
+{
+	press_tier_ring_t* t;
+	size_t pos;
+
+	assert((tier < PRESS_TIER_COUNT) && rollup);
+
+	t = &tiers[tier];
+	if(index >= t->size)
+	{
+		return -1;
+	}
+
+	// oldest entry sits at head once the ring has wrapped
+	pos = (t->size < t->cap) ? index : (t->head + index);
+	if(pos >= t->cap)
+	{
+		pos -= t->cap;
+	}
+	*rollup = t->buf[pos];
+
+	return 0;
+}
+
+int press_history_last(press_tier_t tier, press_rollup_t* rollup)
+{
+	size_t size = press_history_size(tier);
+
+	if(size == 0)
+	{
+		return -1;
+	}
+
+	return press_history_at(tier, size - 1, rollup);
+}
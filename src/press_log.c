@@ -0,0 +1,203 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "press_log.h"
+
+// Block layout: 24-bit little endian keyframe, sample count, nibble stream
+#define PRESS_LOG_HEADER_SIZE 4
+#define PRESS_LOG_NIBBLES ((PRESS_LOG_BLOCK_SIZE - PRESS_LOG_HEADER_SIZE) * 2)
+
+// Nibble value announcing a 16-bit delta in the next four nibbles
+#define PRESS_LOG_ESCAPE 0x0F
+
+// Largest value a keyframe can hold
+#define PRESS_LOG_KEYFRAME_MAX 0xFFFFFF
+
+static uint8_t blocks[PRESS_LOG_BLOCKS][PRESS_LOG_BLOCK_SIZE];
+
+static uint16_t first;     // oldest block
+static uint16_t used;      // blocks holding samples
+static uint16_t nibble;    // next free nibble of the newest block
+static uint32_t last;      // last value written
+static size_t samples;
+
+//#pragma mark - Private Functions -
+
+static inline uint32_t zigzag_encode(int32_t d)
+{
+	return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static inline int32_t zigzag_decode(uint32_t z)
+{
+	return (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+}
+
+static inline uint8_t* block_at(uint16_t i)
+{
+	uint16_t pos = first + i;
+
+	if(pos >= PRESS_LOG_BLOCKS)
+	{
+		pos -= PRESS_LOG_BLOCKS;
+	}
+
+	return blocks[pos];
+}
+
+static inline void nibble_put(uint8_t* b, uint16_t n, uint8_t v)
+{
+	uint8_t* p = &b[PRESS_LOG_HEADER_SIZE + (n >> 1)];
+
+	if(n & 1)
+	{
+		*p = (uint8_t)((*p & 0x0F) | (v << 4));
+	}
+	else
+	{
+		*p = (uint8_t)((*p & 0xF0) | v);
+	}
+}
+
+static inline uint8_t nibble_get(const uint8_t* b, uint16_t n)
+{
+	uint8_t v = b[PRESS_LOG_HEADER_SIZE + (n >> 1)];
+
+	return (n & 1) ? (v >> 4) : (v & 0x0F);
+}
+
+// Open a new block with the value as keyframe, drops the oldest block if needed
+static void block_start(uint32_t pa)
+{
+	uint8_t* b;
+
+	if(used == PRESS_LOG_BLOCKS)
+	{
+		samples -= blocks[first][3];
+		first++;
+		if(first >= PRESS_LOG_BLOCKS)
+		{
+			first = 0;
+		}
+		used--;
+	}
+
+	used++;
+	b = block_at(used - 1);
+	b[0] = (uint8_t)pa;
+	b[1] = (uint8_t)(pa >> 8);
+	b[2] = (uint8_t)(pa >> 16);
+	b[3] = 1;
+	nibble = 0;
+}
+
+//#pragma mark - APIs -
+
+void press_log_init(void)
+{
+	first = 0;
+	used = 0;
+	nibble = PRESS_LOG_NIBBLES;
+	last = 0;
+	samples = 0;
+}
+
+void press_log_put(uint32_t pa)
+{
+	uint8_t* b;
+	uint32_t z;
+
+	if(pa > PRESS_LOG_KEYFRAME_MAX)
+	{
+		pa = PRESS_LOG_KEYFRAME_MAX;
+	}
+
+	z = zigzag_encode((int32_t)(pa - last));
+	b = (used == 0) ? NULL : block_at(used - 1);
+
+	if((b != NULL) && (b[3] < UINT8_MAX) && (z < PRESS_LOG_ESCAPE) && (nibble < PRESS_LOG_NIBBLES))
+	{
+		nibble_put(b, nibble++, (uint8_t)z);
+		b[3]++;
+	}
+	else if((b != NULL) && (b[3] < UINT8_MAX) && (z <= UINT16_MAX) && ((nibble + 5) <= PRESS_LOG_NIBBLES))
+	{
+		nibble_put(b, nibble++, PRESS_LOG_ESCAPE);
+		nibble_put(b, nibble++, (uint8_t)(z & 0x0F));
+		nibble_put(b, nibble++, (uint8_t)((z >> 4) & 0x0F));
+		nibble_put(b, nibble++, (uint8_t)((z >> 8) & 0x0F));
+		nibble_put(b, nibble++, (uint8_t)((z >> 12) & 0x0F));
+		b[3]++;
+	}
+	else
+	{
+		block_start(pa);
+	}
+
+	last = pa;
+	samples++;
+}
+
+size_t press_log_size(void)
+{
+	return samples;
+}
+
+size_t press_log_bytes(void)
+{
+	if(used == 0)
+	{
+		return 0;
+	}
+
+	return ((size_t)(used - 1) * PRESS_LOG_BLOCK_SIZE) + PRESS_LOG_HEADER_SIZE + ((nibble + 1) / 2);
+}
+
+void press_log_iter_begin(press_log_iter_t* it)
+{
+	assert(it);
+
+	it->block = 0;
+	it->nibble = 0;
+	it->left = 0;
+	it->value = 0;
+}
+
+bool press_log_iter_next(press_log_iter_t* it, uint32_t* pa)
+{
+	const uint8_t* b;
+	uint32_t z;
+
+	assert(it && pa);
+
+	if(it->left == 0)
+	{
+		// move on to the keyframe of the next block
+		if(it->block >= used)
+		{
+			return false;
+		}
+		b = block_at(it->block++);
+		it->value = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16);
+		it->left = (uint8_t)(b[3] - 1);
+		it->nibble = 0;
+		*pa = it->value;
+		return true;
+	}
+
+	b = block_at(it->block - 1);
+	z = nibble_get(b, it->nibble++);
+	if(z == PRESS_LOG_ESCAPE)
+	{
+		z = nibble_get(b, it->nibble++);
+		z |= (uint32_t)nibble_get(b, it->nibble++) << 4;
+		z |= (uint32_t)nibble_get(b, it->nibble++) << 8;
+		z |= (uint32_t)nibble_get(b, it->nibble++) << 12;
+	}
+	it->value += (uint32_t)zigzag_decode(z);
+	it->left--;
+	*pa = it->value;
+
+	return true;
+}
@@ -0,0 +1,166 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "press_motion.h"
+
+// the slope of the steady run needs two samples after the first
+#if PRESS_MOTION_CONFIRM < 1
+#error "PRESS_MOTION_CONFIRM must be at least 1"
+#endif
+
+static press_motion_t gate;
+static volatile bool pending;   // event seen since the last sample
+static uint8_t quiet;           // samples left to hold
+static int32_t ref;             // last accepted value
+static bool have_ref;
+static int32_t first;           // first sample of the steady run at rest
+static int32_t last;            // last sample at rest
+static uint8_t agree;           // samples in the steady run
+static uint8_t rest;            // samples at rest since the motion
+static uint8_t since;           // samples since ref
+static uint8_t first_at;        // samples from ref to first
+
+//#pragma mark - Private Functions -
+
+static inline int32_t abs32(int32_t v)
+{
+	return (v < 0) ? -v : v;
+}
+
+// Add a confirmed step to the offset, within PRESS_MOTION_OFFSET_MAX
+// Returns the part of the step that was removed
+static int32_t rebase(int32_t s)
+{
+	int32_t offset = gate.offset + s;
+
+	if(offset > PRESS_MOTION_OFFSET_MAX)
+	{
+		offset = PRESS_MOTION_OFFSET_MAX;
+	}
+	else if(offset < -PRESS_MOTION_OFFSET_MAX)
+	{
+		offset = -PRESS_MOTION_OFFSET_MAX;
+	}
+	s = offset - gate.offset;
+	gate.offset = offset;
+	gate.rebases++;
+
+	return s;
+}
+
+//#pragma mark - APIs -
+
+void press_motion_init(void)
+{
+	gate.moving = false;
+	gate.events = 0;
+	gate.held = 0;
+	gate.rebases = 0;
+	gate.rejected = 0;
+	gate.offset = 0;
+	pending = false;
+	quiet = 0;
+	have_ref = false;
+	agree = 0;
+	rest = 0;
+}
+
+void press_motion_event(void)
+{
+	pending = true;
+	gate.events++;
+}
+
+int32_t press_motion_filter(int32_t pa, bool* held)
+{
+	int32_t value = pa - gate.offset;
+	int32_t s;
+
+	assert(held);
+
+	*held = false;
+	if(pending)
+	{
+		pending = false;
+		quiet = PRESS_MOTION_SETTLE;
+		since = gate.moving ? since : 0;
+		gate.moving = have_ref;
+		agree = 0;
+		rest = 0;
+	}
+
+	if(gate.moving)
+	{
+		since++;
+		if(quiet)
+		{
+			quiet--;
+			gate.held++;
+			*held = true;
+			return ref;
+		}
+
+		// at rest, the height is taken once the next samples stay at the same level,
+		// a glitch or a gust on one of them starts the run again
+		rest++;
+		if((agree > 0) && (abs32(value - last) <= PRESS_MOTION_CONFIRM_TOL))
+		{
+			agree++;
+		}
+		else
+		{
+			first = value;
+			first_at = since;
+			agree = 1;
+		}
+		last = value;
+		if(agree > PRESS_MOTION_CONFIRM)
+		{
+			// the weather moved on while the samples were held, the run is taken back
+			// along its own slope to the time of ref; anything beyond noise is the new height
+			gate.moving = false;
+			s = first - ((last - first) * first_at / (agree - 1)) - ref;
+			if(abs32(s) >= PRESS_MOTION_REBASE_MIN)
+			{
+				value -= rebase(s);
+			}
+		}
+
+		if(gate.moving && (rest >= PRESS_MOTION_CONFIRM_MAX))
+		{
+			// still changing, this is not a change of height the gate can remove
+			gate.moving = false;
+			gate.rejected++;
+		}
+		if(gate.moving)
+		{
+			gate.held++;
+			*held = true;
+			return ref;
+		}
+	}
+
+	ref = value;
+	have_ref = true;
+
+	return value;
+}
+
+void press_motion_clear(void)
+{
+	gate.offset = 0;
+	gate.moving = false;
+	quiet = 0;
+	have_ref = false;
+	agree = 0;
+	rest = 0;
+}
+
+void press_motion_get(press_motion_t* state)
+{
+	assert(state);
+
+	*state = gate;
+}
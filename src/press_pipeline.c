@@ -0,0 +1,223 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "mem_pool.h"
+#include "press_slp.h"
+#include "press_motion.h"
+#include "press_stats.h"
+#include "press_history.h"
+#include "press_log.h"
+#include "press_pipeline.h"
+
+// Window lengths in hours, indexed by PRESS_WINDOW_x
+static const uint8_t window_hours[PRESS_WINDOW_COUNT] = {1, 3, 6, 12};
+
+static press_pipeline_cfg_t cfg;
+static baro_ring_t* ring;
+static outlier_t outl;
+
+//#pragma mark - Private Functions -
+
+// Store a filtered pressure in Pa in the log, the ring, the statistics and the history tiers
+static void history_put(uint32_t pa, press_pipeline_result_t* res)
+{
+	uint16_t value;
+
+	// long history is kept in Pa in the compressed log
+	press_log_put(pa);
+	// clamped so it does not wrap
+	if(pa < PRESS_PIPELINE_OFFSET)
+	{
+		value = 0;
+	}
+	else if(pa > (PRESS_PIPELINE_OFFSET + UINT16_MAX))
+	{
+		value = UINT16_MAX;
+	}
+	else
+	{
+		value = (uint16_t)(pa - PRESS_PIPELINE_OFFSET);
+	}
+	baro_ring_put(ring, value);
+	press_stats_put(value);
+	res->tiers = press_history_put(value);
+	res->value = value;
+	res->logged = true;
+}
+
+// Update the tendency from the 3 hour window, start, middle and end come from the ring
+static void trend_update(press_pipeline_result_t* res)
+{
+	press_stats_t stats;
+	press_stats_t slope;
+	press_filter_t filter;
+	press_tendency_t prev;
+	uint16_t start, mid, end;
+	size_t n;
+
+	press_tendency_get(&prev);
+	res->storm = prev.storm;
+	// the tendency needs a complete 3 hour window
+	if(!press_stats_window_full(PRESS_WINDOW_3H) || (press_stats_get(PRESS_WINDOW_3H, &stats) != 0) ||
+			(press_stats_get(cfg.slope_window, &slope) != 0))
+	{
+		return;
+	}
+	n = baro_ring_size(ring);
+	if((n < stats.count) ||
+			!baro_ring_at(ring, n - stats.count, &start) ||
+			!baro_ring_at(ring, n - (stats.count / 2), &mid) ||
+			!baro_ring_at(ring, n - 1, &end))
+	{
+		return;
+	}
+	if(cfg.filter_rate)
+	{
+		press_filter_get(&filter);
+		slope.slope = filter.rate;
+	}
+
+	res->trend = true;
+	res->storm = press_tendency_update(slope.slope, start, mid, end);
+	res->warning = (res->storm == PRESS_STORM_WARNING) && (prev.storm != PRESS_STORM_WARNING);
+}
+
+static void result_clear(press_pipeline_result_t* res)
+{
+	res->held = false;
+	res->rejected = false;
+	res->logged = false;
+	res->pa = 0;
+	res->value = 0;
+	res->tiers = 0;
+	res->trend = false;
+	res->storm = PRESS_STORM_NONE;
+	res->warning = false;
+}
+
+//#pragma mark - APIs -
+
+int press_pipeline_init(const press_pipeline_cfg_t* config)
+{
+	uint16_t windows[PRESS_WINDOW_COUNT];
+	uint8_t i;
+
+	assert(config);
+	assert(config->period_s > 0);
+	assert(config->slope_window < PRESS_WINDOW_COUNT);
+
+	cfg = *config;
+	// the pool has no free, the ring is taken once and reused by a later init
+	if(ring == NULL)
+	{
+		ring = mem_pool_alloc(MEM_POOL_SAMPLES, sizeof(baro_ring_t));
+		if(ring == NULL)
+		{
+			return -1;
+		}
+	}
+	baro_ring_reset(ring);
+
+	for(i = 0; i < PRESS_WINDOW_COUNT; i++)
+	{
+		windows[i] = (uint16_t)((window_hours[i] * 3600u) / cfg.period_s);
+	}
+	if(press_stats_init(windows, PRESS_WINDOW_COUNT, cfg.period_s) != 0)
+	{
+		return -1;
+	}
+	if(outlier_init(&outl, cfg.outlier_len, OUTLIER_NSIGMA, cfg.outlier_scale) != 0)
+	{
+		return -1;
+	}
+	press_tendency_init(cfg.tendency);
+	press_motion_init();
+	press_filter_init(cfg.filter, cfg.period_s);
+	press_history_init(cfg.period_s);
+	press_log_init();
+
+	return 0;
+}
+
+void press_pipeline_put(int32_t pa, int16_t centi_c, bool valid, press_pipeline_result_t* res)
+{
+	press_filter_t filter;
+	bool held = true;
+
+	assert(ring);
+	assert(res);
+
+	result_clear(res);
+	// a failed read is handled like a held sample
+	if(valid)
+	{
+		// history, trend and forecast work on sea-level pressure
+		pa = press_slp_reduce(pa, centi_c);
+		// samples taken while the station is carried are held, altitude steps are removed
+		pa = press_motion_filter(pa, &held);
+		// glitches are replaced by the median of the last samples, after the
+		// gate so an altitude step is removed before it reaches the window
+		if(!held)
+		{
+			res->rejected = outlier_put(&outl, &pa);
+		}
+	}
+	res->held = held;
+	// the filter coasts on its rate over held samples
+	if(held)
+	{
+		press_filter_predict();
+	}
+	else
+	{
+		press_filter_update(pa);
+	}
+	press_filter_get(&filter);
+	res->pa = (uint32_t)filter.pa;
+	// nothing to log before the first good reading
+	if(filter.updates > 0)
+	{
+		history_put(res->pa, res);
+	}
+	// a held sample carries no new information
+	if(!held)
+	{
+		trend_update(res);
+	}
+}
+
+void press_pipeline_import(uint32_t pa, press_pipeline_result_t* res)
+{
+	assert(ring);
+	assert(res);
+
+	result_clear(res);
+	res->pa = (uint32_t)press_filter_update((int32_t)pa);
+	history_put(res->pa, res);
+	trend_update(res);
+}
+
+uint8_t press_pipeline_restore(uint16_t value)
+{
+	press_pipeline_result_t res;
+
+	assert(ring);
+
+	history_put((uint32_t)value + PRESS_PIPELINE_OFFSET, &res);
+
+	return res.tiers;
+}
+
+const baro_ring_t* press_pipeline_ring(void)
+{
+	assert(ring);
+
+	return ring;
+}
+
+outlier_t* press_pipeline_outlier(void)
+{
+	return &outl;
+}
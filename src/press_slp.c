@@ -0,0 +1,107 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#include "press_slp.h"
+
+// g * M / R = 0.0341632 K/m, scaled so that h / T(0.01 K) gives the exponent in Q16
+// 0.0341632 * 100 * 65536 = 223894
+#define SLP_EXP_SCALE 223894
+
+// Half of the standard lapse rate (0.0065 K/m) in 0.01 K per metre is 13/40
+#define SLP_LAPSE_NUM 13
+#define SLP_LAPSE_DEN 40
+
+// 0 degC in 0.01 K
+#define SLP_ZERO_C 27315
+
+// exp(i / 128) in Q24 for i = 0..96, exponent range 0..0.75
+#define SLP_EXP_SHIFT 9
+#define SLP_EXP_ENTRIES 97
+static const uint32_t exp_q24[SLP_EXP_ENTRIES] =
+{
+	16777216, 16908801, 17041419, 17175076, 17309782, 17445544,
+	17582371, 17720272, 17859253, 17999325, 18140496, 18282773,
+	18426167, 18570685, 18716337, 18863131, 19011076, 19160182,
+	19310457, 19461911, 19614553, 19768392, 19923437, 20079698,
+	20237185, 20395908, 20555875, 20717096, 20879583, 21043343,
+	21208388, 21374728, 21542372, 21711331, 21881615, 22053234,
+	22226200, 22400522, 22576212, 22753279, 22931735, 23111591,
+	23292858, 23475546, 23659667, 23845232, 24032252, 24220740,
+	24410705, 24602161, 24795118, 24989588, 25185584, 25383117,
+	25582199, 25782843, 25985060, 26188864, 26394266, 26601278,
+	26809915, 27020188, 27232110, 27445694, 27660953, 27877900,
+	28096550, 28316913, 28539006, 28762840, 28988430, 29215789,
+	29444931, 29675871, 29908621, 30143197, 30379614, 30617884,
+	30858023, 31100045, 31343966, 31589800, 31837562, 32087267,
+	32338930, 32592568, 32848194, 33105826, 33365478, 33627167,
+	33890908, 34156718, 34424612, 34694608, 34966721, 35240968,
+	35517367,
+};
+
+static int16_t altitude;
+
+//#pragma mark - Private Functions -
+
+// exp(x) in Q24 for x in Q16, 0 <= x < 0.75
+static uint32_t exp_lookup(uint32_t x)
+{
+	uint32_t i = x >> SLP_EXP_SHIFT;
+	uint32_t frac = x & ((1u << SLP_EXP_SHIFT) - 1);
+
+	if(i >= (SLP_EXP_ENTRIES - 1))
+	{
+		return exp_q24[SLP_EXP_ENTRIES - 1];
+	}
+
+	return exp_q24[i] + (((exp_q24[i + 1] - exp_q24[i]) * frac) >> SLP_EXP_SHIFT);
+}
+
+//#pragma mark - APIs -
+
+void press_slp_set_altitude(int16_t altitude_m)
+{
+	if(altitude_m < PRESS_SLP_ALT_MIN)
+	{
+		altitude_m = PRESS_SLP_ALT_MIN;
+	}
+	else if(altitude_m > PRESS_SLP_ALT_MAX)
+	{
+		altitude_m = PRESS_SLP_ALT_MAX;
+	}
+	altitude = altitude_m;
+}
+
+int16_t press_slp_get_altitude(void)
+{
+	return altitude;
+}
+
+int32_t press_slp_reduce(int32_t pa, int16_t centi_c)
+{
+	int32_t h = (altitude < 0) ? -altitude : altitude;
+	int32_t tm;
+	uint32_t x;
+	uint32_t factor;
+
+	if(altitude == 0)
+	{
+		return pa;
+	}
+
+	// mean temperature of the air column in 0.01 K
+	tm = SLP_ZERO_C + centi_c + ((altitude * SLP_LAPSE_NUM) / SLP_LAPSE_DEN);
+	if(tm < 20000)
+	{
+		tm = 20000;
+	}
+
+	x = (uint32_t)(((int64_t)h * SLP_EXP_SCALE) / tm);
+	factor = exp_lookup(x);
+
+	if(altitude > 0)
+	{
+		return (int32_t)((((int64_t)pa * factor) + (1 << 23)) >> 24);
+	}
+	// below sea level the pressure is reduced by the inverse factor
+	return (int32_t)((((int64_t)pa << 24) + (factor / 2)) / factor);
+}
@@ -0,0 +1,244 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "press_stats.h"
+
+// Deque entry, sequence number is truncated to 16 bits which is enough
+// as long as the windows are shorter than 65536 samples
+typedef struct
+{
+	uint16_t seq;
+	uint16_t val;
+} press_stats_entry_t;
+
+// Monotonic deque stored as a ring inside the shared pool
+typedef struct
+{
+	press_stats_entry_t* buf;
+	uint16_t cap;
+	uint16_t head; // oldest entry
+	uint16_t len;
+} press_stats_deque_t;
+
+typedef struct
+{
+	uint16_t len;   // window length in samples
+	uint16_t count; // samples inside the window
+	uint32_t sy;    // sum of values
+	int64_t sxy;    // sum of x * value, x = 0 for the oldest sample
+	press_stats_deque_t min;
+	press_stats_deque_t max;
+} press_stats_window_t;
+
+static uint16_t history[PRESS_STATS_MAX_WINDOW];
+static uint16_t history_head;
+
+static press_stats_entry_t pool[2 * PRESS_STATS_DEQUE_POOL];
+
+static press_stats_window_t windows[PRESS_STATS_MAX_WINDOWS];
+static uint8_t window_count;
+static uint16_t samples_per_hour;
+static uint16_t seq;
+
+//#pragma mark - Private Functions -
+
+static inline uint16_t deque_index(const press_stats_deque_t* dq, uint16_t i)
+{
+	uint16_t pos = dq->head + i;
+
+	return (pos >= dq->cap) ? (pos - dq->cap) : pos;
+}
+
+static inline press_stats_entry_t* deque_front(press_stats_deque_t* dq)
+{
+	return &dq->buf[dq->head];
+}
+
+static inline press_stats_entry_t* deque_back(press_stats_deque_t* dq)
+{
+	return &dq->buf[deque_index(dq, dq->len - 1)];
+}
+
+static inline void deque_pop_front(press_stats_deque_t* dq)
+{
+	dq->head = deque_index(dq, 1);
+	dq->len--;
+}
+
+static inline void deque_push_back(press_stats_deque_t* dq, uint16_t s, uint16_t v)
+{
+	press_stats_entry_t* e;
+
+	assert(dq->len < dq->cap);
+
+	dq->len++;
+	e = deque_back(dq);
+	e->seq = s;
+	e->val = v;
+}
+
+// Drop the front entry if it is older than the window
+static inline void deque_expire(press_stats_deque_t* dq, uint16_t len)
+{
+	if(dq->len && ((uint16_t)(seq - deque_front(dq)->seq) >= len))
+	{
+		deque_pop_front(dq);
+	}
+}
+
+static void window_put(press_stats_window_t* w, uint16_t value, uint16_t evicted)
+{
+	// running sums, x of the new sample is the number of samples before it
+	w->sxy += (int64_t)w->count * value;
+	w->sy += value;
+
+	if(w->count < w->len)
+	{
+		w->count++;
+	}
+	else
+	{
+		// evict the oldest sample (x = 0) and shift all remaining x by one
+		w->sy -= evicted;
+		w->sxy -= w->sy;
+	}
+
+	deque_expire(&w->min, w->len);
+	deque_expire(&w->max, w->len);
+
+	// min deque holds increasing values, max deque decreasing ones
+	while(w->min.len && (deque_back(&w->min)->val >= value))
+	{
+		w->min.len--;
+	}
+	deque_push_back(&w->min, seq, value);
+
+	while(w->max.len && (deque_back(&w->max)->val <= value))
+	{
+		w->max.len--;
+	}
+	deque_push_back(&w->max, seq, value);
+}
+
+//#pragma mark - APIs -
+
+int press_stats_init(const uint16_t* lens, uint8_t count, uint16_t period_s)
+{
+	size_t used = 0;
+	uint8_t i;
+
+	assert(lens && period_s);
+
+	if(count > PRESS_STATS_MAX_WINDOWS)
+	{
+		return -1;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		if((lens[i] == 0) || (lens[i] > PRESS_STATS_MAX_WINDOW) ||
+				((used + lens[i]) > PRESS_STATS_DEQUE_POOL))
+		{
+			window_count = 0;
+			return -1;
+		}
+
+		windows[i].len = lens[i];
+		windows[i].min.buf = &pool[2 * used];
+		windows[i].min.cap = lens[i];
+		windows[i].max.buf = &pool[(2 * used) + lens[i]];
+		windows[i].max.cap = lens[i];
+		used += lens[i];
+	}
+
+	window_count = count;
+	samples_per_hour = 3600 / period_s;
+	press_stats_reset();
+
+	return 0;
+}
+
+void press_stats_reset(void)
+{
+	uint8_t i;
+
+	history_head = 0;
+	seq = 0;
+
+	for(i = 0; i < window_count; i++)
+	{
+		windows[i].count = 0;
+		windows[i].sy = 0;
+		windows[i].sxy = 0;
+		windows[i].min.head = 0;
+		windows[i].min.len = 0;
+		windows[i].max.head = 0;
+		windows[i].max.len = 0;
+	}
+}
+
+void press_stats_put(uint16_t value)
+{
+	press_stats_window_t* w;
+	int32_t pos;
+	uint8_t i;
+
+	for(i = 0; i < window_count; i++)
+	{
+		w = &windows[i];
+		// value leaving the window, only valid once the window is full
+		pos = (int32_t)history_head - w->len;
+		if(pos < 0)
+		{
+			pos += PRESS_STATS_MAX_WINDOW;
+		}
+		window_put(w, value, history[pos]);
+	}
+
+	history[history_head] = value;
+	history_head++;
+	if(history_head >= PRESS_STATS_MAX_WINDOW)
+	{
+		history_head = 0;
+	}
+	seq++;
+}
+
+int press_stats_get(uint8_t window, press_stats_t* stats)
+{
+	press_stats_window_t* w;
+	int64_t n, sx, num, den;
+
+	assert(stats);
+
+	if((window >= window_count) || (windows[window].count == 0))
+	{
+		return -1;
+	}
+
+	w = &windows[window];
+	n = w->count;
+
+	stats->count = w->count;
+	stats->min = deque_front(&w->min)->val;
+	stats->max = deque_front(&w->max)->val;
+	stats->mean = (uint16_t)((w->sy + (w->count / 2)) / w->count);
+	stats->slope = 0;
+
+	if(n > 1)
+	{
+		// slope = (n * Sxy - Sx * Sy) / (n * Sxx - Sx^2) with x = 0..n-1
+		sx = n * (n - 1) / 2;
+		num = (n * w->sxy) - (sx * (int64_t)w->sy);
+		den = (n * n * ((n * n) - 1)) / 12;
+		stats->slope = (int32_t)((num * samples_per_hour) / den);
+	}
+
+	return 0;
+}
+
+bool press_stats_window_full(uint8_t window)
+{
+	return (window < window_count) && (windows[window].count == windows[window].len);
+}
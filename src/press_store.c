@@ -0,0 +1,359 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+
+#include "press_store.h"
+
+// Record layout, little endian:
+//   0  magic (2)    2  sample count (1)    3  reserved (1)    4  sequence (4)
+//   8  samples (2 * PRESS_STORE_RECORD_SAMPLES)    60  CRC-32 of bytes 0..59 (4)
+#define REC_MAGIC        0xB4A5u
+#define REC_ERASED       0xFFFFu
+#define REC_OFF_COUNT    2
+#define REC_OFF_SEQ      4
+#define REC_OFF_SAMPLES  8
+#define REC_OFF_CRC      (REC_OFF_SAMPLES + (2 * PRESS_STORE_RECORD_SAMPLES))
+
+#if (REC_OFF_CRC + 4) > PRESS_STORE_RECORD_SIZE
+#error "press_store record does not fit PRESS_STORE_RECORD_SIZE"
+#endif
+
+typedef struct
+{
+	uint16_t magic;
+	uint8_t count;
+	uint32_t seq;
+	uint16_t samples[PRESS_STORE_RECORD_SAMPLES];
+} press_store_rec_t;
+
+static const press_store_ctx_t* flash;
+static uint32_t slots;         // records per sector
+static uint8_t active;         // sector being appended to
+static uint32_t next_slot;     // first free record in the active sector
+static uint32_t next_seq;
+static uint16_t batch[PRESS_STORE_RECORD_SAMPLES];
+static uint8_t batch_count;
+static press_store_stats_t stats;
+
+//#pragma mark - Private Functions -
+
+static uint32_t crc32(const uint8_t* data, size_t len)
+{
+	static const uint32_t table[16] =
+	{
+		0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+		0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+	};
+	uint32_t crc = 0xFFFFFFFF;
+
+	while(len--)
+	{
+		crc ^= *data++;
+		crc = (crc >> 4) ^ table[crc & 0x0F];
+		crc = (crc >> 4) ^ table[crc & 0x0F];
+	}
+
+	return ~crc;
+}
+
+static inline uint32_t get_u32(const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void put_u32(uint8_t* p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t slot_offset(uint8_t sector, uint32_t slot)
+{
+	return (sector * flash->sector_size) + (slot * PRESS_STORE_RECORD_SIZE);
+}
+
+// Read only the magic of a record
+static int read_magic(uint8_t sector, uint32_t slot, uint16_t* magic)
+{
+	uint8_t buf[2];
+
+	stats.recovery_reads++;
+	if(flash->read(flash->handle, slot_offset(sector, slot), buf, sizeof(buf)) != 0)
+	{
+		return -1;
+	}
+	*magic = (uint16_t)(buf[0] | (buf[1] << 8));
+
+	return 0;
+}
+
+// Read and validate a whole record
+// Returns 0 if the record is valid, -1 otherwise
+static int read_record(uint8_t sector, uint32_t slot, press_store_rec_t* rec)
+{
+	uint8_t buf[PRESS_STORE_RECORD_SIZE];
+	uint8_t i;
+
+	stats.recovery_reads++;
+	if(flash->read(flash->handle, slot_offset(sector, slot), buf, sizeof(buf)) != 0)
+	{
+		return -1;
+	}
+
+	rec->magic = (uint16_t)(buf[0] | (buf[1] << 8));
+	if(rec->magic != REC_MAGIC)
+	{
+		return -1;
+	}
+	if(crc32(buf, REC_OFF_CRC) != get_u32(&buf[REC_OFF_CRC]))
+	{
+		stats.crc_errors++;
+		return -1;
+	}
+
+	rec->count = buf[REC_OFF_COUNT];
+	if((rec->count == 0) || (rec->count > PRESS_STORE_RECORD_SAMPLES))
+	{
+		stats.crc_errors++;
+		return -1;
+	}
+	rec->seq = get_u32(&buf[REC_OFF_SEQ]);
+	for(i = 0; i < rec->count; i++)
+	{
+		rec->samples[i] = (uint16_t)(buf[REC_OFF_SAMPLES + (2 * i)] | (buf[REC_OFF_SAMPLES + (2 * i) + 1] << 8));
+	}
+
+	return 0;
+}
+
+// Binary search for the first erased record, records are appended in order
+static int find_end(uint8_t sector, uint32_t* end)
+{
+	uint32_t lo = 0;
+	uint32_t hi = slots;
+	uint32_t mid;
+	uint16_t magic;
+
+	while(lo < hi)
+	{
+		mid = lo + ((hi - lo) / 2);
+		if(read_magic(sector, mid, &magic) != 0)
+		{
+			return -1;
+		}
+		if(magic == REC_ERASED)
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid + 1;
+		}
+	}
+	*end = lo;
+
+	return 0;
+}
+
+static int write_record(void)
+{
+	uint8_t buf[PRESS_STORE_RECORD_SIZE];
+	uint8_t i;
+
+	if(next_slot >= slots)
+	{
+		// active sector is full, continue in the other one
+		active ^= 1;
+		next_slot = 0;
+		stats.erases++;
+		if(flash->erase(flash->handle, active) != 0)
+		{
+			return -1;
+		}
+	}
+
+	memset(buf, 0xFF, sizeof(buf));
+	buf[0] = (uint8_t)REC_MAGIC;
+	buf[1] = (uint8_t)(REC_MAGIC >> 8);
+	buf[REC_OFF_COUNT] = batch_count;
+	buf[REC_OFF_COUNT + 1] = 0;
+	put_u32(&buf[REC_OFF_SEQ], next_seq);
+	for(i = 0; i < batch_count; i++)
+	{
+		buf[REC_OFF_SAMPLES + (2 * i)] = (uint8_t)batch[i];
+		buf[REC_OFF_SAMPLES + (2 * i) + 1] = (uint8_t)(batch[i] >> 8);
+	}
+	put_u32(&buf[REC_OFF_CRC], crc32(buf, REC_OFF_CRC));
+
+	// the slot is consumed even if programming fails, a torn record fails its CRC
+	next_slot++;
+	next_seq++;
+	batch_count = 0;
+	if(flash->program(flash->handle, slot_offset(active, next_slot - 1), buf, sizeof(buf)) != 0)
+	{
+		return -1;
+	}
+	stats.records_written++;
+
+	return 0;
+}
+
+//#pragma mark - APIs -
+
+int press_store_init(const press_store_ctx_t* ctx)
+{
+	press_store_rec_t first[2];
+	bool valid[2];
+	uint16_t magic;
+	uint8_t s;
+
+	assert(ctx && ctx->erase && ctx->program && ctx->read && ctx->sector_size);
+
+	flash = ctx;
+	slots = ctx->sector_size / PRESS_STORE_RECORD_SIZE;
+	batch_count = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	for(s = 0; s < 2; s++)
+	{
+		valid[s] = (read_record(s, 0, &first[s]) == 0);
+	}
+
+	// the sector that was started last is the active one
+	if(valid[0] && valid[1])
+	{
+		active = ((int32_t)(first[1].seq - first[0].seq) > 0) ? 1 : 0;
+	}
+	else
+	{
+		active = valid[1] ? 1 : 0;
+	}
+
+	if(!valid[active])
+	{
+		// no log yet, start from a clean sector unless it is already erased
+		if(read_magic(active, 0, &magic) != 0)
+		{
+			return -1;
+		}
+		if(magic != REC_ERASED)
+		{
+			stats.erases++;
+			if(flash->erase(flash->handle, active) != 0)
+			{
+				return -1;
+			}
+		}
+		next_slot = 0;
+		next_seq = 0;
+		return 0;
+	}
+
+	if(find_end(active, &next_slot) != 0)
+	{
+		return -1;
+	}
+	// records are sequential inside a sector
+	next_seq = first[active].seq + next_slot;
+
+	return 0;
+}
+
+size_t press_store_recover(void (*sink)(uint16_t value), size_t max_samples)
+{
+	press_store_rec_t rec;
+	uint32_t used[2];
+	uint32_t pos;
+	uint32_t total;
+	uint8_t sector;
+	uint32_t slot;
+	size_t found = 0;
+	size_t skip;
+	size_t out = 0;
+	uint8_t i;
+
+	assert(flash && sink);
+
+	// the other sector holds the older part of the log if it is valid and older
+	used[active] = next_slot;
+	used[active ^ 1] = 0;
+	if((read_record(active ^ 1, 0, &rec) == 0) &&
+			((int32_t)((next_seq - next_slot) - rec.seq) > 0))
+	{
+		used[active ^ 1] = slots;
+	}
+	total = used[0] + used[1];
+
+	// walk back from the newest record until enough samples are found
+	pos = total;
+	while((pos > 0) && (found < max_samples))
+	{
+		pos--;
+		sector = (pos < used[active ^ 1]) ? (active ^ 1) : active;
+		slot = (sector == active) ? (pos - used[active ^ 1]) : pos;
+		if(read_record(sector, slot, &rec) == 0)
+		{
+			found += rec.count;
+		}
+	}
+
+	// replay forward, skipping the surplus of the oldest record
+	skip = (found > max_samples) ? (found - max_samples) : 0;
+	for(; pos < total; pos++)
+	{
+		sector = (pos < used[active ^ 1]) ? (active ^ 1) : active;
+		slot = (sector == active) ? (pos - used[active ^ 1]) : pos;
+		if(read_record(sector, slot, &rec) != 0)
+		{
+			continue;
+		}
+		for(i = 0; i < rec.count; i++)
+		{
+			if(skip)
+			{
+				skip--;
+				continue;
+			}
+			sink(rec.samples[i]);
+			out++;
+		}
+	}
+
+	return out;
+}
+
+int press_store_put(uint16_t value)
+{
+	assert(flash);
+
+	batch[batch_count++] = value;
+	stats.samples_written++;
+
+	if(batch_count < PRESS_STORE_RECORD_SAMPLES)
+	{
+		return 0;
+	}
+
+	return write_record();
+}
+
+int press_store_flush(void)
+{
+	if((flash == NULL) || (batch_count == 0))
+	{
+		return 0;
+	}
+
+	return write_record();
+}
+
+void press_store_get_stats(press_store_stats_t* out)
+{
+	assert(out);
+
+	*out = stats;
+}
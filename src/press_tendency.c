@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+
+#include "press_tendency.h"
+
+static const char* const names[PRESS_TEND_COUNT] =
+{
+	"rising then falling",
+	"rising then steady",
+	"rising",
+	"falling then rising, higher",
+	"steady",
+	"falling then rising",
+	"falling then steady",
+	"falling",
+	"rising then falling, lower",
+};
+
+static press_tendency_cfg_t cfg;
+static press_tendency_t state;
+
+//#pragma mark - Private Functions -
+
+static inline int8_t direction(int32_t change, int32_t steady)
+{
+	if(change > steady)
+	{
+		return 1;
+	}
+	if(change < -steady)
+	{
+		return -1;
+	}
+	return 0;
+}
+
+static press_storm_t storm_level(press_storm_t current, int32_t slope)
+{
+	press_storm_t next = PRESS_STORM_NONE;
+
+	if(slope <= cfg.warn_rate)
+	{
+		next = PRESS_STORM_WARNING;
+	}
+	else if(slope <= cfg.watch_rate)
+	{
+		next = PRESS_STORM_WATCH;
+	}
+
+	// a raised level is kept until the rate has recovered past the hysteresis band
+	if((current == PRESS_STORM_WARNING) && (slope <= (cfg.warn_rate + cfg.hysteresis)))
+	{
+		next = PRESS_STORM_WARNING;
+	}
+	else if((current >= PRESS_STORM_WATCH) && (next == PRESS_STORM_NONE) &&
+			(slope <= (cfg.watch_rate + cfg.hysteresis)))
+	{
+		next = PRESS_STORM_WATCH;
+	}
+
+	return next;
+}
+
+//#pragma mark - APIs -
+
+void press_tendency_init(const press_tendency_cfg_t* config)
+{
+	if(config == NULL)
+	{
+		cfg.steady = PRESS_TENDENCY_STEADY;
+		cfg.watch_rate = PRESS_TENDENCY_WATCH_RATE;
+		cfg.warn_rate = PRESS_TENDENCY_WARN_RATE;
+		cfg.hysteresis = PRESS_TENDENCY_HYSTERESIS;
+	}
+	else
+	{
+		assert((config->warn_rate <= config->watch_rate) && (config->hysteresis >= 0));
+		cfg = *config;
+	}
+
+	state.slope = 0;
+	state.change = 0;
+	state.code = PRESS_TEND_STEADY;
+	state.storm = PRESS_STORM_NONE;
+	state.updates = 0;
+}
+
+press_tend_code_t press_tendency_classify(int32_t first, int32_t second, int32_t steady)
+{
+	int8_t total = direction(first + second, steady);
+	int8_t d1 = direction(first, steady);
+	int8_t d2 = direction(second, steady);
+
+	if(total > 0)
+	{
+		if((d1 > 0) && (d2 > 0))
+		{
+			if((2 * second) < first)
+			{
+				return PRESS_TEND_RISE_STEADY;       // increasing more slowly
+			}
+			if(second > (2 * first))
+			{
+				return PRESS_TEND_FALL_RISE_HIGHER;  // increasing more rapidly
+			}
+			return PRESS_TEND_RISE;
+		}
+		if((d1 > 0) && (d2 == 0))
+		{
+			return PRESS_TEND_RISE_STEADY;
+		}
+		if((d1 > 0) && (d2 < 0))
+		{
+			return PRESS_TEND_RISE_FALL;
+		}
+		if((d1 <= 0) && (d2 > 0))
+		{
+			return PRESS_TEND_FALL_RISE_HIGHER;
+		}
+		return PRESS_TEND_RISE;
+	}
+
+	if(total < 0)
+	{
+		if((d1 < 0) && (d2 < 0))
+		{
+			if((2 * second) > first)
+			{
+				return PRESS_TEND_FALL_STEADY;       // decreasing more slowly
+			}
+			if(second < (2 * first))
+			{
+				return PRESS_TEND_RISE_FALL_LOWER;   // decreasing more rapidly
+			}
+			return PRESS_TEND_FALL;
+		}
+		if((d1 < 0) && (d2 == 0))
+		{
+			return PRESS_TEND_FALL_STEADY;
+		}
+		if((d1 < 0) && (d2 > 0))
+		{
+			return PRESS_TEND_FALL_RISE;
+		}
+		if((d1 >= 0) && (d2 < 0))
+		{
+			return PRESS_TEND_RISE_FALL_LOWER;
+		}
+		return PRESS_TEND_FALL;
+	}
+
+	// same as at the start of the window
+	if((d1 > 0) && (d2 < 0))
+	{
+		return PRESS_TEND_RISE_FALL;
+	}
+	if((d1 < 0) && (d2 > 0))
+	{
+		return PRESS_TEND_FALL_RISE;
+	}
+	return PRESS_TEND_STEADY;
+}
+
+press_storm_t press_tendency_update(int32_t slope, int32_t start, int32_t mid, int32_t end)
+{
+	state.slope = slope;
+	state.change = end - start;
+	state.code = press_tendency_classify(mid - start, end - mid, cfg.steady);
+	state.storm = storm_level(state.storm, slope);
+	state.updates++;
+
+	return state.storm;
+}
+
+void press_tendency_get(press_tendency_t* out)
+{
+	assert(out);
+
+	*out = state;
+}
+
+const char* press_tendency_name(press_tend_code_t code)
+{
+	if(code >= PRESS_TEND_COUNT)
+	{
+		return "unknown";
+	}
+
+	return names[code];
+}
@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "spsc_ring.h"
+
+//#pragma mark - Private Functions -
+
+static inline uint32_t load_acquire(volatile uint32_t* p)
+{
+	return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(volatile uint32_t* p, uint32_t v)
+{
+	__atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+
+//#pragma mark - APIs -
+
+int spsc_ring_init(spsc_ring_t* r, void* buffer, uint16_t elem_size, uint32_t capacity)
+{
+	assert(r && buffer && elem_size);
+
+	if((capacity == 0) || ((capacity & (capacity - 1)) != 0))
+	{
+		return -1;
+	}
+
+	r->buffer = buffer;
+	r->mask = capacity - 1;
+	r->elem_size = elem_size;
+	r->head = 0;
+	r->tail = 0;
+	r->dropped = 0;
+
+	return 0;
+}
+
+bool spsc_ring_push(spsc_ring_t* r, const void* elem)
+{
+	uint32_t head = r->head;
+
+	// the consumer frees slots by advancing tail, acquire so the slot is really free
+	if((head - load_acquire(&r->tail)) > r->mask)
+	{
+		r->dropped++;
+		return false;
+	}
+
+	memcpy(&r->buffer[(head & r->mask) * r->elem_size], elem, r->elem_size);
+	// publish the element only after it has been written
+	store_release(&r->head, head + 1);
+
+	return true;
+}
+
+bool spsc_ring_pop(spsc_ring_t* r, void* elem)
+{
+	uint32_t tail = r->tail;
+
+	// acquire so the element written before head was published is visible
+	if(tail == load_acquire(&r->head))
+	{
+		return false;
+	}
+
+	memcpy(elem, &r->buffer[(tail & r->mask) * r->elem_size], r->elem_size);
+	// hand the slot back only after it has been read
+	store_release(&r->tail, tail + 1);
+
+	return true;
+}
+
+uint32_t spsc_ring_size(spsc_ring_t* r)
+{
+	return load_acquire(&r->head) - load_acquire(&r->tail);
+}
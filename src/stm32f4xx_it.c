@@ -16,6 +16,7 @@
 #endif
 #include "stm32f4xx_it.h"
 #include "main.h"
+#include "Drivers/barometer.h"
 #include "hal_stm_lvgl/stm32f429i_discovery.h"
 #include "lvgl/lvgl.h"
 
@@ -72,6 +73,14 @@ void EXTI0_IRQHandler(void)
   /* USER CODE END EXTI0_IRQn 1 */
 }
 
+/**
+  * @brief This function handles EXTI line3 interrupt.
+  */
+void EXTI3_IRQHandler(void)
+{
+  HAL_GPIO_EXTI_IRQHandler(BARO_INT_Pin);
+}
+
 /**
   * @brief This function handles EXTI line0 interrupt.
   */
@@ -100,6 +109,38 @@ void EXTI15_10_IRQHandler(void)
   /* USER CODE END EXTI0_IRQn 1 */
 }
 
+/**
+  * @brief This function handles I2C3 event interrupt.
+  */
+void I2C3_EV_IRQHandler(void)
+{
+  HAL_I2C_EV_IRQHandler(&I2cHandle);
+}
+
+/**
+  * @brief This function handles I2C3 error interrupt.
+  */
+void I2C3_ER_IRQHandler(void)
+{
+  HAL_I2C_ER_IRQHandler(&I2cHandle);
+}
+
+/**
+  * @brief This function handles DMA1 stream2 (I2C3 RX) interrupt.
+  */
+void DMA1_Stream2_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(I2cHandle.hdmarx);
+}
+
+/**
+  * @brief This function handles DMA1 stream4 (I2C3 TX) interrupt.
+  */
+void DMA1_Stream4_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(I2cHandle.hdmatx);
+}
+
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
 	static uint32_t lastButtonTime = 0;
 
@@ -118,7 +159,15 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin){
 		}
 
 		if (GPIO_Pin == ACC_INT2_Pin){
+			// transient event, the source register is read in the main loop
+			acc_motion = true;
+		}
 
+		if (GPIO_Pin == BARO_INT_Pin){
+			// FIFO watermark reached, one-shot conversion done or wake threshold crossed,
+			// the data is read in the main loop
+			baro_oneshot_drdy();
+			baro_data_ready = true;
 		}
 
 
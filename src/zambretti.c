@@ -0,0 +1,121 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#include "zambretti.h"
+
+// Pressure range covered by the tables in Pa
+#define ZAMBRETTI_LOW    95000
+#define ZAMBRETTI_HIGH   105000
+#define ZAMBRETTI_BANDS  22
+
+// Seasonal shift, 7 % of the range
+#define ZAMBRETTI_SEASON ((ZAMBRETTI_HIGH - ZAMBRETTI_LOW) * 7 / 100)
+
+// Forecast per pressure band, lowest pressure first
+static const uint8_t rising[ZAMBRETTI_BANDS] =
+{
+	25, 25, 25, 24, 24, 19, 16, 12, 11, 9, 8, 6, 5, 2, 1, 1, 0, 0, 0, 0, 0, 0
+};
+
+static const uint8_t steady[ZAMBRETTI_BANDS] =
+{
+	25, 25, 25, 25, 25, 25, 23, 23, 22, 18, 15, 13, 10, 4, 1, 1, 0, 0, 0, 0, 0, 0
+};
+
+static const uint8_t falling[ZAMBRETTI_BANDS] =
+{
+	25, 25, 25, 25, 25, 25, 25, 25, 23, 23, 21, 20, 17, 14, 7, 3, 1, 1, 1, 0, 0, 0
+};
+
+static const char* const texts[ZAMBRETTI_COUNT] =
+{
+	"Settled fine",
+	"Fine weather",
+	"Becoming fine",
+	"Fine, becoming less settled",
+	"Fine, possible showers",
+	"Fairly fine, improving",
+	"Fairly fine, possible showers early",
+	"Fairly fine, showery later",
+	"Showery early, improving",
+	"Changeable, mending",
+	"Fairly fine, showers likely",
+	"Rather unsettled, clearing later",
+	"Unsettled, probably improving",
+	"Showery, bright intervals",
+	"Showery, becoming less settled",
+	"Changeable, some rain",
+	"Unsettled, short fine intervals",
+	"Unsettled, rain later",
+	"Unsettled, some rain",
+	"Mostly very unsettled",
+	"Occasional rain, worsening",
+	"Rain at times, very unsettled",
+	"Rain at frequent intervals",
+	"Rain, very unsettled",
+	"Stormy, may improve",
+	"Stormy, much rain",
+};
+
+//#pragma mark - APIs -
+
+uint8_t zambretti_forecast(int32_t pa, int32_t change_3h, uint8_t month)
+{
+	const uint8_t* table = steady;
+	// April to September
+	uint8_t summer = (month >= 4) && (month <= 9);
+	int32_t band;
+
+	if(change_3h >= ZAMBRETTI_TREND)
+	{
+		table = rising;
+		if(summer)
+		{
+			pa += ZAMBRETTI_SEASON;
+		}
+	}
+	else if(change_3h <= -ZAMBRETTI_TREND)
+	{
+		table = falling;
+		if(summer)
+		{
+			pa -= ZAMBRETTI_SEASON;
+		}
+	}
+
+	if(pa <= ZAMBRETTI_LOW)
+	{
+		band = 0;
+	}
+	else if(pa >= ZAMBRETTI_HIGH)
+	{
+		band = ZAMBRETTI_BANDS - 1;
+	}
+	else
+	{
+		// division by a constant, compiled to a multiply
+		band = ((pa - ZAMBRETTI_LOW) * ZAMBRETTI_BANDS) / (ZAMBRETTI_HIGH - ZAMBRETTI_LOW);
+	}
+
+	return table[band];
+}
+
+char zambretti_letter(uint8_t code)
+{
+	if(code >= ZAMBRETTI_COUNT)
+	{
+		return '?';
+	}
+
+	return (char)('A' + code);
+}
+
+const char* zambretti_text(uint8_t code)
+{
+	if(code >= ZAMBRETTI_COUNT)
+	{
+		return "-";
+	}
+
+	return texts[code];
+}
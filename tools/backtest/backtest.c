@@ -0,0 +1,675 @@
+/*
+ * backtest.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host backtest of the storm detection. Replays a recorded pressure trace
+ *  through the sample pipeline of the firmware (press_pipeline.c: sea-level
+ *  reduction, motion gate, outlier rejection, filter, ring, statistics and
+ *  tendency, the same call as baro_batch_done() in main.c) as fast as the
+ *  host can run it and reports the lead time of the detected storms, the
+ *  false alarms and the CPU cost per sample. Several algorithm variants can
+ *  be run on the same trace.
+ *
+ *  Trace formats, one sample per BAROMETER_LOG_INTERVAL:
+ *    CSV     time_s,pa[,storm[,centi_c[,moved[,alt_pa]]]]  storm is 1 on the
+ *            sample where a storm starts, centi_c the temperature in
+ *            0.01 degC (15 degC if missing), moved is 1 on the sample where
+ *            the station was moved and alt_pa the pressure change of the
+ *            altitude steps so far (tools/tracegen), lines starting with #
+ *            and non-numeric header lines are skipped
+ *    binary  little endian records of uint32 time_s, int32 pa, uint32 flags
+ *            (bit 0 storm start, bit 1 moved), used for any file not ending
+ *            in .csv
+ *
+ *  A moved sample reports a motion event to the gate first, like the
+ *  accelerometer transient interrupt. With -m the altitude steps of the
+ *  trace (alt_pa) are checked against the offset of the gate: once the gate
+ *  is at rest again after a move its offset must have followed the step
+ *  within the given Pa or the exit status is 1. With -k the noise removed
+ *  by press_filter is reported, with -K it must be at least the given
+ *  percentage of the step variance or the exit status is 1. Both also
+ *  check the rate variance of press_filter_get() for periods of 1 s to
+ *  1 h against a double reference, saturated at 32 bits.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o backtest tools/backtest/backtest.c src/press_pipeline.c src/mem_pool.c \
+ *        src/press_stats.c src/press_tendency.c src/press_filter.c src/press_slp.c src/press_motion.c \
+ *        src/outlier.c src/press_history.c src/press_log.c
+ *
+ *  Usage:
+ *    backtest [-a variant[,variant...]] [-H horizon_h] [-r repeat] [-k] [-K min_pct]
+ *             [-m tolerance_pa] [-w warn_rate] [-W watch_rate] [-y hysteresis] trace
+ *    variants: legacy, tend3h, tend1h, kalman (default: all)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mem_pool.h"
+#include "press_tendency.h"
+#include "press_filter.h"
+#include "press_slp.h"
+#include "press_motion.h"
+#include "press_pipeline.h"
+
+// Same configuration as main.h
+#define BAROMETER_LOG_INTERVAL  60
+#define BAROMETER_ALTITUDE      0
+#define BAROMETER_OUTLIER_LEN   5
+#define BAROMETER_OUTLIER_SCALE 3
+
+// Samples of the original rule, the 4 hours of the circular buffer it walked
+#define LEGACY_LEN 240
+
+// Temperature of a trace without one, 0.01 degC
+#define TRACE_CENTI_C 1500
+
+typedef struct
+{
+	uint32_t time_s;
+	int32_t pa;
+	int16_t centi_c;
+	bool storm;
+	bool moved;
+	int32_t alt_pa;
+} sample_t;
+
+typedef struct
+{
+	const char* name;
+	const char* help;
+	uint8_t window;       // press_stats window of the slope
+	bool legacy;
+	bool kalman;          // slope is the press_filter rate
+} variant_t;
+
+static const variant_t variants[] =
+{
+	{"legacy", "max >= 1009.144 hPa and max - min >= 4 hPa in the last 4 h (original rule)", PRESS_WINDOW_3H, true, false},
+	{"tend3h", "press_tendency storm warning, slope of the 3 h window", PRESS_WINDOW_3H, false, false},
+	{"tend1h", "press_tendency storm warning, slope of the 1 h window", PRESS_WINDOW_1H, false, false},
+	{"kalman", "press_tendency storm warning, rate of press_filter", PRESS_WINDOW_3H, false, true},
+};
+
+#define VARIANT_COUNT (sizeof(variants) / sizeof(variants[0]))
+
+static sample_t* trace;
+static size_t trace_len;
+static uint8_t* alarm_on;        // alarm state per sample of the last run
+static press_tendency_cfg_t tend_cfg;
+static bool filtered;            // -k, report the noise removed by press_filter
+static double filter_min = -1;   // -K, least percentage of the step variance it has to remove
+
+//#pragma mark - Trace loading -
+
+static int trace_add(uint32_t time_s, int32_t pa, int16_t centi_c, bool storm, bool moved, int32_t alt_pa)
+{
+	static size_t cap;
+	sample_t* p;
+
+	if(trace_len == cap)
+	{
+		cap = cap ? (cap * 2) : 4096;
+		p = realloc(trace, cap * sizeof(sample_t));
+		if(p == NULL)
+		{
+			return -1;
+		}
+		trace = p;
+	}
+	trace[trace_len].time_s = time_s;
+	trace[trace_len].pa = pa;
+	trace[trace_len].centi_c = centi_c;
+	trace[trace_len].storm = storm;
+	trace[trace_len].moved = moved;
+	trace[trace_len].alt_pa = alt_pa;
+	trace_len++;
+
+	return 0;
+}
+
+static int load_csv(FILE* f)
+{
+	char line[256];
+	unsigned long t;
+	long pa;
+	int storm;
+	int centi_c;
+	int moved;
+	long alt_pa;
+	int n;
+
+	while(fgets(line, sizeof(line), f) != NULL)
+	{
+		if(line[0] == '#')
+		{
+			continue;
+		}
+		storm = 0;
+		centi_c = TRACE_CENTI_C;
+		moved = 0;
+		alt_pa = 0;
+		n = sscanf(line, "%lu,%ld,%d,%d,%d,%ld", &t, &pa, &storm, &centi_c, &moved, &alt_pa);
+		if(n < 2)
+		{
+			// header or empty line
+			continue;
+		}
+		if(trace_add((uint32_t)t, (int32_t)pa, (int16_t)centi_c, storm != 0, moved != 0, (int32_t)alt_pa) != 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static uint32_t get_u32(const uint8_t* p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static int load_bin(FILE* f)
+{
+	uint8_t rec[12];
+	uint32_t flags;
+
+	while(fread(rec, sizeof(rec), 1, f) == 1)
+	{
+		flags = get_u32(&rec[8]);
+		if(trace_add(get_u32(&rec[0]), (int32_t)get_u32(&rec[4]), TRACE_CENTI_C, (flags & 1) != 0, (flags & 2) != 0, 0) != 0)
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int load_trace(const char* path)
+{
+	FILE* f;
+	size_t len = strlen(path);
+	int ret;
+
+	f = fopen(path, "rb");
+	if(f == NULL)
+	{
+		perror(path);
+		return -1;
+	}
+	if((len > 4) && (strcmp(&path[len - 4], ".csv") == 0))
+	{
+		ret = load_csv(f);
+	}
+	else
+	{
+		ret = load_bin(f);
+	}
+	fclose(f);
+
+	return ret;
+}
+
+//#pragma mark - Replay -
+
+static int run_init(const variant_t* v)
+{
+	press_pipeline_cfg_t cfg;
+
+	// same configuration as main(), only the slope of the tendency differs
+	cfg.period_s = BAROMETER_LOG_INTERVAL;
+	cfg.outlier_len = BAROMETER_OUTLIER_LEN;
+	cfg.outlier_scale = BAROMETER_OUTLIER_SCALE;
+	cfg.slope_window = v->window;
+	cfg.filter_rate = v->kalman;
+	cfg.tendency = &tend_cfg;
+	cfg.filter = NULL;
+	press_slp_set_altitude(BAROMETER_ALTITUDE);
+
+	return press_pipeline_init(&cfg);
+}
+
+// The original rule on the last LEGACY_LEN samples of the ring
+static bool run_legacy(void)
+{
+	const baro_ring_t* ring = press_pipeline_ring();
+	size_t n = baro_ring_size(ring);
+	size_t i = (n > LEGACY_LEN) ? (n - LEGACY_LEN) : 0;
+	uint16_t min = UINT16_MAX;
+	uint16_t max = 0;
+	uint16_t v;
+
+	for(; baro_ring_at(ring, i, &v); i++)
+	{
+		min = (v < min) ? v : min;
+		max = (v > max) ? v : max;
+	}
+	// 1009.144 hPa is 10914.4 above the 900 hPa offset
+	return (n > 0) && ((max * 10) >= 109144) && ((max - min) >= 400);
+}
+
+static double run(const variant_t* v, unsigned repeat)
+{
+	press_pipeline_result_t res;
+	struct timespec t0, t1;
+	unsigned r;
+	size_t i;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(r = 0; r < repeat; r++)
+	{
+		if(run_init(v) != 0)
+		{
+			fprintf(stderr, "pipeline configuration rejected\n");
+			exit(1);
+		}
+		for(i = 0; i < trace_len; i++)
+		{
+			// as acc_event_done() and baro_batch_done() in main.c
+			if(trace[i].moved)
+			{
+				press_motion_event();
+			}
+			press_pipeline_put(trace[i].pa, trace[i].centi_c, true, &res);
+			alarm_on[i] = v->legacy ? run_legacy() : (res.storm == PRESS_STORM_WARNING);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	return ((double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec)) / ((double)trace_len * repeat);
+}
+
+//#pragma mark - Scoring -
+
+static void score(const variant_t* v, uint32_t horizon_s, double ns)
+{
+	size_t i, j;
+	unsigned storms = 0;
+	unsigned detected = 0;
+	unsigned alarms = 0;
+	unsigned false_alarms = 0;
+	double lead_sum = 0;
+	uint32_t lead_min = UINT32_MAX;
+	uint32_t lead_max = 0;
+	uint32_t lead;
+	bool hit;
+	double days = (trace[trace_len - 1].time_s - trace[0].time_s) / 86400.0;
+
+	for(i = 0; i < trace_len; i++)
+	{
+		// alarm rising edges
+		if(alarm_on[i] && ((i == 0) || !alarm_on[i - 1]))
+		{
+			alarms++;
+			hit = false;
+			for(j = i; (j < trace_len) && ((trace[j].time_s - trace[i].time_s) <= horizon_s); j++)
+			{
+				if(trace[j].storm)
+				{
+					hit = true;
+					break;
+				}
+			}
+			if(!hit)
+			{
+				false_alarms++;
+			}
+		}
+
+		if(!trace[i].storm)
+		{
+			continue;
+		}
+		// earliest alarm edge within the horizon before the storm start
+		storms++;
+		hit = false;
+		for(j = i + 1; j-- > 0;)
+		{
+			if((trace[i].time_s - trace[j].time_s) > horizon_s)
+			{
+				break;
+			}
+			if(alarm_on[j] && ((j == 0) || !alarm_on[j - 1]))
+			{
+				hit = true;
+				lead = trace[i].time_s - trace[j].time_s;
+			}
+		}
+		if(hit)
+		{
+			detected++;
+			lead_sum += lead;
+			lead_min = (lead < lead_min) ? lead : lead_min;
+			lead_max = (lead > lead_max) ? lead : lead_max;
+		}
+	}
+
+	printf("%-8s storms %u detected %u missed %u | alarms %u false %u (%.2f/day) | ",
+			v->name, storms, detected, storms - detected, alarms, false_alarms,
+			(days > 0) ? (false_alarms / days) : 0.0);
+	if(detected)
+	{
+		printf("lead min/avg/max %.1f/%.1f/%.1f h | ", lead_min / 3600.0, lead_sum / detected / 3600.0, lead_max / 3600.0);
+	}
+	else
+	{
+		printf("lead - | ");
+	}
+	printf("%.1f ns/sample\n", ns);
+}
+
+// Rate variance of the filter for every sample period of main.h up to 1 h, right after the first
+// reading p11 is the clamped rate_var0, the output must be its Q16 Pa^2 per sample in 0.01 (Pa/h)^2
+// Returns the number of mismatches
+static unsigned filter_rate_var_check(void)
+{
+	static const uint16_t periods[] = {1, 2, 10, 60, 600, 3600};
+	press_filter_cfg_t cfg = {PRESS_FILTER_MEAS_VAR, PRESS_FILTER_PRESS_VAR, PRESS_FILTER_RATE_VAR, 0};
+	press_filter_t out;
+	double per_hour, exp;
+	unsigned failed = 0;
+	unsigned shift;
+	size_t p;
+
+	for(p = 0; p < (sizeof(periods) / sizeof(periods[0])); p++)
+	{
+		// 1/65536 .. 4096 Pa^2 per sample, the clamp of press_filter.c
+		for(shift = 0; shift <= 28; shift++)
+		{
+			cfg.rate_var0 = (uint32_t)1 << shift;
+			press_filter_init(&cfg, periods[p]);
+			press_filter_update(101325);
+			press_filter_get(&out);
+			per_hour = 3600 / periods[p];
+			// exact in a double below the saturation
+			exp = (cfg.rate_var0 / 65536.0) * per_hour * per_hour * 100.0;
+			exp = (exp > UINT32_MAX) ? UINT32_MAX : (double)(uint64_t)exp;
+			if(out.rate_var != (uint32_t)exp)
+			{
+				if(failed++ < 10)
+				{
+					printf("  period %u s, p11 2^%u: rate variance %u, expected %.0f\n",
+							periods[p], shift, out.rate_var, exp);
+				}
+			}
+		}
+	}
+
+	return failed;
+}
+
+// Noise removed by the filter, as the variance of the sample to sample differences
+// (the weather changes by far less than the noise from one sample to the next)
+// Returns the number of failed checks: less than min_pct removed, if it is not negative,
+// and the rate variance
+static unsigned filter_report(unsigned repeat, double min_pct)
+{
+	struct timespec t0, t1;
+	double raw = 0;
+	double out = 0;
+	double d;
+	int32_t prev = 0;
+	int32_t pa;
+	volatile int32_t sink;
+	double pct;
+	unsigned failed;
+	unsigned r;
+	size_t i;
+
+	for(i = 1; i < trace_len; i++)
+	{
+		d = trace[i].pa - trace[i - 1].pa;
+		raw += d * d;
+	}
+	press_filter_init(NULL, BAROMETER_LOG_INTERVAL);
+	for(i = 0; i < trace_len; i++)
+	{
+		pa = press_filter_update(trace[i].pa);
+		if(i > 0)
+		{
+			d = pa - prev;
+			out += d * d;
+		}
+		prev = pa;
+	}
+	raw /= (trace_len - 1);
+	out /= (trace_len - 1);
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(r = 0; r < repeat; r++)
+	{
+		press_filter_init(NULL, BAROMETER_LOG_INTERVAL);
+		for(i = 0; i < trace_len; i++)
+		{
+			sink = press_filter_update(trace[i].pa);
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+
+	pct = (raw > 0) ? (100.0 * (raw - out) / raw) : 0.0;
+	printf("filter   step variance raw %.3f Pa^2 filtered %.3f Pa^2 (%.1f%% less) | %.1f ns/sample\n",
+			raw, out, pct,
+			((double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec)) / ((double)trace_len * repeat));
+	(void)sink;
+
+	failed = filter_rate_var_check();
+	if(min_pct >= 0)
+	{
+		printf("filter   %.1f%% of the step variance removed, at least %.1f%% | %s\n", pct, min_pct,
+				(pct >= min_pct) ? "ok" : "FAILED");
+		failed += (pct < min_pct);
+	}
+	if(failed != 0)
+	{
+		printf("filter   FAILED: %u failures\n", failed);
+	}
+
+	return failed;
+}
+
+// Altitude steps of the trace against the offset of the motion gate
+// Returns the number of steps the offset did not follow within tol Pa
+static unsigned motion_check(int32_t tol)
+{
+	press_pipeline_result_t res;
+	press_motion_t gate;
+	int32_t start = 0;      // offset before the step
+	int32_t base = 0;       // alt_pa before the step
+	int32_t step;
+	int32_t err;
+	int32_t err_max = 0;
+	unsigned steps = 0;
+	unsigned over = 0;
+	bool open = false;
+	size_t i;
+
+	// tend3h, the configuration of main.c
+	if(run_init(&variants[1]) != 0)
+	{
+		return 1;
+	}
+	for(i = 0; i < trace_len; i++)
+	{
+		if(trace[i].moved)
+		{
+			// a move before the gate is at rest again adds to the step
+			if(!open)
+			{
+				press_motion_get(&gate);
+				start = gate.offset;
+				base = (i > 0) ? trace[i - 1].alt_pa : 0;
+				open = true;
+			}
+			press_motion_event();
+		}
+		press_pipeline_put(trace[i].pa, trace[i].centi_c, true, &res);
+
+		press_motion_get(&gate);
+		if(!open || gate.moving || trace[i].moved)
+		{
+			continue;
+		}
+		// at rest again, the offset took the step up
+		open = false;
+		steps++;
+		step = trace[i].alt_pa - base;
+		err = (gate.offset - start) - step;
+		err = (err < 0) ? -err : err;
+		err_max = (err > err_max) ? err : err_max;
+		if(err > tol)
+		{
+			over++;
+			if(over <= 10)
+			{
+				printf("  t %u s: step %d Pa, offset moved by %d Pa\n", trace[i].time_s, step, gate.offset - start);
+			}
+		}
+	}
+
+	press_motion_get(&gate);
+	printf("motion   events %u held %u rebases %u not confirmed %u | steps %u, offset error max %d Pa, %u over %d Pa | %s\n",
+			gate.events, gate.held, gate.rebases, gate.rejected, steps, err_max, over, tol, (over == 0) ? "ok" : "FAILED");
+
+	return over;
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	size_t i;
+
+	fprintf(stderr, "usage: backtest [-a variant[,variant...]] [-H horizon_h] [-r repeat] [-k] [-K min_pct]\n"
+			"                [-m tolerance_pa] [-w warn_rate] [-W watch_rate] [-y hysteresis] trace\n"
+			"  -H  storm must start within this many hours after an alarm (default 12)\n"
+			"  -r  replay the trace this many times for the timing (default 1)\n"
+			"  -k  report the noise removed by press_filter\n"
+			"  -K  as -k, fail if it removes less than this many %% of the step variance\n"
+			"  -m  check that the motion gate removes the altitude steps within this many Pa\n"
+			"  -w/-W/-y  press_tendency thresholds in Pa/h (default %d/%d/%d)\n"
+			"variants:\n", PRESS_TENDENCY_WARN_RATE, PRESS_TENDENCY_WATCH_RATE, PRESS_TENDENCY_HYSTERESIS);
+	for(i = 0; i < VARIANT_COUNT; i++)
+	{
+		fprintf(stderr, "  %-8s %s\n", variants[i].name, variants[i].help);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	const char* selected = NULL;
+	unsigned horizon_h = 12;
+	unsigned repeat = 1;
+	int32_t motion_tol = -1;
+	unsigned failures = 0;
+	char list[256];
+	char* name;
+	double ns;
+	size_t i;
+	int opt;
+
+	tend_cfg.steady = PRESS_TENDENCY_STEADY;
+	tend_cfg.watch_rate = PRESS_TENDENCY_WATCH_RATE;
+	tend_cfg.warn_rate = PRESS_TENDENCY_WARN_RATE;
+	tend_cfg.hysteresis = PRESS_TENDENCY_HYSTERESIS;
+
+	while((opt = getopt(argc, argv, "a:H:r:kK:m:w:W:y:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'a':
+			selected = optarg;
+			break;
+		case 'H':
+			horizon_h = (unsigned)atoi(optarg);
+			break;
+		case 'r':
+			repeat = (unsigned)atoi(optarg);
+			break;
+		case 'k':
+			filtered = true;
+			break;
+		case 'K':
+			filtered = true;
+			filter_min = atof(optarg);
+			break;
+		case 'm':
+			motion_tol = atoi(optarg);
+			break;
+		case 'w':
+			tend_cfg.warn_rate = atoi(optarg);
+			break;
+		case 'W':
+			tend_cfg.watch_rate = atoi(optarg);
+			break;
+		case 'y':
+			tend_cfg.hysteresis = atoi(optarg);
+			break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((optind >= argc) || (repeat == 0) || (tend_cfg.warn_rate > tend_cfg.watch_rate) || (tend_cfg.hysteresis < 0))
+	{
+		usage();
+		return 1;
+	}
+
+	if((load_trace(argv[optind]) != 0) || (trace_len < 2))
+	{
+		fprintf(stderr, "%s: no samples\n", argv[optind]);
+		return 1;
+	}
+	alarm_on = calloc(trace_len, 1);
+	if(alarm_on == NULL)
+	{
+		return 1;
+	}
+	printf("%s: %zu samples, %.1f days\n", argv[optind], trace_len,
+			(trace[trace_len - 1].time_s - trace[0].time_s) / 86400.0);
+	if(filtered)
+	{
+		failures += filter_report(repeat, filter_min);
+	}
+	// the ring of the pipeline comes from the pool once, every run resets it
+	mem_pool_init();
+	if(motion_tol >= 0)
+	{
+		failures += motion_check(motion_tol);
+	}
+
+	for(i = 0; i < VARIANT_COUNT; i++)
+	{
+		if(selected != NULL)
+		{
+			// run only the variants named in the list
+			snprintf(list, sizeof(list), "%s", selected);
+			for(name = strtok(list, ","); name != NULL; name = strtok(NULL, ","))
+			{
+				if(strcmp(name, variants[i].name) == 0)
+				{
+					break;
+				}
+			}
+			if(name == NULL)
+			{
+				continue;
+			}
+		}
+		ns = run(&variants[i], repeat);
+		score(&variants[i], horizon_h * 3600, ns);
+	}
+
+	free(alarm_on);
+	free(trace);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,322 @@
+/*
+ * benchsim.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host run of the barometer settings sweep. src/baro_bench.c runs
+ *  unchanged against the register-level LPS28DFW mock (tools/mock): the
+ *  conversions are scheduled from the ODR and AVG codes the sweep writes,
+ *  one-shot conversions end after the modelled conversion time, data ready
+ *  is read from the mock INT pin. The clock is virtual and in us, bus
+ *  transactions take their time on the wire at 100 kHz and every poll of
+ *  the INT pin a few us.
+ *
+ *  The sensor is a model: the noise falls with the square root of the
+ *  averages and the low-pass filter is a first order filter with its
+ *  cut-off at ODR/4 or ODR/9. Next to every result the noise of the model
+ *  is printed, the sweep has to find it back. Every result also goes
+ *  through the binary frame and back, the frames that do not decode to the
+ *  same result are counted. The virtual time of the whole sweep is what
+ *  the "bb" console command takes on the station.
+ *
+ *  The sweep is run with baro_bench_step() the way the superloop steps it,
+ *  the longest step is the longest the superloop is held up. A step over
+ *  STEP_MAX_US makes the exit status 1, like a frame error.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -Itools/mock -o benchsim tools/benchsim/benchsim.c \
+ *        tools/mock/lps28dfw_mock.c src/baro_bench.c -lm
+ *
+ *  Usage:
+ *    benchsim [-n samples] [-o odr_code] [-t startup_us] [-u us_per_sample] [-N noise_pa] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "baro_bench.h"
+#include "lps28dfw_mock.h"
+
+// 1260 hPa full scale, 4096 LSB/hPa
+#define COUNTS_PER_PA 40.96
+
+// bus clock of the I2C transactions
+#define BUS_HZ 100000.0
+
+// time of one poll of the INT pin
+#define POLL_US 20
+
+// longest step of the sweep, a pass of the superloop takes a few ms
+#define STEP_MAX_US 5000
+
+static uint64_t now_us;
+static double startup_us = 1000.0;
+static double sample_us = 200.0;
+static double noise = 1.0;
+
+// conversions of the model
+static uint8_t odr_code;
+static uint64_t next_conv;
+static uint64_t oneshot_at;
+static bool oneshot_pending;
+static double filtered;
+static bool filter_valid;
+
+// frames through the encoder and the decoder
+static unsigned long frames;
+static unsigned long frame_errors;
+
+// steps of the sweep and the longest one in us
+static unsigned long steps;
+static uint64_t step_max;
+
+static int32_t sim_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+static int32_t sim_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+static uint32_t sim_tick(void);
+static uint8_t sim_int(void* handle);
+
+static const baro_bench_ctx_t sim_ctx = {sim_write, sim_read, sim_tick, sim_int, NULL};
+
+//#pragma mark - Model -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Weather: a slow drift, a few Pa per hour
+static double truth(double t)
+{
+	return 101325.0 - (t / 3600.0) * 5.0;
+}
+
+static unsigned avg_samples(uint8_t code)
+{
+	return 4u << code;
+}
+
+static double conversion_us(uint8_t code)
+{
+	return startup_us + sample_us * avg_samples(code);
+}
+
+// First order low-pass, cut-off at ODR/4 or ODR/9
+static double lpf_alpha(uint8_t lpf)
+{
+	if(!(lpf & 0x01))
+	{
+		return 1.0;
+	}
+	return 1.0 - exp(-2.0 * M_PI / ((lpf & 0x02) ? 9.0 : 4.0));
+}
+
+// Noise of the model for a setting, white noise through the filter
+static double model_noise(uint8_t avg, uint8_t lpf)
+{
+	double a = lpf_alpha(lpf);
+
+	return noise * sqrt(4.0 / avg_samples(avg)) * sqrt(a / (2.0 - a));
+}
+
+static void convert(bool continuous)
+{
+	double p = truth(now_us / 1e6) + gauss() * noise * sqrt(4.0 / avg_samples(lps28dfw_mock_avg()));
+	double a = continuous ? lpf_alpha(lps28dfw_mock_lpf()) : 1.0;
+
+	filtered = filter_valid ? (filtered + a * (p - filtered)) : p;
+	filter_valid = continuous;
+	lps28dfw_mock_sample((int32_t)lround(filtered * COUNTS_PER_PA), 2000);
+}
+
+// End the conversions that are due at the current time
+static void advance(void)
+{
+	uint8_t odr = lps28dfw_mock_odr();
+
+	if(odr != odr_code)
+	{
+		// a new rate starts from the current time, the filter from the first conversion
+		odr_code = odr;
+		filter_valid = false;
+		if(odr != 0)
+		{
+			next_conv = now_us + (uint64_t)(1e6 / baro_bench_odr_hz(odr));
+		}
+	}
+	if(oneshot_pending && (now_us >= (oneshot_at + (uint64_t)conversion_us(lps28dfw_mock_avg()))))
+	{
+		oneshot_pending = false;
+		convert(false);
+	}
+	while((odr_code != 0) && (now_us >= next_conv))
+	{
+		convert(true);
+		next_conv += (uint64_t)(1e6 / baro_bench_odr_hz(odr_code));
+	}
+}
+
+// start, address, register, for reads the repeated start and address, 9 bits per byte, stop
+static void bus_time(uint8_t write, uint16_t len)
+{
+	double bits = write ? (1 + 18 + (9.0 * len) + 1) : (2 + 27 + (9.0 * len) + 1);
+
+	now_us += (uint64_t)ceil(bits * 1e6 / BUS_HZ);
+	advance();
+}
+
+static int32_t sim_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	bus_time(0, len);
+	return lps28dfw_mock_read(handle, reg, bufp, len);
+}
+
+static int32_t sim_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	int32_t ret;
+
+	bus_time(1, len);
+	ret = lps28dfw_mock_write(handle, reg, bufp, len);
+	if(lps28dfw_mock_oneshot() && !oneshot_pending)
+	{
+		oneshot_pending = true;
+		oneshot_at = now_us;
+	}
+	advance();
+	return ret;
+}
+
+static uint32_t sim_tick(void)
+{
+	return (uint32_t)now_us;
+}
+
+static uint8_t sim_int(void* handle)
+{
+	(void)handle;
+	now_us += POLL_US;
+	advance();
+	return lps28dfw_mock_int() ? 1 : 0;
+}
+
+//#pragma mark - Output -
+
+static const char* lpf_name(uint8_t lpf)
+{
+	switch(lpf)
+	{
+	case BARO_BENCH_LPF_ODR_4: return "odr/4";
+	case BARO_BENCH_LPF_ODR_9: return "odr/9";
+	default: return "off";
+	}
+}
+
+static void result(const baro_bench_result_t* r)
+{
+	uint8_t frame[BARO_BENCH_FRAME_LEN];
+	baro_bench_result_t back;
+
+	frames++;
+	if((baro_bench_encode(r, frame) != BARO_BENCH_FRAME_LEN) ||
+			(baro_bench_decode(frame, &back) != 0) ||
+			(memcmp(r, &back, sizeof(back)) != 0))
+	{
+		frame_errors++;
+	}
+
+	if(r->status == BARO_BENCH_SKIPPED)
+	{
+		printf("%4u Hz  x%-4u %-6s  skipped, conversion %u us\n",
+				baro_bench_odr_hz(r->odr), avg_samples(r->avg), lpf_name(r->lpf), r->conv_us);
+		return;
+	}
+	printf("%4u Hz  x%-4u %-6s %5u %9u %9.0f %9u %9u %6u %6u%s\n",
+			baro_bench_odr_hz(r->odr), avg_samples(r->avg), lpf_name(r->lpf), r->samples,
+			r->noise_mpa, model_noise(r->avg, r->lpf) * 1000.0, r->conv_us, r->period_us,
+			r->bus_us, r->errors, (r->status == BARO_BENCH_TIMEOUT) ? " timeout" : "");
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: benchsim [-n samples] [-o odr_code] [-t startup_us] [-u us_per_sample] [-N noise_pa] [-s seed]\n"
+			"  defaults: 32 samples, all ODR codes 1..8, 1000 us + 200 us per sample, noise 1.0 Pa at 4 averages,\n"
+			"  seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	int samples = 32;
+	int odr = 0;
+	long seed = 1;
+	uint64_t start;
+	int ret;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:o:t:u:N:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': samples = atoi(optarg); break;
+		case 'o': odr = atoi(optarg); break;
+		case 't': startup_us = atof(optarg); break;
+		case 'u': sample_us = atof(optarg); break;
+		case 'N': noise = atof(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((samples < BARO_BENCH_SAMPLES_MIN) || (samples > BARO_BENCH_SAMPLES_MAX) ||
+			(odr < 0) || (odr > BARO_BENCH_ODR_MAX) || (startup_us < 0) || (sample_us < 0) || (noise < 0))
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+	lps28dfw_mock_init();
+
+	printf("%d samples per setting, conversion %.0f us + %.0f us per averaged sample, noise %.2f Pa at 4 averages\n",
+			samples, startup_us, sample_us, noise);
+	printf("    odr  avg   lpf    samples  noise mPa  model mPa   conv us  period us  bus us errors\n");
+	if(baro_bench_start(&sim_ctx, (uint8_t)odr, (uint16_t)samples, result) != 0)
+	{
+		fprintf(stderr, "sweep failed\n");
+		return 1;
+	}
+	do
+	{
+		start = now_us;
+		ret = baro_bench_step();
+		steps++;
+		step_max = ((now_us - start) > step_max) ? (now_us - start) : step_max;
+	} while(ret > 0);
+	if(ret != 0)
+	{
+		fprintf(stderr, "sweep failed\n");
+		return 1;
+	}
+	printf("sweep %.1f s in %lu steps, longest %u us (max %u), %lu frames of %u bytes, %lu frame errors\n",
+			now_us / 1e6, steps, (unsigned)step_max, STEP_MAX_US, frames, BARO_BENCH_FRAME_LEN, frame_errors);
+
+	return (frame_errors || (step_max > STEP_MAX_US)) ? 1 : 0;
+}
@@ -0,0 +1,333 @@
+/*
+ * cbufbench.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Host benchmark of the scans over the circular buffer
+ *  (src/circular_buffer.c) at 240 (the old barometer buffer), 4096 and
+ *  65536 samples. A full buffer that has wrapped is read oldest first
+ *  three ways:
+ *
+ *    - peek: the loop get_press_trend() and the "cb" command had before,
+ *      circular_buf_peek() of the first i values for i = 1..size, the
+ *      newest copied value is the one used, O(n^2)
+ *    - at:   circular_buf_at() of every index, O(n)
+ *    - spans: one pass over the two segments of circular_buf_spans()
+ *
+ *  Reported is the time of one full scan and per value. The sums of the
+ *  three scans must be equal. The O(n^2) scan runs once per size, at 65536
+ *  samples it takes about 20 s.
+ *
+ *  Then the range operations are timed against the per-element calls they
+ *  replace, a whole buffer at a time: circular_buf_put_range() against
+ *  circular_buf_put() of every value, circular_buf_get_range() against
+ *  circular_buf_get() until empty and circular_buf_peek_range() against
+ *  circular_buf_at() of every index. Both must give the values that were
+ *  put. A mismatch makes the exit status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o cbufbench tools/cbufbench/cbufbench.c src/circular_buffer.c src/mem_pool.c
+ *
+ *  Usage:
+ *    cbufbench [-n scans] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "circular_buffer.h"
+#include "mem_pool.h"
+
+#define MAX_SIZE 65536
+
+typedef enum {
+	SCAN_PEEK = 0,
+	SCAN_AT,
+	SCAN_SPANS,
+	SCAN_COUNT
+} scan_t;
+
+static const char* const scan_names[SCAN_COUNT] = {"peek", "at", "spans"};
+
+typedef enum {
+	RANGE_PUT = 0,
+	RANGE_GET,
+	RANGE_PEEK,
+	RANGE_COUNT
+} range_t;
+
+static const char* const range_names[RANGE_COUNT] = {"put", "get", "peek"};
+
+static const size_t sizes[] = {240, 4096, MAX_SIZE};
+
+static uint16_t storage[MAX_SIZE];
+
+// Output of circular_buf_peek(), it copies up to the whole buffer
+static uint16_t peek_out[MAX_SIZE];
+
+// Values put and read back by the range operations
+static uint16_t values[MAX_SIZE];
+static uint16_t range_out[MAX_SIZE];
+
+static unsigned long failures;
+
+// Keeps the reads from being optimised away
+static volatile uint32_t sink;
+
+//#pragma mark - Timing -
+
+static double now_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec * 1e9) + t.tv_nsec;
+}
+
+//#pragma mark - Scans -
+
+static uint32_t scan(cbuf_handle_t me, scan_t how)
+{
+	const uint16_t* first;
+	const uint16_t* second;
+	size_t first_len, second_len;
+	size_t size = circular_buf_size(me);
+	uint32_t sum = 0;
+	uint16_t v;
+	size_t i;
+
+	switch(how)
+	{
+	case SCAN_PEEK:
+		for(i = 1; i <= size; i++)
+		{
+			circular_buf_peek(me, peek_out, i);
+			sum += peek_out[i - 1];
+		}
+		break;
+	case SCAN_AT:
+		for(i = 0; circular_buf_at(me, i, &v) == 0; i++)
+		{
+			sum += v;
+		}
+		break;
+	default:
+		circular_buf_spans(me, &first, &first_len, &second, &second_len);
+		for(i = 0; i < first_len; i++)
+		{
+			sum += first[i];
+		}
+		for(i = 0; i < second_len; i++)
+		{
+			sum += second[i];
+		}
+		break;
+	}
+	return sum;
+}
+
+// Returns the time of one scan in ns, the sum of the values in *sum
+static double time_scan(cbuf_handle_t me, scan_t how, unsigned long n, uint32_t* sum)
+{
+	unsigned long i;
+	double t0;
+
+	t0 = now_ns();
+	for(i = 0; i < n; i++)
+	{
+		*sum = scan(me, how);
+		sink = *sum;
+	}
+	return (now_ns() - t0) / n;
+}
+
+//#pragma mark - Range operations -
+
+// Move a whole buffer with one range call or one call per value
+static void range_op(cbuf_handle_t me, range_t op, bool bulk, size_t size)
+{
+	size_t i;
+
+	switch(op)
+	{
+	case RANGE_PUT:
+		if(bulk)
+		{
+			circular_buf_put_range(me, values, size);
+		}
+		else
+		{
+			for(i = 0; i < size; i++)
+			{
+				circular_buf_put(me, values[i]);
+			}
+		}
+		break;
+	case RANGE_GET:
+		if(bulk)
+		{
+			circular_buf_get_range(me, range_out, size);
+		}
+		else
+		{
+			for(i = 0; circular_buf_get(me, &range_out[i]) == 0; i++)
+			{
+			}
+		}
+		break;
+	default:
+		if(bulk)
+		{
+			circular_buf_peek_range(me, 0, range_out, size);
+		}
+		else
+		{
+			for(i = 0; circular_buf_at(me, i, &range_out[i]) == 0; i++)
+			{
+			}
+		}
+		break;
+	}
+}
+
+// Returns the time of one operation over the whole buffer in ns
+static double time_range(cbuf_handle_t me, range_t op, bool bulk, size_t size, unsigned long n)
+{
+	unsigned long i;
+	double t = 0;
+	double t0;
+
+	for(i = 0; i < n; i++)
+	{
+		// a put goes into cleared storage, a get starts from a full buffer, neither is timed
+		if(op == RANGE_PUT)
+		{
+			memset(storage, 0, size * sizeof(uint16_t));
+		}
+		else
+		{
+			circular_buf_put_range(me, values, size);
+		}
+		memset(range_out, 0, size * sizeof(uint16_t));
+		t0 = now_ns();
+		range_op(me, op, bulk, size);
+		t += now_ns() - t0;
+	}
+	// the put is read back
+	if(op == RANGE_PUT)
+	{
+		circular_buf_peek_range(me, 0, range_out, size);
+	}
+	if(memcmp(range_out, values, size * sizeof(uint16_t)) != 0)
+	{
+		failures++;
+		printf("  size %zu: %s %s values differ\n", size, range_names[op], bulk ? "range" : "per value");
+	}
+	return t / n;
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: cbufbench [-n scans] [-s seed]\n"
+			"  defaults: 1000 scans of at and spans and range operations per size, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long n = 1000;
+	long seed = 1;
+	cbuf_handle_t me;
+	uint32_t sums[SCAN_COUNT];
+	double ns[SCAN_COUNT];
+	double each_ns, range_ns;
+	size_t size, i, k;
+	scan_t how;
+	range_t op;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': n = (unsigned long)atol(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if(n == 0)
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+
+	printf("%-6s  %-5s  %14s  %10s  %8s\n", "size", "scan", "ns per scan", "ns/value", "vs peek");
+	for(k = 0; k < (sizeof(sizes) / sizeof(sizes[0])); k++)
+	{
+		size = sizes[k];
+		mem_pool_init();
+		me = circular_buf_init(storage, size);
+		if(me == NULL)
+		{
+			return 1;
+		}
+		// full and wrapped, the spans have two segments
+		for(i = 0; i < (size + (size / 3)); i++)
+		{
+			circular_buf_put(me, (uint16_t)(drand48() * (UINT16_MAX + 1.0)));
+		}
+
+		for(how = 0; how < SCAN_COUNT; how++)
+		{
+			// the O(n^2) scan runs once
+			ns[how] = time_scan(me, how, (how == SCAN_PEEK) ? 1 : n, &sums[how]);
+			if(sums[how] != sums[SCAN_PEEK])
+			{
+				failures++;
+				printf("  size %zu: %s sum %u, peek %u\n", size, scan_names[how], sums[how], sums[SCAN_PEEK]);
+			}
+			printf("%-6zu  %-5s  %14.0f  %10.2f  %7.0fx\n", size, scan_names[how], ns[how], ns[how] / size, ns[SCAN_PEEK] / ns[how]);
+		}
+	}
+
+	printf("\n%-6s  %-5s  %16s  %16s\n", "size", "op", "per value ns/v", "range ns/v");
+	for(k = 0; k < (sizeof(sizes) / sizeof(sizes[0])); k++)
+	{
+		size = sizes[k];
+		for(i = 0; i < size; i++)
+		{
+			values[i] = (uint16_t)(drand48() * (UINT16_MAX + 1.0));
+		}
+		mem_pool_init();
+		me = circular_buf_init(storage, size);
+		if(me == NULL)
+		{
+			return 1;
+		}
+		// a whole buffer moved leaves head and tail where they were, start them a third in so every copy wraps
+		for(i = 0; i < (size / 3); i++)
+		{
+			circular_buf_put(me, 0);
+		}
+		for(op = 0; op < RANGE_COUNT; op++)
+		{
+			each_ns = time_range(me, op, false, size, n);
+			range_ns = time_range(me, op, true, size, n);
+			printf("%-6zu  %-5s  %16.2f  %16.2f  (%.1fx)\n", size, range_names[op], each_ns / size, range_ns / size, each_ns / range_ns);
+		}
+	}
+
+	printf("%s\n", (failures == 0) ? "ok" : "FAILED");
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,322 @@
+/*
+ * cbufcheck.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host check of the circular buffer (src/circular_buffer.c). Random
+ *  operations run on buffers of random capacity next to a plain model of
+ *  the contents, oldest value first. After every operation the size, the
+ *  full and empty flags, every index of circular_buf_at() and the two
+ *  segments of circular_buf_spans() are compared with the model, an index
+ *  past the newest value must be refused. The range operations run with
+ *  lengths from 0 to twice the capacity: circular_buf_put_range() must
+ *  keep the newest values like single puts, circular_buf_get_range() and
+ *  circular_buf_peek_range() must return the values and counts of the
+ *  model, also from any index and past the end. Capacity 1 and a buffer
+ *  that wraps many times are part of every run. A mismatch makes the exit
+ *  status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o cbufcheck tools/cbufcheck/cbufcheck.c src/circular_buffer.c src/mem_pool.c
+ *
+ *  Usage:
+ *    cbufcheck [-n operations] [-b buffers] [-c max_capacity] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "circular_buffer.h"
+#include "mem_pool.h"
+
+#define MAX_CAPACITY 1024
+
+// Operations, drawn with their weight
+typedef enum {
+	OP_PUT = 0,
+	OP_TRY_PUT,
+	OP_GET,
+	OP_RESET,
+	OP_PUT_RANGE,
+	OP_GET_RANGE,
+	OP_PEEK_RANGE,
+	OP_COUNT
+} op_t;
+
+static const char* const op_names[OP_COUNT] = {"put", "try_put", "get", "reset", "put_range", "get_range", "peek_range"};
+static const unsigned op_weight[OP_COUNT] = {40, 20, 35, 1, 10, 10, 10};
+
+static uint16_t storage[MAX_CAPACITY];
+
+// Data of the range operations, twice the capacity
+static uint16_t range[2 * MAX_CAPACITY];
+static uint16_t range_out[2 * MAX_CAPACITY];
+
+// Model: contents oldest first
+static uint16_t model[MAX_CAPACITY];
+static size_t model_len;
+static size_t capacity;
+
+static unsigned long failures;
+
+//#pragma mark - Model -
+
+static void model_put(uint16_t v)
+{
+	if(model_len == capacity)
+	{
+		memmove(&model[0], &model[1], (capacity - 1) * sizeof(uint16_t));
+		model_len--;
+	}
+	model[model_len++] = v;
+}
+
+static uint16_t model_get(void)
+{
+	uint16_t v = model[0];
+
+	memmove(&model[0], &model[1], (model_len - 1) * sizeof(uint16_t));
+	model_len--;
+	return v;
+}
+
+//#pragma mark - Check -
+
+static void fail(unsigned long step, op_t op, const char* what)
+{
+	if(failures++ < 10)
+	{
+		printf("  capacity %zu step %lu after %s: %s\n", capacity, step, op_names[op], what);
+	}
+}
+
+static void compare(cbuf_handle_t me, unsigned long step, op_t op)
+{
+	const uint16_t* first;
+	const uint16_t* second;
+	size_t first_len, second_len;
+	uint16_t v;
+	size_t i;
+
+	if(circular_buf_size(me) != model_len)
+	{
+		fail(step, op, "size");
+		return;
+	}
+	if((circular_buf_full(me) != (model_len == capacity)) || (circular_buf_empty(me) != (model_len == 0)))
+	{
+		fail(step, op, "full/empty");
+	}
+	for(i = 0; i < model_len; i++)
+	{
+		if((circular_buf_at(me, i, &v) != 0) || (v != model[i]))
+		{
+			fail(step, op, "at");
+			break;
+		}
+	}
+	if(circular_buf_at(me, model_len, &v) == 0)
+	{
+		fail(step, op, "at past the newest value");
+	}
+
+	if(circular_buf_spans(me, &first, &first_len, &second, &second_len) != model_len)
+	{
+		fail(step, op, "spans total");
+		return;
+	}
+	// the first segment starts at the tail and ends at the storage end at most
+	if(((first_len + second_len) != model_len) ||
+			((first_len != 0) && ((first < storage) || ((first + first_len) > (storage + capacity)))) ||
+			((second_len != 0) && (second != storage)) ||
+			((second_len != 0) && ((first + first_len) != (storage + capacity))) ||
+			(memcmp(first, model, first_len * sizeof(uint16_t)) != 0) ||
+			(memcmp(second, &model[first_len], second_len * sizeof(uint16_t)) != 0))
+	{
+		fail(step, op, "spans");
+	}
+}
+
+static op_t draw(void)
+{
+	unsigned total = 0;
+	unsigned r;
+	op_t op;
+
+	for(op = 0; op < OP_COUNT; op++)
+	{
+		total += op_weight[op];
+	}
+	r = (unsigned)(drand48() * total);
+	for(op = 0; op < (OP_COUNT - 1); op++)
+	{
+		if(r < op_weight[op])
+		{
+			break;
+		}
+		r -= op_weight[op];
+	}
+	return op;
+}
+
+// Returns the number of failures of this buffer
+static unsigned long run(size_t cap, unsigned long n)
+{
+	unsigned long before = failures;
+	cbuf_handle_t me;
+	unsigned long step;
+	uint16_t v, got;
+	size_t len, index, count, i;
+	int ret;
+	op_t op;
+
+	// one control block per buffer, the pools start empty every time
+	mem_pool_init();
+	capacity = cap;
+	model_len = 0;
+	memset(storage, 0, sizeof(storage));
+	me = circular_buf_init(storage, capacity);
+	if(me == NULL)
+	{
+		printf("  capacity %zu: no control block\n", capacity);
+		return ++failures - before;
+	}
+
+	for(step = 0; step < n; step++)
+	{
+		op = draw();
+		v = (uint16_t)(drand48() * (UINT16_MAX + 1.0));
+		len = (size_t)(drand48() * ((2 * capacity) + 1));
+		switch(op)
+		{
+		case OP_PUT:
+			circular_buf_put(me, v);
+			model_put(v);
+			break;
+		case OP_TRY_PUT:
+			ret = circular_buf_try_put(me, v);
+			if(ret != ((model_len == capacity) ? -1 : 0))
+			{
+				fail(step, op, "return value");
+			}
+			if(ret == 0)
+			{
+				model_put(v);
+			}
+			break;
+		case OP_GET:
+			ret = circular_buf_get(me, &got);
+			if((ret != 0) != (model_len == 0))
+			{
+				fail(step, op, "return value");
+			}
+			else if((ret == 0) && (got != model_get()))
+			{
+				fail(step, op, "value");
+			}
+			break;
+		case OP_PUT_RANGE:
+			for(i = 0; i < len; i++)
+			{
+				range[i] = (uint16_t)(drand48() * (UINT16_MAX + 1.0));
+			}
+			circular_buf_put_range(me, range, len);
+			for(i = 0; i < len; i++)
+			{
+				model_put(range[i]);
+			}
+			break;
+		case OP_GET_RANGE:
+			count = (len < model_len) ? len : model_len;
+			if(circular_buf_get_range(me, range_out, len) != count)
+			{
+				fail(step, op, "count");
+				model_len = 0;
+				circular_buf_reset(me);
+				break;
+			}
+			if(memcmp(range_out, model, count * sizeof(uint16_t)) != 0)
+			{
+				fail(step, op, "value");
+			}
+			memmove(&model[0], &model[count], (model_len - count) * sizeof(uint16_t));
+			model_len -= count;
+			break;
+		case OP_PEEK_RANGE:
+			index = (size_t)(drand48() * (model_len + 2));
+			count = (index >= model_len) ? 0 : (((model_len - index) < len) ? (model_len - index) : len);
+			if(circular_buf_peek_range(me, index, range_out, len) != count)
+			{
+				fail(step, op, "count");
+			}
+			else if(memcmp(range_out, &model[index], count * sizeof(uint16_t)) != 0)
+			{
+				fail(step, op, "value");
+			}
+			break;
+		default:
+			circular_buf_reset(me);
+			model_len = 0;
+			break;
+		}
+		compare(me, step, op);
+	}
+
+	return failures - before;
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: cbufcheck [-n operations] [-b buffers] [-c max_capacity] [-s seed]\n"
+			"  defaults: 100000 operations per buffer, 20 buffers, capacity up to 300, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long n = 100000;
+	unsigned buffers = 20;
+	size_t max_cap = 300;
+	long seed = 1;
+	size_t cap;
+	unsigned b;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:b:c:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': n = (unsigned long)atol(optarg); break;
+		case 'b': buffers = (unsigned)atoi(optarg); break;
+		case 'c': max_cap = (size_t)atol(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((n == 0) || (buffers < 2) || (max_cap < 2) || (max_cap > MAX_CAPACITY))
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+
+	for(b = 0; b < buffers; b++)
+	{
+		// capacity 1, the largest one and random ones in between
+		cap = (b == 0) ? 1 : ((b == 1) ? max_cap : (size_t)(1 + drand48() * max_cap));
+		run(cap, n);
+	}
+
+	printf("%s: %lu failures over %u buffers of %lu operations\n",
+			(failures == 0) ? "ok" : "FAILED", failures, buffers, n);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,125 @@
+/*
+ * convcheck.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Host equivalence check of the integer pressure conversion
+ *  (baro_counts_to_pa() of inc/baro_units.h) for every 24 bit output value
+ *  of the LPS28DFW at both full scales:
+ *
+ *    - exactly the rounded Pa of the counts, halves up, computed in double
+ *    - within 1 Pa of the float path it replaced: hPa as the ST driver
+ *      returns it (raw value shifted left by 8 over 2^20 or 2^19 in float)
+ *      and scaled to Pa as main.c did, (uint32_t)(hpa * 100 + 0.5f), for
+ *      every positive result
+ *
+ *  The number of values where the paths differ is reported for the whole
+ *  range and for the 260..1260 hPa the sensor measures. The cost of both
+ *  paths is not timed here, the host has a double precision FPU and
+ *  vectorises the loops; on the target the "pc" command counts the cycles
+ *  with the DWT. A mismatch makes the exit status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o convcheck tools/convcheck/convcheck.c -lm
+ *
+ *  Usage:
+ *    convcheck
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+
+#include "baro_units.h"
+
+// Range of the sign extended 24 bit output
+#define COUNTS_MIN (-(1 << 23))
+#define COUNTS_MAX ((1 << 23) - 1)
+
+// Pressure range of the sensor in Pa
+#define RANGE_MIN_PA 26000
+#define RANGE_MAX_PA 126000
+
+static unsigned long failures;
+
+//#pragma mark - Paths -
+
+// The float path before the integer conversion
+static uint32_t float_pa(int32_t counts, bool fs_4060)
+{
+	float hpa = (float)(counts * 256) / (fs_4060 ? 524288.0f : 1048576.0f);
+
+	return (uint32_t)(hpa * 100 + 0.5f);
+}
+
+// Exact rounded Pa, halves up; counts * 100 is exact in a double
+static int32_t exact_pa(int32_t counts, bool fs_4060)
+{
+	return (int32_t)floor(((double)counts * 100.0 / (fs_4060 ? 2048.0 : 4096.0)) + 0.5);
+}
+
+//#pragma mark - Check -
+
+static void fail(bool fs_4060, int32_t counts, const char* what, int32_t got, int64_t exp)
+{
+	if(failures++ < 10)
+	{
+		printf("  %s counts %d: %s %d, expected %lld\n", fs_4060 ? "4060 hPa" : "1260 hPa", counts, what, got,
+				(long long)exp);
+	}
+}
+
+static void check(bool fs_4060)
+{
+	unsigned long diff = 0, diff_range = 0, range = 0;
+	int64_t dmax = 0, d;
+	int32_t counts, pa, exp;
+	uint32_t fpa;
+
+	for(counts = COUNTS_MIN; counts <= COUNTS_MAX; counts++)
+	{
+		pa = baro_counts_to_pa(counts, fs_4060);
+		exp = exact_pa(counts, fs_4060);
+		if(pa != exp)
+		{
+			fail(fs_4060, counts, "integer", pa, exp);
+		}
+		// the float path only ever saw pressures above 0
+		if(pa <= 0)
+		{
+			continue;
+		}
+		fpa = float_pa(counts, fs_4060);
+		d = (int64_t)fpa - pa;
+		d = (d < 0) ? -d : d;
+		if(d > 1)
+		{
+			fail(fs_4060, counts, "float path", (int32_t)fpa, pa);
+		}
+		dmax = (d > dmax) ? d : dmax;
+		diff += (d != 0);
+		if((pa >= RANGE_MIN_PA) && (pa <= RANGE_MAX_PA))
+		{
+			range++;
+			diff_range += (d != 0);
+		}
+	}
+
+	printf("%s full scale: float path differs by up to %lld Pa on %lu values, %lu of %lu in 260..1260 hPa\n",
+			fs_4060 ? "4060 hPa" : "1260 hPa", (long long)dmax, diff, diff_range, range);
+}
+
+//#pragma mark - Main -
+
+int main(void)
+{
+	check(false);
+	check(true);
+
+	printf("%s: %lu failures\n", (failures == 0) ? "ok" : "FAILED", failures);
+
+	return (failures == 0) ? 0 : 1;
+}
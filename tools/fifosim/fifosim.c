@@ -0,0 +1,175 @@
+/*
+ * fifosim.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host simulation of the batched barometer readout. src/baro_fifo.c runs
+ *  unchanged against the register-level LPS28DFW mock (tools/mock): the
+ *  sensor converts at the ODR into its FIFO, the INT pin is checked like the
+ *  EXTI line and the FIFO is drained once it is raised, optionally late to
+ *  provoke overruns. Reported are the bus transactions and MCU wakeups per
+ *  hour compared with reading every conversion, and the noise of the batch
+ *  average compared with a single reading.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -Itools/mock -o fifosim tools/fifosim/fifosim.c \
+ *        tools/mock/lps28dfw_mock.c src/baro_fifo.c -lm
+ *
+ *  Usage:
+ *    fifosim [-d days] [-o odr_hz] [-w watermark] [-n noise_pa] [-l latency_s] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "baro_fifo.h"
+#include "baro_units.h"
+#include "lps28dfw_mock.h"
+
+// 1260 hPa full scale, 4096 LSB/hPa
+#define COUNTS_PER_PA 40.96
+
+static const baro_fifo_ctx_t mock_ctx = {lps28dfw_mock_write, lps28dfw_mock_read, NULL, NULL};
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Same conversion as barometer.c at the 1260 hPa full scale
+static int32_t counts_to_pa(int32_t counts)
+{
+	return baro_counts_to_pa(counts, false);
+}
+
+// Weather: slow drift with a semi-diurnal tide
+static double truth(double t)
+{
+	return 101325.0 - (t / 3600.0) * 20.0 + 80.0 * sin(2.0 * M_PI * t / 43200.0);
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: fifosim [-d days] [-o odr_hz] [-w watermark] [-n noise_pa] [-l latency_s] [-s seed]\n"
+			"  defaults: 1 day, 1 Hz, watermark 60, noise 1.0 Pa, latency 0 s, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	double days = 1.0;
+	unsigned odr = 1;
+	unsigned wtm = 60;
+	double noise = 1.0;
+	double latency = 0.0;
+	long seed = 1;
+	baro_fifo_batch_t batch;
+	baro_fifo_stats_t fs;
+	lps28dfw_mock_stats_t ms;
+	double t, t_end;
+	double pending = -1.0;   // time the INT pin was seen high, -1 if not
+	double batch_truth = 0.0;
+	unsigned batch_n = 0;
+	double err_single = 0.0;
+	double err_batch = 0.0;
+	double p, hours;
+	unsigned long conversions = 0;
+	unsigned long batches = 0;
+	int32_t counts;
+	int opt;
+
+	while((opt = getopt(argc, argv, "d:o:w:n:l:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'd': days = atof(optarg); break;
+		case 'o': odr = (unsigned)atoi(optarg); break;
+		case 'w': wtm = (unsigned)atoi(optarg); break;
+		case 'n': noise = atof(optarg); break;
+		case 'l': latency = atof(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((days <= 0) || (odr == 0) || (odr > 200) || (wtm == 0) || (wtm > BARO_FIFO_WTM_MAX) || (latency < 0))
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+
+	lps28dfw_mock_init();
+	if(baro_fifo_start(&mock_ctx, (uint8_t)wtm) != 0)
+	{
+		fprintf(stderr, "baro_fifo_start failed\n");
+		return 1;
+	}
+
+	t_end = days * 86400.0;
+	for(t = 0; t < t_end; t += 1.0 / odr)
+	{
+		p = truth(t);
+		counts = (int32_t)lround((p + gauss() * noise) * COUNTS_PER_PA);
+		lps28dfw_mock_sample(counts, 2000);
+		conversions++;
+		// a single reading, as the old one-shot firmware took it
+		err_single += pow(counts_to_pa(counts) - p, 2);
+		batch_truth += p;
+		batch_n++;
+
+		if((pending < 0) && lps28dfw_mock_int())
+		{
+			pending = t;
+		}
+		if((pending >= 0) && ((t - pending) >= latency))
+		{
+			pending = -1.0;
+			if((baro_fifo_drain(&batch) != 0) || (batch.samples == 0))
+			{
+				continue;
+			}
+			batches++;
+			// compare with the mean of the truth over the samples in the batch
+			err_batch += pow(counts_to_pa(batch.counts) - (batch_truth / batch_n), 2);
+			batch_truth = 0.0;
+			batch_n = 0;
+		}
+	}
+
+	baro_fifo_get_stats(&fs);
+	lps28dfw_mock_get_stats(&ms);
+	hours = t_end / 3600.0;
+	printf("%lu conversions at %u Hz over %.1f h, watermark %u\n", conversions, odr, hours, wtm);
+	printf("batches %lu (%.1f samples avg), overruns %u, errors %u\n",
+			batches, batches ? ((double)fs.samples / batches) : 0.0, fs.overruns, fs.errors);
+	printf("bus transactions/h: fifo %.1f, one read per conversion %.1f (%.0fx fewer)\n",
+			(ms.reads + ms.writes) / hours, conversions / hours,
+			(ms.reads + ms.writes) ? ((double)conversions / (ms.reads + ms.writes)) : 0.0);
+	printf("mcu wakeups/h: fifo %.1f, data ready interrupt %.1f\n", batches / hours, conversions / hours);
+	printf("rms error: single reading %.3f Pa, batch average %.3f Pa\n",
+			sqrt(err_single / conversions), batches ? sqrt(err_batch / batches) : 0.0);
+
+	return 0;
+}
@@ -0,0 +1,360 @@
+/*
+ * histcheck.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host check of the tiered pressure history (src/press_history.c). A
+ *  random pressure trace of several weeks is fed to press_history_put() for
+ *  the sample periods that divide 15 minutes. The rollups are recomputed
+ *  from the raw trace: every 15 minute entry covers the samples of its
+ *  quarter hour, every hourly entry four of them. Checked after every
+ *  sample are the returned tier mask, the size of both tiers and, once a
+ *  tier closed an entry, every stored entry oldest first, also after the
+ *  tiers have wrapped:
+ *
+ *    - min and max of both tiers exactly
+ *    - mean of the 15 minute tier as the rounded mean of its samples
+ *    - mean of the hourly tier as the rounded mean of its four 15 minute
+ *      means, and within 1 of the mean of its raw samples
+ *    - press_history_at() refuses the index past the newest entry
+ *
+ *  A mismatch makes the exit status 1.
+ *
+ *  Then the trace of the 60 s period of main.h is put again with every
+ *  press_history_put() timed on its own, the cost of the clock read taken
+ *  off. Reported is the mean time per tier: a sample that only adds to the
+ *  15 minute accumulator, one that closes a 15 minute entry and one that
+ *  cascades into the hourly tier as well. The RAM of the entries of every
+ *  tier and the time it covers are printed next to it.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o histcheck tools/histcheck/histcheck.c src/press_history.c -lm
+ *
+ *  Usage:
+ *    histcheck [-d days] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "press_history.h"
+
+#define QUARTER_S 900
+
+// Period of main.h, the insert cost is timed with it
+#define BENCH_PERIOD_S 60
+
+// Samples timed, the trace is put again until there are as many
+#define BENCH_SAMPLES 2000000
+
+// sample periods that divide 15 minutes, 60 s is the one of main.h
+static const uint16_t periods[] = {60, 1, 15, 300, 900};
+
+static uint16_t* trace;
+static unsigned long failures;
+
+// expected entries of both tiers since the start, mean of the raw samples of every hour
+static press_rollup_t* quarter;
+static press_rollup_t* hour;
+static double* hour_mean;
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Pressure in Pa above 900 hPa, a walk with noise and now and then a glitch to the rails
+static void generate(size_t n)
+{
+	double walk = 11325.0;
+	size_t i;
+
+	for(i = 0; i < n; i++)
+	{
+		walk += gauss() * 2.0;
+		walk = (walk < 0) ? 0 : ((walk > 30000) ? 30000 : walk);
+		trace[i] = (uint16_t)lround(walk + gauss() * 3.0);
+		if(uniform() < 0.0005)
+		{
+			trace[i] = (uniform() < 0.5) ? 0 : UINT16_MAX;
+		}
+	}
+}
+
+//#pragma mark - Model -
+
+// Rollup of count samples starting at first
+static void rollup(size_t first, size_t count, press_rollup_t* r, double* mean)
+{
+	uint64_t sum = 0;
+	size_t i;
+
+	r->min = UINT16_MAX;
+	r->max = 0;
+	for(i = first; i < (first + count); i++)
+	{
+		r->min = (trace[i] < r->min) ? trace[i] : r->min;
+		r->max = (trace[i] > r->max) ? trace[i] : r->max;
+		sum += trace[i];
+	}
+	r->mean = (uint16_t)((sum + (count / 2)) / count);
+	*mean = (double)sum / count;
+}
+
+// Expected entries of both tiers for the whole trace
+static void model(size_t quarters, size_t fan_in)
+{
+	uint32_t qsum;
+	double mean;
+	size_t k, j;
+
+	for(k = 0; k < quarters; k++)
+	{
+		rollup(k * fan_in, fan_in, &quarter[k], &mean);
+	}
+	for(k = 0; k < (quarters / 4); k++)
+	{
+		rollup(k * fan_in * 4, fan_in * 4, &hour[k], &hour_mean[k]);
+		// the hourly mean is made from the rounded 15 minute means
+		qsum = 0;
+		for(j = 0; j < 4; j++)
+		{
+			qsum += quarter[(k * 4) + j].mean;
+		}
+		hour[k].mean = (uint16_t)((qsum + 2) / 4);
+	}
+}
+
+//#pragma mark - Timing -
+
+static double now_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec * 1e9) + t.tv_nsec;
+}
+
+// Time every put of the trace, the mean per tier mask: none, 15 minutes, 15 minutes and hour
+static void bench(uint16_t period_s, size_t n)
+{
+	static const char* const names[3] = {"sample", "15 minute close", "hourly cascade"};
+	double sum[3] = {0, 0, 0};
+	unsigned long count[3] = {0, 0, 0};
+	double overhead = 0;
+	double t0, t;
+	unsigned long k;
+	uint8_t mask;
+	size_t i;
+	int c;
+
+	// the two clock reads around a put
+	for(k = 0; k < BENCH_SAMPLES; k++)
+	{
+		t0 = now_ns();
+		overhead += now_ns() - t0;
+	}
+	overhead /= BENCH_SAMPLES;
+
+	for(k = 0; k < BENCH_SAMPLES; )
+	{
+		press_history_init(period_s);
+		for(i = 0; (i < n) && (k < BENCH_SAMPLES); i++, k++)
+		{
+			t0 = now_ns();
+			mask = press_history_put(trace[i]);
+			t = now_ns() - t0;
+			c = (mask & (1u << PRESS_TIER_HOUR)) ? 2 : ((mask != 0) ? 1 : 0);
+			sum[c] += t;
+			count[c]++;
+		}
+	}
+
+	printf("insert cost at %u s, clock read of %.1f ns taken off:\n", period_s, overhead);
+	for(c = 0; c < 3; c++)
+	{
+		printf("  %-16s %10lu puts  %6.1f ns\n", names[c], count[c], (count[c] != 0) ? ((sum[c] / count[c]) - overhead) : 0.0);
+	}
+	printf("entries: 15 minute tier %zu x %zu bytes = %zu bytes (%.0f h), hourly tier %zu x %zu bytes = %zu bytes (%.0f days)\n",
+			press_history_capacity(PRESS_TIER_15MIN), sizeof(press_rollup_t),
+			press_history_capacity(PRESS_TIER_15MIN) * sizeof(press_rollup_t), press_history_capacity(PRESS_TIER_15MIN) / 4.0,
+			press_history_capacity(PRESS_TIER_HOUR), sizeof(press_rollup_t),
+			press_history_capacity(PRESS_TIER_HOUR) * sizeof(press_rollup_t), press_history_capacity(PRESS_TIER_HOUR) / 24.0);
+}
+
+//#pragma mark - Check -
+
+static void fail(uint16_t period_s, size_t at, const char* what)
+{
+	if(failures++ < 10)
+	{
+		printf("  period %u s sample %zu: %s\n", period_s, at, what);
+	}
+}
+
+// Compare every entry of a tier, closed is the number of entries the tier has closed so far
+static void compare(press_tier_t tier, size_t closed, uint16_t period_s, size_t at)
+{
+	size_t cap = press_history_capacity(tier);
+	size_t size = (closed < cap) ? closed : cap;
+	press_rollup_t got, exp;
+	size_t i, k;
+
+	if(press_history_size(tier) != size)
+	{
+		fail(period_s, at, (tier == PRESS_TIER_15MIN) ? "15 minute tier size" : "hourly tier size");
+		return;
+	}
+	for(i = 0; i < size; i++)
+	{
+		// entry number k since the start
+		k = closed - size + i;
+		if(press_history_at(tier, i, &got) != 0)
+		{
+			fail(period_s, at, "at");
+			return;
+		}
+		if(tier == PRESS_TIER_15MIN)
+		{
+			exp = quarter[k];
+		}
+		else
+		{
+			exp = hour[k];
+			if(fabs(got.mean - hour_mean[k]) > 1.0)
+			{
+				fail(period_s, at, "hourly mean away from the raw mean");
+			}
+		}
+		if((got.min != exp.min) || (got.max != exp.max) || (got.mean != exp.mean))
+		{
+			fail(period_s, at, (tier == PRESS_TIER_15MIN) ? "15 minute entry" : "hourly entry");
+			return;
+		}
+	}
+	if((press_history_at(tier, size, &got) == 0) ||
+			((size == 0) != (press_history_last(tier, &got) != 0)))
+	{
+		fail(period_s, at, "index past the newest entry");
+	}
+}
+
+static void run(uint16_t period_s, double days)
+{
+	size_t fan_in = QUARTER_S / period_s;
+	size_t n = (size_t)(days * 86400.0 / period_s);
+	size_t i, quarters, hours;
+	uint8_t mask, exp;
+
+	trace = malloc(n * sizeof(uint16_t));
+	quarter = malloc(((n / fan_in) + 1) * sizeof(press_rollup_t));
+	hour = malloc(((n / fan_in / 4) + 1) * sizeof(press_rollup_t));
+	hour_mean = malloc(((n / fan_in / 4) + 1) * sizeof(double));
+	if((trace == NULL) || (quarter == NULL) || (hour == NULL) || (hour_mean == NULL))
+	{
+		fail(period_s, 0, "no memory");
+		return;
+	}
+	generate(n);
+	model(n / fan_in, fan_in);
+	press_history_init(period_s);
+	compare(PRESS_TIER_15MIN, 0, period_s, 0);
+	compare(PRESS_TIER_HOUR, 0, period_s, 0);
+
+	for(i = 0; i < n; i++)
+	{
+		mask = press_history_put(trace[i]);
+		quarters = (i + 1) / fan_in;
+		hours = quarters / 4;
+		exp = (((i + 1) % fan_in) == 0) ? (1u << PRESS_TIER_15MIN) : 0;
+		exp |= ((exp != 0) && ((quarters % 4) == 0)) ? (1u << PRESS_TIER_HOUR) : 0;
+		if(mask != exp)
+		{
+			fail(period_s, i, "tier mask");
+		}
+		// the entries only change when a tier closed one, the sizes are checked every time
+		if(mask != 0)
+		{
+			compare(PRESS_TIER_15MIN, quarters, period_s, i);
+			compare(PRESS_TIER_HOUR, hours, period_s, i);
+		}
+		else if((press_history_size(PRESS_TIER_15MIN) != ((quarters < PRESS_HISTORY_15MIN_LEN) ? quarters : PRESS_HISTORY_15MIN_LEN)) ||
+				(press_history_size(PRESS_TIER_HOUR) != ((hours < PRESS_HISTORY_HOUR_LEN) ? hours : PRESS_HISTORY_HOUR_LEN)))
+		{
+			fail(period_s, i, "size between rollups");
+		}
+	}
+
+	printf("period %4u s: %zu samples, %zu quarter hours, %zu hours\n", period_s, n, n / fan_in, n / fan_in / 4);
+	if(period_s == BENCH_PERIOD_S)
+	{
+		bench(period_s, n);
+	}
+	free(hour_mean);
+	free(hour);
+	free(quarter);
+	free(trace);
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: histcheck [-d days] [-s seed]\n"
+			"  defaults: 20 days (both tiers wrap), seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	double days = 20.0;
+	long seed = 1;
+	unsigned i;
+	int opt;
+
+	while((opt = getopt(argc, argv, "d:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'd': days = atof(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if(days <= 0)
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+
+	for(i = 0; i < (sizeof(periods) / sizeof(periods[0])); i++)
+	{
+		run(periods[i], days);
+	}
+
+	printf("%s: %lu failures\n", (failures == 0) ? "ok" : "FAILED", failures);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,500 @@
+/*
+ * i2csched.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host simulation of the queueing on the shared sensor bus. src/i2c_async.c
+ *  runs unchanged on the I2C bus mock with latency (tools/mock) with the
+ *  three devices of the station as register stand-ins, and a synthetic load
+ *  mix submits to it:
+ *
+ *    touch       STMPE811 read of the touch data every frame period
+ *    sensor      MMA8652 transient source and axes on random motion events
+ *    background  LPS28DFW FIFO drains of the full FIFO and configuration
+ *                writes at random
+ *
+ *  The same load, from the same seed, runs three times: with one queue in
+ *  submission order as before, with the priority classes and with the
+ *  priority classes and the FIFO readout split in parts. Reported per class
+ *  are the queueing delay (submission to completion without the time of the
+ *  transaction itself on the bus) as mean, p99 and maximum, the transactions
+ *  over the deadline of the class and the submissions refused because the
+ *  class queue was full or the previous transaction of the source was still
+ *  pending.
+ *
+ *  The touch controller is read with the blocking wrapper from inside LVGL.
+ *  A last check reads it while an accelerometer read is on the bus and a
+ *  FIFO readout is queued: no callback may run during the wait and both
+ *  have to run from the next poll. A failed check makes the exit status 1.
+ *
+ *  Built with -DI2C_PROF (and src/i2c_prof.c) the bus profile of every
+ *  device is printed after each mode as the "ip" console command shows it,
+ *  the cycle counter is the virtual clock in us.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -Itools/mock -o i2csched tools/i2csched/i2csched.c \
+ *        tools/mock/i2c_bus_mock.c src/i2c_async.c src/spsc_ring.c -lm
+ *
+ *  Usage:
+ *    i2csched [-t seconds] [-c clock_hz] [-p touch_ms] [-a events_per_s] [-d drains_per_s] [-k chunk] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "i2c_async.h"
+#include "i2c_bus_mock.h"
+#ifdef I2C_PROF
+#include "i2c_prof.h"
+#endif
+
+// 8-bit bus addresses, as in the drivers
+#define TOUCH_ADDR         0x82
+#define ACC_ADDR           0x3A
+#define BARO_ADDR          0xB8
+
+// time the HAL needs to set up a transfer
+#define BUS_SETUP_US       5
+
+// the superloop polls the queue between its other work
+#define LOOP_STEP_US       50
+
+// a full LPS28DFW FIFO, 128 samples of 3 bytes, and the status read before it
+#define BARO_FIFO_LEN      384
+#define BARO_STATUS_LEN    8
+// configuration writes per second
+#define BARO_WRITE_RATE    2.0
+
+// queueing delay histogram, 50 us buckets
+#define HIST_BUCKETS       4000
+#define HIST_US            50
+
+// Transaction source, one transaction of it pending at a time
+typedef struct
+{
+	i2c_async_xfer_t xfer;
+	uint8_t buf[BARO_FIFO_LEN];
+	uint64_t submit_us;
+	uint32_t bus_us;            // time of the transaction itself on the bus
+	uint8_t cls;
+} source_t;
+
+// Result of a class
+typedef struct
+{
+	uint32_t done;
+	uint32_t late;
+	uint32_t refused;           // class queue full or source still pending
+	uint64_t sum_us;
+	uint32_t max_us;
+	uint32_t hist[HIST_BUCKETS];
+} class_t;
+
+typedef enum {
+	MODE_FIFO = 0,
+	MODE_PRIO,
+	MODE_CHUNK,
+	MODES,
+} sim_mode_t;
+
+static const char* mode_name[MODES] = {"fifo", "prio", "prio+chunk"};
+static const char* class_name[I2C_ASYNC_PRIO_LEVELS] = {"touch", "sensor", "background"};
+static const uint32_t deadline_ms[I2C_ASYNC_PRIO_LEVELS] = {
+	I2C_ASYNC_DEADLINE_TOUCH, I2C_ASYNC_DEADLINE_SENSOR, I2C_ASYNC_DEADLINE_BACKGROUND};
+
+static source_t touch;
+static source_t acc;
+static source_t baro_status;
+static source_t baro_fifo;
+static source_t baro_cfg;
+static class_t res[I2C_ASYNC_PRIO_LEVELS];
+static uint16_t chunk = 30;
+// callbacks run while a blocking transfer waits
+static bool blocking;
+static uint32_t nested;
+
+#ifdef I2C_PROF
+static uint32_t prof_cycles(void);
+
+static const i2c_prof_ctx_t prof_ctx = {prof_cycles, 1};
+#endif
+
+//#pragma mark - Model -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+// Time to the next event of a Poisson process
+static double exponential(double rate)
+{
+	double u = uniform();
+
+	if(u < 1e-12)
+	{
+		u = 1e-12;
+	}
+	return -log(u) / rate;
+}
+
+#ifdef I2C_PROF
+static uint32_t prof_cycles(void)
+{
+	return (uint32_t)i2c_bus_mock_now();
+}
+#endif
+
+// Register stand-ins, only the timing matters
+static int32_t dev_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	(void)reg;
+	memset(bufp, 0, len);
+	return 0;
+}
+
+static int32_t dev_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	(void)reg;
+	(void)bufp;
+	(void)len;
+	return 0;
+}
+
+//#pragma mark - Sources -
+
+static void done(i2c_async_xfer_t* x)
+{
+	source_t* s = x->arg;
+	class_t* c = &res[s->cls];
+	uint64_t lat = i2c_bus_mock_now() - s->submit_us;
+	uint32_t wait = (lat > s->bus_us) ? (uint32_t)(lat - s->bus_us) : 0;
+
+	nested += blocking ? 1 : 0;
+	c->done++;
+	c->sum_us += wait;
+	c->max_us = (wait > c->max_us) ? wait : c->max_us;
+	c->hist[((wait / HIST_US) < HIST_BUCKETS) ? (wait / HIST_US) : (HIST_BUCKETS - 1)]++;
+	if(lat > (deadline_ms[s->cls] * 1000u))
+	{
+		c->late++;
+	}
+}
+
+static void source_init(source_t* s, uint8_t addr, uint8_t reg, uint8_t write, uint16_t len, uint8_t cls, uint16_t parts)
+{
+	uint16_t n;
+	uint16_t left = len;
+
+	memset(s, 0, sizeof(*s));
+	s->xfer.addr = addr;
+	s->xfer.reg = reg;
+	s->xfer.write = write;
+	s->xfer.buf = s->buf;
+	s->xfer.len = len;
+	s->xfer.chunk = parts;
+	s->xfer.done = done;
+	s->xfer.arg = s;
+	s->cls = cls;
+
+	// every part is a transaction of its own on the wire
+	while(left > 0)
+	{
+		n = ((parts != 0) && (left > parts)) ? parts : left;
+		s->bus_us += i2c_bus_mock_duration(write, n);
+		left -= n;
+	}
+}
+
+static void submit(source_t* s)
+{
+	s->submit_us = i2c_bus_mock_now();
+	if(i2c_async_submit(&s->xfer) != 0)
+	{
+		res[s->cls].refused++;
+	}
+}
+
+//#pragma mark - Simulation -
+
+static void run(sim_mode_t mode, double seconds, uint32_t clock_hz, double touch_ms, double acc_rate,
+		double drain_rate, long seed)
+{
+	uint16_t parts = (mode == MODE_CHUNK) ? chunk : 0;
+	double end = seconds * 1e6;
+	double next_touch;
+	double next_acc;
+	double next_drain;
+	double next_cfg;
+	double now;
+
+	// same load for every mode
+	srand48(seed);
+	memset(res, 0, sizeof(res));
+	i2c_bus_mock_init(clock_hz, BUS_SETUP_US);
+	i2c_bus_mock_attach(TOUCH_ADDR, dev_read, dev_write);
+	i2c_bus_mock_attach(ACC_ADDR, dev_read, dev_write);
+	i2c_bus_mock_attach(BARO_ADDR, dev_read, dev_write);
+	i2c_async_init(i2c_bus_mock_ctx());
+#ifdef I2C_PROF
+	i2c_prof_init(&prof_ctx);
+#endif
+	if(mode != MODE_FIFO)
+	{
+		i2c_async_set_priority(TOUCH_ADDR, I2C_ASYNC_PRIO_TOUCH);
+		i2c_async_set_priority(ACC_ADDR, I2C_ASYNC_PRIO_SENSOR);
+		i2c_async_set_priority(BARO_ADDR, I2C_ASYNC_PRIO_BACKGROUND);
+	}
+
+	// STMPE811 TSC_DATA_NON_INC, MMA8652 TRANSIENT_SRC and the axes, LPS28DFW
+	// FIFO_STATUS1 and the output registers, FIFO_CTRL
+	source_init(&touch, TOUCH_ADDR, 0xD7, 0, 4, I2C_ASYNC_PRIO_TOUCH, 0);
+	source_init(&acc, ACC_ADDR, 0x1E, 0, 7, I2C_ASYNC_PRIO_SENSOR, 0);
+	source_init(&baro_status, BARO_ADDR, 0x25, 0, BARO_STATUS_LEN, I2C_ASYNC_PRIO_BACKGROUND, 0);
+	source_init(&baro_fifo, BARO_ADDR, 0x78, 0, BARO_FIFO_LEN, I2C_ASYNC_PRIO_BACKGROUND, parts);
+	source_init(&baro_cfg, BARO_ADDR, 0x14, 1, 2, I2C_ASYNC_PRIO_BACKGROUND, 0);
+
+	next_touch = uniform() * touch_ms * 1000.0;
+	next_acc = exponential(acc_rate) * 1e6;
+	next_drain = exponential(drain_rate) * 1e6;
+	next_cfg = exponential(BARO_WRITE_RATE) * 1e6;
+
+	while((now = (double)i2c_bus_mock_now()) < end)
+	{
+		// the touch period and the sensors run on their own clocks, a source
+		// with its transaction still pending skips its turn
+		if(now >= next_touch)
+		{
+			next_touch += touch_ms * 1000.0;
+			if(touch.xfer.status == I2C_ASYNC_PENDING)
+			{
+				res[touch.cls].refused++;
+			}
+			else
+			{
+				submit(&touch);
+			}
+		}
+		if(now >= next_acc)
+		{
+			next_acc += exponential(acc_rate) * 1e6;
+			if(acc.xfer.status == I2C_ASYNC_PENDING)
+			{
+				res[acc.cls].refused++;
+			}
+			else
+			{
+				submit(&acc);
+			}
+		}
+		if(now >= next_drain)
+		{
+			next_drain += exponential(drain_rate) * 1e6;
+			if((baro_status.xfer.status == I2C_ASYNC_PENDING) || (baro_fifo.xfer.status == I2C_ASYNC_PENDING))
+			{
+				res[baro_fifo.cls].refused++;
+			}
+			else
+			{
+				submit(&baro_status);
+				submit(&baro_fifo);
+			}
+		}
+		if(now >= next_cfg)
+		{
+			next_cfg += exponential(BARO_WRITE_RATE) * 1e6;
+			if(baro_cfg.xfer.status == I2C_ASYNC_PENDING)
+			{
+				res[baro_cfg.cls].refused++;
+			}
+			else
+			{
+				submit(&baro_cfg);
+			}
+		}
+
+		i2c_async_poll();
+		i2c_bus_mock_advance(LOOP_STEP_US);
+	}
+}
+
+// Blocking touch read while other transactions complete
+static int blocking_check(uint32_t clock_hz)
+{
+	uint8_t buf[4];
+	int32_t ret;
+	bool held;
+	bool ok;
+
+	memset(res, 0, sizeof(res));
+	i2c_bus_mock_init(clock_hz, BUS_SETUP_US);
+	i2c_bus_mock_attach(TOUCH_ADDR, dev_read, dev_write);
+	i2c_bus_mock_attach(ACC_ADDR, dev_read, dev_write);
+	i2c_bus_mock_attach(BARO_ADDR, dev_read, dev_write);
+	i2c_async_init(i2c_bus_mock_ctx());
+	i2c_async_set_priority(TOUCH_ADDR, I2C_ASYNC_PRIO_TOUCH);
+	i2c_async_set_priority(ACC_ADDR, I2C_ASYNC_PRIO_SENSOR);
+	i2c_async_set_priority(BARO_ADDR, I2C_ASYNC_PRIO_BACKGROUND);
+	source_init(&acc, ACC_ADDR, 0x1E, 0, 7, I2C_ASYNC_PRIO_SENSOR, 0);
+	source_init(&baro_fifo, BARO_ADDR, 0x78, 0, BARO_FIFO_LEN, I2C_ASYNC_PRIO_BACKGROUND, chunk);
+
+	// the accelerometer read goes on the bus at once, the touch read waits for it
+	submit(&acc);
+	submit(&baro_fifo);
+	nested = 0;
+	blocking = true;
+	ret = i2c_async_transfer(TOUCH_ADDR, 0xD7, 0, buf, sizeof(buf));
+	blocking = false;
+	held = (acc.xfer.status == I2C_ASYNC_PENDING) && (res[I2C_ASYNC_PRIO_SENSOR].done == 0);
+
+	while(!i2c_async_idle())
+	{
+		i2c_async_poll();
+		i2c_bus_mock_advance(LOOP_STEP_US);
+	}
+
+	ok = (ret == 0) && (nested == 0) && held && (res[I2C_ASYNC_PRIO_SENSOR].done == 1) &&
+			(res[I2C_ASYNC_PRIO_BACKGROUND].done == 1);
+	printf("blocking touch read: %u callbacks during the wait, accelerometer %s, %u + %u run from the poll | %s\n",
+			nested, held ? "held back" : "not held back", res[I2C_ASYNC_PRIO_SENSOR].done,
+			res[I2C_ASYNC_PRIO_BACKGROUND].done, ok ? "ok" : "FAIL");
+
+	return ok ? 0 : -1;
+}
+
+//#pragma mark - Output -
+
+static uint32_t percentile(const class_t* c, double q)
+{
+	uint32_t want = (uint32_t)ceil(c->done * q);
+	uint32_t n = 0;
+	uint32_t i;
+
+	for(i = 0; i < HIST_BUCKETS; i++)
+	{
+		n += c->hist[i];
+		if(n >= want)
+		{
+			return (i + 1) * HIST_US;
+		}
+	}
+	return HIST_BUCKETS * HIST_US;
+}
+
+#ifdef I2C_PROF
+static void print_profile(void)
+{
+	i2c_prof_device_t devices[I2C_PROF_DEVICES];
+	const i2c_prof_device_t* d;
+	uint8_t n = i2c_prof_get(devices, I2C_PROF_DEVICES);
+	uint8_t i;
+	uint8_t b;
+
+	for(i = 0; i < n; i++)
+	{
+		d = &devices[i];
+		printf("  0x%02X: %u transactions, %u bytes, %u errors, %u timeouts, mean %u us, max %u us\n    us:",
+				d->addr, d->transactions, d->bytes, d->errors, d->timeouts,
+				d->transactions ? (uint32_t)(d->latency_sum / d->transactions) : 0, d->latency_max);
+		for(b = 0; b < I2C_PROF_BUCKETS; b++)
+		{
+			if(d->hist[b] != 0)
+			{
+				printf(" %u:%u", i2c_prof_bucket_us(b), d->hist[b]);
+			}
+		}
+		printf("\n");
+	}
+}
+#endif
+
+static void print_run(sim_mode_t mode)
+{
+	i2c_async_stats_t stats;
+	const class_t* c;
+	uint8_t i;
+
+	i2c_async_get_stats(&stats);
+	for(i = 0; i < I2C_ASYNC_PRIO_LEVELS; i++)
+	{
+		c = &res[i];
+		printf("%-11s %-10s %8u %9.2f %8.2f %8.2f %6u %8u\n", mode_name[mode], class_name[i], c->done,
+				c->done ? (c->sum_us / 1000.0 / c->done) : 0.0, c->done ? (percentile(c, 0.99) / 1000.0) : 0.0,
+				c->max_us / 1000.0, c->late, c->refused);
+	}
+	printf("%-11s %u bus transfers, queue full %u\n", mode_name[mode], stats.parts, stats.rejected);
+#ifdef I2C_PROF
+	print_profile();
+#endif
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: i2csched [-t seconds] [-c clock_hz] [-p touch_ms] [-a events_per_s] [-d drains_per_s] [-k chunk] [-s seed]\n"
+			"  defaults: 600 s, 100000 Hz, touch every 10 ms, 20 accelerometer events/s, 2 FIFO drains/s,\n"
+			"  chunk 30 bytes, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	double seconds = 600.0;
+	int clock_hz = 100000;
+	double touch_ms = 10.0;
+	double acc_rate = 20.0;
+	double drain_rate = 2.0;
+	int parts = chunk;
+	long seed = 1;
+	sim_mode_t mode;
+	int opt;
+
+	while((opt = getopt(argc, argv, "t:c:p:a:d:k:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 't': seconds = atof(optarg); break;
+		case 'c': clock_hz = atoi(optarg); break;
+		case 'p': touch_ms = atof(optarg); break;
+		case 'a': acc_rate = atof(optarg); break;
+		case 'd': drain_rate = atof(optarg); break;
+		case 'k': parts = atoi(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((seconds <= 0) || (clock_hz <= 0) || (touch_ms <= 0) || (acc_rate <= 0) || (drain_rate <= 0) ||
+			(parts < 1) || (parts > BARO_FIFO_LEN))
+	{
+		usage();
+		return 1;
+	}
+	chunk = (uint16_t)parts;
+
+	i2c_bus_mock_init((uint32_t)clock_hz, BUS_SETUP_US);
+	printf("%.0f s, %d Hz bus, touch every %.1f ms (%u us), %.1f accelerometer events/s (%u us),\n"
+			"%.1f FIFO drains/s (%u us, %u us in parts of %u bytes), %.1f writes/s\n",
+			seconds, clock_hz, touch_ms, i2c_bus_mock_duration(0, 4), acc_rate, i2c_bus_mock_duration(0, 7),
+			drain_rate, i2c_bus_mock_duration(0, BARO_STATUS_LEN) + i2c_bus_mock_duration(0, BARO_FIFO_LEN),
+			i2c_bus_mock_duration(0, chunk), chunk, BARO_WRITE_RATE);
+	printf("deadlines: touch %u ms, sensor %u ms, background %u ms; queueing delay in ms\n",
+			I2C_ASYNC_DEADLINE_TOUCH, I2C_ASYNC_DEADLINE_SENSOR, I2C_ASYNC_DEADLINE_BACKGROUND);
+	printf("mode        class          done      mean      p99      max   late  refused\n");
+	for(mode = MODE_FIFO; mode < MODES; mode++)
+	{
+		run(mode, seconds, (uint32_t)clock_hz, touch_ms, acc_rate, drain_rate, seed);
+		print_run(mode);
+	}
+
+	return (blocking_check((uint32_t)clock_hz) == 0) ? 0 : 1;
+}
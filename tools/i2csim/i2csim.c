@@ -0,0 +1,383 @@
+/*
+ * i2csim.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host simulation of the superloop with blocking and with asynchronous
+ *  sensor transactions. src/i2c_async.c and src/baro_fifo.c run unchanged
+ *  on the I2C bus mock with latency (tools/mock), with the LPS28DFW mock
+ *  and a small MMA8652 stand-in on the bus. Every loop pass waits 3 ms and
+ *  renders a UI frame, then serves the barometer FIFO watermark and the
+ *  accelerometer transient events like main.c does: either through the
+ *  blocking wrapper, as the drivers did before, or by submitting the
+ *  transactions and handling them in the completion callbacks.
+ *
+ *  Reported are the loop pass times (frame to frame), the time the bus is
+ *  driven and the time from the watermark to the averaged batch.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -Itools/mock -o i2csim tools/i2csim/i2csim.c \
+ *        tools/mock/i2c_bus_mock.c tools/mock/lps28dfw_mock.c src/i2c_async.c \
+ *        src/baro_fifo.c src/spsc_ring.c -lm
+ *
+ *  Usage:
+ *    i2csim [-t seconds] [-c clock_hz] [-w watermark] [-f frame_ms] [-a events_per_s] [-x stalls] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "i2c_async.h"
+#include "baro_fifo.h"
+#include "i2c_bus_mock.h"
+#include "lps28dfw_mock.h"
+
+// 8-bit bus addresses, as in the drivers
+#define BARO_ADDR          0xB8
+#define ACC_ADDR           0x3A
+
+// MMA8652 transient source register, the event flag is latched until it is read
+#define ACC_TRANSIENT_SRC  0x1E
+#define ACC_TRANSIENT_EA   0x40
+
+// time the HAL needs to set up a transfer
+#define BUS_SETUP_US       5
+
+// superloop: HAL_Delay(3) and the frame
+#define LOOP_DELAY_US      3000
+
+// loop pass histogram, 0.1 ms buckets
+#define HIST_BUCKETS       1000
+#define HIST_US            100
+
+// 1260 hPa full scale, 4096 LSB/hPa
+#define COUNTS_PER_PA      40.96
+
+typedef struct
+{
+	uint64_t passes;
+	uint64_t sum_us;
+	uint32_t max_us;
+	uint32_t hist[HIST_BUCKETS];
+	uint32_t batches;
+	uint64_t batch_latency_us;
+	uint32_t max_batch_latency_us;
+	uint32_t acc_events;
+	uint32_t acc_reads;
+} result_t;
+
+static uint8_t acc_regs[256];
+static bool async_mode;
+static result_t res;
+
+// barometer batch in flight
+static bool baro_pending;
+static uint64_t baro_int_us;
+
+// accelerometer read in flight
+static i2c_async_xfer_t acc_xfer;
+static uint8_t acc_src;
+
+// barometer bus access, like barometer.c
+static i2c_async_xfer_t baro_xfer;
+static baro_fifo_read_done_ptr baro_read_done;
+
+//#pragma mark - Devices -
+
+static int32_t acc_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	uint16_t i;
+
+	(void)handle;
+	for(i = 0; i < len; i++)
+	{
+		bufp[i] = acc_regs[(uint8_t)(reg + i)];
+		// reading the source register releases the latch
+		if((uint8_t)(reg + i) == ACC_TRANSIENT_SRC)
+		{
+			acc_regs[ACC_TRANSIENT_SRC] = 0;
+		}
+	}
+	return 0;
+}
+
+static int32_t acc_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	memcpy(&acc_regs[reg], bufp, (reg + len) > 256 ? (256 - reg) : len);
+	return 0;
+}
+
+static int32_t baro_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	return i2c_async_transfer(BARO_ADDR, reg, 0, bufp, len);
+}
+
+static int32_t baro_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	return i2c_async_transfer(BARO_ADDR, reg, 1, bufp, len);
+}
+
+static void baro_xfer_done(i2c_async_xfer_t* xfer)
+{
+	baro_read_done((xfer->status == I2C_ASYNC_DONE) ? 0 : -1);
+}
+
+static int32_t baro_read_async(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len, baro_fifo_read_done_ptr done)
+{
+	(void)handle;
+	baro_xfer.addr = BARO_ADDR;
+	baro_xfer.reg = reg;
+	baro_xfer.write = 0;
+	baro_xfer.buf = bufp;
+	baro_xfer.len = len;
+	baro_xfer.done = baro_xfer_done;
+	baro_read_done = done;
+	return i2c_async_submit(&baro_xfer);
+}
+
+static const baro_fifo_ctx_t baro_ctx = {baro_write, baro_read, baro_read_async, NULL};
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+//#pragma mark - Superloop -
+
+static void batch_done(const baro_fifo_batch_t* batch, int32_t status)
+{
+	uint32_t us = (uint32_t)(i2c_bus_mock_now() - baro_int_us);
+
+	baro_pending = false;
+	if((status != 0) || (batch->samples == 0))
+	{
+		return;
+	}
+	res.batches++;
+	res.batch_latency_us += us;
+	res.max_batch_latency_us = (us > res.max_batch_latency_us) ? us : res.max_batch_latency_us;
+}
+
+static void acc_done(i2c_async_xfer_t* xfer)
+{
+	res.acc_reads++;
+	if((xfer->status == I2C_ASYNC_DONE) && (acc_src & ACC_TRANSIENT_EA))
+	{
+		res.acc_events++;
+	}
+}
+
+static void serve_sensors(void)
+{
+	baro_fifo_batch_t batch;
+
+	// the barometer INT pin is level, a batch is started once per watermark
+	if(!baro_pending && lps28dfw_mock_int())
+	{
+		baro_pending = true;
+		baro_int_us = i2c_bus_mock_now();
+		if(async_mode)
+		{
+			if(baro_fifo_drain_async(batch_done) != 0)
+			{
+				baro_pending = false;
+			}
+		}
+		else
+		{
+			batch_done(&batch, baro_fifo_drain(&batch));
+		}
+	}
+
+	// INT2 is held while the transient source is latched
+	if((acc_regs[ACC_TRANSIENT_SRC] & ACC_TRANSIENT_EA) && (acc_xfer.status != I2C_ASYNC_PENDING))
+	{
+		if(async_mode)
+		{
+			i2c_async_submit(&acc_xfer);
+		}
+		else
+		{
+			acc_xfer.status = (uint8_t)((i2c_async_transfer(ACC_ADDR, ACC_TRANSIENT_SRC, 0, &acc_src, 1) == 0) ?
+					I2C_ASYNC_DONE : I2C_ASYNC_ERROR);
+			acc_done(&acc_xfer);
+		}
+	}
+}
+
+static void run(bool async, double seconds, uint32_t clock_hz, uint8_t wtm, uint32_t frame_us,
+		double acc_rate, uint32_t stalls, long seed)
+{
+	uint64_t end = (uint64_t)(seconds * 1e6);
+	uint64_t next_conv = 1000000;
+	uint64_t pass_start;
+	uint32_t us;
+	double p;
+
+	srand48(seed);
+	memset(&res, 0, sizeof(res));
+	memset(acc_regs, 0, sizeof(acc_regs));
+	memset(&acc_xfer, 0, sizeof(acc_xfer));
+	memset(&baro_xfer, 0, sizeof(baro_xfer));
+	async_mode = async;
+	baro_pending = false;
+
+	i2c_bus_mock_init(clock_hz, BUS_SETUP_US);
+	i2c_bus_mock_attach(BARO_ADDR, lps28dfw_mock_read, lps28dfw_mock_write);
+	i2c_bus_mock_attach(ACC_ADDR, acc_read, acc_write);
+	i2c_async_init(i2c_bus_mock_ctx());
+	lps28dfw_mock_init();
+	if(baro_fifo_start(&baro_ctx, wtm) != 0)
+	{
+		fprintf(stderr, "baro_fifo_start failed\n");
+		exit(1);
+	}
+	i2c_bus_mock_stall(stalls);
+
+	acc_xfer.addr = ACC_ADDR;
+	acc_xfer.reg = ACC_TRANSIENT_SRC;
+	acc_xfer.buf = &acc_src;
+	acc_xfer.len = 1;
+	acc_xfer.done = acc_done;
+
+	while(i2c_bus_mock_now() < end)
+	{
+		pass_start = i2c_bus_mock_now();
+
+		i2c_bus_mock_advance(LOOP_DELAY_US);
+		// lv_task_handler()
+		i2c_bus_mock_advance(frame_us);
+		i2c_async_poll();
+
+		// conversions at 1 Hz and handling of the station since the last pass
+		while(next_conv <= i2c_bus_mock_now())
+		{
+			p = 101325.0 + gauss();
+			lps28dfw_mock_sample((int32_t)lround(p * COUNTS_PER_PA), 2000);
+			next_conv += 1000000;
+		}
+		if(uniform() < (acc_rate * (i2c_bus_mock_now() - pass_start) / 1e6))
+		{
+			acc_regs[ACC_TRANSIENT_SRC] |= ACC_TRANSIENT_EA;
+		}
+
+		serve_sensors();
+
+		us = (uint32_t)(i2c_bus_mock_now() - pass_start);
+		res.passes++;
+		res.sum_us += us;
+		res.max_us = (us > res.max_us) ? us : res.max_us;
+		res.hist[((us / HIST_US) < HIST_BUCKETS) ? (us / HIST_US) : (HIST_BUCKETS - 1)]++;
+	}
+}
+
+static double percentile(double q)
+{
+	uint64_t need = (uint64_t)ceil(q * res.passes);
+	uint64_t seen = 0;
+	uint32_t i;
+
+	for(i = 0; i < HIST_BUCKETS; i++)
+	{
+		seen += res.hist[i];
+		if(seen >= need)
+		{
+			return (i + 1) * HIST_US / 1000.0;
+		}
+	}
+	return HIST_BUCKETS * HIST_US / 1000.0;
+}
+
+static void report(const char* name, double seconds)
+{
+	i2c_bus_mock_stats_t bs;
+	i2c_async_stats_t qs;
+
+	i2c_bus_mock_get_stats(&bs);
+	i2c_async_get_stats(&qs);
+	printf("%-9s %8llu %8.2f %8.1f %8.1f %9.2f %9.2f %9.2f %6u %6u %5u\n", name,
+			(unsigned long long)res.passes, (double)res.sum_us / res.passes / 1000.0,
+			percentile(0.99), res.max_us / 1000.0,
+			bs.busy_us / seconds / 1000.0,
+			res.batches ? ((double)res.batch_latency_us / res.batches / 1000.0) : 0.0,
+			res.max_batch_latency_us / 1000.0,
+			res.batches, res.acc_events, qs.timeouts);
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: i2csim [-t seconds] [-c clock_hz] [-w watermark] [-f frame_ms] [-a events_per_s] [-x stalls] [-s seed]\n"
+			"  defaults: 600 s, 100000 Hz, watermark 60, frame 5 ms, 0.5 events/s, 0 stalls, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	double seconds = 600.0;
+	unsigned clock_hz = 100000;
+	unsigned wtm = 60;
+	double frame_ms = 5.0;
+	double acc_rate = 0.5;
+	unsigned stalls = 0;
+	long seed = 1;
+	int opt;
+
+	while((opt = getopt(argc, argv, "t:c:w:f:a:x:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 't': seconds = atof(optarg); break;
+		case 'c': clock_hz = (unsigned)atoi(optarg); break;
+		case 'w': wtm = (unsigned)atoi(optarg); break;
+		case 'f': frame_ms = atof(optarg); break;
+		case 'a': acc_rate = atof(optarg); break;
+		case 'x': stalls = (unsigned)atoi(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((seconds <= 0) || (clock_hz < 10000) || (wtm == 0) || (wtm > BARO_FIFO_WTM_MAX) || (frame_ms < 0) || (acc_rate < 0))
+	{
+		usage();
+		return 1;
+	}
+
+	i2c_bus_mock_init(clock_hz, BUS_SETUP_US);
+	printf("%.0f s, %u Hz bus, watermark %u (%u us per drain), frame %.1f ms, %.2f accelerometer events/s\n",
+			seconds, clock_hz, wtm, i2c_bus_mock_duration(0, 8) + i2c_bus_mock_duration(0, (uint16_t)(wtm * 3)),
+			frame_ms, acc_rate);
+	printf("%-9s %8s %8s %8s %8s %9s %9s %9s %6s %6s %5s\n", "mode", "passes", "mean ms", "p99 ms", "max ms",
+			"bus ms/s", "batch ms", "max ms", "batch", "events", "tmo");
+	run(false, seconds, clock_hz, (uint8_t)wtm, (uint32_t)(frame_ms * 1000), acc_rate, stalls, seed);
+	report("blocking", seconds);
+	run(true, seconds, clock_hz, (uint8_t)wtm, (uint32_t)(frame_ms * 1000), acc_rate, stalls, seed);
+	report("async", seconds);
+
+	return 0;
+}
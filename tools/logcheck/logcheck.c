@@ -0,0 +1,338 @@
+/*
+ * logcheck.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host round-trip check of the delta-encoded pressure log (src/press_log.c).
+ *  Random traces are appended with press_log_put() and after every sample
+ *  the log is decoded from the oldest sample: it must give back exactly the
+ *  newest press_log_size() values that were put, clamped to the 24 bit
+ *  keyframe, and the size may only drop by whole blocks once the log is
+ *  full. The traces cover the nibble deltas of one-minute readings, the
+ *  16 bit escape, jumps that need a new keyframe and values beyond the
+ *  keyframe range. A recorded trace can be given as well, a CSV of
+ *  time_s,pa like the ones of tools/tracegen, lines starting with # and
+ *  non-numeric header lines are skipped. The samples per byte of every
+ *  trace are reported next to a plain uint16_t ring. A mismatch makes the
+ *  exit status 1.
+ *
+ *  Every trace is then timed: press_log_put() of the whole trace into an
+ *  empty log and press_log_iter_next() over the full log, repeated until
+ *  BENCH_SAMPLES samples were encoded and decoded. Reported is the time per
+ *  sample of both.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o logcheck tools/logcheck/logcheck.c src/press_log.c -lm
+ *
+ *  Usage:
+ *    logcheck [-n samples] [-s seed] [trace.csv]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "press_log.h"
+
+// Largest value of the 24 bit keyframe
+#define KEYFRAME_MAX 0xFFFFFF
+
+// Samples encoded and decoded by the timing of every trace
+#define BENCH_SAMPLES 10000000
+
+static const char* const kinds[] = {"minute", "escape", "jumps", "range"};
+
+static uint32_t* trace;
+static unsigned long failures;
+
+// Keeps the decoded values from being optimised away
+static volatile uint32_t sink;
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+//#pragma mark - Traces -
+
+static void generate(size_t n, unsigned kind)
+{
+	double walk = 101325.0;
+	size_t i;
+
+	for(i = 0; i < n; i++)
+	{
+		switch(kind)
+		{
+		case 0:
+			// one-minute readings, a few Pa apart
+			walk += gauss() * 0.5;
+			trace[i] = (uint32_t)lround(walk + gauss() * 2.0);
+			break;
+		case 1:
+			// deltas up to the 16 bit escape
+			walk += gauss() * ((uniform() < 0.2) ? 3000.0 : 5.0);
+			walk = (walk < 0) ? 0 : walk;
+			trace[i] = (uint32_t)lround(walk);
+			break;
+		case 2:
+			// jumps beyond the escape need a new keyframe
+			if(uniform() < 0.05)
+			{
+				walk = uniform() * KEYFRAME_MAX;
+			}
+			walk += gauss() * 3.0;
+			walk = (walk < 0) ? 0 : walk;
+			trace[i] = (uint32_t)lround(walk);
+			break;
+		default:
+			// anything, also past the keyframe range
+			trace[i] = (uniform() < 0.5) ? (uint32_t)(uniform() * UINT32_MAX) : (uint32_t)(uniform() * 16);
+			break;
+		}
+	}
+}
+
+// Load the pa column of a CSV trace, returns the number of samples or 0
+static size_t load_csv(const char* path)
+{
+	char line[256];
+	unsigned long t;
+	long pa;
+	size_t cap = 0;
+	size_t n = 0;
+	uint32_t* p;
+	FILE* f;
+
+	f = fopen(path, "r");
+	if(f == NULL)
+	{
+		perror(path);
+		return 0;
+	}
+	while(fgets(line, sizeof(line), f) != NULL)
+	{
+		// comments, header and empty lines
+		if((line[0] == '#') || (sscanf(line, "%lu,%ld", &t, &pa) < 2))
+		{
+			continue;
+		}
+		if(n == cap)
+		{
+			cap = cap ? (cap * 2) : 4096;
+			p = realloc(trace, cap * sizeof(uint32_t));
+			if(p == NULL)
+			{
+				n = 0;
+				break;
+			}
+			trace = p;
+		}
+		trace[n++] = (pa < 0) ? 0 : (uint32_t)pa;
+	}
+	fclose(f);
+
+	return n;
+}
+
+//#pragma mark - Timing -
+
+static double now_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec * 1e9) + t.tv_nsec;
+}
+
+// Encode the trace into an empty log and decode the full log until BENCH_SAMPLES of each
+static void bench(size_t n, const char* name)
+{
+	press_log_iter_t it;
+	unsigned long encoded = 0;
+	unsigned long decoded = 0;
+	double put_ns, next_ns;
+	uint32_t pa, sum = 0;
+	double t0;
+	size_t i;
+
+	t0 = now_ns();
+	while(encoded < BENCH_SAMPLES)
+	{
+		press_log_init();
+		for(i = 0; i < n; i++)
+		{
+			press_log_put(trace[i]);
+		}
+		encoded += n;
+	}
+	put_ns = (now_ns() - t0) / encoded;
+	if(press_log_size() == 0)
+	{
+		return;
+	}
+
+	t0 = now_ns();
+	while(decoded < BENCH_SAMPLES)
+	{
+		press_log_iter_begin(&it);
+		while(press_log_iter_next(&it, &pa))
+		{
+			sum += pa;
+			decoded++;
+		}
+	}
+	next_ns = (now_ns() - t0) / decoded;
+	sink = sum;
+
+	printf("%-7s encode %6.2f ns/sample, decode %6.2f ns/sample\n", name, put_ns, next_ns);
+}
+
+//#pragma mark - Check -
+
+static void fail(const char* name, size_t at, const char* what)
+{
+	if(failures++ < 10)
+	{
+		printf("  %s sample %zu: %s\n", name, at, what);
+	}
+}
+
+static void check(size_t n, const char* name)
+{
+	press_log_iter_t it;
+	size_t size, prev = 0;
+	size_t i, k, max_size = 0;
+	uint32_t pa, exp;
+	bool ok;
+
+	press_log_init();
+	press_log_iter_begin(&it);
+	if(press_log_iter_next(&it, &pa))
+	{
+		fail(name, 0, "empty log decodes a sample");
+	}
+
+	for(i = 0; i < n; i++)
+	{
+		press_log_put(trace[i]);
+		size = press_log_size();
+		max_size = (size > max_size) ? size : max_size;
+		// grows by one, or drops the samples of the oldest block
+		if((size == 0) || (size > (i + 1)) || ((size != (prev + 1)) && (size > prev)) ||
+				(press_log_bytes() > (PRESS_LOG_BLOCKS * PRESS_LOG_BLOCK_SIZE)))
+		{
+			fail(name, i, "size");
+		}
+		prev = size;
+
+		ok = true;
+		press_log_iter_begin(&it);
+		for(k = (i + 1) - size; k <= i; k++)
+		{
+			exp = (trace[k] > KEYFRAME_MAX) ? KEYFRAME_MAX : trace[k];
+			if(!press_log_iter_next(&it, &pa) || (pa != exp))
+			{
+				ok = false;
+				break;
+			}
+		}
+		if(!ok || press_log_iter_next(&it, &pa))
+		{
+			fail(name, i, "round trip");
+		}
+	}
+
+	printf("%-7s %zu samples kept, %zu bytes, %.2f samples per byte (uint16_t ring 0.50)\n",
+			name, press_log_size(), press_log_bytes(),
+			(double)press_log_size() / press_log_bytes());
+	if(max_size == 0)
+	{
+		fail(name, n, "nothing stored");
+	}
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: logcheck [-n samples] [-s seed] [trace.csv]\n"
+			"  defaults: 20000 samples per generated trace, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	size_t n = 20000;
+	size_t len;
+	long seed = 1;
+	unsigned kind;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': n = (size_t)atol(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if(n == 0)
+	{
+		usage();
+		return 1;
+	}
+
+	trace = malloc(n * sizeof(uint32_t));
+	if(trace == NULL)
+	{
+		return 1;
+	}
+	srand48(seed);
+
+	for(kind = 0; kind < (sizeof(kinds) / sizeof(kinds[0])); kind++)
+	{
+		generate(n, kind);
+		check(n, kinds[kind]);
+		bench(n, kinds[kind]);
+	}
+
+	if(optind < argc)
+	{
+		len = load_csv(argv[optind]);
+		if(len == 0)
+		{
+			fprintf(stderr, "%s: no samples\n", argv[optind]);
+			free(trace);
+			return 1;
+		}
+		check(len, "file");
+		bench(len, "file");
+	}
+
+	free(trace);
+	printf("%s: %lu failures\n", (failures == 0) ? "ok" : "FAILED", failures);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,203 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+
+#include "i2c_bus_mock.h"
+
+// Bits on the wire, a byte is 8 bits and the acknowledge
+#define BITS_BYTE        9
+#define BITS_START       1
+#define BITS_STOP        1
+
+typedef struct
+{
+	uint8_t addr;
+	i2c_bus_mock_rw_ptr read;
+	i2c_bus_mock_rw_ptr write;
+} device_t;
+
+static device_t devices[I2C_BUS_MOCK_DEVICES];
+static uint8_t device_count;
+static uint32_t bus_clock;
+static uint32_t setup;
+static uint64_t now;
+static const i2c_async_xfer_t* active;
+static uint64_t active_end;
+static uint32_t stall;
+static i2c_bus_mock_stats_t stats;
+
+static int32_t mock_start(void* handle, const i2c_async_xfer_t* xfer);
+static void mock_abort(void* handle);
+static uint32_t mock_tick(void);
+
+static const i2c_async_ctx_t mock_ctx = {mock_start, mock_abort, mock_tick, NULL};
+
+//#pragma mark - Private Functions -
+
+static uint32_t bits_to_us(uint32_t bits)
+{
+	return (uint32_t)(((uint64_t)bits * 1000000u + bus_clock - 1) / bus_clock);
+}
+
+// start, address, register and for reads the repeated start with the address again
+static uint32_t address_bits(uint8_t write)
+{
+	return write ? (BITS_START + (2 * BITS_BYTE)) : ((2 * BITS_START) + (3 * BITS_BYTE));
+}
+
+static uint32_t data_bits(uint16_t len)
+{
+	return ((uint32_t)len * BITS_BYTE) + BITS_STOP;
+}
+
+static device_t* find(uint8_t addr)
+{
+	uint8_t i;
+
+	// the R/W bit is not part of the address
+	for(i = 0; i < device_count; i++)
+	{
+		if((devices[i].addr & 0xFE) == (addr & 0xFE))
+		{
+			return &devices[i];
+		}
+	}
+	return NULL;
+}
+
+static int32_t mock_start(void* handle, const i2c_async_xfer_t* xfer)
+{
+	uint32_t us;
+
+	(void)handle;
+	assert(active == NULL);
+
+	if(find(xfer->addr) == NULL)
+	{
+		// the address is not acknowledged, the HAL fails in the polled phase
+		stats.nacks++;
+		now += setup + bits_to_us(BITS_START + BITS_BYTE + BITS_STOP);
+		return -1;
+	}
+
+	// the HAL polls through the address phase before the DMA takes over
+	us = setup + bits_to_us(address_bits(xfer->write));
+	now += us;
+	stats.busy_us += us;
+	active = xfer;
+	active_end = now + bits_to_us(data_bits(xfer->len));
+	if(stall > 0)
+	{
+		stall--;
+		active_end = UINT64_MAX;
+	}
+
+	return 0;
+}
+
+static void mock_abort(void* handle)
+{
+	(void)handle;
+
+	if(active != NULL)
+	{
+		active = NULL;
+		stats.aborts++;
+	}
+}
+
+static uint32_t mock_tick(void)
+{
+	i2c_bus_mock_advance(I2C_BUS_MOCK_POLL_US);
+
+	return (uint32_t)(now / 1000);
+}
+
+//#pragma mark - APIs -
+
+void i2c_bus_mock_init(uint32_t clock_hz, uint32_t setup_us)
+{
+	assert(clock_hz);
+
+	memset(devices, 0, sizeof(devices));
+	device_count = 0;
+	bus_clock = clock_hz;
+	setup = setup_us;
+	now = 0;
+	active = NULL;
+	stall = 0;
+	memset(&stats, 0, sizeof(stats));
+}
+
+int i2c_bus_mock_attach(uint8_t addr, i2c_bus_mock_rw_ptr read, i2c_bus_mock_rw_ptr write)
+{
+	assert(read && write);
+
+	if(device_count >= I2C_BUS_MOCK_DEVICES)
+	{
+		return -1;
+	}
+	devices[device_count].addr = addr;
+	devices[device_count].read = read;
+	devices[device_count].write = write;
+	device_count++;
+
+	return 0;
+}
+
+const i2c_async_ctx_t* i2c_bus_mock_ctx(void)
+{
+	return &mock_ctx;
+}
+
+void i2c_bus_mock_advance(uint32_t us)
+{
+	const i2c_async_xfer_t* x;
+	device_t* dev;
+	int32_t status;
+	uint64_t end = now + us;
+
+	if((active != NULL) && (active_end <= end))
+	{
+		x = active;
+		active = NULL;
+		stats.busy_us += active_end - now;
+		now = active_end;
+		stats.transfers++;
+		stats.bytes += x->len;
+
+		// the data is in place when the DMA completes
+		dev = find(x->addr);
+		status = x->write ? dev->write(NULL, x->reg, x->buf, x->len) : dev->read(NULL, x->reg, x->buf, x->len);
+		i2c_async_complete(status);
+	}
+	else if(active != NULL)
+	{
+		stats.busy_us += us;
+	}
+
+	now = end;
+}
+
+uint64_t i2c_bus_mock_now(void)
+{
+	return now;
+}
+
+uint32_t i2c_bus_mock_duration(uint8_t write, uint16_t len)
+{
+	return setup + bits_to_us(address_bits(write) + data_bits(len));
+}
+
+void i2c_bus_mock_stall(uint32_t count)
+{
+	stall = count;
+}
+
+void i2c_bus_mock_get_stats(i2c_bus_mock_stats_t* out)
+{
+	assert(out);
+
+	*out = stats;
+}
@@ -0,0 +1,72 @@
+/*
+ * i2c_bus_mock.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  I2C bus mock with latency for the host, the i2c_async_ctx_t of the
+ *  simulations. A register transaction takes the time it takes on the
+ *  wire: start, device address, register, repeated start and address for
+ *  reads, 9 bits per data byte and stop at the configured clock, plus a
+ *  fixed setup time. As with the F4 HAL the address phase is sent by
+ *  polling inside start(), only the data phase runs in the background.
+ *
+ *  Time is virtual, in us. It advances with i2c_bus_mock_advance() and by
+ *  I2C_BUS_MOCK_POLL_US with every tick read by the queue, so busy waiting
+ *  on the bus costs time like it does on the target. The device registers
+ *  are accessed when the transfer ends, through read and write functions
+ *  with the stmdev_ctx_t signature (e.g. tools/mock/lps28dfw_mock).
+ */
+
+#ifndef I2C_BUS_MOCK_H_
+#define I2C_BUS_MOCK_H_
+
+#include <stdint.h>
+
+#include "i2c_async.h"
+
+/// Devices that can be attached to the bus
+#define I2C_BUS_MOCK_DEVICES 4
+
+/// Time in us one poll of the queue costs
+#define I2C_BUS_MOCK_POLL_US 2
+
+/// Register access of an attached device, returns 0 on success
+typedef int32_t (*i2c_bus_mock_rw_ptr)(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+
+/// Bus counters
+typedef struct {
+	uint32_t transfers;
+	uint32_t bytes;
+	uint32_t nacks;      // transfers to an address nobody answers
+	uint32_t aborts;
+	uint64_t busy_us;    // time the bus was driven
+} i2c_bus_mock_stats_t;
+
+/// Empty bus at time 0
+/// Requires: clock_hz > 0
+void i2c_bus_mock_init(uint32_t clock_hz, uint32_t setup_us);
+
+/// Attach a device at the 8-bit address
+/// Returns 0 on success, -1 if all slots are used
+int i2c_bus_mock_attach(uint8_t addr, i2c_bus_mock_rw_ptr read, i2c_bus_mock_rw_ptr write);
+
+/// Bus interface for i2c_async_init()
+const i2c_async_ctx_t* i2c_bus_mock_ctx(void);
+
+/// Let us pass, the running transfer completes once its time is up
+void i2c_bus_mock_advance(uint32_t us);
+
+/// Current virtual time in us
+uint64_t i2c_bus_mock_now(void);
+
+/// Time in us a transaction of len bytes holds the bus
+uint32_t i2c_bus_mock_duration(uint8_t write, uint16_t len);
+
+/// The next count transfers never complete, to exercise the timeout
+void i2c_bus_mock_stall(uint32_t count);
+
+/// Get the bus counters
+void i2c_bus_mock_get_stats(i2c_bus_mock_stats_t* stats);
+
+#endif // I2C_BUS_MOCK_H_
@@ -0,0 +1,294 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "lps28dfw_mock.h"
+
+#define REG_INTERRUPT_CFG  0x0B
+#define REG_THS_P_L        0x0C
+#define REG_THS_P_H        0x0D
+#define REG_CTRL_REG1      0x10
+#define REG_CTRL_REG2      0x11
+#define REG_CTRL_REG4      0x13
+#define REG_FIFO_CTRL      0x14
+#define REG_FIFO_WTM       0x15
+#define REG_REF_P_L        0x16
+#define REG_REF_P_H        0x17
+#define REG_INT_SOURCE     0x24
+#define REG_FIFO_STATUS1   0x25
+#define REG_FIFO_STATUS2   0x26
+#define REG_STATUS         0x27
+#define REG_PRESS_OUT_XL   0x28
+#define REG_PRESS_OUT_H    0x2A
+#define REG_TEMP_OUT_L     0x2B
+#define REG_TEMP_OUT_H     0x2C
+#define REG_FIFO_DATA_XL   0x78
+#define REG_FIFO_DATA_H    0x7A
+
+#define FIFO_DEPTH 128
+
+#define CTRL_REG2_ONESHOT  0x01
+#define STATUS_P_DA        0x01
+#define STATUS_T_DA        0x02
+#define CFG_AUTOREFP       0x80
+#define CFG_RESET_ARP      0x40
+#define CFG_LIR            0x04
+#define CFG_PLE            0x02
+#define CFG_PHE            0x01
+#define INT_SOURCE_IA      0x04
+#define INT_SOURCE_PL      0x02
+#define INT_SOURCE_PH      0x01
+
+static uint8_t regs[256];
+static int32_t fifo[FIFO_DEPTH];
+static uint8_t head;       // oldest sample
+static uint8_t level;
+static bool overrun;
+static int32_t popped;     // sample being read out of FIFO_DATA_OUT
+static bool ref_valid;     // AUTOREFP has taken the reference
+static lps28dfw_mock_stats_t stats;
+
+//#pragma mark - Private Functions -
+
+static bool streaming(void)
+{
+	return (regs[REG_FIFO_CTRL] & 0x03) != 0;
+}
+
+static uint8_t watermark(void)
+{
+	return regs[REG_FIFO_WTM] & 0x7F;
+}
+
+static uint8_t status2(void)
+{
+	uint8_t s = 0;
+
+	if((watermark() != 0) && (level >= watermark()))
+	{
+		s |= 0x80;
+	}
+	if(overrun)
+	{
+		s |= 0x40;
+	}
+	if(level == FIFO_DEPTH)
+	{
+		s |= 0x20;
+	}
+	return s;
+}
+
+// Compare a conversion with the reference, REF_P and THS_P count 1/16 hPa (counts >> 8)
+static void threshold(int32_t counts)
+{
+	uint8_t cfg = regs[REG_INTERRUPT_CFG];
+	int32_t ref;
+	int32_t ths;
+	int32_t diff;
+	uint8_t src = 0;
+
+	if((cfg & CFG_AUTOREFP) && !ref_valid)
+	{
+		// the first conversion after AUTOREFP is the reference
+		regs[REG_REF_P_L] = (uint8_t)(counts >> 8);
+		regs[REG_REF_P_H] = (uint8_t)(counts >> 16);
+		ref_valid = true;
+	}
+	if(!ref_valid || ((cfg & (CFG_PLE | CFG_PHE)) == 0))
+	{
+		return;
+	}
+	ref = (int16_t)((uint16_t)regs[REG_REF_P_L] | ((uint16_t)regs[REG_REF_P_H] << 8));
+	ths = ((int32_t)regs[REG_THS_P_L] | ((int32_t)regs[REG_THS_P_H] << 8)) & 0x7FFF;
+	diff = (counts >> 8) - ref;
+	if((cfg & CFG_PHE) && (diff > ths))
+	{
+		src |= INT_SOURCE_PH | INT_SOURCE_IA;
+	}
+	if((cfg & CFG_PLE) && (-diff > ths))
+	{
+		src |= INT_SOURCE_PL | INT_SOURCE_IA;
+	}
+	// latched flags stay until INT_SOURCE is read, otherwise they follow the comparison
+	regs[REG_INT_SOURCE] = (cfg & CFG_LIR) ? (uint8_t)(regs[REG_INT_SOURCE] | src) : src;
+}
+
+static uint8_t read_byte(uint8_t reg)
+{
+	uint8_t v;
+
+	switch(reg)
+	{
+	case REG_INT_SOURCE:
+		v = regs[reg];
+		if(regs[REG_INTERRUPT_CFG] & CFG_LIR)
+		{
+			regs[reg] = 0;
+		}
+		return v;
+	case REG_FIFO_STATUS1:
+		return level;
+	case REG_FIFO_STATUS2:
+		return status2();
+	case REG_FIFO_DATA_XL:
+		// reading the first byte pops the oldest sample
+		popped = 0;
+		if(level > 0)
+		{
+			popped = fifo[head];
+			head = (uint8_t)((head + 1) % FIFO_DEPTH);
+			level--;
+			overrun = false;
+		}
+		return (uint8_t)popped;
+	case REG_FIFO_DATA_XL + 1:
+		return (uint8_t)(popped >> 8);
+	case REG_FIFO_DATA_H:
+		return (uint8_t)(popped >> 16);
+	case REG_PRESS_OUT_H:
+		// reading the output clears its data available flag
+		regs[REG_STATUS] &= (uint8_t)~STATUS_P_DA;
+		return regs[reg];
+	case REG_TEMP_OUT_H:
+		regs[REG_STATUS] &= (uint8_t)~STATUS_T_DA;
+		return regs[reg];
+	default:
+		return regs[reg];
+	}
+}
+
+//#pragma mark - APIs -
+
+void lps28dfw_mock_init(void)
+{
+	memset(regs, 0, sizeof(regs));
+	memset(&stats, 0, sizeof(stats));
+	head = 0;
+	level = 0;
+	overrun = false;
+	popped = 0;
+	ref_valid = false;
+}
+
+void lps28dfw_mock_sample(int32_t counts, int16_t centi_c)
+{
+	regs[REG_PRESS_OUT_XL] = (uint8_t)counts;
+	regs[REG_PRESS_OUT_XL + 1] = (uint8_t)(counts >> 8);
+	regs[REG_PRESS_OUT_XL + 2] = (uint8_t)(counts >> 16);
+	regs[REG_TEMP_OUT_L] = (uint8_t)centi_c;
+	regs[REG_TEMP_OUT_L + 1] = (uint8_t)((uint16_t)centi_c >> 8);
+	regs[REG_STATUS] |= STATUS_P_DA | STATUS_T_DA;
+	// the one-shot bit clears itself at the end of the conversion
+	regs[REG_CTRL_REG2] &= (uint8_t)~CTRL_REG2_ONESHOT;
+	threshold(counts);
+
+	if(!streaming())
+	{
+		return;
+	}
+	if(level == FIFO_DEPTH)
+	{
+		// stream mode drops the oldest sample
+		head = (uint8_t)((head + 1) % FIFO_DEPTH);
+		level--;
+		overrun = true;
+	}
+	fifo[(head + level) % FIFO_DEPTH] = counts;
+	level++;
+}
+
+int32_t lps28dfw_mock_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	uint16_t i;
+
+	(void)handle;
+	stats.reads++;
+	stats.bytes += len;
+	for(i = 0; i < len; i++)
+	{
+		bufp[i] = read_byte(reg);
+		// auto-increment, the FIFO output rolls back to its first byte
+		reg = (reg == REG_FIFO_DATA_H) ? REG_FIFO_DATA_XL : (uint8_t)(reg + 1);
+	}
+
+	return 0;
+}
+
+int32_t lps28dfw_mock_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	uint16_t i;
+
+	(void)handle;
+	stats.writes++;
+	stats.bytes += len;
+	for(i = 0; i < len; i++)
+	{
+		regs[reg] = bufp[i];
+		if((reg == REG_INTERRUPT_CFG) && (bufp[i] & CFG_RESET_ARP))
+		{
+			// the reference is dropped, the reset bit does not stay set
+			regs[reg] &= (uint8_t)~CFG_RESET_ARP;
+			regs[REG_REF_P_L] = 0;
+			regs[REG_REF_P_H] = 0;
+			regs[REG_INT_SOURCE] = 0;
+			ref_valid = false;
+		}
+		if((reg == REG_FIFO_CTRL) && !streaming())
+		{
+			// bypass mode empties the FIFO
+			head = 0;
+			level = 0;
+			overrun = false;
+		}
+		reg++;
+	}
+
+	return 0;
+}
+
+bool lps28dfw_mock_int(void)
+{
+	uint8_t ctrl = regs[REG_CTRL_REG4];
+
+	if((ctrl & 0x10) == 0)
+	{
+		return false;
+	}
+	return (regs[REG_INT_SOURCE] & INT_SOURCE_IA) ||
+			((ctrl & 0x20) && (regs[REG_STATUS] & STATUS_P_DA)) ||
+			((ctrl & 0x02) && (status2() & 0x80)) ||
+			((ctrl & 0x01) && overrun) ||
+			((ctrl & 0x04) && (level == FIFO_DEPTH));
+}
+
+bool lps28dfw_mock_oneshot(void)
+{
+	// ONESHOT only starts a conversion in power-down, ODR 0
+	return ((regs[REG_CTRL_REG1] & 0x78) == 0) && (regs[REG_CTRL_REG2] & CTRL_REG2_ONESHOT);
+}
+
+uint8_t lps28dfw_mock_avg(void)
+{
+	return regs[REG_CTRL_REG1] & 0x07;
+}
+
+uint8_t lps28dfw_mock_odr(void)
+{
+	return (regs[REG_CTRL_REG1] >> 3) & 0x0F;
+}
+
+uint8_t lps28dfw_mock_lpf(void)
+{
+	return (regs[REG_CTRL_REG2] >> 4) & 0x03;
+}
+
+uint8_t lps28dfw_mock_level(void)
+{
+	return level;
+}
+
+void lps28dfw_mock_get_stats(lps28dfw_mock_stats_t* out)
+{
+	*out = stats;
+}
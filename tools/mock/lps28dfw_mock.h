@@ -0,0 +1,64 @@
+/*
+ * lps28dfw_mock.h
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Register-level mock of the LPS28DFW for host tests. Models the output
+ *  registers with their data available flags, the one-shot trigger in
+ *  power-down, the pressure threshold interrupt against the AUTOREFP
+ *  reference (latched or not), the 128-slot FIFO in bypass and stream mode
+ *  with the watermark, full and overrun flags, the INT pin (threshold,
+ *  data ready and the FIFO flags routed in CTRL_REG4) and the register
+ *  auto-increment, including the roll back from FIFO_DATA_OUT_PRESS_H to
+ *  FIFO_DATA_OUT_PRESS_XL. The read and write functions have the
+ *  stmdev_ctx_t / baro_fifo_ctx_t signature. Time is up to the caller: a
+ *  conversion ends when lps28dfw_mock_sample() is called.
+ */
+
+#ifndef LPS28DFW_MOCK_H_
+#define LPS28DFW_MOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Bus traffic seen by the mock
+typedef struct {
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t bytes;
+} lps28dfw_mock_stats_t;
+
+/// Power-on state, all registers 0, FIFO in bypass
+void lps28dfw_mock_init(void);
+
+/// One conversion: update the output registers and push into the FIFO,
+/// ends a conversion started with ONESHOT
+void lps28dfw_mock_sample(int32_t counts, int16_t centi_c);
+
+/// Register access, handle is unused
+int32_t lps28dfw_mock_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+int32_t lps28dfw_mock_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+
+/// Level of the INT pin, active high
+bool lps28dfw_mock_int(void);
+
+/// Check if a one-shot conversion was triggered and not ended with lps28dfw_mock_sample
+bool lps28dfw_mock_oneshot(void);
+
+/// AVG code set in CTRL_REG1
+uint8_t lps28dfw_mock_avg(void);
+
+/// ODR code set in CTRL_REG1, 0 is power-down
+uint8_t lps28dfw_mock_odr(void);
+
+/// EN_LPFP (bit 0) and LFPF_CFG (bit 1) set in CTRL_REG2
+uint8_t lps28dfw_mock_lpf(void);
+
+/// Samples in the FIFO
+uint8_t lps28dfw_mock_level(void);
+
+/// Get the bus counters
+void lps28dfw_mock_get_stats(lps28dfw_mock_stats_t* stats);
+
+#endif // LPS28DFW_MOCK_H_
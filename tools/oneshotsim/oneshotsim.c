@@ -0,0 +1,257 @@
+/*
+ * oneshotsim.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host simulation of the one-shot barometer acquisition. src/baro_oneshot.c
+ *  runs unchanged against the register-level LPS28DFW mock (tools/mock) for
+ *  every averaging setting: a conversion is triggered every log interval,
+ *  ends after the modelled conversion time with data ready on the INT pin,
+ *  and is read on the next pass of the main loop. The clock is virtual and
+ *  in us, bus transactions take their time on the wire at 100 kHz.
+ *
+ *  The conversion time (startup plus a time per averaged sample) and the
+ *  noise (falling with the square root of the averages) are a model, the
+ *  conversion time of the real sensor is measured by the firmware and
+ *  shown with the "bm" console command. Reported are the latency measured
+ *  by baro_oneshot, the noise of the logged samples, the time the sensor is
+ *  converting per hour, which is where its current goes, and the bus
+ *  transactions per hour, next to the continuous 1 Hz FIFO acquisition.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -Itools/mock -o oneshotsim tools/oneshotsim/oneshotsim.c \
+ *        tools/mock/lps28dfw_mock.c src/baro_oneshot.c -lm
+ *
+ *  Usage:
+ *    oneshotsim [-d days] [-i interval_s] [-a avg] [-t startup_us] [-u us_per_sample] [-n noise_pa] [-f frame_ms] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "baro_oneshot.h"
+#include "baro_units.h"
+#include "lps28dfw_mock.h"
+
+// 1260 hPa full scale, 4096 LSB/hPa
+#define COUNTS_PER_PA 40.96
+
+// bus clock of the I2C transactions
+#define BUS_HZ 100000.0
+
+// batch of the FIFO acquisition, one conversion per second
+#define FIFO_BATCH 60
+
+static uint64_t now_us;
+static double startup_us = 1000.0;
+static double sample_us = 200.0;
+
+static int32_t sim_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+static int32_t sim_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len);
+static uint32_t sim_tick(void);
+
+static const baro_oneshot_ctx_t sim_ctx = {sim_write, sim_read, NULL, sim_tick, NULL};
+
+//#pragma mark - Model -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Same conversion as barometer.c at the 1260 hPa full scale
+static int32_t counts_to_pa(int32_t counts)
+{
+	return baro_counts_to_pa(counts, false);
+}
+
+// Weather: slow drift with a semi-diurnal tide
+static double truth(double t)
+{
+	return 101325.0 - (t / 3600.0) * 20.0 + 80.0 * sin(2.0 * M_PI * t / 43200.0);
+}
+
+static unsigned avg_samples(uint8_t code)
+{
+	return 4u << code;
+}
+
+static double conversion_us(uint8_t code)
+{
+	return startup_us + sample_us * avg_samples(code);
+}
+
+// start, address, register, for reads the repeated start and address, 9 bits per byte, stop
+static void bus_time(uint8_t write, uint16_t len)
+{
+	double bits = write ? (1 + 18 + (9.0 * len) + 1) : (2 + 27 + (9.0 * len) + 1);
+
+	now_us += (uint64_t)ceil(bits * 1e6 / BUS_HZ);
+}
+
+static int32_t sim_read(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	bus_time(0, len);
+	return lps28dfw_mock_read(handle, reg, bufp, len);
+}
+
+static int32_t sim_write(void* handle, uint8_t reg, uint8_t* bufp, uint16_t len)
+{
+	bus_time(1, len);
+	return lps28dfw_mock_write(handle, reg, bufp, len);
+}
+
+static uint32_t sim_tick(void)
+{
+	return (uint32_t)now_us;
+}
+
+//#pragma mark - Simulation -
+
+// One averaging setting over the whole run, prints one row
+static int simulate(uint8_t code, double t_end, double interval, double noise, double frame_ms)
+{
+	baro_oneshot_sample_t sample;
+	baro_oneshot_stats_t os;
+	lps28dfw_mock_stats_t ms;
+	double t, p, hours;
+	double sigma = noise * sqrt(4.0 / avg_samples(code));
+	double err = 0.0;
+	unsigned long n = 0;
+
+	lps28dfw_mock_init();
+	now_us = 0;
+	if(baro_oneshot_start(&sim_ctx, code) != 0)
+	{
+		fprintf(stderr, "baro_oneshot_start failed\n");
+		return -1;
+	}
+
+	for(t = interval; t < t_end; t += interval)
+	{
+		now_us = (uint64_t)(t * 1e6);
+		if((baro_oneshot_trigger() != 0) || !lps28dfw_mock_oneshot())
+		{
+			fprintf(stderr, "trigger failed at %.0f s\n", t);
+			return -1;
+		}
+		// the sensor converts, data ready raises INT
+		now_us += (uint64_t)conversion_us(code);
+		p = truth(now_us / 1e6);
+		lps28dfw_mock_sample((int32_t)lround((p + gauss() * sigma) * COUNTS_PER_PA), 2000);
+		if(lps28dfw_mock_int())
+		{
+			baro_oneshot_drdy();
+		}
+		// the main loop sees the flag on its next pass
+		now_us += (uint64_t)(uniform() * frame_ms * 1000.0);
+		if((baro_oneshot_read(&sample) != 0) || !sample.ready || lps28dfw_mock_int())
+		{
+			fprintf(stderr, "read failed at %.0f s\n", t);
+			return -1;
+		}
+		err += pow(counts_to_pa(sample.counts) - p, 2);
+		n++;
+	}
+
+	baro_oneshot_get_stats(&os);
+	lps28dfw_mock_get_stats(&ms);
+	hours = t_end / 3600.0;
+	printf("oneshot x%-4u %9.2f %9.2f %9.2f %9.2f %9.3f %9.1f %9.1f %6.2f\n",
+			avg_samples(code), conversion_us(code) / 1000.0,
+			os.conv_min_us / 1000.0, os.conv_max_us / 1000.0, os.read_max_us / 1000.0,
+			n ? sqrt(err / n) : 0.0,
+			(os.conversions * conversion_us(code) / 1000.0) / hours,
+			(ms.reads + ms.writes) / hours,
+			(os.conversions * conversion_us(code)) / (t_end * conversion_us(0)));
+
+	return 0;
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: oneshotsim [-d days] [-i interval_s] [-a avg] [-t startup_us] [-u us_per_sample] [-n noise_pa] [-f frame_ms] [-s seed]\n"
+			"  defaults: 1 day, 60 s, all averages 4..512, 1000 us + 200 us per sample, noise 1.0 Pa at 4 averages,\n"
+			"  frame 8 ms, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	double days = 1.0;
+	double interval = 60.0;
+	int avg = 0;
+	double noise = 1.0;
+	double frame_ms = 8.0;
+	long seed = 1;
+	double t_end;
+	uint8_t code;
+	int opt;
+
+	while((opt = getopt(argc, argv, "d:i:a:t:u:n:f:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'd': days = atof(optarg); break;
+		case 'i': interval = atof(optarg); break;
+		case 'a': avg = atoi(optarg); break;
+		case 't': startup_us = atof(optarg); break;
+		case 'u': sample_us = atof(optarg); break;
+		case 'n': noise = atof(optarg); break;
+		case 'f': frame_ms = atof(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((days <= 0) || (interval < 1) || (startup_us < 0) || (sample_us < 0) || (frame_ms < 0) ||
+			((avg != 0) && ((avg < 4) || (avg > 512) || (avg & (avg - 1)))))
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+	t_end = days * 86400.0;
+
+	printf("%.1f h, one sample per %.0f s, conversion %.0f us + %.0f us per averaged sample, noise %.2f Pa at 4 averages\n",
+			t_end / 3600.0, interval, startup_us, sample_us, noise);
+	printf("mode          conv ms  meas min  meas max  read max   rms Pa  active ms/h   xfer/h  charge\n");
+	// continuous reference: 1 Hz with 4 averages, a batch of 60 averaged in counts, rounded to Pa
+	printf("fifo 1 Hz x4 %9.2f %9s %9s %9s %9.3f %9.1f %9.1f %6.2f\n",
+			conversion_us(0) / 1000.0, "-", "-", "-",
+			sqrt((noise * noise / FIFO_BATCH) + (1.0 / 12.0)),
+			3600.0 * conversion_us(0) / 1000.0, 2.0 * 3600.0 / FIFO_BATCH, 1.0);
+
+	for(code = 0; code <= BARO_ONESHOT_AVG_MAX; code++)
+	{
+		if((avg != 0) && (avg_samples(code) != (unsigned)avg))
+		{
+			continue;
+		}
+		if(simulate(code, t_end, interval, noise, frame_ms) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,326 @@
+/*
+ * outlierbench.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host benchmark of the outlier rejection stage (src/outlier.c) for all
+ *  window lengths. A pressure stream (slow random walk, sensor noise) and an
+ *  accelerometer stream (device at rest, 2 g range, 1024 counts/g) are
+ *  corrupted with spikes like those of a failed I2C transfer: zeroed or
+ *  random readings. For every window the share of spikes caught, the share
+ *  of good samples rejected and the CPU time per sample are reported.
+ *
+ *  The pressure chain of main.c is checked as well: the station is carried
+ *  to another height, a motion event arrives with a step of the pressure,
+ *  and the samples pass the motion gate (src/press_motion.c) and then the
+ *  outlier stage. The step has to be removed as altitude and no sample at
+ *  the new height may be rejected or let through with the step. Setting
+ *  the altitude again empties the window, the samples after it must not be
+ *  clamped to the old median. A failed check makes the exit status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o outlierbench tools/outlierbench/outlierbench.c src/outlier.c \
+ *        src/press_motion.c -lm
+ *
+ *  Usage:
+ *    outlierbench [-n samples] [-p spike_rate] [-k nsigma] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "outlier.h"
+#include "press_motion.h"
+
+// Scale floors, about the sensor noise
+#define PRESS_MIN_SCALE 3
+#define ACC_MIN_SCALE   20
+
+// Smallest accelerometer corruption counted as a spike (about 0.1 g),
+// a zeroed reading of an axis that is near 0 anyway is harmless
+#define ACC_SPIKE_MIN   100
+
+// Pressure chain as in main.h: window and scale of the barometer stage
+#define CHAIN_LEN       5
+#define CHAIN_SCALE     3
+
+// Largest error in Pa of a sample after the chain, noise and the rebased step
+#define CHAIN_TOLERANCE 6
+
+typedef struct
+{
+	int32_t value[3];
+	bool spike;
+} sample_t;
+
+static sample_t* press;
+static sample_t* acc;
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// A corrupted reading: all zero or random bits
+static int32_t spike(int32_t range)
+{
+	if(uniform() < 0.3)
+	{
+		return 0;
+	}
+	return (int32_t)((uniform() * 2.0 - 1.0) * range);
+}
+
+//#pragma mark - Streams -
+
+static void generate(size_t n, double rate)
+{
+	double walk = 101325.0;
+	size_t i;
+	int32_t v;
+	uint8_t a;
+
+	for(i = 0; i < n; i++)
+	{
+		// pressure in Pa, one sample per minute
+		walk += gauss() * 0.15;
+		press[i].value[0] = (int32_t)lround(walk + gauss());
+		press[i].spike = (uniform() < rate);
+		if(press[i].spike)
+		{
+			press[i].value[0] = (uniform() < 0.3) ? 0 : (int32_t)(walk + ((uniform() < 0.5) ? -1 : 1) * (30 + uniform() * 5000));
+		}
+
+		// accelerometer counts, lying flat
+		acc[i].value[0] = (int32_t)lround(gauss() * 8.0);
+		acc[i].value[1] = (int32_t)lround(gauss() * 8.0);
+		acc[i].value[2] = (int32_t)lround(1024.0 + gauss() * 8.0);
+		acc[i].spike = false;
+		if(uniform() < rate)
+		{
+			a = (uint8_t)(uniform() * 3);
+			v = spike(2048);
+			acc[i].spike = (abs(v - acc[i].value[a]) >= ACC_SPIKE_MIN);
+			acc[i].value[a] = v;
+		}
+	}
+}
+
+static double elapsed_ns(const struct timespec* t0, const struct timespec* t1)
+{
+	return (double)(t1->tv_sec - t0->tv_sec) * 1e9 + (double)(t1->tv_nsec - t0->tv_nsec);
+}
+
+static void report(const char* name, uint8_t len, size_t n, const uint8_t* rejected, const sample_t* s, double ns)
+{
+	size_t spikes = 0;
+	size_t caught = 0;
+	size_t good_rejected = 0;
+	size_t i;
+
+	for(i = 0; i < n; i++)
+	{
+		if(s[i].spike)
+		{
+			spikes++;
+			caught += rejected[i];
+		}
+		else
+		{
+			good_rejected += rejected[i];
+		}
+	}
+
+	printf("%-6s len %2u | spikes %zu caught %.2f%% | good rejected %.4f%% | %.1f ns/sample\n",
+			name, len, spikes, spikes ? (100.0 * caught / spikes) : 0.0,
+			100.0 * good_rejected / (n - spikes), ns);
+}
+
+static void bench(uint8_t len, uint8_t nsigma, size_t n, uint8_t* rejected)
+{
+	struct timespec t0, t1;
+	outlier_t po;
+	outlier3_t ao;
+	int32_t v;
+	int32_t xyz[3];
+	size_t i;
+
+	outlier_init(&po, len, nsigma, PRESS_MIN_SCALE);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(i = 0; i < n; i++)
+	{
+		v = press[i].value[0];
+		rejected[i] = outlier_put(&po, &v);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	report("press", len, n, rejected, press, elapsed_ns(&t0, &t1) / n);
+
+	outlier3_init(&ao, len, nsigma, ACC_MIN_SCALE);
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	for(i = 0; i < n; i++)
+	{
+		memcpy(xyz, acc[i].value, sizeof(xyz));
+		rejected[i] = outlier3_put(&ao, xyz);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	report("accel", len, n, rejected, acc, elapsed_ns(&t0, &t1) / n);
+}
+
+//#pragma mark - Pressure chain -
+
+// One sample through the gate and the outlier stage, in the order of baro_batch_done()
+static int32_t chain_put(outlier_t* o, int32_t pa, bool* held, bool* rejected)
+{
+	int32_t v = press_motion_filter(pa, held);
+
+	*rejected = false;
+	if(!*held)
+	{
+		*rejected = outlier_put(o, &v);
+	}
+	return v;
+}
+
+// Station carried by step Pa with noise, then the altitude set again which shifts
+// the sea-level pressure by shift Pa. Returns the number of failed samples.
+static unsigned chain_check(int32_t step, int32_t shift, double noise)
+{
+	const double base = 101325.0;
+	outlier_t o;
+	press_motion_t gate;
+	unsigned failed = 0;
+	int32_t pa;
+	int32_t v;
+	bool held;
+	bool rejected;
+	unsigned i;
+
+	outlier_init(&o, CHAIN_LEN, OUTLIER_NSIGMA, CHAIN_SCALE);
+	press_motion_init();
+
+	// at rest, the window fills
+	for(i = 0; i < 20; i++)
+	{
+		chain_put(&o, (int32_t)lround(base + gauss() * noise), &held, &rejected);
+	}
+
+	// carried: the event comes with the first sample at the new height
+	press_motion_event();
+	for(i = 0; i < 20; i++)
+	{
+		pa = (int32_t)lround(base + step + gauss() * noise);
+		v = chain_put(&o, pa, &held, &rejected);
+		if(rejected || (labs(v - (int32_t)base) > CHAIN_TOLERANCE))
+		{
+			failed++;
+		}
+	}
+	press_motion_get(&gate);
+	if((gate.rebases != 1) || (labs(gate.offset - step) > CHAIN_TOLERANCE))
+	{
+		failed++;
+	}
+
+	// "alt": the offset goes, the new sea-level pressure holds from the next sample
+	press_motion_clear();
+	outlier_clear(&o);
+	for(i = 0; i < 20; i++)
+	{
+		pa = (int32_t)lround(base + step + shift + gauss() * noise);
+		v = chain_put(&o, pa, &held, &rejected);
+		if(rejected || (labs(v - (int32_t)(base + step + shift)) > CHAIN_TOLERANCE))
+		{
+			failed++;
+		}
+	}
+
+	printf("chain  step %+4d Pa, alt shift %+4d Pa, noise %.1f Pa | rebases %u offset %+d Pa | %s\n",
+			step, shift, noise, gate.rebases, gate.offset, failed ? "FAIL" : "ok");
+	return failed;
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: outlierbench [-n samples] [-p spike_rate] [-k nsigma] [-s seed]\n"
+			"  defaults: 1000000 samples, spike rate 0.002, nsigma %d, seed 1\n", OUTLIER_NSIGMA);
+}
+
+int main(int argc, char* argv[])
+{
+	size_t n = 1000000;
+	double rate = 0.002;
+	unsigned nsigma = OUTLIER_NSIGMA;
+	long seed = 1;
+	uint8_t* rejected;
+	uint8_t len;
+	unsigned failed = 0;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:p:k:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': n = (size_t)atol(optarg); break;
+		case 'p': rate = atof(optarg); break;
+		case 'k': nsigma = (unsigned)atoi(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((n < OUTLIER_WINDOW_MAX) || (nsigma == 0) || (nsigma > UINT8_MAX) || (rate < 0) || (rate > 1))
+	{
+		usage();
+		return 1;
+	}
+
+	press = malloc(n * sizeof(sample_t));
+	acc = malloc(n * sizeof(sample_t));
+	rejected = malloc(n);
+	if((press == NULL) || (acc == NULL) || (rejected == NULL))
+	{
+		return 1;
+	}
+	srand48(seed);
+	generate(n, rate);
+
+	for(len = OUTLIER_WINDOW_MIN; len <= OUTLIER_WINDOW_MAX; len += 2)
+	{
+		bench(len, (uint8_t)nsigma, n, rejected);
+	}
+
+	failed += chain_check(50, 0, 0.0);
+	failed += chain_check(-50, 0, 0.0);
+	failed += chain_check(50, -120, 1.0);
+	failed += chain_check(-200, 300, 1.0);
+
+	free(rejected);
+	free(acc);
+	free(press);
+
+	return failed ? 1 : 0;
+}
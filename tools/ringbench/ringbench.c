@@ -0,0 +1,321 @@
+/*
+ * ringbench.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host benchmark of the barometer ring of press_pipeline.h (RING_DECLARE from
+ *  inc/ring_template.h) against the circular buffer it replaced
+ *  (src/circular_buffer.c) at the old 240 and the new 256 samples. The
+ *  operations of the firmware run on both with the same random values:
+ *  put into a full buffer (history_put), at() of three indices (the
+ *  tendency of get_press_trend) and a full walk oldest first (the "cb"
+ *  command). Reported is the time per operation and, on x86 hosts, the
+ *  cycles per operation counted with the time stamp counter (it runs at
+ *  the nominal clock of the host). Before the timing the contents of the
+ *  256 sample buffers are compared after every one of the first 100000
+ *  puts and must be equal, a mismatch makes the exit status 1.
+ *
+ *  The numbers are host numbers, on the Cortex-M4 the difference is the
+ *  call, the handle and the modulo of the circular buffer against the
+ *  inlined masked access. On the board the same loops are counted with the
+ *  DWT cycle counter the way the "pc" command does: set TRCENA in
+ *  CoreDebug->DEMCR and CYCCNTENA in DWT->CTRL (i2c_dma_prof_init() in
+ *  i2c_dma.c), read DWT->CYCCNT before and after a few thousand operations
+ *  and take off the cycles of the empty loop. The code size of both is
+ *  compared with tools/ringbench/ringtext.c.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o ringbench tools/ringbench/ringbench.c src/circular_buffer.c src/mem_pool.c
+ *
+ *  Usage:
+ *    ringbench [-n operations] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "circular_buffer.h"
+#include "mem_pool.h"
+#include "press_pipeline.h"
+
+// Ring of the pipeline, and the size of the circular buffer before
+#define BAROMETER_BUFFER_SIZE PRESS_PIPELINE_RING_LEN
+#define CBUF_OLD_SIZE         240
+
+typedef enum {
+	OP_PUT = 0,
+	OP_AT,
+	OP_WALK,
+	OP_COUNT
+} op_t;
+
+static const char* const op_names[OP_COUNT] = {"put", "at x3", "walk"};
+
+// Cost of one operation
+typedef struct {
+	double ns;
+	double cycles;
+} cost_t;
+
+static uint16_t* values;
+static size_t* indices;
+static unsigned long failures;
+
+// Keeps the reads from being optimised away
+static volatile uint32_t sink;
+
+//#pragma mark - Timing -
+
+static double now_ns(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (t.tv_sec * 1e9) + t.tv_nsec;
+}
+
+static uint64_t now_cycles(void)
+{
+#ifdef HAVE_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+static cost_t cost(double t0, uint64_t c0, unsigned long n)
+{
+	cost_t c;
+
+	c.cycles = (double)(now_cycles() - c0) / n;
+	c.ns = (now_ns() - t0) / n;
+	return c;
+}
+
+//#pragma mark - Circular buffer -
+
+static cost_t cbuf_run(cbuf_handle_t me, op_t op, unsigned long n)
+{
+	size_t size = circular_buf_capacity(me);
+	uint32_t sum = 0;
+	uint16_t v = 0;
+	unsigned long i;
+	size_t k;
+	uint64_t c0;
+	double t0;
+
+	t0 = now_ns();
+	c0 = now_cycles();
+	for(i = 0; i < n; i++)
+	{
+		switch(op)
+		{
+		case OP_PUT:
+			circular_buf_put(me, values[i]);
+			break;
+		case OP_AT:
+			// start, middle and end of the window like get_press_trend()
+			k = indices[i] % size;
+			circular_buf_at(me, size - 1 - k, &v);
+			sum += v;
+			circular_buf_at(me, size - 1 - (k / 2), &v);
+			sum += v;
+			circular_buf_at(me, size - 1, &v);
+			sum += v;
+			break;
+		default:
+			for(k = 0; circular_buf_at(me, k, &v) == 0; k++)
+			{
+				sum += v;
+			}
+			break;
+		}
+	}
+	sink = sum;
+	return cost(t0, c0, n);
+}
+
+//#pragma mark - Ring -
+
+static cost_t ring_run(baro_ring_t* r, op_t op, unsigned long n)
+{
+	size_t size = baro_ring_capacity();
+	uint32_t sum = 0;
+	uint16_t v = 0;
+	unsigned long i;
+	size_t k;
+	uint64_t c0;
+	double t0;
+
+	t0 = now_ns();
+	c0 = now_cycles();
+	for(i = 0; i < n; i++)
+	{
+		switch(op)
+		{
+		case OP_PUT:
+			baro_ring_put(r, values[i]);
+			break;
+		case OP_AT:
+			k = indices[i] % size;
+			baro_ring_at(r, size - 1 - k, &v);
+			sum += v;
+			baro_ring_at(r, size - 1 - (k / 2), &v);
+			sum += v;
+			baro_ring_at(r, size - 1, &v);
+			sum += v;
+			break;
+		default:
+			for(k = 0; baro_ring_at(r, k, &v); k++)
+			{
+				sum += v;
+			}
+			break;
+		}
+	}
+	sink = sum;
+	return cost(t0, c0, n);
+}
+
+//#pragma mark - Check -
+
+// Both buffers of 256 samples must hold the same values after every put
+static void check(cbuf_handle_t me, baro_ring_t* r, unsigned long n)
+{
+	uint16_t a, b;
+	unsigned long i;
+	size_t k;
+
+	for(i = 0; i < n; i++)
+	{
+		circular_buf_put(me, values[i]);
+		baro_ring_put(r, values[i]);
+		if(circular_buf_size(me) != baro_ring_size(r))
+		{
+			failures++;
+			printf("  put %lu: size %zu / %zu\n", i, circular_buf_size(me), baro_ring_size(r));
+			return;
+		}
+		for(k = 0; k < baro_ring_size(r); k++)
+		{
+			if((circular_buf_at(me, k, &a) != 0) || !baro_ring_at(r, k, &b) || (a != b))
+			{
+				failures++;
+				printf("  put %lu: index %zu differs\n", i, k);
+				return;
+			}
+		}
+	}
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: ringbench [-n operations] [-s seed]\n"
+			"  defaults: 10000000 operations, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	static uint16_t old_storage[CBUF_OLD_SIZE];
+	static uint16_t new_storage[BAROMETER_BUFFER_SIZE];
+	static baro_ring_t ring;
+	cbuf_handle_t old_cbuf, new_cbuf;
+	unsigned long n = 10000000;
+	unsigned long i, ops;
+	long seed = 1;
+	cost_t old_cost[OP_COUNT], new_cost[OP_COUNT], ring_cost[OP_COUNT];
+	op_t op;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': n = (unsigned long)atol(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if(n < BAROMETER_BUFFER_SIZE)
+	{
+		usage();
+		return 1;
+	}
+
+	values = malloc(n * sizeof(uint16_t));
+	indices = malloc(n * sizeof(size_t));
+	if((values == NULL) || (indices == NULL))
+	{
+		return 1;
+	}
+	srand48(seed);
+	for(i = 0; i < n; i++)
+	{
+		values[i] = (uint16_t)(drand48() * (UINT16_MAX + 1.0));
+		indices[i] = (size_t)(drand48() * BAROMETER_BUFFER_SIZE);
+	}
+
+	// the old buffer runs first, the pool starts again for the second one
+	mem_pool_init();
+	old_cbuf = circular_buf_init(old_storage, CBUF_OLD_SIZE);
+	if(old_cbuf == NULL)
+	{
+		return 1;
+	}
+	for(op = 0; op < OP_COUNT; op++)
+	{
+		// a walk reads the whole buffer, fewer of them
+		ops = (op == OP_WALK) ? (n / BAROMETER_BUFFER_SIZE) : n;
+		old_cost[op] = cbuf_run(old_cbuf, op, ops);
+	}
+
+	mem_pool_init();
+	new_cbuf = circular_buf_init(new_storage, BAROMETER_BUFFER_SIZE);
+	if(new_cbuf == NULL)
+	{
+		return 1;
+	}
+	baro_ring_reset(&ring);
+	// the values seen by both agree before any time is taken
+	check(new_cbuf, &ring, (n < 100000) ? n : 100000);
+
+	for(op = 0; op < OP_COUNT; op++)
+	{
+		ops = (op == OP_WALK) ? (n / BAROMETER_BUFFER_SIZE) : n;
+		new_cost[op] = cbuf_run(new_cbuf, op, ops);
+		ring_cost[op] = ring_run(&ring, op, ops);
+	}
+
+	printf("%-6s  %12s  %12s  %12s\n", "op", "cbuf 240 ns", "cbuf 256 ns", "ring 256 ns");
+	for(op = 0; op < OP_COUNT; op++)
+	{
+		printf("%-6s  %12.2f  %12.2f  %12.2f  (%.1fx)\n", op_names[op], old_cost[op].ns, new_cost[op].ns, ring_cost[op].ns,
+				old_cost[op].ns / ring_cost[op].ns);
+	}
+#ifdef HAVE_TSC
+	printf("\n%-6s  %12s  %12s  %12s\n", "op", "cbuf 240 cyc", "cbuf 256 cyc", "ring 256 cyc");
+	for(op = 0; op < OP_COUNT; op++)
+	{
+		printf("%-6s  %12.1f  %12.1f  %12.1f\n", op_names[op], old_cost[op].cycles, new_cost[op].cycles, ring_cost[op].cycles);
+	}
+#endif
+
+	free(indices);
+	free(values);
+	printf("%s\n", (failures == 0) ? "ok" : "FAILED");
+
+	return (failures == 0) ? 0 : 1;
+}
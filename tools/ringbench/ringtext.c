@@ -0,0 +1,63 @@
+/*
+ * ringtext.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Code size of the barometer ring against the circular buffer. The
+ *  accessors of RING_DECLARE are static inline and have no symbols of their
+ *  own, here every accessor the firmware uses gets one external function
+ *  of the same shape as the circular buffer call it replaced. Built next to
+ *  src/circular_buffer.c, nm lists both sets of functions by size and size
+ *  gives the .text of the two objects.
+ *
+ *  Host (from the repository root):
+ *    gcc -O3 -std=gnu11 -Iinc -c tools/ringbench/ringtext.c src/circular_buffer.c
+ *    size ringtext.o circular_buffer.o && nm -S --size-sort ringtext.o circular_buffer.o
+ *
+ *  Target, the flags of the firmware build:
+ *    arm-none-eabi-gcc -O3 -std=gnu11 -mcpu=cortex-m4 -mthumb -mfloat-abi=hard -mfpu=fpv4-sp-d16 -Iinc -c
+ *        tools/ringbench/ringtext.c src/circular_buffer.c
+ *    arm-none-eabi-size ringtext.o circular_buffer.o && arm-none-eabi-nm -S --size-sort ringtext.o circular_buffer.o
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "press_pipeline.h"
+
+void ringtext_reset(baro_ring_t* r)
+{
+	baro_ring_reset(r);
+}
+
+size_t ringtext_size(const baro_ring_t* r)
+{
+	return baro_ring_size(r);
+}
+
+bool ringtext_full(const baro_ring_t* r)
+{
+	return baro_ring_full(r);
+}
+
+void ringtext_put(baro_ring_t* r, uint16_t data)
+{
+	baro_ring_put(r, data);
+}
+
+bool ringtext_try_put(baro_ring_t* r, uint16_t data)
+{
+	return baro_ring_try_put(r, data);
+}
+
+bool ringtext_get(baro_ring_t* r, uint16_t* data)
+{
+	return baro_ring_get(r, data);
+}
+
+bool ringtext_at(const baro_ring_t* r, size_t index, uint16_t* data)
+{
+	return baro_ring_at(r, index, data);
+}
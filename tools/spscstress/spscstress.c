@@ -0,0 +1,240 @@
+/*
+ * spscstress.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host stress test of the lock-free SPSC ring (src/spsc_ring.c). A
+ *  producer thread pushes numbered records while a consumer thread pops
+ *  them, like the DMA interrupt and the superloop of i2c_async.c. Every
+ *  record carries its sequence number and a pattern derived from it over
+ *  the whole element, the consumer checks that no record is lost,
+ *  duplicated, reordered or torn.
+ *
+ *  Every capacity and element size runs twice: with a producer that waits
+ *  for a free slot (no record may be lost) and with one that pushes into a
+ *  full ring (the popped records must be increasing and popped plus
+ *  dropped must give all records). A last run starts the free-running indices just
+ *  below 2^32 so they wrap during the test. Both threads give way when
+ *  the ring is full or empty, on a single core the other one runs then
+ *  and preemption lands anywhere in between. The host orders memory more
+ *  strictly than the Cortex-M4, the run catches lost publication and
+ *  compiler reordering, not a missing DMB. A failure makes the exit
+ *  status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -pthread -Iinc -o spscstress tools/spscstress/spscstress.c src/spsc_ring.c
+ *
+ *  Usage:
+ *    spscstress [-n records]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "spsc_ring.h"
+
+#define MAX_CAPACITY 1024
+#define MAX_ELEM     64
+
+static const uint32_t capacities[] = {1, 2, 8, 64, MAX_CAPACITY};
+static const uint16_t elem_sizes[] = {4, 16, MAX_ELEM};
+
+// One run
+typedef struct {
+	spsc_ring_t ring;
+	uint32_t records;
+	bool drop;
+	uint32_t sent;      // records pushed or dropped by the producer
+	uint32_t popped;
+	uint32_t errors;      // consumer: lost, reordered or torn records
+	uint32_t push_errors; // producer: push into a free slot failed
+} run_t;
+
+static uint8_t storage[MAX_CAPACITY * MAX_ELEM];
+static unsigned long failures;
+
+//#pragma mark - Records -
+
+// Sequence number followed by a pattern of it over the rest of the element
+static void record_make(uint8_t* e, uint16_t size, uint32_t seq)
+{
+	uint16_t i;
+
+	memcpy(e, &seq, sizeof(seq));
+	for(i = sizeof(seq); i < size; i++)
+	{
+		e[i] = (uint8_t)((seq * 31u) + i);
+	}
+}
+
+static bool record_valid(const uint8_t* e, uint16_t size, uint32_t* seq)
+{
+	uint16_t i;
+
+	memcpy(seq, e, sizeof(*seq));
+	for(i = sizeof(*seq); i < size; i++)
+	{
+		if(e[i] != (uint8_t)((*seq * 31u) + i))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//#pragma mark - Threads -
+
+static void* producer(void* arg)
+{
+	run_t* r = arg;
+	uint8_t e[MAX_ELEM];
+	uint32_t seq;
+
+	for(seq = 0; seq < r->records; seq++)
+	{
+		record_make(e, r->ring.elem_size, seq);
+		// a waiting producer pushes only into a free slot, the push may not fail then
+		while(!r->drop && (spsc_ring_size(&r->ring) > r->ring.mask))
+		{
+			// on a single core the consumer only runs if the producer gives way
+			sched_yield();
+		}
+		if(!spsc_ring_push(&r->ring, e))
+		{
+			if(!r->drop)
+			{
+				r->push_errors++;
+			}
+			sched_yield();
+		}
+		__atomic_store_n(&r->sent, seq + 1, __ATOMIC_RELEASE);
+	}
+	return NULL;
+}
+
+static void* consumer(void* arg)
+{
+	run_t* r = arg;
+	uint8_t e[MAX_ELEM];
+	uint32_t seq;
+	uint32_t next = 0;
+	bool last = false;
+
+	// the producer is done once the last record came out or the drops account for the rest
+	while(!last)
+	{
+		if(!spsc_ring_pop(&r->ring, e))
+		{
+			last = (__atomic_load_n(&r->sent, __ATOMIC_ACQUIRE) == r->records) &&
+					(spsc_ring_size(&r->ring) == 0);
+			sched_yield();
+			continue;
+		}
+		r->popped++;
+		if(!record_valid(e, r->ring.elem_size, &seq) || (seq < next) || (!r->drop && (seq != next)))
+		{
+			r->errors++;
+		}
+		next = seq + 1;
+	}
+	return NULL;
+}
+
+//#pragma mark - Check -
+
+static void check(uint32_t capacity, uint16_t elem_size, bool drop, uint32_t records, uint32_t start)
+{
+	pthread_t prod, cons;
+	struct timespec t0, t1;
+	unsigned long before = failures;
+	run_t r = {0};
+	double s;
+
+	r.records = records;
+	r.drop = drop;
+	if(spsc_ring_init(&r.ring, storage, elem_size, capacity) != 0)
+	{
+		printf("  capacity %u rejected\n", capacity);
+		failures++;
+		return;
+	}
+	// free-running indices close to the wrap
+	r.ring.head = start;
+	r.ring.tail = start;
+
+	clock_gettime(CLOCK_MONOTONIC, &t0);
+	if((pthread_create(&cons, NULL, consumer, &r) != 0) || (pthread_create(&prod, NULL, producer, &r) != 0))
+	{
+		printf("  no threads\n");
+		exit(1);
+	}
+	pthread_join(prod, NULL);
+	pthread_join(cons, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &t1);
+	s = (t1.tv_sec - t0.tv_sec) + ((t1.tv_nsec - t0.tv_nsec) * 1e-9);
+
+	// every record was popped or dropped, never both and never twice
+	if((r.errors != 0) || (r.push_errors != 0) || ((r.popped + r.ring.dropped) != records) ||
+			(!drop && (r.popped != records)))
+	{
+		failures++;
+	}
+	printf("%5u x %2u B  %-5s start %08x  popped %9u  dropped %9u  errors %u  %6.1f Mrec/s%s\n",
+			capacity, elem_size, drop ? "drop" : "wait", start, r.popped, r.ring.dropped, r.errors + r.push_errors,
+			records / s / 1e6, (failures != before) ? "  FAILED" : "");
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: spscstress [-n records]\n"
+			"  default: 500000 records per run\n");
+}
+
+int main(int argc, char* argv[])
+{
+	uint32_t records = 500000;
+	unsigned c, e;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': records = (uint32_t)atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if(records == 0)
+	{
+		usage();
+		return 1;
+	}
+
+	for(c = 0; c < (sizeof(capacities) / sizeof(capacities[0])); c++)
+	{
+		for(e = 0; e < (sizeof(elem_sizes) / sizeof(elem_sizes[0])); e++)
+		{
+			check(capacities[c], elem_sizes[e], false, records, 0);
+			check(capacities[c], elem_sizes[e], true, records, 0);
+		}
+	}
+	// the indices wrap after a few records
+	check(8, 16, false, records, UINT32_MAX - 1000);
+	check(8, 16, true, records, UINT32_MAX - 1000);
+
+	printf("%s\n", (failures == 0) ? "ok" : "FAILED");
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,299 @@
+/*
+ * statscheck.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host check of the sliding-window statistics (src/press_stats.c) against
+ *  a naive recompute. Random traces are fed to press_stats_put() and after
+ *  every sample min, max, mean and slope of every window are recomputed
+ *  from the whole trace: a loop over the window and a least-squares fit in
+ *  double. The first trace runs with the windows of main.c, the others
+ *  with random window lengths, sample periods and a reset at a random
+ *  sample. The traces are longer than 65536 samples so the 16 bit sequence
+ *  numbers of the deques wrap.
+ *
+ *  Traces: pressure random walk with noise (Pa above 900 hPa), uniform
+ *  noise over the full uint16_t range, a constant value and storm ramps
+ *  with steps. Min, max and mean must match exactly, the slope within one
+ *  unit (integer division against double). A mismatch makes the exit
+ *  status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o statscheck tools/statscheck/statscheck.c src/press_stats.c -lm
+ *
+ *  Usage:
+ *    statscheck [-n samples] [-t traces] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "press_stats.h"
+
+// windows of main.h at one sample per minute
+#define MAIN_PERIOD_S 60
+
+// periods in seconds for the random configurations
+static const uint16_t periods[] = {1, 10, 60, 300, 3600};
+
+static const char* const kinds[] = {"walk", "uniform", "constant", "storm"};
+
+// Configuration of one trace
+typedef struct {
+	uint16_t lens[PRESS_STATS_MAX_WINDOWS];
+	uint8_t count;
+	uint16_t period_s;
+} config_t;
+
+static uint16_t* trace;
+static unsigned long mismatches;
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static uint16_t clamp(double v)
+{
+	return (uint16_t)((v < 0) ? 0 : ((v > UINT16_MAX) ? UINT16_MAX : lround(v)));
+}
+
+//#pragma mark - Traces -
+
+static void generate(size_t n, unsigned kind)
+{
+	double walk = 11325.0;
+	double rate = 0.0;
+	size_t i;
+
+	for(i = 0; i < n; i++)
+	{
+		switch(kind)
+		{
+		case 0:
+			walk += gauss() * 0.15;
+			trace[i] = clamp(walk + gauss());
+			break;
+		case 1:
+			trace[i] = (uint16_t)(uniform() * (UINT16_MAX + 1.0));
+			break;
+		case 2:
+			trace[i] = 11325;
+			break;
+		default:
+			// a new rate every few hours, now and then a step
+			if(uniform() < (1.0 / 300.0))
+			{
+				rate = (uniform() * 2.0 - 1.0) * 10.0;
+			}
+			if(uniform() < (1.0 / 2000.0))
+			{
+				walk += (uniform() * 2.0 - 1.0) * 2000.0;
+			}
+			walk += rate;
+			walk = (walk < 0) ? 0 : ((walk > UINT16_MAX) ? UINT16_MAX : walk);
+			trace[i] = clamp(walk + gauss() * 2.0);
+			break;
+		}
+	}
+}
+
+static void random_config(config_t* c)
+{
+	uint16_t left = PRESS_STATS_DEQUE_POOL;
+	uint16_t max;
+	uint8_t i;
+
+	c->count = (uint8_t)(1 + uniform() * PRESS_STATS_MAX_WINDOWS);
+	for(i = 0; i < c->count; i++)
+	{
+		// room for one sample in each of the windows still to come
+		max = left - (c->count - i - 1);
+		max = (max > PRESS_STATS_MAX_WINDOW) ? PRESS_STATS_MAX_WINDOW : max;
+		c->lens[i] = (uint16_t)(1 + uniform() * max);
+		// short windows now and then, the edge cases of the deques
+		if(uniform() < 0.3)
+		{
+			c->lens[i] = (uint16_t)(1 + uniform() * ((max < 3) ? max : 3));
+		}
+		left -= c->lens[i];
+	}
+	c->period_s = periods[(unsigned)(uniform() * (sizeof(periods) / sizeof(periods[0])))];
+}
+
+//#pragma mark - Check -
+
+// Naive statistics of the last n samples before end
+static void naive(size_t end, size_t n, uint16_t sph, press_stats_t* s, double* slope)
+{
+	const uint16_t* v = &trace[end - n];
+	uint64_t sum = 0;
+	double mx = (n - 1) / 2.0;
+	double my, sxy = 0.0, sxx = 0.0;
+	size_t i;
+
+	s->count = (uint16_t)n;
+	s->min = v[0];
+	s->max = v[0];
+	for(i = 0; i < n; i++)
+	{
+		s->min = (v[i] < s->min) ? v[i] : s->min;
+		s->max = (v[i] > s->max) ? v[i] : s->max;
+		sum += v[i];
+	}
+	s->mean = (uint16_t)((sum + (n / 2)) / n);
+	my = (double)sum / n;
+	for(i = 0; i < n; i++)
+	{
+		sxy += (i - mx) * (v[i] - my);
+		sxx += (i - mx) * (i - mx);
+	}
+	*slope = (n > 1) ? (sxy / sxx) * sph : 0.0;
+}
+
+static void report(const char* kind, size_t at, uint8_t w, const press_stats_t* got, const press_stats_t* exp, double slope)
+{
+	if(mismatches++ < 10)
+	{
+		printf("  %s sample %zu window %u: count %u/%u min %u/%u max %u/%u mean %u/%u slope %d/%.2f\n",
+				kind, at, w, got->count, exp->count, got->min, exp->min, got->max, exp->max,
+				got->mean, exp->mean, got->slope, slope);
+	}
+}
+
+// Returns the number of mismatching samples
+static unsigned long check(size_t n, unsigned kind, const config_t* c, size_t reset_at)
+{
+	press_stats_t got, exp;
+	unsigned long before = mismatches;
+	size_t start = 0;
+	size_t i, len;
+	double slope;
+	uint8_t w;
+
+	if(press_stats_init(c->lens, c->count, c->period_s) != 0)
+	{
+		printf("  configuration rejected\n");
+		return 1;
+	}
+	generate(n, kind);
+
+	for(i = 0; i < n; i++)
+	{
+		if(i == reset_at)
+		{
+			press_stats_reset();
+			start = i;
+		}
+		press_stats_put(trace[i]);
+		for(w = 0; w < c->count; w++)
+		{
+			len = ((i + 1 - start) < c->lens[w]) ? (i + 1 - start) : c->lens[w];
+			naive(i + 1, len, (uint16_t)(3600 / c->period_s), &exp, &slope);
+			if((press_stats_get(w, &got) != 0) ||
+					(press_stats_window_full(w) != (len == c->lens[w])) ||
+					(got.count != exp.count) || (got.min != exp.min) ||
+					(got.max != exp.max) || (got.mean != exp.mean) ||
+					(fabs(got.slope - slope) > 1.0))
+			{
+				report(kinds[kind], i, w, &got, &exp, slope);
+			}
+		}
+	}
+
+	return mismatches - before;
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: statscheck [-n samples] [-t traces] [-s seed]\n"
+			"  defaults: 70000 samples per trace, 8 traces, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	size_t n = 70000;
+	unsigned traces = 8;
+	long seed = 1;
+	config_t c = {{60, 180, 360, 720}, 4, MAIN_PERIOD_S};
+	unsigned long bad;
+	size_t reset_at;
+	unsigned t, kind;
+	uint8_t w;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:t:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': n = (size_t)atol(optarg); break;
+		case 't': traces = (unsigned)atoi(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((n < 2) || (traces == 0))
+	{
+		usage();
+		return 1;
+	}
+
+	trace = malloc(n * sizeof(uint16_t));
+	if(trace == NULL)
+	{
+		return 1;
+	}
+	srand48(seed);
+
+	for(t = 0; t < traces; t++)
+	{
+		kind = t % (sizeof(kinds) / sizeof(kinds[0]));
+		// the first trace runs as on the station, without a reset
+		reset_at = n;
+		if(t > 0)
+		{
+			random_config(&c);
+			reset_at = (size_t)(uniform() * n);
+		}
+		printf("trace %u %-8s period %4u s windows", t, kinds[kind], c.period_s);
+		for(w = 0; w < c.count; w++)
+		{
+			printf(" %u", c.lens[w]);
+		}
+		printf("\n");
+		bad = check(n, kind, &c, reset_at);
+		if(bad != 0)
+		{
+			printf("  %lu mismatches\n", bad);
+		}
+	}
+
+	free(trace);
+	printf("%s: %lu mismatches over %u traces of %zu samples\n",
+			(mismatches == 0) ? "ok" : "FAILED", mismatches, traces, n);
+
+	return (mismatches == 0) ? 0 : 1;
+}
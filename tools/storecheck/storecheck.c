@@ -0,0 +1,420 @@
+/*
+ * storecheck.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Host check of the persistent pressure log (src/press_store.c) on a RAM
+ *  mock of the two flash sectors of int_flash.c. Programming can only
+ *  clear bits and an erase sets the whole sector to 0xFF, like the flash.
+ *  The mock keeps every record that is programmed, so it knows which
+ *  samples the flash holds at any time.
+ *
+ *  A stream of samples is put into the store. At random points the station
+ *  is reset: Error_Handler() flushes the batch first, then the store is
+ *  attached again and recovers the newest samples like the boot in main.c.
+ *  With -t a record is torn instead, power is lost after half of it is
+ *  programmed and the reset follows without a flush. Checked on every
+ *  reset:
+ *
+ *    - the flush left no sample in RAM, every sample put since the last
+ *      reset is in a programmed record
+ *    - the recovery returns the newest samples of the records still in
+ *      flash, in order, the torn ones skipped, as many as asked for or
+ *      all of them
+ *    - the recovery cost: the end of the log is found with a binary
+ *      search, the replay reads every record it walks twice and one more
+ *
+ *  Checked at the end, the write amplification: only whole records are
+ *  programmed, one per full batch and one per flush or tear at most,
+ *  and a sector is erased once per sector of records, once more after a
+ *  torn first record as the sector is not clean any more. Flash bytes per
+ *  sample and erases are reported next to the ideal of full records. A
+ *  failed check makes the exit status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o storecheck tools/storecheck/storecheck.c src/press_store.c
+ *
+ *  Usage:
+ *    storecheck [-n samples] [-r samples_per_reset] [-t tear_probability] [-m max_recover]
+ *               [-S sector_kb] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "press_store.h"
+
+// Sector size of int_flash.c in KB
+#define SECTOR_KB_FLASH 128
+
+// Samples of the history replayed at boot (PRESS_STATS_MAX_WINDOW)
+#define RECOVER_DEFAULT 720
+
+// A record of the mock, in the order it was programmed
+typedef struct
+{
+	uint16_t samples[PRESS_STORE_RECORD_SAMPLES];
+	uint8_t count;
+	uint8_t sector;
+	uint32_t slot;
+	bool torn;          // power was lost while it was programmed
+	bool erased;        // its sector was erased since
+} record_t;
+
+static uint8_t* image;
+static uint32_t sector_size;
+
+// records programmed so far
+static record_t* records;
+static size_t nrecords;
+static size_t max_records;
+
+// the next record is torn
+static bool tear;
+
+static unsigned long programmed_bytes;
+static unsigned long erases;
+static unsigned long torn_first;
+static unsigned long misaligned;
+
+static unsigned long failures;
+
+//#pragma mark - Flash mock -
+
+static int32_t flash_erase(void* handle, uint8_t sector)
+{
+	size_t i;
+
+	(void)handle;
+	memset(&image[sector * sector_size], 0xFF, sector_size);
+	erases++;
+	for(i = 0; i < nrecords; i++)
+	{
+		records[i].erased |= (records[i].sector == sector);
+	}
+	return 0;
+}
+
+static int32_t flash_program(void* handle, uint32_t offset, const uint8_t* bufp, uint16_t len)
+{
+	record_t* r;
+	uint16_t n = len;
+	uint16_t i;
+
+	(void)handle;
+	if(((offset % PRESS_STORE_RECORD_SIZE) != 0) || (len != PRESS_STORE_RECORD_SIZE) || (nrecords >= max_records))
+	{
+		misaligned++;
+		return -1;
+	}
+	// the samples of the record, little endian after the 8 byte header
+	r = &records[nrecords++];
+	r->count = bufp[2];
+	r->sector = (uint8_t)(offset / sector_size);
+	r->slot = (offset % sector_size) / PRESS_STORE_RECORD_SIZE;
+	r->torn = tear;
+	r->erased = false;
+	for(i = 0; (i < r->count) && (i < PRESS_STORE_RECORD_SAMPLES); i++)
+	{
+		r->samples[i] = (uint16_t)(bufp[8 + (2 * i)] | (bufp[9 + (2 * i)] << 8));
+	}
+	if(tear)
+	{
+		n = len / 2;
+		torn_first += (r->slot == 0);
+	}
+	// flash can only clear bits
+	for(i = 0; i < n; i++)
+	{
+		image[offset + i] &= bufp[i];
+	}
+	programmed_bytes += n;
+
+	return tear ? -1 : 0;
+}
+
+static int32_t flash_read(void* handle, uint32_t offset, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	memcpy(bufp, &image[offset], len);
+	return 0;
+}
+
+static const press_store_ctx_t* flash_ctx(void)
+{
+	static press_store_ctx_t ctx;
+
+	ctx.erase = flash_erase;
+	ctx.program = flash_program;
+	ctx.read = flash_read;
+	ctx.sector_size = sector_size;
+	ctx.handle = NULL;
+
+	return &ctx;
+}
+
+//#pragma mark - Check -
+
+static uint16_t recovered[PRESS_STORE_RECORD_SAMPLES * 4096];
+static size_t nrecovered;
+
+static void sink(uint16_t value)
+{
+	if(nrecovered < (sizeof(recovered) / sizeof(recovered[0])))
+	{
+		recovered[nrecovered] = value;
+	}
+	nrecovered++;
+}
+
+static void fail(unsigned long reset, const char* what, unsigned long got, unsigned long exp)
+{
+	if(failures++ < 10)
+	{
+		printf("  reset %lu: %s %lu, expected %lu\n", reset, what, got, exp);
+	}
+}
+
+// Reads of the binary search for the end of a sector
+static unsigned long search_reads(uint32_t slots)
+{
+	unsigned long n = 0;
+
+	while(slots > 0)
+	{
+		slots /= 2;
+		n++;
+	}
+	return n;
+}
+
+// Every sample put since the last reset is in a programmed record
+static void check_stored(unsigned long n, unsigned long since)
+{
+	unsigned long stored = 0;
+	size_t i;
+
+	for(i = nrecords; (i > 0) && (stored < since); i--)
+	{
+		stored += records[i - 1].count;
+	}
+	if(stored != since)
+	{
+		fail(n, "samples left in RAM at the reset", since - stored, 0);
+	}
+}
+
+// Attach the store again and recover, check against the records in flash
+static void reset(unsigned long n, size_t max_recover, unsigned long* init_reads, unsigned long* recover_reads)
+{
+	press_store_stats_t stats;
+	const record_t* r;
+	unsigned long init, walked = 0;
+	size_t want = 0;
+	size_t got;
+	size_t i, k;
+	int j;
+
+	if(press_store_init(flash_ctx()) != 0)
+	{
+		fail(n, "init", 1, 0);
+		return;
+	}
+	press_store_get_stats(&stats);
+	init = stats.recovery_reads;
+	*init_reads += init;
+	if(init > (3 + search_reads(sector_size / PRESS_STORE_RECORD_SIZE)))
+	{
+		fail(n, "reads to find the end", init, 3 + search_reads(sector_size / PRESS_STORE_RECORD_SIZE));
+	}
+
+	nrecovered = 0;
+	got = press_store_recover(sink, max_recover);
+	press_store_get_stats(&stats);
+	*recover_reads += stats.recovery_reads - init;
+
+	// the newest samples of the records in flash, walking back like the recovery
+	// a torn first record leaves its sector out until the next record erases it
+	for(i = nrecords; (i > 0) && (want < max_recover); i--)
+	{
+		r = &records[i - 1];
+		if(r->erased || (r->torn && (r->slot == 0)))
+		{
+			continue;
+		}
+		walked++;
+		want += r->torn ? 0 : r->count;
+	}
+	want = (want > max_recover) ? max_recover : want;
+	if((got != want) || (nrecovered != want))
+	{
+		fail(n, "samples recovered", got, want);
+		return;
+	}
+	if((stats.recovery_reads - init) != (1 + (2 * walked)))
+	{
+		fail(n, "reads of the recovery", stats.recovery_reads - init, 1 + (2 * walked));
+	}
+
+	// compare from the newest sample back
+	k = got;
+	for(i = nrecords; (i > 0) && (k > 0); i--)
+	{
+		r = &records[i - 1];
+		if(r->erased || r->torn)
+		{
+			continue;
+		}
+		for(j = r->count - 1; (j >= 0) && (k > 0); j--)
+		{
+			k--;
+			if((k < (sizeof(recovered) / sizeof(recovered[0]))) && (recovered[k] != r->samples[j]))
+			{
+				fail(n, "sample", recovered[k], r->samples[j]);
+				return;
+			}
+		}
+	}
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: storecheck [-n samples] [-r samples_per_reset] [-t tear_probability] [-m max_recover]\n"
+			"                  [-S sector_kb] [-s seed]\n"
+			"  defaults: 200000 samples, a reset every 2000 samples on average, no torn records,\n"
+			"  720 samples recovered, 4 KB sectors (128 on the station), seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	unsigned long samples = 200000;
+	double per_reset = 2000;
+	double tear_p = 0;
+	long max_recover = RECOVER_DEFAULT;
+	long sector_kb = 4;
+	long seed = 1;
+	unsigned long resets = 0, flushes = 0, tears = 0;
+	unsigned long init_reads = 0, recover_reads = 0;
+	unsigned long since = 0;
+	unsigned long full;
+	size_t before;
+	unsigned long i;
+	bool torn;
+	int opt;
+
+	while((opt = getopt(argc, argv, "n:r:t:m:S:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'n': samples = strtoul(optarg, NULL, 10); break;
+		case 'r': per_reset = atof(optarg); break;
+		case 't': tear_p = atof(optarg); break;
+		case 'm': max_recover = atol(optarg); break;
+		case 'S': sector_kb = atol(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((samples < PRESS_STORE_RECORD_SAMPLES) || (per_reset < 1) || (tear_p < 0) || (tear_p > 1) || (max_recover < 1) ||
+			((size_t)max_recover > (sizeof(recovered) / sizeof(recovered[0]))) ||
+			(sector_kb < 1) || (sector_kb > SECTOR_KB_FLASH))
+	{
+		usage();
+		return 1;
+	}
+	srand48(seed);
+	sector_size = (uint32_t)sector_kb * 1024;
+	image = malloc(2 * (size_t)sector_size);
+	// a record per sample at worst, one more per reset
+	max_records = (2 * samples) + 1;
+	records = calloc(max_records, sizeof(record_t));
+	if((image == NULL) || (records == NULL))
+	{
+		fprintf(stderr, "out of memory\n");
+		return 1;
+	}
+	memset(image, 0xFF, 2 * (size_t)sector_size);
+	if(press_store_init(flash_ctx()) != 0)
+	{
+		fprintf(stderr, "init failed\n");
+		return 1;
+	}
+
+	for(i = 0; i < samples; i++)
+	{
+		tear = (tear_p > 0) && (drand48() < tear_p);
+		torn = (press_store_put((uint16_t)(lrand48() & 0xFFFF)) != 0);
+		since++;
+		if(torn && !tear)
+		{
+			fail(resets, "put failed", 1, 0);
+		}
+		tear = false;
+		if(torn)
+		{
+			// power lost while the record was programmed, no flush
+			tears++;
+		}
+		else if(drand48() < (1.0 / per_reset))
+		{
+			// Error_Handler(): the batch goes to flash before the lock-up
+			before = nrecords;
+			if(press_store_flush() != 0)
+			{
+				fail(resets, "flush failed", 1, 0);
+			}
+			flushes += (nrecords != before);
+		}
+		else
+		{
+			continue;
+		}
+
+		check_stored(resets, since);
+		since = 0;
+		reset(resets, (size_t)max_recover, &init_reads, &recover_reads);
+		resets++;
+	}
+
+	// whole records only, one per full batch and one per flush or tear at most
+	full = samples / PRESS_STORE_RECORD_SAMPLES;
+	if(misaligned != 0)
+	{
+		fail(resets, "partial or misaligned programs", misaligned, 0);
+	}
+	if(nrecords > (full + flushes + tears + 1))
+	{
+		fail(resets, "records programmed", nrecords, full + flushes + tears + 1);
+	}
+	if(erases > ((nrecords / (sector_size / PRESS_STORE_RECORD_SIZE)) + 1 + torn_first))
+	{
+		fail(resets, "sector erases", erases, (nrecords / (sector_size / PRESS_STORE_RECORD_SIZE)) + 1 + torn_first);
+	}
+
+	printf("%lu samples, %lu resets (%lu flushed a batch, %lu torn records), %ld KB sectors\n",
+			samples, resets, flushes, tears, sector_kb);
+	printf("programmed %lu records, %lu bytes: %.3f bytes per sample, %.3f with full records only\n",
+			(unsigned long)nrecords, programmed_bytes, (double)programmed_bytes / samples,
+			(double)PRESS_STORE_RECORD_SIZE / PRESS_STORE_RECORD_SAMPLES);
+	printf("erases %lu, %.1f samples per erase\n", erases, erases ? ((double)samples / erases) : 0.0);
+	if(resets > 0)
+	{
+		printf("reads per reset: %.1f to find the end, %.1f to recover %ld samples\n",
+				(double)init_reads / resets, (double)recover_reads / resets, max_recover);
+	}
+	printf("%s: %lu failures\n", (failures == 0) ? "ok" : "FAILED", failures);
+
+	free(records);
+	free(image);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,357 @@
+/*
+ * tendcheck.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Host check of the pressure tendency engine (src/press_tendency.c).
+ *  Three parts:
+ *
+ *    - a table of cases for press_tendency_classify() with the expected
+ *      WMO code, every code 0..8, the changes at and just past +-steady,
+ *      the "more slowly" and "more rapidly" splits at twice the change of
+ *      the other half and a steady band other than the default
+ *    - a sweep of both half changes over -300..300 Pa: a falling trace must
+ *      give the mirrored code of the rising one (0 and 5, 1 and 6, 2 and 7,
+ *      3 and 8, 4 stays) and the code must agree with the change over the
+ *      whole window (higher, lower or the same within +-steady)
+ *    - sequences of slopes through press_tendency_update() with the storm
+ *      level expected after every one: raising at the watch and warning
+ *      rates, holding inside the hysteresis band and dropping just past it,
+ *      with the defaults and with a configuration without hysteresis
+ *
+ *  Also checked: the code, slope and change of press_tendency_get() after
+ *  an update and the names of the codes. A mismatch makes the exit status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o tendcheck tools/tendcheck/tendcheck.c src/press_tendency.c
+ *
+ *  Usage:
+ *    tendcheck
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "press_tendency.h"
+
+// Half changes of the sweep in Pa
+#define SWEEP_PA 300
+
+// One case of the classification table
+typedef struct {
+	int32_t first;
+	int32_t second;
+	int32_t steady;
+	press_tend_code_t code;
+} tcase_t;
+
+static const tcase_t cases[] =
+{
+	// 0: increasing, then decreasing; higher or the same
+	{  50,  -20, 10, PRESS_TEND_RISE_FALL},
+	{  50,  -50, 10, PRESS_TEND_RISE_FALL},
+	{  30,  -11, 10, PRESS_TEND_RISE_FALL},
+	{  11,  -11, 10, PRESS_TEND_RISE_FALL},
+	// 1: increasing, then steady or increasing more slowly
+	{  30,    0, 10, PRESS_TEND_RISE_STEADY},
+	{  30,  -10, 10, PRESS_TEND_RISE_STEADY},
+	{  30,   10, 10, PRESS_TEND_RISE_STEADY},
+	{  60,   29, 10, PRESS_TEND_RISE_STEADY},
+	// 2: increasing steadily or unsteadily
+	{  30,   30, 10, PRESS_TEND_RISE},
+	{  60,   30, 10, PRESS_TEND_RISE},
+	{  20,   40, 10, PRESS_TEND_RISE},
+	{  10,   10, 10, PRESS_TEND_RISE},
+	// 3: decreasing or steady, then increasing or increasing more rapidly
+	{ -20,   50, 10, PRESS_TEND_FALL_RISE_HIGHER},
+	{   0,   30, 10, PRESS_TEND_FALL_RISE_HIGHER},
+	{   0,   11, 10, PRESS_TEND_FALL_RISE_HIGHER},
+	{  20,   41, 10, PRESS_TEND_FALL_RISE_HIGHER},
+	// 4: steady, within +-steady over the whole window and no turn
+	{   0,    0, 10, PRESS_TEND_STEADY},
+	{   0,   10, 10, PRESS_TEND_STEADY},
+	{   0,  -10, 10, PRESS_TEND_STEADY},
+	{  10,  -10, 10, PRESS_TEND_STEADY},
+	{ -10,   10, 10, PRESS_TEND_STEADY},
+	{  11,   -1, 10, PRESS_TEND_STEADY},
+	// 5: decreasing, then increasing; lower or the same
+	{ -50,   20, 10, PRESS_TEND_FALL_RISE},
+	{ -50,   50, 10, PRESS_TEND_FALL_RISE},
+	{ -30,   11, 10, PRESS_TEND_FALL_RISE},
+	{ -11,   11, 10, PRESS_TEND_FALL_RISE},
+	// 6: decreasing, then steady or decreasing more slowly
+	{ -30,    0, 10, PRESS_TEND_FALL_STEADY},
+	{ -30,   10, 10, PRESS_TEND_FALL_STEADY},
+	{ -30,  -10, 10, PRESS_TEND_FALL_STEADY},
+	{ -60,  -29, 10, PRESS_TEND_FALL_STEADY},
+	// 7: decreasing steadily or unsteadily
+	{ -30,  -30, 10, PRESS_TEND_FALL},
+	{ -60,  -30, 10, PRESS_TEND_FALL},
+	{ -20,  -40, 10, PRESS_TEND_FALL},
+	{ -10,  -10, 10, PRESS_TEND_FALL},
+	// 8: steady or increasing, then decreasing or decreasing more rapidly
+	{  20,  -50, 10, PRESS_TEND_RISE_FALL_LOWER},
+	{   0,  -30, 10, PRESS_TEND_RISE_FALL_LOWER},
+	{   0,  -11, 10, PRESS_TEND_RISE_FALL_LOWER},
+	{ -20,  -41, 10, PRESS_TEND_RISE_FALL_LOWER},
+	// the steady band is the one passed in
+	{  40,    0, 50, PRESS_TEND_STEADY},
+	{  51,    0, 50, PRESS_TEND_RISE_STEADY},
+	{ -40,    0, 50, PRESS_TEND_STEADY},
+	{ -51,    0, 50, PRESS_TEND_FALL_STEADY},
+	{   1,    0,  0, PRESS_TEND_RISE_STEADY},
+	{   0,   -1,  0, PRESS_TEND_RISE_FALL_LOWER},
+};
+
+// Code of the same trace upside down
+static const press_tend_code_t mirror[PRESS_TEND_COUNT] =
+{
+	PRESS_TEND_FALL_RISE,
+	PRESS_TEND_FALL_STEADY,
+	PRESS_TEND_FALL,
+	PRESS_TEND_RISE_FALL_LOWER,
+	PRESS_TEND_STEADY,
+	PRESS_TEND_RISE_FALL,
+	PRESS_TEND_RISE_STEADY,
+	PRESS_TEND_RISE,
+	PRESS_TEND_FALL_RISE_HIGHER,
+};
+
+// One update of a storm sequence and the level expected after it
+typedef struct {
+	int32_t slope;
+	press_storm_t storm;
+} step_t;
+
+// Defaults: watch at -120 Pa/h, warning at -200 Pa/h, 30 Pa/h hysteresis
+static const step_t default_steps[] =
+{
+	{-100, PRESS_STORM_NONE},
+	{-119, PRESS_STORM_NONE},
+	{-120, PRESS_STORM_WATCH},
+	{-100, PRESS_STORM_WATCH},
+	{ -90, PRESS_STORM_WATCH},
+	{ -89, PRESS_STORM_NONE},
+	{-110, PRESS_STORM_NONE},
+	{-120, PRESS_STORM_WATCH},
+	{-199, PRESS_STORM_WATCH},
+	{-200, PRESS_STORM_WARNING},
+	{-180, PRESS_STORM_WARNING},
+	{-170, PRESS_STORM_WARNING},
+	{-169, PRESS_STORM_WATCH},
+	{-190, PRESS_STORM_WATCH},
+	{ -95, PRESS_STORM_WATCH},
+	{-250, PRESS_STORM_WARNING},
+	{ -50, PRESS_STORM_NONE},
+	{-201, PRESS_STORM_WARNING},
+	{   0, PRESS_STORM_NONE},
+	{ 300, PRESS_STORM_NONE},
+	{-130, PRESS_STORM_WATCH},
+	{-300, PRESS_STORM_WARNING},
+	{-171, PRESS_STORM_WARNING},
+	{ -91, PRESS_STORM_WATCH},
+	{ -89, PRESS_STORM_NONE},
+};
+
+static const press_tendency_cfg_t sharp_cfg = {10, -100, -150, 0};
+
+// No hysteresis: the level follows the thresholds both ways
+static const step_t sharp_steps[] =
+{
+	{-100, PRESS_STORM_WATCH},
+	{ -99, PRESS_STORM_NONE},
+	{-150, PRESS_STORM_WARNING},
+	{-149, PRESS_STORM_WATCH},
+	{-150, PRESS_STORM_WARNING},
+	{ -99, PRESS_STORM_NONE},
+};
+
+static unsigned long failures;
+
+//#pragma mark - Check -
+
+static void fail(const char* what, long a, long b, long got, long exp)
+{
+	if(failures++ < 10)
+	{
+		printf("  %s %ld, %ld: got %ld, expected %ld\n", what, a, b, got, exp);
+	}
+}
+
+static void check_cases(void)
+{
+	bool seen[PRESS_TEND_COUNT] = {false};
+	const tcase_t* c;
+	press_tend_code_t code;
+	size_t i;
+
+	for(i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++)
+	{
+		c = &cases[i];
+		code = press_tendency_classify(c->first, c->second, c->steady);
+		if(code != c->code)
+		{
+			fail("case", c->first, c->second, code, c->code);
+		}
+		seen[c->code] = true;
+	}
+	for(i = 0; i < PRESS_TEND_COUNT; i++)
+	{
+		if(!seen[i])
+		{
+			printf("  no case for code %zu\n", i);
+			failures++;
+		}
+	}
+	printf("%zu cases\n", sizeof(cases) / sizeof(cases[0]));
+}
+
+static void check_sweep(void)
+{
+	unsigned long n = 0;
+	press_tend_code_t code;
+	int32_t first, second, total;
+	bool ok;
+
+	for(first = -SWEEP_PA; first <= SWEEP_PA; first++)
+	{
+		for(second = -SWEEP_PA; second <= SWEEP_PA; second++)
+		{
+			code = press_tendency_classify(first, second, PRESS_TENDENCY_STEADY);
+			if(press_tendency_classify(-first, -second, PRESS_TENDENCY_STEADY) != mirror[code])
+			{
+				fail("mirror of", first, second, press_tendency_classify(-first, -second, PRESS_TENDENCY_STEADY), mirror[code]);
+			}
+			// higher for 1..3, lower for 6..8, the same for 4, not lower for 0 and not higher for 5
+			total = first + second;
+			switch(code)
+			{
+			case PRESS_TEND_RISE_STEADY:
+			case PRESS_TEND_RISE:
+			case PRESS_TEND_FALL_RISE_HIGHER:
+				ok = (total > PRESS_TENDENCY_STEADY);
+				break;
+			case PRESS_TEND_FALL_STEADY:
+			case PRESS_TEND_FALL:
+			case PRESS_TEND_RISE_FALL_LOWER:
+				ok = (total < -PRESS_TENDENCY_STEADY);
+				break;
+			case PRESS_TEND_STEADY:
+				ok = (total >= -PRESS_TENDENCY_STEADY) && (total <= PRESS_TENDENCY_STEADY);
+				break;
+			case PRESS_TEND_RISE_FALL:
+				ok = (total >= -PRESS_TENDENCY_STEADY);
+				break;
+			case PRESS_TEND_FALL_RISE:
+				ok = (total <= PRESS_TENDENCY_STEADY);
+				break;
+			default:
+				ok = false;
+				break;
+			}
+			if(!ok && (failures++ < 10))
+			{
+				printf("  %d, %d: code %d with a change of %d Pa over the window\n", first, second, code, total);
+			}
+			n++;
+		}
+	}
+	printf("%lu sweep points\n", n);
+}
+
+static void check_steps(const char* name, const press_tendency_cfg_t* cfg, const step_t* steps, size_t count)
+{
+	press_tendency_t t;
+	press_storm_t storm;
+	size_t i;
+
+	press_tendency_init(cfg);
+	for(i = 0; i < count; i++)
+	{
+		// a steady window, only the slope moves the level
+		storm = press_tendency_update(steps[i].slope, 101000, 101000, 101000);
+		press_tendency_get(&t);
+		if((storm != steps[i].storm) || (t.storm != steps[i].storm))
+		{
+			fail(name, (long)i, steps[i].slope, storm, steps[i].storm);
+		}
+		if((t.slope != steps[i].slope) || (t.updates != (i + 1)))
+		{
+			fail(name, (long)i, steps[i].slope, t.slope, steps[i].slope);
+		}
+	}
+	printf("%s: %zu updates\n", name, count);
+}
+
+static void check_update(void)
+{
+	press_tendency_t t;
+
+	press_tendency_init(NULL);
+	press_tendency_get(&t);
+	if((t.code != PRESS_TEND_STEADY) || (t.storm != PRESS_STORM_NONE) || (t.updates != 0))
+	{
+		fail("state after init", t.code, t.storm, t.updates, 0);
+	}
+	// the halves of the window are mid - start and end - mid
+	press_tendency_update(-150, 101000, 100950, 100700);
+	press_tendency_get(&t);
+	if((t.code != PRESS_TEND_RISE_FALL_LOWER) || (t.change != -300))
+	{
+		fail("update -50, -250: code and change", t.code, t.change, PRESS_TEND_RISE_FALL_LOWER, -300);
+	}
+	if((t.slope != -150) || (t.storm != PRESS_STORM_WATCH))
+	{
+		fail("update -50, -250: slope and storm", t.slope, t.storm, -150, PRESS_STORM_WATCH);
+	}
+	press_tendency_update(0, 100700, 100800, 100820);
+	press_tendency_get(&t);
+	if((t.code != PRESS_TEND_RISE_STEADY) || (t.change != 120))
+	{
+		fail("update 100, 20: code and change", t.code, t.change, PRESS_TEND_RISE_STEADY, 120);
+	}
+}
+
+static void check_names(void)
+{
+	size_t i, j;
+
+	for(i = 0; i < PRESS_TEND_COUNT; i++)
+	{
+		for(j = 0; j < i; j++)
+		{
+			if(strcmp(press_tendency_name(i), press_tendency_name(j)) == 0)
+			{
+				fail("same name of codes", (long)i, (long)j, 0, 0);
+			}
+		}
+		if(strcmp(press_tendency_name(i), "unknown") == 0)
+		{
+			fail("no name of code", (long)i, 0, 0, 0);
+		}
+	}
+	if(strcmp(press_tendency_name(PRESS_TEND_COUNT), "unknown") != 0)
+	{
+		fail("name of code", PRESS_TEND_COUNT, 0, 0, 0);
+	}
+}
+
+//#pragma mark - Main -
+
+int main(void)
+{
+	check_cases();
+	check_sweep();
+	check_steps("defaults", NULL, default_steps, sizeof(default_steps) / sizeof(default_steps[0]));
+	check_steps("no hysteresis", &sharp_cfg, sharp_steps, sizeof(sharp_steps) / sizeof(sharp_steps[0]));
+	check_update();
+	check_names();
+
+	printf("%s: %lu failures\n", (failures == 0) ? "ok" : "FAILED", failures);
+
+	return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,373 @@
+/*
+ * tracegen.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Synthetic weather trace generator for soak testing the pressure modules.
+ *  The pressure is a slow random walk around 1013 hPa with passing fronts
+ *  (a cosine shaped dip, the deep ones flagged as storms at their minimum),
+ *  semi-diurnal and diurnal atmospheric tides, altitude steps as when the
+ *  device is moved (flagged like the accelerometer transient interrupt,
+ *  optionally with a one sample glitch within the next 4 samples, a door or
+ *  a gust while the station is put down), sensor noise and the LPS28DFW
+ *  quantization (4096 LSB/hPa rounded to Pa like barometer_data()). The
+ *  temperature follows a daily cycle.
+ *
+ *  Output formats:
+ *    csv      time_s,pa,storm,centi_c,moved,alt_pa (read by tools/backtest),
+ *             alt_pa is the pressure change of the altitude steps so far
+ *    bin      little endian uint32 time_s, int32 pa, uint32 flags, bit 0
+ *             storm, bit 1 moved (tools/backtest)
+ *    console  one "pi <pa>" command per sample, to be sent to the console
+ *    flash    image of flash sectors 22/23 written by press_store.c, to be
+ *             programmed at 0x081C0000 and replayed at boot
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o tracegen tools/tracegen/tracegen.c src/press_store.c -lm
+ *
+ *  Usage:
+ *    tracegen [-f csv|bin|console|flash] [-d days] [-i interval_s] [-s seed]
+ *             [-F fronts_per_week] [-D front_depth_hpa] [-S storm_depth_hpa]
+ *             [-t tide_pa] [-n noise_pa] [-a steps_per_week] [-A step_m]
+ *             [-g glitch_pa] [-o file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "press_store.h"
+#include "baro_units.h"
+
+// Flash region used by int_flash.c: sectors 22 and 23 of 128 KB
+#define FLASH_SECTOR_SIZE (128 * 1024)
+
+// Pressure change per metre of altitude near sea level
+#define PA_PER_METRE 12.0
+
+// A glitch lands on one of the samples 1..GLITCH_WITHIN after an altitude step
+#define GLITCH_WITHIN 4
+
+#define MAX_FRONTS 64
+
+typedef struct
+{
+	double start_s;   // begin of the fall
+	double fall_s;    // duration of the fall
+	double rise_s;    // duration of the recovery
+	double depth;     // Pa
+	bool storm;
+	bool flagged;
+} front_t;
+
+typedef enum
+{
+	FMT_CSV = 0,
+	FMT_BIN,
+	FMT_CONSOLE,
+	FMT_FLASH
+} format_t;
+
+static front_t fronts[MAX_FRONTS];
+static uint8_t flash_image[2 * FLASH_SECTOR_SIZE];
+
+//#pragma mark - Random numbers -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Exponentially distributed waiting time in seconds for a rate per week
+static double wait_s(double per_week)
+{
+	return -log(1.0 - uniform()) * (7.0 * 86400.0) / per_week;
+}
+
+//#pragma mark - Flash mock -
+
+static int32_t flash_erase(void* handle, uint8_t sector)
+{
+	(void)handle;
+	memset(&flash_image[sector * FLASH_SECTOR_SIZE], 0xFF, FLASH_SECTOR_SIZE);
+	return 0;
+}
+
+static int32_t flash_program(void* handle, uint32_t offset, const uint8_t* bufp, uint16_t len)
+{
+	uint16_t i;
+
+	(void)handle;
+	// flash can only clear bits
+	for(i = 0; i < len; i++)
+	{
+		flash_image[offset + i] &= bufp[i];
+	}
+	return 0;
+}
+
+static int32_t flash_read(void* handle, uint32_t offset, uint8_t* bufp, uint16_t len)
+{
+	(void)handle;
+	memcpy(bufp, &flash_image[offset], len);
+	return 0;
+}
+
+//#pragma mark - Output -
+
+static void put_u32(uint8_t* p, uint32_t v)
+{
+	p[0] = (uint8_t)v;
+	p[1] = (uint8_t)(v >> 8);
+	p[2] = (uint8_t)(v >> 16);
+	p[3] = (uint8_t)(v >> 24);
+}
+
+static void emit(FILE* out, format_t fmt, uint32_t time_s, int32_t pa, bool storm, int32_t centi_c, bool moved,
+		int32_t alt_pa)
+{
+	uint8_t rec[12];
+
+	switch(fmt)
+	{
+	case FMT_CSV:
+		fprintf(out, "%u,%d,%d,%d,%d,%d\n", time_s, pa, storm ? 1 : 0, centi_c, moved ? 1 : 0, alt_pa);
+		break;
+	case FMT_BIN:
+		put_u32(&rec[0], time_s);
+		put_u32(&rec[4], (uint32_t)pa);
+		put_u32(&rec[8], (storm ? 1 : 0) | (moved ? 2 : 0));
+		fwrite(rec, sizeof(rec), 1, out);
+		break;
+	case FMT_CONSOLE:
+		fprintf(out, "pi %d\r\n", pa);
+		break;
+	case FMT_FLASH:
+		// stored like history_put() in main.c
+		if(pa < 90000)
+		{
+			pa = 90000;
+		}
+		else if(pa > (90000 + UINT16_MAX))
+		{
+			pa = 90000 + UINT16_MAX;
+		}
+		press_store_put((uint16_t)(pa - 90000));
+		break;
+	}
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: tracegen [-f csv|bin|console|flash] [-d days] [-i interval_s] [-s seed]\n"
+			"                [-F fronts_per_week] [-D front_depth_hpa] [-S storm_depth_hpa]\n"
+			"                [-t tide_pa] [-n noise_pa] [-a steps_per_week] [-A step_m]\n"
+			"                [-g glitch_pa] [-o file]\n"
+			"defaults: csv, 30 days, 60 s, seed 1, 2 fronts/week of 12 hPa, storms >= 15 hPa,\n"
+			"          tide 80 Pa, noise 0.5 Pa, 1 altitude step/week of up to 20 m,\n"
+			"          no glitch after a step, stdout\n");
+}
+
+int main(int argc, char* argv[])
+{
+	format_t fmt = FMT_CSV;
+	double days = 30;
+	unsigned interval = 60;
+	long seed = 1;
+	double fronts_week = 2;
+	double front_depth = 12;
+	double storm_depth = 15;
+	double tide = 80;
+	double noise = 0.5;
+	double steps_week = 1;
+	double step_m = 20;
+	double glitch = 0;
+	const char* path = NULL;
+	FILE* out = stdout;
+	press_store_ctx_t ctx;
+	unsigned nfronts = 0;
+	double next_front, next_step;
+	double t, end, walk = 0, altitude = 0;
+	double p, phase, x, temp;
+	int64_t counts;
+	int32_t pa;
+	bool storm, moved;
+	unsigned glitch_in = 0;
+	unsigned i;
+	int opt;
+
+	while((opt = getopt(argc, argv, "f:d:i:s:F:D:S:t:n:a:A:g:o:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'f':
+			if(strcmp(optarg, "csv") == 0) fmt = FMT_CSV;
+			else if(strcmp(optarg, "bin") == 0) fmt = FMT_BIN;
+			else if(strcmp(optarg, "console") == 0) fmt = FMT_CONSOLE;
+			else if(strcmp(optarg, "flash") == 0) fmt = FMT_FLASH;
+			else
+			{
+				usage();
+				return 1;
+			}
+			break;
+		case 'd': days = atof(optarg); break;
+		case 'i': interval = (unsigned)atoi(optarg); break;
+		case 's': seed = atol(optarg); break;
+		case 'F': fronts_week = atof(optarg); break;
+		case 'D': front_depth = atof(optarg); break;
+		case 'S': storm_depth = atof(optarg); break;
+		case 't': tide = atof(optarg); break;
+		case 'n': noise = atof(optarg); break;
+		case 'a': steps_week = atof(optarg); break;
+		case 'A': step_m = atof(optarg); break;
+		case 'g': glitch = atof(optarg); break;
+		case 'o': path = optarg; break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((days <= 0) || (interval == 0) || (fronts_week < 0) || (steps_week < 0))
+	{
+		usage();
+		return 1;
+	}
+
+	if(path != NULL)
+	{
+		out = fopen(path, (fmt == FMT_CSV) || (fmt == FMT_CONSOLE) ? "w" : "wb");
+		if(out == NULL)
+		{
+			perror(path);
+			return 1;
+		}
+	}
+	if(fmt == FMT_CSV)
+	{
+		fprintf(out, "time_s,pa,storm,centi_c,moved,alt_pa\n");
+	}
+	if(fmt == FMT_FLASH)
+	{
+		memset(flash_image, 0xFF, sizeof(flash_image));
+		ctx.erase = flash_erase;
+		ctx.program = flash_program;
+		ctx.read = flash_read;
+		ctx.sector_size = FLASH_SECTOR_SIZE;
+		ctx.handle = NULL;
+		press_store_init(&ctx);
+	}
+
+	srand48(seed);
+	next_front = (fronts_week > 0) ? wait_s(fronts_week) : INFINITY;
+	next_step = (steps_week > 0) ? wait_s(steps_week) : INFINITY;
+	phase = uniform() * 2.0 * M_PI;
+	end = days * 86400.0;
+
+	for(t = 0; t < end; t += interval)
+	{
+		// new fronts, the oldest finished one is reused when the table is full
+		while(t >= next_front)
+		{
+			front_t* f = &fronts[nfronts % MAX_FRONTS];
+
+			f->start_s = next_front;
+			f->fall_s = (6 + 12 * uniform()) * 3600.0;
+			f->rise_s = (12 + 12 * uniform()) * 3600.0;
+			f->depth = front_depth * 100.0 * (0.5 + uniform());
+			f->storm = f->depth >= (storm_depth * 100.0);
+			f->flagged = false;
+			nfronts++;
+			next_front += wait_s(fronts_week);
+		}
+		moved = false;
+		while(t >= next_step)
+		{
+			altitude += step_m * (2.0 * uniform() - 1.0);
+			next_step += wait_s(steps_week);
+			moved = true;
+			if(glitch > 0)
+			{
+				glitch_in = 1 + (unsigned)(uniform() * GLITCH_WITHIN);
+			}
+		}
+
+		// slow random walk pulled back to the mean (a few hPa over days)
+		walk += (-walk * interval / (3.0 * 86400.0)) + (gauss() * 8.0 * sqrt(interval / 3600.0));
+		p = 101325.0 + walk - (altitude * PA_PER_METRE);
+
+		// semi-diurnal tide with a weaker diurnal component
+		p += tide * cos((2.0 * M_PI * t / 43200.0) + phase) + (tide / 3.0) * cos((2.0 * M_PI * t / 86400.0) + phase);
+
+		storm = false;
+		for(i = 0; (i < nfronts) && (i < MAX_FRONTS); i++)
+		{
+			front_t* f = &fronts[i];
+
+			x = t - f->start_s;
+			if((x < 0) || (x > (f->fall_s + f->rise_s)))
+			{
+				continue;
+			}
+			if(x <= f->fall_s)
+			{
+				p -= f->depth * 0.5 * (1.0 - cos(M_PI * x / f->fall_s));
+			}
+			else
+			{
+				p -= f->depth * 0.5 * (1.0 + cos(M_PI * (x - f->fall_s) / f->rise_s));
+				// the storm arrives with the pressure minimum
+				if(f->storm && !f->flagged)
+				{
+					f->flagged = true;
+					storm = true;
+				}
+			}
+		}
+
+		p += gauss() * noise;
+		if((glitch_in > 0) && !moved && (--glitch_in == 0))
+		{
+			p += (uniform() < 0.5) ? -glitch : glitch;
+		}
+
+		// LPS28DFW counts at 4096 LSB/hPa, converted to Pa like barometer_data()
+		counts = llround(p * BARO_COUNTS_PER_HPA / 100.0);
+		pa = baro_counts_to_pa((int32_t)counts, false);
+
+		temp = 15.0 + 5.0 * sin((2.0 * M_PI * (t - 32400.0)) / 86400.0) + gauss() * 0.05;
+		emit(out, fmt, (uint32_t)t, pa, storm, (int32_t)lround(temp * 100.0), moved,
+				(int32_t)lround(-altitude * PA_PER_METRE));
+	}
+
+	if(fmt == FMT_FLASH)
+	{
+		press_store_flush();
+		fwrite(flash_image, sizeof(flash_image), 1, out);
+	}
+	if(out != stdout)
+	{
+		fclose(out);
+	}
+
+	return 0;
+}
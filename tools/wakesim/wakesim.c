@@ -0,0 +1,308 @@
+/*
+ * wakesim.c
+ *
+ *  Created on: Oct 16, 2026
+ *      Author: tdarlic
+ *
+ *  Host test of the wake on pressure change. src/baro_wake.c and
+ *  src/baro_fifo.c run unchanged against the register-level LPS28DFW mock
+ *  (tools/mock): the sensor converts at 1 Hz into its FIFO, the INT pin is
+ *  watched for rising edges like the EXTI line and every edge or expired
+ *  log tick drains the FIFO and rearms the reference, as main.c does. Like
+ *  main.c one sample is logged per slot, half an interval to both sides of
+ *  its nominal time: a batch before the slot is open is only handled as the
+ *  shown pressure and the log tick then drains the FIFO at the nominal time
+ *  of the next sample, every logged sample moves the next slot one interval
+ *  on.
+ *  The weather is a slow
+ *  drift with the tide and squalls, fast pressure steps of a few hPa within
+ *  minutes.
+ *
+ *  For every threshold the run is made with the timer only and with the
+ *  threshold interrupt. The lag is how far the true pressure has moved away
+ *  from the last handled sample, the pressure the storm logic works with.
+ *  Reported are the largest lag, the time per day the lag is beyond the
+ *  threshold, the logged samples, the early batches and threshold events
+ *  per hour and the shortest and longest time between two logged samples.
+ *  The history counts samples, more than one per interval fails the run
+ *  (exit status 1). The sensor
+ *  compares in steps of 1/16 hPa, the lag is counted beyond the threshold
+ *  once it exceeds the programmed one by two steps (strict comparison and
+ *  truncated reference).
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -Itools/mock -o wakesim tools/wakesim/wakesim.c \
+ *        tools/mock/lps28dfw_mock.c src/baro_wake.c src/baro_fifo.c -lm
+ *
+ *  Usage:
+ *    wakesim [-d days] [-t threshold_pa] [-q squalls_per_day] [-j step_pa] [-r step_s] [-n noise_pa] [-s seed]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <unistd.h>
+
+#include "baro_fifo.h"
+#include "baro_wake.h"
+#include "lps28dfw_mock.h"
+
+// 1260 hPa full scale, 4096 LSB/hPa
+#define COUNTS_PER_PA 40.96
+
+// THS_P and REF_P step, 1/16 hPa
+#define THS_STEP_PA 6.25
+
+// acquisition as in main.h: 1 Hz, one batch per minute, 5 s grace for the fallback tick
+#define ODR_HZ 1
+#define WATERMARK 60
+#define GRACE_S 5
+
+#define MAX_SQUALLS 1000
+
+static const baro_fifo_ctx_t fifo_ctx = {lps28dfw_mock_write, lps28dfw_mock_read, NULL, NULL};
+static const baro_wake_ctx_t wake_ctx = {lps28dfw_mock_write, lps28dfw_mock_read, NULL};
+
+static double squall_at[MAX_SQUALLS];
+static unsigned squalls;
+static double step_pa = -300.0;
+static double step_s = 300.0;
+
+// Result of one run
+typedef struct {
+	unsigned long samples;    // logged, one per slot
+	unsigned long early;      // shown only
+	unsigned long events;
+	unsigned long beyond;     // seconds the lag was beyond the threshold
+	double lag_max;
+	double gap_min;           // time between two samples
+	double gap_max;
+} run_t;
+
+//#pragma mark - Model -
+
+static double uniform(void)
+{
+	return drand48();
+}
+
+static double gauss(void)
+{
+	double u1 = uniform();
+	double u2 = uniform();
+
+	if(u1 < 1e-12)
+	{
+		u1 = 1e-12;
+	}
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+// Weather: slow drift with a semi-diurnal tide and the squall steps
+static double truth(double t)
+{
+	double p = 101325.0 - (t / 3600.0) * 20.0 + 80.0 * sin(2.0 * M_PI * t / 43200.0);
+	double x;
+	unsigned i;
+
+	for(i = 0; i < squalls; i++)
+	{
+		x = (t - squall_at[i]) / step_s;
+		p += step_pa * ((x < 0) ? 0.0 : ((x > 1) ? 1.0 : x));
+	}
+	return p;
+}
+
+//#pragma mark - Simulation -
+
+static int simulate(double t_end, uint16_t ths, bool wake, double noise, long seed, run_t* r)
+{
+	baro_fifo_batch_t batch;
+	double t;
+	double p;
+	double next_tick = WATERMARK + GRACE_S;
+	// nominal time of the next sample, main.c logTick
+	double slot = WATERMARK;
+	double last = 0;
+	double logged;
+	double lag;
+	bool int_prev = false;
+	bool ready = false;
+	bool int_now;
+	uint8_t ev;
+	// programmed threshold as baro_wake rounds it, plus the comparison steps
+	double beyond = (floor((ths * 16 + 50) / 100) + 2) * THS_STEP_PA;
+
+	// same noise for both runs
+	srand48(seed);
+	lps28dfw_mock_init();
+	if((baro_fifo_start(&fifo_ctx, WATERMARK) != 0) ||
+			(wake && (baro_wake_start(&wake_ctx, ths) != 0)))
+	{
+		fprintf(stderr, "start failed\n");
+		return -1;
+	}
+	logged = truth(0);
+
+	for(t = 0; t < t_end; t += 1.0 / ODR_HZ)
+	{
+		p = truth(t);
+		lps28dfw_mock_sample((int32_t)lround((p + gauss() * noise) * COUNTS_PER_PA), 2000);
+		lag = fabs(p - logged);
+		r->lag_max = (lag > r->lag_max) ? lag : r->lag_max;
+		r->beyond += (lag > beyond) ? 1 : 0;
+
+		// EXTI on the rising edge
+		int_now = lps28dfw_mock_int();
+		ready |= int_now && !int_prev;
+		int_prev = int_now;
+		if(!ready && (t < next_tick))
+		{
+			continue;
+		}
+
+		ready = false;
+		if(baro_fifo_drain(&batch) != 0)
+		{
+			fprintf(stderr, "drain failed at %.0f s\n", t);
+			return -1;
+		}
+		next_tick = t + WATERMARK + GRACE_S;
+		if(t < (slot - (WATERMARK / 2)))
+		{
+			// the tick takes the sample at its nominal time
+			next_tick = slot;
+			r->early++;
+		}
+		else
+		{
+			slot += WATERMARK;
+			if(t >= (slot - (WATERMARK / 2)))
+			{
+				slot = t + WATERMARK;
+			}
+			if(r->samples > 0)
+			{
+				r->gap_min = ((t - last) < r->gap_min) ? (t - last) : r->gap_min;
+				r->gap_max = ((t - last) > r->gap_max) ? (t - last) : r->gap_max;
+			}
+			last = t;
+			r->samples++;
+		}
+		if(wake)
+		{
+			if(baro_wake_rearm(&ev) != 0)
+			{
+				fprintf(stderr, "rearm failed at %.0f s\n", t);
+				return -1;
+			}
+			r->events += (ev != 0) ? 1 : 0;
+		}
+		int_prev = lps28dfw_mock_int();
+
+		logged = p;
+	}
+
+	return 0;
+}
+
+static void print_run(uint16_t ths, const char* mode, const run_t* r, double hours)
+{
+	printf("%6u Pa  %-6s %9.1f %7.1f %9.1f %9.1f %11.1f %6.0f %6.0f\n", ths, mode,
+			r->samples / hours, r->early / hours, r->events / hours, r->lag_max, r->beyond / (hours / 24.0),
+			r->gap_min, r->gap_max);
+}
+
+//#pragma mark - Main -
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: wakesim [-d days] [-t threshold_pa] [-q squalls_per_day] [-j step_pa] [-r step_s] [-n noise_pa] [-s seed]\n"
+			"  defaults: 7 days, thresholds 10, 20, 50, 100 Pa, 4 squalls per day of -300 Pa over 300 s,\n"
+			"  noise 1.0 Pa, seed 1\n");
+}
+
+int main(int argc, char* argv[])
+{
+	static const uint16_t sweep[] = {10, 20, 50, 100};
+	double days = 7.0;
+	int threshold = 0;
+	double per_day = 4.0;
+	double noise = 1.0;
+	long seed = 1;
+	double t_end, hours;
+	unsigned long slots;
+	unsigned fail = 0;
+	run_t timer, wake;
+	uint16_t ths;
+	unsigned i;
+	int opt;
+
+	while((opt = getopt(argc, argv, "d:t:q:j:r:n:s:h")) != -1)
+	{
+		switch(opt)
+		{
+		case 'd': days = atof(optarg); break;
+		case 't': threshold = atoi(optarg); break;
+		case 'q': per_day = atof(optarg); break;
+		case 'j': step_pa = atof(optarg); break;
+		case 'r': step_s = atof(optarg); break;
+		case 'n': noise = atof(optarg); break;
+		case 's': seed = atol(optarg); break;
+		default:
+			usage();
+			return 1;
+		}
+	}
+	if((days <= 0) || (per_day < 0) || (step_s < 1) || (noise < 0) ||
+			((threshold != 0) && ((threshold < BARO_WAKE_MIN_PA) || (threshold > BARO_WAKE_MAX_PA))) ||
+			((days * per_day) > MAX_SQUALLS))
+	{
+		usage();
+		return 1;
+	}
+	t_end = days * 86400.0;
+	hours = t_end / 3600.0;
+	slots = (unsigned long)(t_end / WATERMARK) + 1;
+
+	srand48(seed + 1);
+	squalls = (unsigned)(days * per_day);
+	for(i = 0; i < squalls; i++)
+	{
+		squall_at[i] = uniform() * t_end;
+	}
+
+	printf("%.1f h, %u squalls of %.0f Pa over %.0f s, noise %.2f Pa, 1 Hz, batch every %u s\n",
+			hours, squalls, step_pa, step_s, noise, WATERMARK);
+	printf("threshold  mode   samples/h early/h  events/h  lag Pa  beyond s/day  gap s  max s\n");
+	for(i = 0; i < (sizeof(sweep) / sizeof(sweep[0])); i++)
+	{
+		ths = (threshold != 0) ? (uint16_t)threshold : sweep[i];
+		timer = (run_t){.gap_min = t_end};
+		wake = (run_t){.gap_min = t_end};
+		if((simulate(t_end, ths, false, noise, seed, &timer) != 0) ||
+				(simulate(t_end, ths, true, noise, seed, &wake) != 0))
+		{
+			return 1;
+		}
+		print_run(ths, "timer", &timer, hours);
+		print_run(ths, "wake", &wake, hours);
+		if((timer.samples > slots) || (wake.samples > slots))
+		{
+			fail++;
+		}
+		if(threshold != 0)
+		{
+			break;
+		}
+	}
+	if(fail != 0)
+	{
+		printf("more than one sample per %u s interval\n", WATERMARK);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,226 @@
+/*
+ * zamcheck.c
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: tdarlic
+ *
+ *  Host check of the Zambretti forecaster (src/zambretti.c). Two parts:
+ *
+ *    - a table of cases with the expected letter and text, at least one
+ *      for every forecast A..Z, with both trends, the trend threshold, the
+ *      summer shift and pressures below and above the 950..1050 hPa range
+ *    - a sweep of 900..1100 hPa in steps of 1 Pa for every trend around
+ *      the threshold and every month against a reference written after
+ *      the published algorithm (option = floor((hPa - 950) / (100 / 22)),
+ *      7 % of the range added when rising or taken off when falling in
+ *      April..September, clamped to the 22 options), in double
+ *
+ *  Also checked: the letter and text of codes past Z. A mismatch makes
+ *  the exit status 1.
+ *
+ *  Build (from the repository root):
+ *    gcc -O2 -std=gnu11 -Iinc -o zamcheck tools/zamcheck/zamcheck.c src/zambretti.c -lm
+ *
+ *  Usage:
+ *    zamcheck
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+
+#include "zambretti.h"
+
+// Options of the published algorithm, lowest pressure first, 0 is A
+static const uint8_t ref_rising[22] = {25, 25, 25, 24, 24, 19, 16, 12, 11, 9, 8, 6, 5, 2, 1, 1, 0, 0, 0, 0, 0, 0};
+static const uint8_t ref_steady[22] = {25, 25, 25, 25, 25, 25, 23, 23, 22, 18, 15, 13, 10, 4, 1, 1, 0, 0, 0, 0, 0, 0};
+static const uint8_t ref_falling[22] = {25, 25, 25, 25, 25, 25, 25, 25, 23, 23, 21, 20, 17, 14, 7, 3, 1, 1, 1, 0, 0, 0};
+
+// One case of the table
+typedef struct {
+	int32_t pa;
+	int32_t change_3h;
+	uint8_t month;
+	char letter;
+	const char* text;
+} zcase_t;
+
+static const zcase_t cases[] =
+{
+	// rising, no season
+	{ 95200,   200,  0, 'Z', "Stormy, much rain"},
+	{ 96600,   200,  0, 'Y', "Stormy, may improve"},
+	{ 97500,   200,  0, 'T', "Mostly very unsettled"},
+	{ 98000,   200,  0, 'Q', "Unsettled, short fine intervals"},
+	{ 98400,   200,  0, 'M', "Unsettled, probably improving"},
+	{ 98900,   200,  0, 'L', "Rather unsettled, clearing later"},
+	{ 99300,   200,  0, 'J', "Changeable, mending"},
+	{ 99800,   200,  0, 'I', "Showery early, improving"},
+	{100200,   200,  0, 'G', "Fairly fine, possible showers early"},
+	{100700,   200,  0, 'F', "Fairly fine, improving"},
+	{101100,   200,  0, 'C', "Becoming fine"},
+	{101600,   200,  0, 'B', "Fine weather"},
+	{102500,   200,  0, 'A', "Settled fine"},
+	// steady
+	{ 95200,     0,  0, 'Z', "Stormy, much rain"},
+	{ 98000,     0,  0, 'X', "Rain, very unsettled"},
+	{ 98900,     0,  0, 'W', "Rain at frequent intervals"},
+	{ 99300,     0,  0, 'S', "Unsettled, some rain"},
+	{ 99800,     0,  0, 'P', "Changeable, some rain"},
+	{100200,     0,  0, 'N', "Showery, bright intervals"},
+	{100700,     0,  0, 'K', "Fairly fine, showers likely"},
+	{101100,     0,  0, 'E', "Fine, possible showers"},
+	{101600,     0,  0, 'B', "Fine weather"},
+	{102500,     0,  0, 'A', "Settled fine"},
+	// falling
+	{ 95200,  -200,  0, 'Z', "Stormy, much rain"},
+	{ 98900,  -200,  0, 'X', "Rain, very unsettled"},
+	{ 99800,  -200,  0, 'V', "Rain at times, very unsettled"},
+	{100200,  -200,  0, 'U', "Occasional rain, worsening"},
+	{100700,  -200,  0, 'R', "Unsettled, rain later"},
+	{101100,  -200,  0, 'O', "Showery, becoming less settled"},
+	{101600,  -200,  0, 'H', "Fairly fine, showery later"},
+	{102000,  -200,  0, 'D', "Fine, becoming less settled"},
+	{102500,  -200,  0, 'B', "Fine weather"},
+	{103900,  -200,  0, 'A', "Settled fine"},
+	// the trend threshold of 1.6 hPa counts, 1.59 hPa is steady
+	{100200,   160,  0, 'G', "Fairly fine, possible showers early"},
+	{100200,  -160,  0, 'U', "Occasional rain, worsening"},
+	{100200,   159,  0, 'N', "Showery, bright intervals"},
+	{100200,  -159,  0, 'N', "Showery, bright intervals"},
+	// summer moves a rising pressure up and a falling one down by 7 hPa, winter and no month do not
+	{ 99300,   200,  6, 'G', "Fairly fine, possible showers early"},
+	{ 99300,   200, 12, 'J', "Changeable, mending"},
+	{100700,  -200,  4, 'U', "Occasional rain, worsening"},
+	{100700,  -200,  9, 'U', "Occasional rain, worsening"},
+	{100700,  -200, 10, 'R', "Unsettled, rain later"},
+	{ 99800,     0,  7, 'P', "Changeable, some rain"},
+	// outside of 950..1050 hPa the first and the last option
+	{ 80000,     0,  0, 'Z', "Stormy, much rain"},
+	{120000,     0,  0, 'A', "Settled fine"},
+	{120000,  -200,  0, 'A', "Settled fine"},
+	{ 80000,   200,  7, 'Z', "Stormy, much rain"},
+};
+
+static const int32_t changes[] = {-5000, -161, -160, -159, 0, 159, 160, 161, 5000};
+
+static unsigned long failures;
+
+//#pragma mark - Reference -
+
+static uint8_t reference(int32_t pa, int32_t change_3h, uint8_t month)
+{
+	const uint8_t* options = ref_steady;
+	bool summer = (month >= 4) && (month <= 9);
+	double p = pa;
+	double option;
+
+	// 7 % of the 100 hPa range is 700 Pa
+	if(change_3h >= 160)
+	{
+		options = ref_rising;
+		p += summer ? 700.0 : 0.0;
+	}
+	else if(change_3h <= -160)
+	{
+		options = ref_falling;
+		p -= summer ? 700.0 : 0.0;
+	}
+	// (hPa - 950) / (100 / 22) in Pa, exact in a double
+	option = floor((p - 95000.0) * 22.0 / 10000.0);
+	option = (option < 0) ? 0 : ((option > 21) ? 21 : option);
+
+	return options[(int)option];
+}
+
+//#pragma mark - Check -
+
+static void fail(int32_t pa, int32_t change_3h, uint8_t month, const char* what, char got, char exp)
+{
+	if(failures++ < 10)
+	{
+		printf("  %d Pa, change %d Pa, month %u: %s %c, expected %c\n", pa, change_3h, month, what, got, exp);
+	}
+}
+
+static void check_cases(void)
+{
+	bool seen[ZAMBRETTI_COUNT] = {false};
+	const zcase_t* c;
+	uint8_t code;
+	size_t i;
+
+	for(i = 0; i < (sizeof(cases) / sizeof(cases[0])); i++)
+	{
+		c = &cases[i];
+		code = zambretti_forecast(c->pa, c->change_3h, c->month);
+		if(zambretti_letter(code) != c->letter)
+		{
+			fail(c->pa, c->change_3h, c->month, "letter", zambretti_letter(code), c->letter);
+		}
+		else if(strcmp(zambretti_text(code), c->text) != 0)
+		{
+			fail(c->pa, c->change_3h, c->month, "text of", zambretti_letter(code), c->letter);
+		}
+		seen[c->letter - 'A'] = true;
+	}
+	for(i = 0; i < ZAMBRETTI_COUNT; i++)
+	{
+		if(!seen[i])
+		{
+			printf("  no case for %c\n", (char)('A' + i));
+			failures++;
+		}
+	}
+	printf("%zu cases\n", sizeof(cases) / sizeof(cases[0]));
+}
+
+static void check_sweep(void)
+{
+	unsigned long n = 0;
+	uint8_t code, exp;
+	int32_t pa;
+	uint8_t month;
+	size_t c;
+
+	for(c = 0; c < (sizeof(changes) / sizeof(changes[0])); c++)
+	{
+		for(month = 0; month <= 12; month++)
+		{
+			for(pa = 90000; pa <= 110000; pa++)
+			{
+				code = zambretti_forecast(pa, changes[c], month);
+				exp = reference(pa, changes[c], month);
+				if(code != exp)
+				{
+					fail(pa, changes[c], month, "sweep", zambretti_letter(code), zambretti_letter(exp));
+				}
+				n++;
+			}
+		}
+	}
+	printf("%lu sweep points\n", n);
+}
+
+//#pragma mark - Main -
+
+int main(void)
+{
+	check_cases();
+	check_sweep();
+
+	// codes past Z
+	if((zambretti_letter(ZAMBRETTI_COUNT) != '?') || (strcmp(zambretti_text(ZAMBRETTI_COUNT), "-") != 0) ||
+			(zambretti_letter(UINT8_MAX) != '?'))
+	{
+		printf("  code past Z\n");
+		failures++;
+	}
+
+	printf("%s: %lu failures\n", (failures == 0) ? "ok" : "FAILED", failures);
+
+	return (failures == 0) ? 0 : 1;
+}